@@ -45,9 +45,9 @@ void ParseFrame::clear()
 {
    last_poped = genDummy();
 
-   pse = Container{};
-   pse.reserve(CONTAINER_INIT_SIZE);
-   pse.push_back(genDummy());
+   pse = std::make_shared<Container>();
+   pse->reserve(CONTAINER_INIT_SIZE);
+   pse->push_back(genDummy());
 
    ref_no       = 0;
    level        = 0;
@@ -67,6 +67,22 @@ ParseFrame::ParseFrame()
 }
 
 
+Container &ParseFrame::stack()
+{
+   if (pse.use_count() > 1)
+   {
+      pse = std::make_shared<Container>(*pse);
+   }
+   return(*pse);
+}
+
+
+const Container &ParseFrame::stack() const
+{
+   return(*pse);
+}
+
+
 bool ParseFrame::empty() const
 {
    // always at least one (dummy) element inside pse guaranteed
@@ -77,13 +93,13 @@ bool ParseFrame::empty() const
 
 ContainerType &ParseFrame::at(size_t idx)
 {
-   return(pse.at(idx));
+   return(stack().at(idx));
 }
 
 
 const ContainerType &ParseFrame::at(size_t idx) const
 {
-   return(pse.at(idx));
+   return(stack().at(idx));
 }
 
 
@@ -97,14 +113,14 @@ ContainerType &ParseFrame::prev(size_t idx)
                              + " idx can't be zero");
    }
 
-   if (idx >= pse.size())
+   if (idx >= stack().size())
    {
       LOG_FMT(LINDPSE, "%s(%d): idx is %zu, size is %zu\n",
-              __func__, __LINE__, idx, pse.size());
+              __func__, __LINE__, idx, stack().size());
       throw invalid_argument(string(__FILE__) + ":" + to_string(__LINE__)
                              + " idx can't be >= size()");
    }
-   return(*std::prev(std::end(pse), idx + 1));
+   return(*std::prev(std::end(stack()), idx + 1));
 }
 
 
@@ -112,12 +128,12 @@ const ContainerType &ParseFrame::prev(size_t idx) const
 {
    LOG_FUNC_ENTRY();
 
-   if (idx == 0 || idx >= pse.size())
+   if (idx == 0 || idx >= stack().size())
    {
       throw invalid_argument(string(__FILE__) + ":" + to_string(__LINE__)
                              + " idx can't be zero or >= size()");
    }
-   return(*std::prev(std::end(pse), idx + 1));
+   return(*std::prev(std::end(stack()), idx + 1));
 }
 
 
@@ -129,7 +145,7 @@ ContainerType &ParseFrame::top()
 //      throw logic_error(string(__FILE__) + ":" + to_string(__LINE__)
 //                        + " called top on an empty stack");
 //   }
-   return(*std::prev(std::end(pse)));
+   return(*std::prev(std::end(stack())));
 }
 
 
@@ -141,7 +157,7 @@ const ContainerType &ParseFrame::top() const
 //      throw logic_error(string(__FILE__) + ":" + to_string(__LINE__)
 //                        + " called top on an empty stack");
 //   }
-   return(*std::prev(std::end(pse)));
+   return(*std::prev(std::end(stack())));
 }
 
 
@@ -174,7 +190,9 @@ void ParseFrame::push(chunk_t *pc, const char *func, int line, brace_stage_e sta
    new_entry.non_vardef = false;
    new_entry.ip         = top().ip;
 
-   pse.push_back(new_entry);
+   Container &entries = stack();
+
+   entries.push_back(new_entry);
 
 // un comment the line below to get the address of the pse
 // #define DEBUG_PUSH_POP
@@ -183,13 +201,13 @@ void ParseFrame::push(chunk_t *pc, const char *func, int line, brace_stage_e sta
            "brace_level is %zu, level is %zu, pse_tos: %zu -> %zu\n",
            func, line, (size_t)this, pc->orig_line, pc->orig_col,
            get_token_name(pc->type), pc->brace_level, pc->level,
-           (pse.size() - 2), (pse.size() - 1));
+           (entries.size() - 2), (entries.size() - 1));
 #else /* DEBUG_PUSH_POP */
    LOG_FMT(LINDPSE, "ParseFrame::push(%s:%d): orig_line is %zu, orig_col is %zu, type is %s, "
            "brace_level is %zu, level is %zu, pse_tos: %zu -> %zu\n",
            func, line, pc->orig_line, pc->orig_col,
            get_token_name(pc->type), pc->brace_level, pc->level,
-           (pse.size() - 2), (pse.size() - 1));
+           (entries.size() - 2), (entries.size() - 1));
 #endif /* DEBUG_PUSH_POP */
 }
 
@@ -198,6 +216,8 @@ void ParseFrame::pop(const char *func, int line)
 {
    LOG_FUNC_ENTRY();
 
+   Container &entries = stack();
+
    // always at least one (dummy) element inside pse guaranteed
 //   if (pse.empty())
 //   {
@@ -208,26 +228,26 @@ void ParseFrame::pop(const char *func, int line)
 #ifdef DEBUG_PUSH_POP
    LOG_FMT(LINDPSE, "ParseFrame::pop (%s:%d) Add is %zu: open_line is %zu, clos_col is %zu, type is %s, "
            "cpd.level   is %d, level is %zu, pse_tos: %zu -> %zu\n",
-           func, line, (size_t)this, pse.back().open_line, pse.back().open_colu,
-           get_token_name(pse.back().type), cpd.pp_level, pse.back().level,
-           (pse.size() - 1), (pse.size() - 2));
+           func, line, (size_t)this, entries.back().open_line, entries.back().open_colu,
+           get_token_name(entries.back().type), cpd.pp_level, entries.back().level,
+           (entries.size() - 1), (entries.size() - 2));
 #else /* DEBUG_PUSH_POP */
    LOG_FMT(LINDPSE, "ParseFrame::pop (%s:%d): open_line is %zu, clos_col is %zu, type is %s, "
            "cpd.level   is %d, level is %zu, pse_tos: %zu -> %zu\n",
-           func, line, pse.back().open_line, pse.back().open_colu,
-           get_token_name(pse.back().type), cpd.pp_level, pse.back().level,
-           (pse.size() - 1), (pse.size() - 2));
+           func, line, entries.back().open_line, entries.back().open_colu,
+           get_token_name(entries.back().type), cpd.pp_level, entries.back().level,
+           (entries.size() - 1), (entries.size() - 2));
 #endif /* DEBUG_PUSH_POP */
 
-   last_poped = *std::prev(std::end(pse));
+   last_poped = *std::prev(std::end(entries));
 
-   if (pse.size() == 1)
+   if (entries.size() == 1)
    {
-      *std::begin(pse) = genDummy();
+      *std::begin(entries) = genDummy();
    }
    else
    {
-      pse.pop_back();
+      entries.pop_back();
    }
 }
 
@@ -235,7 +255,7 @@ void ParseFrame::pop(const char *func, int line)
 size_t ParseFrame::size() const
 {
    // always at least one (dummy) element inside pse guaranteed
-   return(pse.size());
+   return(stack().size());
 }
 
 
@@ -248,47 +268,47 @@ const paren_stack_entry_t &ParseFrame::poped() const
 // TODO C++14: see abstract versions: std::rend, std::cend, std::crend ...
 ParseFrame::iterator ParseFrame::begin()
 {
-   return(std::begin(pse));
+   return(std::begin(stack()));
 }
 
 
 ParseFrame::const_iterator ParseFrame::begin() const
 {
-   return(std::begin(pse));
+   return(std::begin(stack()));
 }
 
 
 ParseFrame::reverse_iterator ParseFrame::rbegin()
 {
-   return(pse.rbegin());
+   return(stack().rbegin());
 }
 
 
 ParseFrame::const_reverse_iterator ParseFrame::rbegin() const
 {
-   return(pse.rbegin());
+   return(stack().rbegin());
 }
 
 
 ParseFrame::iterator ParseFrame::end()
 {
-   return(std::end(pse));
+   return(std::end(stack()));
 }
 
 
 ParseFrame::const_iterator ParseFrame::end() const
 {
-   return(std::end(pse));
+   return(std::end(stack()));
 }
 
 
 ParseFrame::reverse_iterator ParseFrame::rend()
 {
-   return(pse.rend());
+   return(stack().rend());
 }
 
 
 ParseFrame::const_reverse_iterator ParseFrame::rend() const
 {
-   return(pse.rend());
+   return(stack().rend());
 }
@@ -39,14 +39,24 @@ struct paren_stack_entry_t
    chunk_t       *pop_pc;
 };
 
+/**
+ * The paren stack is shared between copies of a frame until one of them
+ * changes it, as the preprocessor branch handling copies whole frames on
+ * every #if, #else and #endif, and most of those copies are thrown away
+ * unchanged.
+ */
 class ParseFrame
 {
 private:
-   std::vector<paren_stack_entry_t> pse;
-   paren_stack_entry_t              last_poped;
+   std::shared_ptr<std::vector<paren_stack_entry_t> > pse;
+   paren_stack_entry_t                                last_poped;
 
    void clear();
 
+   //! the paren stack, made a copy of its own first if it is shared
+   std::vector<paren_stack_entry_t> &stack();
+   const std::vector<paren_stack_entry_t> &stack() const;
+
 public:
    size_t    ref_no;
    size_t    level;           //! level of parens/square/angle/brace
@@ -32,6 +32,7 @@
 #include "uncrustify.h"
 
 
+using namespace std;
 using namespace uncrustify;
 
 
@@ -113,15 +114,145 @@ using namespace uncrustify;
  *     typedef int32_t     INT32;
  *     typedef uint32_t    UINT32;
  */
+//! The chunks the aligners start from, in the order of the chunk list
+struct align_candidates_t
+{
+   bool              typedefs     = false;
+   bool              oc_msgs      = false;
+   bool              braces       = false;
+   bool              oc_msg_specs = false;
+   bool              oc_scopes    = false;
+   bool              asm_colons   = false;
+   bool              func_parens  = false;
+
+   vector<chunk_t *> typedef_chunks;     //! newlines, typedefs and anchors
+   vector<chunk_t *> oc_msg_chunks;      //! open squares
+   vector<chunk_t *> brace_chunks;       //! open braces
+   vector<chunk_t *> oc_msg_spec_chunks; //! newlines and OC message specs
+   vector<chunk_t *> oc_scope_chunks;    //! OC scopes
+   vector<chunk_t *> asm_colon_chunks;   //! asm colons
+   vector<chunk_t *> func_paren_chunks;  //! open function parenthesis
+};
+
+
+//! Fills the lists of the enabled aligners in a single walk
+static void collect_candidates(align_candidates_t &cand)
+{
+   if (  !cand.typedefs
+      && !cand.oc_msgs
+      && !cand.braces
+      && !cand.oc_msg_specs
+      && !cand.oc_scopes
+      && !cand.asm_colons
+      && !cand.func_parens)
+   {
+      return;
+   }
+
+   for (chunk_t *pc = chunk_get_head(); pc != nullptr; pc = chunk_get_next(pc))
+   {
+      if (chunk_is_newline(pc))
+      {
+         if (cand.typedefs)
+         {
+            cand.typedef_chunks.push_back(pc);
+         }
+
+         if (cand.oc_msg_specs)
+         {
+            cand.oc_msg_spec_chunks.push_back(pc);
+         }
+         continue;
+      }
+
+      if (  cand.typedefs
+         && (  chunk_is_token(pc, CT_TYPEDEF)
+            || pc->flags.test(PCF_ANCHOR)))
+      {
+         cand.typedef_chunks.push_back(pc);
+      }
+
+      switch (pc->type)
+      {
+      case CT_SQUARE_OPEN:
+
+         if (cand.oc_msgs)
+         {
+            cand.oc_msg_chunks.push_back(pc);
+         }
+         break;
+
+      case CT_BRACE_OPEN:
+
+         if (cand.braces)
+         {
+            cand.brace_chunks.push_back(pc);
+         }
+         break;
+
+      case CT_OC_MSG_SPEC:
+
+         if (cand.oc_msg_specs)
+         {
+            cand.oc_msg_spec_chunks.push_back(pc);
+         }
+         break;
+
+      case CT_OC_SCOPE:
+
+         if (cand.oc_scopes)
+         {
+            cand.oc_scope_chunks.push_back(pc);
+         }
+         break;
+
+      case CT_ASM_COLON:
+
+         if (cand.asm_colons)
+         {
+            cand.asm_colon_chunks.push_back(pc);
+         }
+         break;
+
+      case CT_FPAREN_OPEN:
+
+         if (cand.func_parens)
+         {
+            cand.func_paren_chunks.push_back(pc);
+         }
+         break;
+
+      default:
+         break;
+      } // switch
+   }
+} // collect_candidates
+
+
 void align_all(void)
 {
    LOG_FUNC_ENTRY();
 
+   align_candidates_t cand;
+
+   // The rules are logged below, where they are used
+   cand.typedefs     = options::align_typedef_span() > 0;
+   cand.oc_msgs      = options::align_oc_msg_colon_span() > 0;
+   cand.braces       = options::align_struct_init_span() > 0;
+   cand.oc_msg_specs = options::align_oc_msg_spec_span() > 0;
+   cand.oc_scopes    = options::align_oc_decl_colon();
+   cand.asm_colons   = options::align_asm_colon();
+   cand.func_parens  = (  options::align_func_params()
+                       || options::align_func_params_span() > 0);
+
+   // The aligners below only move columns, so one walk finds where they start
+   collect_candidates(cand);
+
    log_rule_B("align_typedef_span");
 
-   if (options::align_typedef_span() > 0)
+   if (cand.typedefs)
    {
-      align_typedefs(options::align_typedef_span());
+      align_typedefs(options::align_typedef_span(), cand.typedef_chunks);
    }
    log_rule_B("align_left_shift");
 
@@ -131,9 +262,9 @@ void align_all(void)
    }
    log_rule_B("align_oc_msg_colon_span");
 
-   if (options::align_oc_msg_colon_span() > 0)
+   if (cand.oc_msgs)
    {
-      align_oc_msg_colons();
+      align_oc_msg_colons(cand.oc_msg_chunks);
    }
    // Align variable definitions
    log_rule_B("align_var_def_span");
@@ -161,9 +292,9 @@ void align_all(void)
    // Align structure initializers
    log_rule_B("align_struct_init_span");
 
-   if (options::align_struct_init_span() > 0)
+   if (cand.braces)
    {
-      align_struct_initializers();
+      align_struct_initializers(cand.brace_chunks);
    }
    // Align function prototypes
    log_rule_B("align_func_proto_span");
@@ -177,31 +308,30 @@ void align_all(void)
    // Align function prototypes
    log_rule_B("align_oc_msg_spec_span");
 
-   if (options::align_oc_msg_spec_span() > 0)
+   if (cand.oc_msg_specs)
    {
-      align_oc_msg_spec(options::align_oc_msg_spec_span());
+      align_oc_msg_spec(options::align_oc_msg_spec_span(), cand.oc_msg_spec_chunks);
    }
    // Align OC colons
    log_rule_B("align_oc_decl_colon");
 
-   if (options::align_oc_decl_colon())
+   if (cand.oc_scopes)
    {
-      align_oc_decl_colon();
+      align_oc_decl_colon(cand.oc_scope_chunks);
    }
    log_rule_B("align_asm_colon");
 
-   if (options::align_asm_colon())
+   if (cand.asm_colons)
    {
-      align_asm_colon();
+      align_asm_colon(cand.asm_colon_chunks);
    }
    // Align variable definitions in function prototypes
    log_rule_B("align_func_params");
    log_rule_B("align_func_params_span");
 
-   if (  options::align_func_params()
-      || options::align_func_params_span() > 0)
+   if (cand.func_parens)
    {
-      align_func_params();
+      align_func_params(cand.func_paren_chunks);
    }
    log_rule_B("align_same_func_call_params");
 
@@ -10,10 +10,11 @@
 #include "align_asm_colon.h"
 
 #include "align_stack.h"
+#include "align_tools.h"
 #include "chunk_list.h"
 
 
-void align_asm_colon(void)
+void align_asm_colon(const std::vector<chunk_t *> &candidates)
 {
    LOG_FUNC_ENTRY();
 
@@ -22,13 +23,14 @@ void align_asm_colon(void)
 
    cas.Start(4);
 
-   chunk_t *pc = chunk_get_head();
+   size_t idx = 0;
 
-   while (pc != nullptr)
+   while (idx < candidates.size())
    {
+      chunk_t *pc = candidates[idx++];
+
       if (pc->type != CT_ASM_COLON)
       {
-         pc = chunk_get_next(pc);
          continue;
       }
       cas.Reset();
@@ -57,5 +59,8 @@ void align_asm_colon(void)
          pc = chunk_get_next_nc(pc, scope_e::PREPROC);
       }
       cas.End();
+
+      // The colons of the same statement were handled above
+      idx = skip_passed_candidates(candidates, idx, pc);
    }
 } // align_asm_colon
@@ -9,6 +9,9 @@
 #ifndef ALIGN_ASM_COLON_H_INCLUDED
 #define ALIGN_ASM_COLON_H_INCLUDED
 
+#include "uncrustify_types.h"
+
+#include <vector>
 
 /**
  * Aligns asm declarations on the colon
@@ -18,7 +21,9 @@
  *      "y"(l),
  *    : "z"(h)
  *    );
+ *
+ * @param candidates  the asm colons, in order
  */
-void align_asm_colon(void);
+void align_asm_colon(const std::vector<chunk_t *> &candidates);
 
 #endif /* ALIGN_ASM_COLON_H_INCLUDED */
@@ -9,6 +9,7 @@
 
 #include "align_func_params.h"
 #include "align_stack.h"
+#include "align_tools.h"
 #include "log_rules.h"
 
 #include <algorithm>                           // to get max
@@ -159,13 +160,15 @@ chunk_t *align_func_param(chunk_t *start)
 } // align_func_param
 
 
-void align_func_params(void)
+void align_func_params(const std::vector<chunk_t *> &candidates)
 {
    LOG_FUNC_ENTRY();
-   chunk_t *pc = chunk_get_head();
+   size_t idx = 0;
 
-   while ((pc = chunk_get_next(pc)) != nullptr)
+   while (idx < candidates.size())
    {
+      chunk_t *pc = candidates[idx++];
+
       LOG_FMT(LFLPAREN, "%s(%d): orig_line is %zu, orig_col is %zu, text() is '%s', parent_type is %s, parent_type is %s\n",
               __func__, __LINE__, pc->orig_line, pc->orig_col, pc->text(),
               get_token_name(pc->type), get_token_name(pc->parent_type));
@@ -180,6 +183,7 @@ void align_func_params(void)
          continue;
       }
       // We are on a open parenthesis of a prototype
-      pc = align_func_param(pc);
+      pc  = align_func_param(pc);
+      idx = skip_passed_candidates(candidates, idx, chunk_get_next(pc));
    }
 } // void align_func_params
@@ -12,7 +12,14 @@
 
 #include "chunk_list.h"
 
-void align_func_params(void);
+#include <vector>
+
+/**
+ * Aligns the parameters of function prototypes and definitions.
+ *
+ * @param candidates  the open parenthesis of the functions, in order
+ */
+void align_func_params(const std::vector<chunk_t *> &candidates);
 
 chunk_t *align_func_param(chunk_t *start);
 
@@ -19,20 +19,20 @@
 using namespace uncrustify;
 
 
-void align_init_brace(chunk_t *start)
+void align_init_brace(chunk_t *start, ib_table_t &table)
 {
    LOG_FUNC_ENTRY();
 
    chunk_t *num_token = nullptr;
 
-   cpd.al_cnt       = 0;
-   cpd.al_c99_array = false;
+   table.al.clear();
+   table.c99_array = false;
 
    LOG_FMT(LALBR, "%s(%d): start @ orig_line is %zu, orig_col is %zu\n",
            __func__, __LINE__, start->orig_line, start->orig_col);
 
    chunk_t *pc       = chunk_get_next_ncnl(start);
-   chunk_t *pcSingle = scan_ib_line(pc, true);
+   chunk_t *pcSingle = scan_ib_line(pc, table);
 
    if (  pcSingle == nullptr
       || (chunk_is_token(pcSingle, CT_BRACE_CLOSE) && get_chunk_parent_type(pcSingle) == CT_ASSIGN))
@@ -45,12 +45,12 @@ void align_init_brace(chunk_t *start)
 
    do
    {
-      pc = scan_ib_line(pc, false);
+      pc = scan_ib_line(pc, table);
 
       // debug dump the current frame
       LOG_FMT(LALBR, "%s(%d): debug dump after, orig_line is %zu\n",
               __func__, __LINE__, pc->orig_line);
-      align_log_al(LALBR, pc->orig_line);
+      align_log_al(LALBR, pc->orig_line, table.al);
 
       while (chunk_is_newline(pc))
       {
@@ -59,15 +59,15 @@ void align_init_brace(chunk_t *start)
    } while (pc != nullptr && pc->level > start->level);
 
    // debug dump the current frame
-   align_log_al(LALBR, start->orig_line);
+   align_log_al(LALBR, start->orig_line, table.al);
 
    log_rule_B("align_on_tabstop");
 
    if (  options::align_on_tabstop()
-      && cpd.al_cnt >= 1
-      && (cpd.al[0].type == CT_ASSIGN))
+      && !table.al.empty()
+      && (table.al[0].type == CT_ASSIGN))
    {
-      cpd.al[0].col = align_tab_column(cpd.al[0].col);
+      table.al[0].col = align_tab_column(table.al[0].col);
    }
    pc = chunk_get_next(start);
    size_t idx = 0;
@@ -89,14 +89,14 @@ void align_init_brace(chunk_t *start)
       }
       chunk_t *next = pc;
 
-      if (idx < cpd.al_cnt)
+      if (idx < table.al.size())
       {
          LOG_FMT(LALBR, " (%zu) check %s vs %s -- ",
-                 idx, get_token_name(pc->type), get_token_name(cpd.al[idx].type));
+                 idx, get_token_name(pc->type), get_token_name(table.al[idx].type));
 
-         if (pc->type == cpd.al[idx].type)
+         if (pc->type == table.al[idx].type)
          {
-            if (idx == 0 && cpd.al_c99_array)
+            if (idx == 0 && table.c99_array)
             {
                chunk_t *prev = chunk_get_prev(pc);
 
@@ -105,16 +105,16 @@ void align_init_brace(chunk_t *start)
                   chunk_flags_set(pc, PCF_DONT_INDENT);
                }
             }
-            LOG_FMT(LALBR, " [%s] to col %zu\n", pc->text(), cpd.al[idx].col);
+            LOG_FMT(LALBR, " [%s] to col %zu\n", pc->text(), table.al[idx].col);
 
             if (num_token != nullptr)
             {
                int col_diff = pc->column - num_token->column;
 
-               reindent_line(num_token, cpd.al[idx].col - col_diff);
+               reindent_line(num_token, table.al[idx].col - col_diff);
                //LOG_FMT(LSYS, "-= %zu =- NUM indent [%s] col=%d diff=%d\n",
                //        num_token->orig_line,
-               //        num_token->text(), cpd.al[idx - 1].col, col_diff);
+               //        num_token->text(), table.al[idx - 1].col, col_diff);
 
                chunk_flags_set(num_token, PCF_WAS_ALIGNED);
                num_token = nullptr;
@@ -129,11 +129,11 @@ void align_init_brace(chunk_t *start)
                {
                   //LOG_FMT(LSYS, "-= %zu =- indent [%s] col=%d len=%d\n",
                   //        next->orig_line,
-                  //        next->text(), cpd.al[idx].col, cpd.al[idx].len);
+                  //        next->text(), table.al[idx].col, table.al[idx].len);
 
                   log_rule_B("align_number_right");
 
-                  if (  (idx < (cpd.al_cnt - 1))
+                  if (  (idx < (table.al.size() - 1))
                      && options::align_number_right()
                      && (  chunk_is_token(next, CT_NUMBER_FP)
                         || chunk_is_token(next, CT_NUMBER)
@@ -143,11 +143,11 @@ void align_init_brace(chunk_t *start)
                      // Need to wait until the next match to indent numbers
                      num_token = next;
                   }
-                  else if (idx < (cpd.al_cnt - 1))
+                  else if (idx < (table.al.size() - 1))
                   {
-                     LOG_FMT(LALBR, "%s(%d): idx is %zu, al_cnt is %zu, cpd.al[%zu].col is %zu, cpd.al[%zu].len is %zu\n",
-                             __func__, __LINE__, idx, cpd.al_cnt, idx, cpd.al[idx].col, idx, cpd.al[idx].len);
-                     reindent_line(next, cpd.al[idx].col + cpd.al[idx].len);
+                     LOG_FMT(LALBR, "%s(%d): idx is %zu, al_cnt is %zu, al[%zu].col is %zu, al[%zu].len is %zu\n",
+                             __func__, __LINE__, idx, table.al.size(), idx, table.al[idx].col, idx, table.al[idx].len);
+                     reindent_line(next, table.al[idx].col + table.al[idx].len);
                      chunk_flags_set(next, PCF_WAS_ALIGNED);
                   }
                }
@@ -155,15 +155,15 @@ void align_init_brace(chunk_t *start)
             else
             {
                // first item on the line
-               LOG_FMT(LALBR, "%s(%d): idx is %zu, cpd.al[%zu].col is %zu\n",
-                       __func__, __LINE__, idx, idx, cpd.al[idx].col);
-               reindent_line(pc, cpd.al[idx].col);
+               LOG_FMT(LALBR, "%s(%d): idx is %zu, al[%zu].col is %zu\n",
+                       __func__, __LINE__, idx, idx, table.al[idx].col);
+               reindent_line(pc, table.al[idx].col);
                chunk_flags_set(pc, PCF_WAS_ALIGNED);
 
                // see if we need to right-align a number
                log_rule_B("align_number_right");
 
-               if (  (idx < (cpd.al_cnt - 1))
+               if (  (idx < (table.al.size() - 1))
                   && options::align_number_right())
                {
                   next = chunk_get_next(pc);
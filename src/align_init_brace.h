@@ -10,7 +10,7 @@
 #ifndef ALIGN_INIT_BRACE_H_INCLUDED
 #define ALIGN_INIT_BRACE_H_INCLUDED
 
-#include "uncrustify_types.h"
+#include "align_tools.h"
 
 /**
  * Generically aligns on '=', '{', '(' and item after ','
@@ -43,7 +43,8 @@
  *       if it isn't, some extra spaces will be inserted.
  *
  * @param start   Points to the open brace chunk
+ * @param table   Holds the columns, reused between the initializers
  */
-void align_init_brace(chunk_t *start);
+void align_init_brace(chunk_t *start, ib_table_t &table);
 
 #endif /* ALIGN_INIT_BRACE_H_INCLUDED */
@@ -11,18 +11,18 @@
 #include "uncrustify.h"
 
 
-void align_log_al(log_sev_t sev, size_t line)
+void align_log_al(log_sev_t sev, size_t line, const std::vector<align_t> &al)
 {
    if (log_sev_on(sev))
    {
-      log_fmt(sev, "%s(%d): line %zu, cpd.al_cnt is %zu\n",
-              __func__, __LINE__, line, cpd.al_cnt);
+      log_fmt(sev, "%s(%d): line %zu, al_cnt is %zu\n",
+              __func__, __LINE__, line, al.size());
 
-      for (size_t idx = 0; idx < cpd.al_cnt; idx++)
+      for (size_t idx = 0; idx < al.size(); idx++)
       {
-         log_fmt(sev, "   cpd.al[%2.1zu].col is %2.1zu, cpd.al[%2.1zu].len is %zu, type is %s\n",
-                 idx, cpd.al[idx].col, idx, cpd.al[idx].len,
-                 get_token_name(cpd.al[idx].type));
+         log_fmt(sev, "   al[%2.1zu].col is %2.1zu, al[%2.1zu].len is %zu, type is %s\n",
+                 idx, al[idx].col, idx, al[idx].len,
+                 get_token_name(al[idx].type));
       }
 
       log_fmt(sev, "\n");
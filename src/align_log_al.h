@@ -12,6 +12,8 @@
 
 #include "uncrustify_types.h"
 
-void align_log_al(log_sev_t sev, size_t line);
+#include <vector>
+
+void align_log_al(log_sev_t sev, size_t line, const std::vector<align_t> &al);
 
 #endif /* ALIGN_LOG_AL_H_INCLUDED */
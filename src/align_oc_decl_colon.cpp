@@ -11,13 +11,14 @@
 
 #include "align_oc_msg_colons.h"
 #include "align_stack.h"
+#include "align_tools.h"
 #include "chunk_list.h"
 
 
 using namespace uncrustify;
 
 
-void align_oc_decl_colon(void)
+void align_oc_decl_colon(const std::vector<chunk_t *> &candidates)
 {
    LOG_FUNC_ENTRY();
 
@@ -29,13 +30,14 @@ void align_oc_decl_colon(void)
    nas.Start(4);
    nas.m_right_align = !options::align_on_tabstop();
 
-   chunk_t *pc = chunk_get_head();
+   size_t idx = 0;
 
-   while (pc != nullptr)
+   while (idx < candidates.size())
    {
+      chunk_t *pc = candidates[idx++];
+
       if (pc->type != CT_OC_SCOPE)
       {
-         pc = chunk_get_next(pc);
          continue;
       }
       nas.Reset();
@@ -86,5 +88,8 @@ void align_oc_decl_colon(void)
       }
       nas.End();
       cas.End();
+
+      // Scopes the declaration went past are not looked at again
+      idx = skip_passed_candidates(candidates, idx, pc);
    }
 } // align_oc_decl_colon
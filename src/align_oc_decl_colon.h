@@ -10,12 +10,17 @@
 #ifndef ALIGN_OC_DECL_COLON_H_INCLUDED
 #define ALIGN_OC_DECL_COLON_H_INCLUDED
 
+#include "uncrustify_types.h"
+
+#include <vector>
 
 /**
  * Aligns OC declarations on the colon
  * -(void) doSomething: (NSString*) param1
  *                with: (NSString*) param2
+ *
+ * @param candidates  the OC scopes, in order
  */
-void align_oc_decl_colon(void);
+void align_oc_decl_colon(const std::vector<chunk_t *> &candidates);
 
 #endif /* ALIGN_OC_DECL_COLON_H_INCLUDED */
@@ -160,11 +160,11 @@ void align_oc_msg_colon(chunk_t *so)
 } // align_oc_msg_colon
 
 
-void align_oc_msg_colons(void)
+void align_oc_msg_colons(const std::vector<chunk_t *> &candidates)
 {
    LOG_FUNC_ENTRY();
 
-   for (chunk_t *pc = chunk_get_head(); pc != nullptr; pc = chunk_get_next(pc))
+   for (chunk_t *pc : candidates)
    {
       if (chunk_is_token(pc, CT_SQUARE_OPEN) && get_chunk_parent_type(pc) == CT_OC_MSG)
       {
@@ -10,7 +10,15 @@
 #ifndef ALIGN_OC_MSG_COLONS_H_INCLUDED
 #define ALIGN_OC_MSG_COLONS_H_INCLUDED
 
-//! Aligns OC messages
-void align_oc_msg_colons(void);
+#include "uncrustify_types.h"
+
+#include <vector>
+
+/**
+ * Aligns OC messages
+ *
+ * @param candidates  the open squares of the OC messages, in order
+ */
+void align_oc_msg_colons(const std::vector<chunk_t *> &candidates);
 
 #endif /* ALIGN_OC_MSG_COLONS_H_INCLUDED */
@@ -13,7 +13,7 @@
 #include "align_stack.h"
 
 
-void align_oc_msg_spec(size_t span)
+void align_oc_msg_spec(size_t span, const std::vector<chunk_t *> &candidates)
 {
    LOG_FUNC_ENTRY();
 
@@ -21,7 +21,7 @@ void align_oc_msg_spec(size_t span)
 
    as.Start(span, 0);
 
-   for (chunk_t *pc = chunk_get_head(); pc != nullptr; pc = chunk_get_next(pc))
+   for (chunk_t *pc : candidates)
    {
       if (chunk_is_newline(pc))
       {
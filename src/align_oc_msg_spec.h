@@ -12,7 +12,13 @@
 
 #include "uncrustify_types.h"
 
-//! Aligns all function prototypes in the file.
-void align_oc_msg_spec(size_t span);
+#include <vector>
+
+/**
+ * Aligns all function prototypes in the file.
+ *
+ * @param candidates  the newlines and OC message specs, in order
+ */
+void align_oc_msg_spec(size_t span, const std::vector<chunk_t *> &candidates);
 
 #endif /* ALIGN_OC_MSG_SPEC_H_INCLUDED */
@@ -14,6 +14,7 @@
 #include "chunk_list.h"
 #include "indent.h"
 #include "prototypes.h"
+#include "quick_align_again.h"
 #include "space.h"
 #include "uncrustify.h"
 #if defined WITH_STACKID
@@ -50,15 +51,17 @@ void AlignStack::Start(size_t span, int thresh)
       m_absolute_thresh = true;
       m_thresh          = -thresh;
    }
-   m_span        = span;
-   m_min_col     = numeric_limits<size_t>::max();
-   m_max_col     = 0;
-   m_nl_seqnum   = 0;
-   m_seqnum      = 0;
-   m_gap         = 0;
-   m_right_align = false;
-   m_star_style  = SS_IGNORE;
-   m_amp_style   = SS_IGNORE;
+   m_typedef_from = nullptr;
+   m_typedef      = nullptr;
+   m_span         = span;
+   m_min_col      = numeric_limits<size_t>::max();
+   m_max_col      = 0;
+   m_nl_seqnum    = 0;
+   m_seqnum       = 0;
+   m_gap          = 0;
+   m_right_align  = false;
+   m_star_style   = SS_IGNORE;
+   m_amp_style    = SS_IGNORE;
 }
 
 
@@ -70,6 +73,34 @@ void AlignStack::ReAddSkipped()
    {
       return;
    }
+   /*
+    * Add() already tightened the items when it skipped them, so an item
+    * that is still out of the threshold would only be skipped again.
+    * The max column grows often on long spans, so only replay the list
+    * when one of the items can come back.
+    * An item that was skipped with seqnum 0 gets the current m_seqnum when
+    * it is skipped again, as Add() numbers new items, so such an item is
+    * also replayed once m_seqnum moved on.
+    * A nested call always replays, as it reuses m_scratch of the outer one.
+    */
+   bool replay = m_replaying;
+
+   for (size_t idx = 0; !replay && idx < m_skipped.Len(); idx++)
+   {
+      const ChunkStack::Entry *ce = m_skipped.Get(idx);
+
+      replay = (  (ce->m_seqnum == 0 && m_seqnum != 0)
+               || IsWithinThreshold(ce->m_pc->column));
+   }
+
+   if (!replay)
+   {
+      LOG_FMT(LAS, "AlignStack::ReAddSkipped(%d): all %zu items are still skipped\n",
+              __LINE__, m_skipped.Len());
+      m_last_added = 2;
+      NewLines(0); // Check to see if we need to flush right away
+      return;
+   }
    // Make a copy of the ChunkStack and clear m_skipped
    m_scratch.Set(m_skipped);
    LOG_FMT(LAS, "AlignStack::ReAddSkipped(%d):m_skipped.Reset()\n", __LINE__);
@@ -80,10 +111,31 @@ void AlignStack::ReAddSkipped()
    {
       const ChunkStack::Entry *ce = m_scratch.Get(idx);
       LOG_FMT(LAS, "AlignStack::ReAddSkipped [%zu] - ", ce->m_seqnum);
+
+      if (!IsWithinThreshold(ce->m_pc->column))
+      {
+         m_skipped.Push_Back(ce->m_pc, (ce->m_seqnum == 0) ? m_seqnum : ce->m_seqnum);
+         m_last_added = 2;
+         LOG_FMT(LAS, "still skipped\n");
+         continue;
+      }
+      const bool replaying = m_replaying;
+      m_replaying = true;
       Add(ce->m_pc, ce->m_seqnum);
+      m_replaying = replaying;
    }
 
    NewLines(0); // Check to see if we need to flush right away
+} // AlignStack::ReAddSkipped
+
+
+bool AlignStack::IsWithinThreshold(size_t column) const
+{
+   return(  m_max_col == 0
+         || m_thresh == 0
+         || (  ((column + m_gap) <= (m_thresh + (m_absolute_thresh ? m_min_col : m_max_col))) // don't use subtraction here to prevent underflow
+            && (  (column + m_gap + m_thresh) >= m_max_col                                    // change the expression to mind negative expression
+               || column >= m_min_col)));
 }
 
 
@@ -256,11 +308,7 @@ void AlignStack::Add(chunk_t *start, size_t seqnum)
    }
 
    // Check threshold limits
-   if (  m_max_col == 0
-      || m_thresh == 0
-      || (  ((start->column + m_gap) <= (m_thresh + (m_absolute_thresh ? m_min_col : m_max_col))) // don't use subtraction here to prevent underflow
-         && (  (start->column + m_gap + m_thresh) >= m_max_col                                    // change the expression to mind negative expression
-            || start->column >= m_min_col)))
+   if (IsWithinThreshold(start->column))
    {
       // we are adding it, so update the newline seqnum
       if (seqnum > m_nl_seqnum)
@@ -380,6 +428,34 @@ void AlignStack::NewLines(size_t cnt)
 }
 
 
+chunk_t *AlignStack::FindPrevTypedef(chunk_t *pc)
+{
+   chunk_t *found = nullptr;
+
+   for (chunk_t *tmp = chunk_get_prev(pc); tmp != nullptr; tmp = chunk_get_prev(tmp))
+   {
+      if (  chunk_is_token(tmp, CT_TYPEDEF)
+         && tmp->level == pc->level)
+      {
+         found = tmp;
+         break;
+      }
+
+      if (  tmp == m_typedef_from
+         && tmp->level == pc->level)
+      {
+         found = m_typedef;
+         break;
+      }
+   }
+
+   m_typedef_from = pc;
+   m_typedef      = found;
+
+   return(found);
+}
+
+
 void AlignStack::Flush()
 {
    WITH_STACKID_DEBUG;
@@ -397,7 +473,7 @@ void AlignStack::Flush()
    {
       // check if we have *one* typedef in the line
       chunk_t *pc   = m_aligned.Get(0)->m_pc;
-      chunk_t *temp = chunk_get_prev_type(pc, CT_TYPEDEF, pc->level);
+      chunk_t *temp = FindPrevTypedef(pc);
 
       if (temp != nullptr)
       {
@@ -512,6 +588,11 @@ void AlignStack::Flush()
             m_skip_first = true;
             return;
          }
+
+         if (!pc->flags.test(PCF_ALIGN_START))
+         {
+            quick_align_new_chain();
+         }
          chunk_flags_set(pc, PCF_ALIGN_START);
 
          pc->align.right_align = m_right_align;
@@ -61,6 +61,9 @@ public:
       , stackID(std::numeric_limits<std::size_t>::max()) // under linux 64 bits: 18446744073709551615
 #endif
       , m_last_added(0)
+      , m_replaying(false)
+      , m_typedef_from(nullptr)
+      , m_typedef(nullptr)
    {
    }
 
@@ -81,6 +84,9 @@ public:
       , m_amp_style(ref.m_amp_style)
       , m_skip_first(ref.m_skip_first)
       , m_last_added(ref.m_last_added)
+      , m_replaying(false)
+      , m_typedef_from(nullptr)
+      , m_typedef(nullptr)
    {
    }
 
@@ -137,11 +143,24 @@ public:
    const char *get_StarStyle_name(StarStyle star_style);
 
 protected:
-   size_t     m_last_added; //! 0=none, 1=aligned, 2=skipped
-   ChunkStack m_scratch;    //! used in ReAddSkipped()
+   size_t     m_last_added;    //! 0=none, 1=aligned, 2=skipped
+   ChunkStack m_scratch;       //! used in ReAddSkipped()
+   bool       m_replaying;     //! ReAddSkipped() is adding an item
+   chunk_t    *m_typedef_from; //! where FindPrevTypedef() last searched from
+   chunk_t    *m_typedef;      //! and what it found there
 
    //! Calls Add on all the skipped items
    void ReAddSkipped();
+
+   //! Checks if an item at 'column' is within the column threshold
+   bool IsWithinThreshold(size_t column) const;
+
+   /**
+    * Finds the typedef before 'pc' on the level of 'pc'.
+    * The stack is flushed from the top of the file down, so the search
+    * stops where the previous one started and reuses what it found.
+    */
+   chunk_t *FindPrevTypedef(chunk_t *pc);
 };
 
 #if defined WITH_STACKID
@@ -13,12 +13,12 @@
 #include "chunk_list.h"
 
 
-void align_struct_initializers(void)
+void align_struct_initializers(const std::vector<chunk_t *> &candidates)
 {
    LOG_FUNC_ENTRY();
-   chunk_t *pc = chunk_get_head();
+   ib_table_t table;
 
-   while (pc != nullptr)
+   for (chunk_t *pc : candidates)
    {
       chunk_t *prev = chunk_get_prev_ncnl(pc);
 
@@ -26,8 +26,7 @@ void align_struct_initializers(void)
          && (  chunk_is_token(pc, CT_BRACE_OPEN)
             || (language_is_set(LANG_D) && chunk_is_token(pc, CT_SQUARE_OPEN))))
       {
-         align_init_brace(pc);
+         align_init_brace(pc, table);
       }
-      pc = chunk_get_next_type(pc, CT_BRACE_OPEN, -1);
    }
 } // align_struct_initializers
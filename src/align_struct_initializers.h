@@ -12,7 +12,13 @@
 
 #include "uncrustify_types.h"
 
-//! Aligns stuff inside a multi-line "= { ... }" sequence.
-void align_struct_initializers(void);
+#include <vector>
+
+/**
+ * Aligns stuff inside a multi-line "= { ... }" sequence.
+ *
+ * @param candidates  the open braces, in order
+ */
+void align_struct_initializers(const std::vector<chunk_t *> &candidates);
 
 #endif /* ALIGN_STRUCT_INITIALIZERS_H_INCLUDED */
@@ -11,7 +11,6 @@
 
 #include "space.h"
 #include "uncrustify.h"
-#include "uncrustify_limits.h"
 
 
 chunk_t *skip_c99_array(chunk_t *sq_open)
@@ -29,12 +28,12 @@ chunk_t *skip_c99_array(chunk_t *sq_open)
 } // skip_c99_array
 
 
-chunk_t *scan_ib_line(chunk_t *start, bool first_pass)
+chunk_t *scan_ib_line(chunk_t *start, ib_table_t &table)
 {
-   UNUSED(first_pass);
    LOG_FUNC_ENTRY();
    chunk_t *prev_match = nullptr;
    size_t  idx         = 0;
+   size_t  shift       = 0; // the columns from idx on still have to move out by this
 
    // Skip past C99 "[xx] =" stuff
    chunk_t *tmp = skip_c99_array(start);
@@ -42,8 +41,8 @@ chunk_t *scan_ib_line(chunk_t *start, bool first_pass)
    if (tmp != nullptr)
    {
       set_chunk_parent(start, CT_TSQUARE);
-      start            = tmp;
-      cpd.al_c99_array = true;
+      start           = tmp;
+      table.c99_array = true;
    }
    chunk_t *pc = start;
 
@@ -76,7 +75,7 @@ chunk_t *scan_ib_line(chunk_t *start, bool first_pass)
          // TODO: need to handle missing structure defs? ie NULL vs { ... } ??
 
          // Is this a new entry?
-         if (idx >= cpd.al_cnt)
+         if (idx >= table.al.size())
          {
             if (idx == 0)
             {
@@ -84,41 +83,34 @@ chunk_t *scan_ib_line(chunk_t *start, bool first_pass)
             }
             LOG_FMT(LSIB, "%s(%d):   New idx is %2.1zu, pc->column is %2.1zu, text() '%s', token_width is %zu, type is %s\n",
                     __func__, __LINE__, idx, pc->column, pc->text(), token_width, get_token_name(pc->type));
-            cpd.al[cpd.al_cnt].type = pc->type;
-            cpd.al[cpd.al_cnt].col  = pc->column;
-            cpd.al[cpd.al_cnt].len  = token_width;
-            cpd.al_cnt++;
-
-            if (cpd.al_cnt == uncrustify::limits::AL_SIZE)
-            {
-               fprintf(stderr, "Number of 'entry' to be aligned is too big for the current value %d,\n",
-                       uncrustify::limits::AL_SIZE);
-               fprintf(stderr, "at line %zu, column %zu.\n",
-                       pc->orig_line, pc->orig_col);
-               fprintf(stderr, "Please make a report.\n");
-               log_flush(true);
-               exit(EX_SOFTWARE);
-            }
+            align_t entry;
+            entry.type = pc->type;
+            entry.col  = pc->column;
+            entry.len  = token_width;
+            table.al.push_back(entry);
             idx++;
          }
          else
          {
+            align_t &entry = table.al[idx];
+
             // expect to match stuff
-            if (cpd.al[idx].type == pc->type)
+            if (entry.type == pc->type)
             {
                LOG_FMT(LSIB, "%s(%d):   Match? idx is %2.1zu, orig_line is %2.1zu, column is %2.1zu, token_width is %zu, type is %s\n",
                        __func__, __LINE__, idx, pc->orig_line, pc->column, token_width, get_token_name(pc->type));
+               entry.col += shift;
 
                // Shift out based on column
                if (prev_match == nullptr)
                {
-                  if (pc->column > cpd.al[idx].col)
+                  if (pc->column > entry.col)
                   {
-                     LOG_FMT(LSIB, "%s(%d): [ pc->column (%zu) > cpd.al[%zu].col(%zu) ] \n",
-                             __func__, __LINE__, pc->column, idx, cpd.al[idx].col);
+                     LOG_FMT(LSIB, "%s(%d): [ pc->column (%zu) > table.al[%zu].col(%zu) ] \n",
+                             __func__, __LINE__, pc->column, idx, entry.col);
 
-                     ib_shift_out(idx, pc->column - cpd.al[idx].col);
-                     cpd.al[idx].col = pc->column;
+                     shift    += pc->column - entry.col;
+                     entry.col = pc->column;
                   }
                }
                else if (idx > 0)
@@ -126,17 +118,18 @@ chunk_t *scan_ib_line(chunk_t *start, bool first_pass)
                   LOG_FMT(LSIB, "%s(%d):   prev_match '%s', prev_match->orig_line is %zu, prev_match->orig_col is %zu\n",
                           __func__, __LINE__, prev_match->text(), prev_match->orig_line, prev_match->orig_col);
                   int min_col_diff = pc->column - prev_match->column;
-                  int cur_col_diff = cpd.al[idx].col - cpd.al[idx - 1].col;
+                  int cur_col_diff = entry.col - table.al[idx - 1].col;
 
                   if (cur_col_diff < min_col_diff)
                   {
                      LOG_FMT(LSIB, "%s(%d):   pc->orig_line is %zu\n",
                              __func__, __LINE__, pc->orig_line);
-                     ib_shift_out(idx, min_col_diff - cur_col_diff);
+                     shift     += min_col_diff - cur_col_diff;
+                     entry.col += min_col_diff - cur_col_diff;
                   }
                }
                LOG_FMT(LSIB, "%s(%d): at ende of the loop: now is col %zu, len is %zu\n",
-                       __func__, __LINE__, cpd.al[idx].col, cpd.al[idx].len);
+                       __func__, __LINE__, entry.col, entry.len);
                idx++;
             }
          }
@@ -144,18 +137,17 @@ chunk_t *scan_ib_line(chunk_t *start, bool first_pass)
       }
       pc = chunk_get_next_nc(pc);
    }
-   return(pc);
-} // scan_ib_line
 
-
-void ib_shift_out(size_t idx, size_t num)
-{
-   while (idx < cpd.al_cnt)
+   // The columns are moved out when the line reaches them, do the rest now
+   if (shift > 0)
    {
-      cpd.al[idx].col += num;
-      idx++;
+      for ( ; idx < table.al.size(); idx++)
+      {
+         table.al[idx].col += shift;
+      }
    }
-} // ib_shift_out
+   return(pc);
+} // scan_ib_line
 
 
 chunk_t *step_back_over_member(chunk_t *pc)
@@ -171,3 +163,24 @@ chunk_t *step_back_over_member(chunk_t *pc)
    }
    return(pc);
 } // step_back_over_member
+
+
+size_t skip_passed_candidates(const std::vector<chunk_t *> &candidates, size_t idx, chunk_t *end)
+{
+   if (end == nullptr)
+   {
+      return(candidates.size());
+   }
+
+   for (chunk_t *pc = candidates[idx - 1];
+        pc != nullptr && pc != end && idx < candidates.size();
+        pc = chunk_get_next(pc))
+   {
+      if (pc == candidates[idx])
+      {
+         idx++;
+      }
+   }
+
+   return(idx);
+}
@@ -13,6 +13,8 @@
 #include "chunk_list.h"
 #include "uncrustify_types.h"
 
+#include <vector>
+
 
 /**
  * @brief return the chunk the follows after a C array
@@ -33,16 +35,34 @@
  */
 chunk_t *skip_c99_array(chunk_t *sq_open);
 
+//! The columns align_init_brace() lines up the items of an initializer on
+struct ib_table_t
+{
+   std::vector<align_t> al;                //! one entry per column, left to right
+   bool                 c99_array = false; //! the lines start with "[xx] ="
+};
+
 /**
  * Scans a line for stuff to align on.
  *
  * We trigger on BRACE_OPEN, FPAREN_OPEN, ASSIGN, and COMMA.
  * We want to align the NEXT item.
+ * The columns of the line are added to or merged into 'table'.
  */
-chunk_t *scan_ib_line(chunk_t *start, bool first_pass);
-
-void ib_shift_out(size_t idx, size_t num);
+chunk_t *scan_ib_line(chunk_t *start, ib_table_t &table);
 
 chunk_t *step_back_over_member(chunk_t *pc);
 
+/**
+ * Steps over the candidates that a walk from candidates[idx - 1] up to 'end'
+ * went past, so the caller goes on with the first one at or after 'end'.
+ *
+ * @param candidates  chunks in the order of the chunk list
+ * @param idx         index of the candidate after the one the walk started on
+ * @param end         chunk the walk stopped on, nullptr if it reached the end
+ *
+ * @return the index of the next candidate to handle
+ */
+size_t skip_passed_candidates(const std::vector<chunk_t *> &candidates, size_t idx, chunk_t *end);
+
 #endif /* ALIGN_TOOLS_H_INCLUDED */
@@ -16,7 +16,7 @@
 using namespace uncrustify;
 
 
-void align_typedefs(size_t span)
+void align_typedefs(size_t span, const std::vector<chunk_t *> &candidates)
 {
    LOG_FUNC_ENTRY();
 
@@ -31,9 +31,8 @@ void align_typedefs(size_t span)
    as.m_amp_style = static_cast<AlignStack::StarStyle>(options::align_typedef_amp_style());
 
    chunk_t *c_typedef = nullptr;
-   chunk_t *pc        = chunk_get_head();
 
-   while (pc != nullptr)
+   for (chunk_t *pc : candidates)
    {
       if (chunk_is_newline(pc))
       {
@@ -58,7 +57,7 @@ void align_typedefs(size_t span)
             c_typedef = pc;
          }
       }
-      pc = chunk_get_next(pc);
    }
+
    as.End();
 } // align_typedefs
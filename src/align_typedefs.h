@@ -12,6 +12,8 @@
 
 #include "uncrustify_types.h"
 
+#include <vector>
+
 /**
  * Aligns simple typedefs that are contained on a single line each.
  * This should be called after the typedef target is marked as a type.
@@ -19,7 +21,9 @@
  * typedef int        foo_t;
  * typedef char       bar_t;
  * typedef const char cc_t;
+ *
+ * @param candidates  the newlines, typedefs and anchored chunks, in order
  */
-void align_typedefs(size_t span);
+void align_typedefs(size_t span, const std::vector<chunk_t *> &candidates);
 
 #endif /* ALIGN_TYPEDEFS_H_INCLUDED */
@@ -8,6 +8,7 @@
 
 #include "chunk_list.h"
 
+#include "interner.h"
 #include "ListManager.h"
 #include "prototypes.h"
 #include "space.h"
@@ -16,6 +17,7 @@
 
 #include <cstdlib>
 #include <cstring>
+#include <vector>
 
 
 typedef ListManager<chunk_t> ChunkList_t;
@@ -197,6 +199,20 @@ static chunk_t *chunk_search_str(chunk_t *cur, const char *str, size_t len, scop
 static chunk_t *chunk_add(const chunk_t *pc_in, chunk_t *ref, const direction_e pos = direction_e::FORWARD);
 
 
+/**
+ * @brief Link a chunk before/after the given position in a chunk list
+ *
+ * If ref is nullptr, add either at the head or tail based on the specified pos
+ *
+ * @param  pc   chunk to link into the list, the list takes ownership
+ * @param  ref  insert position in list
+ * @param  pos  insert before or after
+ *
+ * @return chunk_t  pointer to the linked chunk
+ */
+static chunk_t *chunk_link(chunk_t *pc, chunk_t *ref, const direction_e pos);
+
+
 /**
  * @brief Determines which chunk search function to use
  *
@@ -210,7 +226,35 @@ static chunk_t *chunk_add(const chunk_t *pc_in, chunk_t *ref, const direction_e
 static search_t select_search_fct(const direction_e dir = direction_e::FORWARD);
 
 
-ChunkList_t g_cl; //! global chunk list
+ChunkList_t           g_cl;     //! global chunk list
+
+static chunk_counts_t g_counts; //! see chunk_get_counts()
+
+/**
+ * Changes when a chunk is added, deleted or moved, or when a chunk in the
+ * list becomes or stops being a comment or newline. The neighbor links a
+ * chunk keeps are valid while their stamp matches. Only the main thread
+ * changes it.
+ */
+static size_t g_links_stamp = 1;
+
+
+chunk_counts_t chunk_get_counts(void)
+{
+   return(g_counts);
+}
+
+
+/**
+ * Checks if a chunk is linked into the list. The tokenizer threads set up
+ * chunks that are not in it yet, their changes are not counted.
+ */
+static bool chunk_is_listed(const chunk_t *pc)
+{
+   return(  pc->next != nullptr
+         || pc->prev != nullptr
+         || g_cl.GetHead() == pc);
+}
 
 
 chunk_t *chunk_get_head(void)
@@ -312,14 +356,15 @@ static chunk_t *chunk_search_str(chunk_t *cur, const char *str, size_t len, scop
    /*
     * Depending on the parameter dir the search function searches
     * in forward or backward direction */
-   search_t search_function = select_search_fct(dir);
-   chunk_t  *pc             = cur;
+   search_t     search_function = select_search_fct(dir);
+   chunk_t      *pc             = cur;
+   const size_t sym             = find_interned(str, len);
 
    do                                  // loop over the chunk list
    {
       pc = search_function(pc, scope); // in either direction while
    } while (  pc != nullptr            // the end of the list was not reached yet
-           && (is_expected_string_and_level(pc, str, level, len) == false));
+           && (is_expected_intern_id_and_level(pc, str, sym, level, len) == false));
 
    return(pc);                         // the latest chunk is the searched one
 }
@@ -392,6 +437,7 @@ chunk_t *chunk_get_next(chunk_t *cur, scope_e scope)
    {
       return(nullptr);
    }
+   g_counts.visits++;
    chunk_t *pc = g_cl.GetNext(cur);
 
    if (pc == nullptr || scope == scope_e::ALL)
@@ -424,6 +470,7 @@ chunk_t *chunk_get_prev(chunk_t *cur, scope_e scope)
    {
       return(nullptr);
    }
+   g_counts.visits++;
    chunk_t *pc = g_cl.GetPrev(cur);
 
    if (pc == nullptr || scope == scope_e::ALL)
@@ -466,6 +513,9 @@ chunk_t *chunk_dup(const chunk_t *pc_in)
    *pc = *pc_in; // TODO: what happens if pc_in == nullptr?
    g_cl.InitEntry(pc);
 
+   // The copy does not start a chain of aligned chunks, see quick_align_again()
+   pc->flags &= ~PCF_ALIGN_START;
+
    return(pc);
 }
 
@@ -538,9 +588,18 @@ chunk_t *chunk_add_before(const chunk_t *pc_in, chunk_t *ref)
 }
 
 
+chunk_t *chunk_link_before(chunk_t *pc, chunk_t *ref)
+{
+   g_cl.InitEntry(pc);
+   return(chunk_link(pc, ref, direction_e::BACKWARD));
+}
+
+
 void chunk_del_2(chunk_t *pc)
 {
    g_cl.Pop(pc);
+   g_counts.deletes++;
+   g_links_stamp++;
    delete pc;
 }
 
@@ -550,6 +609,8 @@ void chunk_move_after(chunk_t *pc_in, chunk_t *ref)
    LOG_FUNC_ENTRY();
    g_cl.Pop(pc_in);
    g_cl.AddAfter(pc_in, ref);
+   g_counts.moves++;
+   g_links_stamp++;
 
    // HACK: Adjust the original column
    pc_in->column       = ref->column + space_col_align(ref, pc_in);
@@ -584,7 +645,18 @@ chunk_t *chunk_get_prev_nnl(chunk_t *cur, scope_e scope)
 
 chunk_t *chunk_get_next_ncnl(chunk_t *cur, scope_e scope)
 {
-   return(chunk_search(cur, chunk_is_comment_or_newline, scope, direction_e::FORWARD, false));
+   if (  cur == nullptr
+      || scope != scope_e::ALL)
+   {
+      return(chunk_search(cur, chunk_is_comment_or_newline, scope, direction_e::FORWARD, false));
+   }
+
+   if (cur->ncnl_next_stamp != g_links_stamp)
+   {
+      cur->ncnl_next       = chunk_search(cur, chunk_is_comment_or_newline, scope, direction_e::FORWARD, false);
+      cur->ncnl_next_stamp = g_links_stamp;
+   }
+   return(cur->ncnl_next);
 }
 
 
@@ -632,7 +704,18 @@ chunk_t *chunk_get_next_nisq(chunk_t *cur, scope_e scope)
 
 chunk_t *chunk_get_prev_ncnl(chunk_t *cur, scope_e scope)
 {
-   return(chunk_search(cur, chunk_is_comment_or_newline, scope, direction_e::BACKWARD, false));
+   if (  cur == nullptr
+      || scope != scope_e::ALL)
+   {
+      return(chunk_search(cur, chunk_is_comment_or_newline, scope, direction_e::BACKWARD, false));
+   }
+
+   if (cur->ncnl_prev_stamp != g_links_stamp)
+   {
+      cur->ncnl_prev       = chunk_search(cur, chunk_is_comment_or_newline, scope, direction_e::BACKWARD, false);
+      cur->ncnl_prev_stamp = g_links_stamp;
+   }
+   return(cur->ncnl_prev);
 }
 
 
@@ -689,6 +772,8 @@ bool chunk_is_newline_between(chunk_t *start, chunk_t *end)
 void chunk_swap(chunk_t *pc1, chunk_t *pc2)
 {
    g_cl.Swap(pc1, pc2);
+   g_counts.moves++;
+   g_links_stamp++;
 }
 
 
@@ -745,6 +830,10 @@ void chunk_swap_lines(chunk_t *pc1, chunk_t *pc2)
     */
    chunk_t *ref2 = chunk_get_prev(pc2);
 
+   g_counts.moves++;
+
+   g_links_stamp++;
+
    // Move the line started at pc2 before pc1
    while (pc2 != nullptr && !chunk_is_newline(pc2))
    {
@@ -798,6 +887,89 @@ void chunk_swap_lines(chunk_t *pc1, chunk_t *pc2)
 } // chunk_swap_lines
 
 
+void chunk_reorder_lines(chunk_t *const *lines, const size_t *order, size_t count)
+{
+   //! A line to move, and where the line before it was
+   struct line_t
+   {
+      size_t  first;    //! index of its first chunk in 'chunks'
+      size_t  end;      //! index after its newline in 'chunks'
+      chunk_t *after;   //! the chunk the place follows, nullptr for the head
+      bool    adjacent; //! true if the place follows the previous place
+      size_t  nl_count; //! nl_count of the newline of the place
+   };
+   std::vector<line_t>    places(count);
+   std::vector<chunk_t *> chunks;
+
+   for (size_t idx = 0; idx < count; idx++)
+   {
+      line_t  &place = places[idx];
+      chunk_t *pc    = chunk_first_on_line(lines[idx]);
+
+      place.after    = chunk_get_prev(pc);
+      place.adjacent = (  idx > 0
+                       && place.after != nullptr
+                       && place.after == chunks.back());
+      place.first    = chunks.size();
+      place.nl_count = 0;
+
+      for ( ; pc != nullptr; pc = chunk_get_next(pc))
+      {
+         chunks.push_back(pc);
+
+         if (chunk_is_newline(pc))
+         {
+            place.nl_count = pc->nl_count;
+            break;
+         }
+      }
+
+      place.end = chunks.size();
+   }
+
+   for (chunk_t *pc : chunks)
+   {
+      g_cl.Pop(pc);
+   }
+
+   chunk_t *prev = nullptr;
+
+   for (size_t idx = 0; idx < count; idx++)
+   {
+      const line_t &place = places[idx];
+      const line_t &line  = places[order[idx]];
+
+      if (!place.adjacent)
+      {
+         prev = place.after;
+      }
+
+      for (size_t cdx = line.first; cdx < line.end; cdx++)
+      {
+         chunk_t *pc = chunks[cdx];
+
+         if (prev != nullptr)
+         {
+            g_cl.AddAfter(pc, prev);
+         }
+         else
+         {
+            g_cl.AddHead(pc);
+         }
+         prev = pc;
+      }
+
+      if (chunk_is_newline(prev))
+      {
+         prev->nl_count = place.nl_count;
+      }
+   }
+
+   g_counts.moves++;
+   g_links_stamp++;
+} // chunk_reorder_lines
+
+
 chunk_t *chunk_get_next_nvb(chunk_t *cur, const scope_e scope)
 {
    return(chunk_search(cur, chunk_is_vbrace, scope, direction_e::FORWARD, false));
@@ -832,11 +1004,36 @@ void chunk_flags_set_real(chunk_t *pc, pcf_flags_t clr_bits, pcf_flags_t set_bit
                  get_token_name(get_chunk_parent_type(pc)));
          log_func_stack_inline(LSETFLG);
          pc->flags = nflags;
+
+         if (chunk_is_listed(pc))
+         {
+            g_counts.edits++;
+         }
       }
    }
 }
 
 
+void set_chunk_nl_count(chunk_t *pc, size_t nl_count)
+{
+   if (pc->nl_count != nl_count)
+   {
+      pc->nl_count = nl_count;
+      g_counts.edits++;
+   }
+}
+
+
+void set_chunk_column(chunk_t *pc, size_t column)
+{
+   if (pc->column != column)
+   {
+      pc->column = column;
+      g_counts.edits++;
+   }
+}
+
+
 void set_chunk_type_real(chunk_t *pc, c_token_t token, const char *func, int line)
 {
    LOG_FUNC_ENTRY();
@@ -860,7 +1057,19 @@ void set_chunk_type_real(chunk_t *pc, c_token_t token, const char *func, int lin
    LOG_FMT(LSETTYP, "   pc->type is %s, pc->parent_type is %s => *type is %s, *parent_type is %s\n",
            get_token_name(pc->type), get_token_name(get_chunk_parent_type(pc)),
            get_token_name(token), get_token_name(get_chunk_parent_type(pc)));
+   const bool was_skipped = chunk_is_comment_or_newline(pc);
+
    pc->type = token;
+
+   if (chunk_is_listed(pc))
+   {
+      g_counts.edits++;
+
+      if (chunk_is_comment_or_newline(pc) != was_skipped)
+      {
+         g_links_stamp++;
+      }
+   }
 } // set_chunk_type_real
 
 
@@ -888,6 +1097,11 @@ void set_chunk_parent_real(chunk_t *pc, c_token_t token, const char *func, int l
            get_token_name(pc->type), get_token_name(get_chunk_parent_type(pc)),
            get_token_name(token), get_token_name(get_chunk_parent_type(pc)));
    pc->parent_type = token;
+
+   if (chunk_is_listed(pc))
+   {
+      g_counts.edits++;
+   }
 } // set_chunk_parent_real
 
 
@@ -915,9 +1129,15 @@ static chunk_t *chunk_get_ncnlnp(chunk_t *cur, const scope_e scope, const direct
 
 
 static chunk_t *chunk_add(const chunk_t *pc_in, chunk_t *ref, const direction_e pos)
+{
+   return(chunk_link(chunk_dup(pc_in), ref, pos));
+}
+
+
+static chunk_t *chunk_link(chunk_t *pc, chunk_t *ref, const direction_e pos)
 {
 #ifdef DEBUG
-   if (pc_in->orig_line == 0)
+   if (pc->orig_line == 0)
    {
       fprintf(stderr, "%s(%d): no line number\n", __func__, __LINE__);
       log_func_stack_inline(LSETFLG);
@@ -925,7 +1145,7 @@ static chunk_t *chunk_add(const chunk_t *pc_in, chunk_t *ref, const direction_e
       exit(EX_SOFTWARE);
    }
 
-   if (pc_in->orig_col == 0)
+   if (pc->orig_col == 0)
    {
       fprintf(stderr, "%s(%d): no column number\n", __func__, __LINE__);
       log_func_stack_inline(LSETFLG);
@@ -934,8 +1154,6 @@ static chunk_t *chunk_add(const chunk_t *pc_in, chunk_t *ref, const direction_e
    }
 #endif /* DEBUG */
 
-   chunk_t *pc = chunk_dup(pc_in);
-
    if (pc != nullptr)
    {
       if (ref != nullptr) // ref is a valid chunk
@@ -946,6 +1164,8 @@ static chunk_t *chunk_add(const chunk_t *pc_in, chunk_t *ref, const direction_e
       {
          (pos == direction_e::FORWARD) ? g_cl.AddHead(pc) : g_cl.AddTail(pc);
       }
+      g_counts.inserts++;
+      g_links_stamp++;
       chunk_log(pc, "chunk_add(A):");
    }
    return(pc);
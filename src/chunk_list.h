@@ -12,6 +12,7 @@
 #include "uncrustify_types.h"
 // necessary to not sort it
 #include "char_table.h"
+#include "interner.h"
 #include "language_tools.h"
 
 
@@ -42,6 +43,21 @@ enum class scope_e : unsigned int
 };
 
 
+//! Counts of the chunk list operations since the program started
+struct chunk_counts_t
+{
+   size_t visits;  //! calls of chunk_get_next() and chunk_get_prev()
+   size_t inserts; //! chunks added to the list
+   size_t deletes; //! chunks deleted from the list
+   size_t moves;   //! chunks or lines moved to another place in the list
+   size_t edits;   //! changes of the type, parent, flags, column or newline count of a chunk
+};
+
+
+//! Reads the counts of the chunk list operations, used by --profile
+chunk_counts_t chunk_get_counts(void);
+
+
 /**
  * duplicate a chunk in a chunk list
  *
@@ -82,6 +98,22 @@ chunk_t *chunk_add_after(const chunk_t *pc_in, chunk_t *ref);
 chunk_t *chunk_add_before(const chunk_t *pc_in, chunk_t *ref);
 
 
+/**
+ * @brief Link a newly allocated chunk into a chunk list before the given position.
+ *
+ * Unlike chunk_add_before() no copy is made, the list takes ownership of pc.
+ * This lets the tokenizer build each chunk directly in its final storage.
+ *
+ * @note If ref is nullptr, add at the tail of the chunk list
+ *
+ * @param pc   pointer to the chunk to link, allocated with new
+ * @param ref  position where insertion takes place
+ *
+ * @retval pointer to the linked chunk
+ */
+chunk_t *chunk_link_before(chunk_t *pc, chunk_t *ref);
+
+
 /**
  * delete a chunk from a chunk list
  *
@@ -156,6 +188,18 @@ void chunk_swap(chunk_t *pc1, chunk_t *pc2);
 void chunk_swap_lines(chunk_t *pc1, chunk_t *pc2);
 
 
+/**
+ * Puts lines into a new order, moving each chunk once. The lines take the
+ * places the lines had before. As with chunk_swap_lines(), the newline of
+ * a line moves with it, and the nl_count stays with the place.
+ *
+ * @param lines  a chunk of each line, in list order
+ * @param order  order[k] is the index in lines of the line to put at place k
+ * @param count  number of lines
+ */
+void chunk_reorder_lines(chunk_t *const *lines, const size_t *order, size_t count);
+
+
 /**
  * Finds the first chunk on the line that pc is on.
  * This just backs up until a newline or nullptr is hit.
@@ -491,6 +535,29 @@ static inline bool is_expected_string_and_level(chunk_t *pc, const char *str, in
 }
 
 
+/**
+ * Like is_expected_string_and_level(), with the intern id of the string.
+ * A chunk whose text was interned is compared by its id, any other chunk
+ * by its text.
+ *
+ * @param sym  intern id of the expected string, 0 if it was not interned,
+ *             see find_interned()
+ * @param len  number of chars of the expected string
+ */
+static inline bool is_expected_intern_id_and_level(chunk_t *pc, const char *str, size_t sym, int level, size_t len)
+{
+   if (  (level >= 0 && pc->level != static_cast<size_t>(level))
+      || pc->len() != len)
+   {
+      return(false);
+   }
+   const size_t id = pc->str.known_intern_id();
+
+   // an interned text that differs from the string has another id
+   return((id != 0) ? id == sym : memcmp(str, pc->text(), len) == 0);
+}
+
+
 static inline bool chunk_is_token(const chunk_t *pc, c_token_t c_token)
 {
    return(pc != nullptr && pc->type == c_token);
@@ -681,16 +748,27 @@ static inline bool chunk_is_type(chunk_t *pc)
 }
 
 
+/**
+ * Checks if the text of a chunk is a string literal. The literal is looked
+ * up in the interned texts, so a chunk with an interned text compares ids.
+ *
+ * @param str  the string, must be a literal, see find_interned_literal()
+ * @param len  length of the string
+ */
 static inline bool chunk_is_str(chunk_t *pc, const char *str, size_t len)
 {
-   return(  pc != nullptr                         // valid pc pointer
-         && (pc->len() == len)                    // token size equals size parameter
-         && (memcmp(pc->text(), str, len) == 0)); // token name is the same as str parameter
+   if (  pc == nullptr                            // valid pc pointer
+      || pc->len() != len)                        // token size equals size parameter
+   {
+      return(false);
+   }
+   const size_t id = pc->str.known_intern_id();
 
-   /*
-    * TODO: possible access beyond array for memcmp, check this
-    * why not use strncmp here?
-    */
+   if (id != 0)
+   {
+      return(id == find_interned_literal(str, len));
+   }
+   return(memcmp(pc->text(), str, len) == 0);     // token name is the same as str parameter
 }
 
 
@@ -901,6 +979,14 @@ void chunk_flags_set_real(chunk_t *pc, pcf_flags_t clr_bits, pcf_flags_t set_bit
 } while (false)
 
 
+//! Sets the newline count of a newline chunk, and counts it if it changes
+void set_chunk_nl_count(chunk_t *pc, size_t nl_count);
+
+
+//! Sets the output column of a chunk, and counts it if it changes
+void set_chunk_column(chunk_t *pc, size_t column);
+
+
 void chunk_set_parent(chunk_t *pc, chunk_t *parent);
 
 
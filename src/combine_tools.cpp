@@ -312,7 +312,7 @@ bool chunkstack_match(ChunkStack &cs, chunk_t *pc)
    {
       chunk_t *tmp = cs.GetChunk(idx);
 
-      if (pc->str.equals(tmp->str))
+      if (pc->str.intern_id() == tmp->str.intern_id())
       {
          return(true);
       }
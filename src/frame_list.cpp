@@ -54,6 +54,10 @@ void fl_trash_tos(std::vector<ParseFrame> &frames);
 //! Logs one parse frame
 void fl_log(log_sev_t logsev, const ParseFrame &frm)
 {
+   if (!log_sev_on(logsev))
+   {
+      return;
+   }
    LOG_FMT(logsev, "[%s] BrLevel=%zu Level=%zu PseTos=%zu\n",
            get_token_name(frm.in_ifdef), frm.brace_level, frm.level, frm.size() - 1);
 
@@ -74,6 +78,10 @@ void fl_log_frms(log_sev_t                     logsev,
                  const ParseFrame              &frm,
                  const std::vector<ParseFrame> &frames)
 {
+   if (!log_sev_on(logsev))
+   {
+      return;
+   }
    LOG_FMT(logsev, "%s Parse Frames(%zu):", txt, frames.size());
 
    for (size_t idx = 0; idx < frames.size(); idx++)
@@ -88,6 +96,10 @@ void fl_log_frms(log_sev_t                     logsev,
 
 void fl_log_all(log_sev_t logsev, const std::vector<ParseFrame> &frames)
 {
+   if (!log_sev_on(logsev))
+   {
+      return;
+   }
    LOG_FMT(logsev, "##=- Parse Frame : %zu entries\n", frames.size());
 
    for (size_t idx = 0; idx < frames.size(); idx++)
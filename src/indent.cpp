@@ -234,7 +234,7 @@ void align_to_column(chunk_t *pc, size_t column)
    const auto col_delta = static_cast<int>(column) - static_cast<int>(pc->column);
    size_t     min_col   = column;
 
-   pc->column = column;
+   set_chunk_column(pc, column);
 
    do
    {
@@ -263,7 +263,7 @@ void align_to_column(chunk_t *pc, size_t column)
       if (almod == align_mode_e::KEEP_ABS)
       {
          // Keep same absolute column
-         pc->column = max(pc->orig_col, min_col);
+         set_chunk_column(pc, max(pc->orig_col, min_col));
       }
       else if (almod == align_mode_e::KEEP_REL)
       {
@@ -271,15 +271,15 @@ void align_to_column(chunk_t *pc, size_t column)
          auto orig_delta = static_cast<int>(pc->orig_col) - static_cast<int>(prev->orig_col);
          orig_delta = max<int>(orig_delta, min_delta);  // keeps orig_delta positive
 
-         pc->column = prev->column + static_cast<size_t>(orig_delta);
+         set_chunk_column(pc, prev->column + static_cast<size_t>(orig_delta));
       }
       else // SHIFT
       {
          // Shift by the same amount, keep above negative values
-         pc->column = (  col_delta >= 0
-                      || cast_abs(pc->column, col_delta) < pc->column)
-                      ? pc->column + col_delta : 0;
-         pc->column = max(pc->column, min_col);
+         const size_t shifted = (  col_delta >= 0
+                                || cast_abs(pc->column, col_delta) < pc->column)
+                                ? pc->column + col_delta : 0;
+         set_chunk_column(pc, max(shifted, min_col));
       }
       LOG_FMT(LINDLINED, "%s(%d):   %s set column of '%s', type is %s, orig_line is %zu, to col %zu (orig_col was %zu)\n",
               __func__, __LINE__,
@@ -306,7 +306,7 @@ void reindent_line(chunk_t *pc, size_t column)
    auto col_delta = static_cast<int>(column) - static_cast<int>(pc->column);
    auto min_col   = column;
 
-   pc->column = column;
+   set_chunk_column(pc, column);
 
    do
    {
@@ -355,14 +355,14 @@ void reindent_line(chunk_t *pc, size_t column)
          && get_chunk_parent_type(pc) != CT_COMMENT_EMBED
          && !keep)
       {
-         pc->column = max(pc->orig_col, min_col);
+         set_chunk_column(pc, max(pc->orig_col, min_col));
          LOG_FMT(LINDLINE, "%s(%d): set comment on line %zu to col %zu (orig %zu)\n",
                  __func__, __LINE__, pc->orig_line, pc->column, pc->orig_col);
       }
       else
       {
          const auto tmp_col = static_cast<int>(pc->column) + col_delta;
-         pc->column = max(tmp_col, static_cast<int>(min_col));
+         set_chunk_column(pc, max(tmp_col, static_cast<int>(min_col)));
 
          LOG_FMT(LINDLINED, "   set column of ");
 
@@ -0,0 +1,203 @@
+/**
+ * @file interner.cpp
+ * Open addressing hash table of the interned texts.
+ *
+ * @license GPL v2+
+ */
+
+#include "interner.h"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+
+using namespace std;
+
+
+struct interned_t
+{
+   size_t offset; //! start of the text in the pool
+   size_t len;    //! length of the text in bytes
+   size_t hash;
+};
+
+
+//! the texts of all entries, one after the other
+static string pool;
+
+//! the entries, the index is the id minus first_id
+static vector<interned_t> entries;
+
+//! the hash table, holds intern ids, 0 for a free slot
+static vector<size_t> slots;
+
+//! id of the first entry of the current file
+static size_t first_id = 1;
+
+
+//! a remembered lookup of a string literal, see find_interned_literal()
+struct literal_t
+{
+   const char *literal; //! address of the literal
+   size_t     len;      //! its length in bytes
+   size_t     id;       //! its intern id, 0 if it was not interned
+   size_t     next_id;  //! next_id() at the lookup, to recheck a missing text
+};
+
+
+//! the remembered lookups, indexed by the address of the literal, per thread
+static thread_local literal_t literals[256];
+
+
+//! initial number of slots, must be a power of 2
+static constexpr size_t MIN_SLOTS = 1024;
+
+
+//! FNV-1a hash of a text
+static size_t hash_text(const char *text, size_t len);
+
+
+/**
+ * Finds the slot of a text
+ *
+ * @return the slot that holds the id of the text or the free slot where
+ *         it would go
+ */
+static size_t find_slot(const char *text, size_t len, size_t hash);
+
+
+//! Doubles the hash table and moves the ids to their new slots
+static void grow_slots(void);
+
+
+//! Returns the id the next new text gets
+static size_t next_id(void);
+
+
+static size_t hash_text(const char *text, size_t len)
+{
+   size_t hash = 2166136261u;
+
+   for (size_t idx = 0; idx < len; idx++)
+   {
+      hash ^= static_cast<unsigned char>(text[idx]);
+      hash *= 16777619u;
+   }
+
+   return(hash);
+}
+
+
+static size_t find_slot(const char *text, size_t len, size_t hash)
+{
+   const size_t mask = slots.size() - 1;
+   size_t       slot = hash & mask;
+
+   while (slots[slot] != 0)
+   {
+      const interned_t &entry = entries[slots[slot] - first_id];
+
+      if (  entry.hash == hash
+         && entry.len == len
+         && memcmp(pool.data() + entry.offset, text, len) == 0)
+      {
+         break;
+      }
+      slot = (slot + 1) & mask;
+   }
+   return(slot);
+}
+
+
+static void grow_slots(void)
+{
+   slots.assign(slots.empty() ? MIN_SLOTS : slots.size() * 2, 0);
+
+   const size_t mask = slots.size() - 1;
+
+   for (size_t idx = 0; idx < entries.size(); idx++)
+   {
+      size_t slot = entries[idx].hash & mask;
+
+      while (slots[slot] != 0)
+      {
+         slot = (slot + 1) & mask;
+      }
+      slots[slot] = first_id + idx;
+   }
+}
+
+
+size_t intern_text(const char *text, size_t len)
+{
+   // keep the table at most half full
+   if ((entries.size() + 1) * 2 > slots.size())
+   {
+      grow_slots();
+   }
+   const size_t hash = hash_text(text, len);
+   const size_t slot = find_slot(text, len, hash);
+
+   if (slots[slot] == 0)
+   {
+      entries.push_back({ pool.size(), len, hash });
+      pool.append(text, len);
+      slots[slot] = first_id + entries.size() - 1;
+   }
+   return(slots[slot]);
+}
+
+
+static size_t next_id(void)
+{
+   return(first_id + entries.size());
+}
+
+
+size_t find_interned(const char *text, size_t len)
+{
+   if (slots.empty())
+   {
+      return(0);
+   }
+   return(slots[find_slot(text, len, hash_text(text, len))]);
+}
+
+
+size_t find_interned_literal(const char *literal, size_t len)
+{
+   literal_t &entry = literals[(reinterpret_cast<size_t>(literal) >> 3)
+                               % (sizeof(literals) / sizeof(literals[0]))];
+
+   if (  entry.literal != literal
+      || entry.len != len
+      || (entry.id == 0 && entry.next_id != next_id())
+      || (entry.id != 0 && !is_current_intern_id(entry.id)))
+   {
+      entry.literal = literal;
+      entry.len     = len;
+      entry.id      = find_interned(literal, len);
+      entry.next_id = next_id();
+   }
+   return(entry.id);
+}
+
+
+bool is_current_intern_id(size_t id)
+{
+   return(id >= first_id && id - first_id < entries.size());
+}
+
+
+void clear_interned(void)
+{
+   first_id += entries.size();
+   entries.clear();
+   pool.clear();
+
+   if (!slots.empty())
+   {
+      slots.assign(slots.size(), 0);
+   }
+}
@@ -0,0 +1,54 @@
+/**
+ * @file interner.h
+ * Interns the text of the chunks of a file, so that equal texts can be
+ * compared as integer intern ids.
+ *
+ * @license GPL v2+
+ */
+
+#ifndef INTERNER_H_INCLUDED
+#define INTERNER_H_INCLUDED
+
+#include <cstddef>
+
+
+/**
+ * Returns the intern id of a text, the text is added if it is new.
+ * The ids of a file are dense and never 0.
+ *
+ * @param text  UTF-8 text, does not need to be zero terminated
+ * @param len   length of the text in bytes
+ */
+size_t intern_text(const char *text, size_t len);
+
+
+/**
+ * Returns the intern id of a text without adding it
+ *
+ * @return the id, 0 if the text was not interned
+ */
+size_t find_interned(const char *text, size_t len);
+
+
+/**
+ * Like find_interned(), for a string literal. The id is remembered by the
+ * address of the literal, so that repeated lookups do not hash the text.
+ * Only for texts that never change, such as string literals.
+ *
+ * @return the id, 0 if the text was not interned
+ */
+size_t find_interned_literal(const char *literal, size_t len);
+
+
+//! Checks if an intern id was handed out since the last clear_interned()
+bool is_current_intern_id(size_t id);
+
+
+/**
+ * Forgets all interned texts, called before each file is processed.
+ * Ids handed out before are never reused.
+ */
+void clear_interned(void);
+
+
+#endif /* INTERNER_H_INCLUDED */
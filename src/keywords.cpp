@@ -54,7 +54,7 @@ static const chunk_tag_t *kw_static_first(const chunk_tag_t *tag);
 
 
 //static const chunk_tag_t *kw_static_match(const chunk_tag_t *tag);
-static const chunk_tag_t *kw_static_match(const chunk_tag_t *tag, int lang_flags);
+static const chunk_tag_t *kw_static_match(const chunk_tag_t *tag, int lang_flags, c_token_t in_preproc);
 
 /**
  * interesting static keywords - keep sorted.
@@ -375,14 +375,14 @@ void init_keywords()
       if ((tag->lang_flags & LANG_C) != 0)
       {
          int               lang_flags = LANG_OC;
-         const chunk_tag_t *probe     = kw_static_match(tag, lang_flags);
+         const chunk_tag_t *probe     = kw_static_match(tag, lang_flags, cpd.in_preproc);
 
          if (probe == NULL)
          {
             tag->lang_flags |= lang_flags;
          }
          lang_flags = LANG_CPP;
-         probe      = kw_static_match(tag, lang_flags);
+         probe      = kw_static_match(tag, lang_flags, cpd.in_preproc);
 
          if (probe == NULL)
          {
@@ -457,10 +457,10 @@ static const chunk_tag_t *kw_static_first(const chunk_tag_t *tag)
 }
 
 
-static const chunk_tag_t *kw_static_match(const chunk_tag_t *tag, int lang_flags)
+static const chunk_tag_t *kw_static_match(const chunk_tag_t *tag, int lang_flags, c_token_t in_preproc)
 {
-   bool in_pp = (  cpd.in_preproc != CT_NONE
-                && cpd.in_preproc != CT_PP_DEFINE);
+   bool in_pp = (  in_preproc != CT_NONE
+                && in_preproc != CT_PP_DEFINE);
 
    for (const chunk_tag_t *iter = kw_static_first(tag);
         iter < &keywords[ARRAY_SIZE(keywords)];
@@ -482,6 +482,12 @@ static const chunk_tag_t *kw_static_match(const chunk_tag_t *tag, int lang_flags
 
 
 c_token_t find_keyword_type(const char *word, size_t len)
+{
+   return(find_keyword_type(word, len, cpd.in_preproc));
+}
+
+
+c_token_t find_keyword_type(const char *word, size_t len, c_token_t &in_preproc)
 {
    if (len <= 0)
    {
@@ -505,11 +511,13 @@ c_token_t find_keyword_type(const char *word, size_t len)
 
    if (p_ret != nullptr)
    {
-      if (strcmp(p_ret->tag, "__pragma") == 0 || strcmp(p_ret->tag, "_Pragma") == 0)
+      // __pragma and _Pragma, unlike the pragma of #pragma
+      if (  p_ret->type == CT_PP_PRAGMA
+         && p_ret->tag[0] == '_')
       {
-         cpd.in_preproc = CT_PREPROC;
+         in_preproc = CT_PREPROC;
       }
-      p_ret = kw_static_match(p_ret, cpd.lang_flags);
+      p_ret = kw_static_match(p_ret, cpd.lang_flags, in_preproc);
    }
    return((p_ret != nullptr) ? p_ret->type : CT_WORD);
 }
@@ -38,6 +38,19 @@ int load_keyword_file(const char *filename);
 c_token_t find_keyword_type(const char *word, size_t len);
 
 
+/**
+ * Same as above, with the preprocessor state of the caller instead of
+ * cpd.in_preproc
+ *
+ * @param word        Pointer to the text -- NOT zero terminated
+ * @param len         The length of the text
+ * @param in_preproc  The preprocessor state, set to CT_PREPROC by '__pragma'
+ *
+ * @return CT_WORD (no match) or the keyword token
+ */
+c_token_t find_keyword_type(const char *word, size_t len, c_token_t &in_preproc);
+
+
 /**
  * Adds a keyword to the list of dynamic keywords
  *
@@ -33,7 +33,13 @@ struct log_fcn_info
    const char *name;
    int        line;
 };
-static std::deque<log_fcn_info> g_fq;
+static thread_local std::deque<log_fcn_info> g_fq;
+
+//! true while the logs of this thread are held back
+static thread_local bool g_muted = false;
+
+//! number of logs held back since the thread was muted
+static thread_local size_t g_muted_count = 0;
 
 //! Private log structure
 struct log_buf
@@ -103,7 +109,30 @@ void log_show_sev(bool show)
 
 bool log_sev_on(log_sev_t sev)
 {
-   return(logmask_test(g_log.mask, sev));
+   if (!logmask_test(g_log.mask, sev))
+   {
+      return(false);
+   }
+
+   if (g_muted)
+   {
+      g_muted_count++;
+      return(false);
+   }
+   return(true);
+}
+
+
+void log_mute(bool mute)
+{
+   g_muted       = mute;
+   g_muted_count = 0;
+}
+
+
+size_t log_muted_count(void)
+{
+   return(g_muted_count);
 }
 
 
@@ -47,6 +47,21 @@ void log_show_sev(bool show);
 bool log_sev_on(log_sev_t sev);
 
 
+/**
+ * Holds back the logs of the calling thread, for work that is thrown away
+ * and done again if it had anything to log.
+ *
+ * @param mute  true to hold back the logs, false to let them through again
+ */
+void log_mute(bool mute);
+
+
+/**
+ * @return the number of logs the calling thread held back since it was muted
+ */
+size_t log_muted_count(void);
+
+
 /**
  * Sets a log sev on or off
  *
@@ -491,7 +491,7 @@ void double_newline(chunk_t *nl)
 
    if (nl->nl_count != 2)
    {
-      nl->nl_count = 2;
+      set_chunk_nl_count(nl, 2);
       MARK_CHANGE();
    }
 }
@@ -531,7 +531,7 @@ chunk_t *newline_force_before(chunk_t *pc)
 
    if (nl != nullptr && nl->nl_count > 1)
    {
-      nl->nl_count = 1;
+      set_chunk_nl_count(nl, 1);
       MARK_CHANGE();
    }
    return(nl);
@@ -578,7 +578,7 @@ chunk_t *newline_force_after(chunk_t *pc)
    if (  nl != nullptr
       && nl->nl_count > 1) // check if there are more than 1 newline
    {
-      nl->nl_count = 1;                   // if so change the newline count back to 1
+      set_chunk_nl_count(nl, 1);                   // if so change the newline count back to 1
       MARK_CHANGE();
    }
    return(nl);
@@ -667,7 +667,7 @@ static void newline_min_after(chunk_t *ref, size_t count, pcf_flag_e flag)
    {
       if (pc->nl_count < count)
       {
-         pc->nl_count = count;
+         set_chunk_nl_count(pc, count);
          MARK_CHANGE();
       }
    }
@@ -814,7 +814,7 @@ void newline_del_between(chunk_t *start, chunk_t *end)
          {
             if (pc->nl_count > 1)
             {
-               pc->nl_count = 1;
+               set_chunk_nl_count(pc, 1);
                MARK_CHANGE();
             }
          }
@@ -1001,7 +1001,7 @@ static void newlines_if_for_while_switch_pre_blank_lines(chunk_t *start, iarf_e
 
                if (nl_count != pc->nl_count)
                {
-                  pc->nl_count = nl_count;
+                  set_chunk_nl_count(pc, nl_count);
                   MARK_CHANGE();
                }
 
@@ -1077,7 +1077,7 @@ static void blank_line_set(chunk_t *pc, Option<unsigned> &opt)
    {
       LOG_FMT(LBLANKD, "%s(%d): do_blank_lines: %s set line %zu to %u\n",
               __func__, __LINE__, opt.name(), pc->orig_line, optval);
-      pc->nl_count = optval;
+      set_chunk_nl_count(pc, optval);
       MARK_CHANGE();
    }
 }
@@ -1465,7 +1465,7 @@ static void newlines_if_for_while_switch_post_blank_lines(chunk_t *start, iarf_e
       {
          if (prev->nl_count != 1)
          {
-            prev->nl_count = 1;
+            set_chunk_nl_count(prev, 1);
             MARK_CHANGE();
          }
          remove_next_newlines(pc);
@@ -1476,7 +1476,7 @@ static void newlines_if_for_while_switch_post_blank_lines(chunk_t *start, iarf_e
          // otherwise just deal with newlines after brace
          if (next->nl_count != 1)
          {
-            next->nl_count = 1;
+            set_chunk_nl_count(next, 1);
             MARK_CHANGE();
          }
          remove_next_newlines(next);
@@ -2052,7 +2052,7 @@ static chunk_t *newline_def_blk(chunk_t *start, bool fn_top)
 
                   if (prev->nl_count > options::nl_var_def_blk_in())
                   {
-                     prev->nl_count = options::nl_var_def_blk_in();
+                     set_chunk_nl_count(prev, options::nl_var_def_blk_in());
                      MARK_CHANGE();
                   }
                }
@@ -2426,7 +2426,7 @@ static void newlines_brace_pair(chunk_t *br_open)
          }
          else if (next->nl_count > 1)
          {
-            next->nl_count = 1;
+            set_chunk_nl_count(next, 1);
             LOG_FMT(LBLANKD, "%s(%d): eat_blanks_after_open_brace %zu\n",
                     __func__, __LINE__, next->orig_line);
             MARK_CHANGE();
@@ -2627,7 +2627,7 @@ static void newline_before_return(chunk_t *start)
    if (  chunk_is_newline(nl)
       && nl->nl_count < 2)
    {
-      nl->nl_count++;
+      set_chunk_nl_count(nl, nl->nl_count + 1);
       MARK_CHANGE();
    }
 } // newline_before_return
@@ -2695,7 +2695,7 @@ static void newline_iarf_pair(chunk_t *before, chunk_t *after, iarf_e av, bool c
          && av == IARF_FORCE
          && nl->nl_count > 1)
       {
-         nl->nl_count = 1;
+         set_chunk_nl_count(nl, 1);
       }
    }
    else if (av & IARF_REMOVE)
@@ -3567,20 +3567,19 @@ void newlines_remove_newlines(void)
 }
 
 
-void newlines_cleanup_angles()
+void newlines_cleanup_angles(chunk_t *pc)
 {
    // Issue #1167
-   LOG_FUNC_ENTRY();
-
-   for (chunk_t *pc = chunk_get_head(); pc != nullptr; pc = chunk_get_next_ncnl(pc))
+   if (chunk_is_comment(pc) || chunk_is_newline(pc))
    {
-      LOG_FMT(LBLANK, "%s(%d): orig_line is %zu, orig_col is %zu, text() is '%s'\n",
-              __func__, __LINE__, pc->orig_line, pc->orig_col, pc->text());
+      return;
+   }
+   LOG_FMT(LBLANK, "%s(%d): orig_line is %zu, orig_col is %zu, text() is '%s'\n",
+           __func__, __LINE__, pc->orig_line, pc->orig_col, pc->text());
 
-      if (chunk_is_token(pc, CT_ANGLE_OPEN))
-      {
-         newline_template(pc);
-      }
+   if (chunk_is_token(pc, CT_ANGLE_OPEN))
+   {
+      newline_template(pc);
    }
 }
 
@@ -4047,7 +4046,7 @@ void newlines_cleanup_braces(bool first)
                }
                else if (prev->nl_count != 1)
                {
-                  prev->nl_count = 1;
+                  set_chunk_nl_count(prev, 1);
                   LOG_FMT(LBLANKD, "%s(%d): eat_blanks_before_close_brace %zu\n",
                           __func__, __LINE__, prev->orig_line);
                   MARK_CHANGE();
@@ -4277,7 +4276,7 @@ void newlines_cleanup_braces(bool first)
          }
       }
       else if (  chunk_is_token(pc, CT_QUALIFIER)
-              && !strcmp(pc->text(), "throws"))
+              && chunk_is_str(pc, "throws", 6))
       {
          prev = chunk_get_prev(pc);
 
@@ -4729,40 +4728,29 @@ static void nl_handle_define(chunk_t *pc)
 }
 
 
-void newline_after_multiline_comment(void)
+void newline_after_multiline_comment(chunk_t *pc)
 {
-   LOG_FUNC_ENTRY();
-
-   for (chunk_t *pc = chunk_get_head(); pc != nullptr; pc = chunk_get_next(pc))
+   if (pc->type != CT_COMMENT_MULTI)
    {
-      if (pc->type != CT_COMMENT_MULTI)
-      {
-         continue;
-      }
-      chunk_t *tmp = pc;
+      return;
+   }
+   chunk_t *tmp = pc;
 
-      while (((tmp = chunk_get_next(tmp)) != nullptr) && !chunk_is_newline(tmp))
+   while (((tmp = chunk_get_next(tmp)) != nullptr) && !chunk_is_newline(tmp))
+   {
+      if (!chunk_is_comment(tmp))
       {
-         if (!chunk_is_comment(tmp))
-         {
-            newline_add_before(tmp);
-            break;
-         }
+         newline_add_before(tmp);
+         break;
       }
    }
 }
 
 
-void newline_after_label_colon(void)
+void newline_after_label_colon(chunk_t *pc)
 {
-   LOG_FUNC_ENTRY();
-
-   for (chunk_t *pc = chunk_get_head(); pc != nullptr; pc = chunk_get_next(pc))
+   if (pc->type == CT_LABEL_COLON)
    {
-      if (pc->type != CT_LABEL_COLON)
-      {
-         continue;
-      }
       newline_add_after(pc);
    }
 }
@@ -4911,7 +4899,7 @@ void newlines_functions_remove_extra_blank_lines(void)
          {
             LOG_FMT(LNEWLINE, "%s(%d): orig_line is %zu, orig_col is %zu, text() '%s', type is %s\n",
                     __func__, __LINE__, pc->orig_line, pc->orig_col, pc->text(), get_token_name(pc->type));
-            pc->nl_count = nl_max_blank_in_func;
+            set_chunk_nl_count(pc, nl_max_blank_in_func);
             MARK_CHANGE();
             remove_next_newlines(pc);
          }
@@ -4958,7 +4946,7 @@ void newlines_squeeze_ifdef(void)
                {
                   if (pnl->nl_count > 1)
                   {
-                     pnl->nl_count = 1;
+                     set_chunk_nl_count(pnl, 1);
                      MARK_CHANGE();
 
                      tmp1 = chunk_get_prev_nnl(pnl);
@@ -4976,7 +4964,7 @@ void newlines_squeeze_ifdef(void)
                      tmp1 = chunk_get_prev_nnl(nnl);
                      LOG_FMT(LNEWLINE, "%s(%d): trimmed newlines after line %zu from %zu\n",
                              __func__, __LINE__, tmp1->orig_line, nnl->nl_count);
-                     nnl->nl_count = 1;
+                     set_chunk_nl_count(nnl, 1);
                      MARK_CHANGE();
                   }
                }
@@ -5082,7 +5070,7 @@ void newlines_eat_start_end(void)
                log_rule_B("nl_start_of_file");
                LOG_FMT(LBLANKD, "%s(%d): set_blanks_start_of_file %zu\n",
                        __func__, __LINE__, pc->orig_line);
-               pc->nl_count = options::nl_start_of_file_min();
+               set_chunk_nl_count(pc, options::nl_start_of_file_min());
                log_rule_B("nl_start_of_file_min");
                MARK_CHANGE();
             }
@@ -5139,7 +5127,7 @@ void newlines_eat_start_end(void)
                   log_rule_B("nl_end_of_file_min");
                   LOG_FMT(LBLANKD, "%s(%d): set_blanks_end_of_file %zu\n",
                           __func__, __LINE__, pc->orig_line);
-                  pc->nl_count = options::nl_end_of_file_min();
+                  set_chunk_nl_count(pc, options::nl_end_of_file_min());
                   log_rule_B("nl_end_of_file_min");
                   MARK_CHANGE();
                }
@@ -5166,402 +5154,474 @@ void newlines_eat_start_end(void)
 } // newlines_eat_start_end
 
 
-void newlines_chunk_pos(c_token_t chunk_type, token_pos_e mode)
+//! Moves one chunk of a type that has a position option, if needed
+static void newline_chunk_pos(chunk_t *pc, c_token_t chunk_type, token_pos_e mode)
 {
    LOG_FUNC_ENTRY();
 
-   LOG_FMT(LNEWLINE, "%s(%d): mode is %s\n",
-           __func__, __LINE__, to_string(mode));
+   token_pos_e mode_local;
 
-   if (  !(mode & (TP_JOIN | TP_LEAD | TP_TRAIL))
-      && chunk_type != CT_COMMA)
+   if (chunk_type == CT_COMMA)
    {
-      return;
-   }
+      LOG_FMT(LNEWLINE, "%s(%d): orig_line is %zu, orig_col is %zu, text() is '%s', type is %s\n   ",
+              __func__, __LINE__, pc->orig_line, pc->orig_col, pc->text(), get_token_name(pc->type));
+      log_pcf_flags(LNEWLINE, pc->flags);
 
-   for (chunk_t *pc = chunk_get_head(); pc != nullptr; pc = chunk_get_next_ncnl(pc))
+      if (pc->flags.test(PCF_IN_CONST_ARGS)) // Issue #2250
+      {
+         return;
+      }
+
+      /*
+       * for chunk_type == CT_COMMA
+       * we get 'mode' from options::pos_comma()
+       * BUT we must take care of options::pos_class_comma()
+       * TODO and options::pos_constr_comma()
+       */
+      if (pc->flags.test(PCF_IN_CLASS_BASE))
+      {
+         // change mode
+         mode_local = options::pos_class_comma();
+      }
+      else if (pc->flags.test(PCF_IN_ENUM))
+      {
+         mode_local = options::pos_enum_comma();
+      }
+      else
+      {
+         mode_local = mode;
+      }
+      LOG_FMT(LNEWLINE, "%s(%d): mode_local is %s\n",
+              __func__, __LINE__, to_string(mode_local));
+   }
+   else
    {
-      LOG_FMT(LNEWLINE, "%s(%d): pc->orig_line is %zu, orig_col is %zu, text() is '%s'\n   ",
-              __func__, __LINE__, pc->orig_line, pc->orig_col, pc->text());
-      log_pcf_flags(LNEWLINE, pc->flags);
+      mode_local = mode;
+   }
+   chunk_t *prev = chunk_get_prev_nc(pc);
+   chunk_t *next = chunk_get_next_nc(pc);
 
-      if (pc->type == chunk_type)
+   LOG_FMT(LNEWLINE, "%s(%d): mode_local is %s\n",
+           __func__, __LINE__, to_string(mode_local));
+
+   LOG_FMT(LNEWLINE, "%s(%d): prev->orig_line is %zu, orig_col is %zu, text() is '%s'\n",
+           __func__, __LINE__, prev->orig_line, prev->orig_col, prev->text());
+   LOG_FMT(LNEWLINE, "%s(%d): next->orig_line is %zu, orig_col is %zu, text() is '%s'\n",
+           __func__, __LINE__, next->orig_line, next->orig_col, next->text());
+   size_t nl_flag = ((chunk_is_newline(prev) ? 1 : 0) |
+                     (chunk_is_newline(next) ? 2 : 0));
+
+   LOG_FMT(LNEWLINE, "%s(%d): nl_flag is %zu\n",
+           __func__, __LINE__, nl_flag);
+
+   if (mode_local & TP_JOIN)
+   {
+      if (nl_flag & 1)
       {
-         token_pos_e mode_local;
+         // remove newline if not preceded by a comment
+         chunk_t *prev2 = chunk_get_prev(prev);
 
-         if (chunk_type == CT_COMMA)
+         if (prev2 != nullptr && !(chunk_is_comment(prev2)))
          {
-            LOG_FMT(LNEWLINE, "%s(%d): orig_line is %zu, orig_col is %zu, text() is '%s', type is %s\n   ",
-                    __func__, __LINE__, pc->orig_line, pc->orig_col, pc->text(), get_token_name(pc->type));
-            log_pcf_flags(LNEWLINE, pc->flags);
+            remove_next_newlines(prev2);
+         }
+      }
 
-            if (pc->flags.test(PCF_IN_CONST_ARGS)) // Issue #2250
-            {
-               continue;
-            }
+      if (nl_flag & 2)
+      {
+         // remove newline if not followed by a comment
+         chunk_t *next2 = chunk_get_next(next);
 
-            /*
-             * for chunk_type == CT_COMMA
-             * we get 'mode' from options::pos_comma()
-             * BUT we must take care of options::pos_class_comma()
-             * TODO and options::pos_constr_comma()
-             */
-            if (pc->flags.test(PCF_IN_CLASS_BASE))
-            {
-               // change mode
-               mode_local = options::pos_class_comma();
-            }
-            else if (pc->flags.test(PCF_IN_ENUM))
-            {
-               mode_local = options::pos_enum_comma();
-            }
-            else
-            {
-               mode_local = mode;
-            }
-            LOG_FMT(LNEWLINE, "%s(%d): mode_local is %s\n",
-                    __func__, __LINE__, to_string(mode_local));
-         }
-         else
+         if (next2 != nullptr && !(chunk_is_comment(next2)))
          {
-            mode_local = mode;
+            remove_next_newlines(pc);
          }
-         chunk_t *prev = chunk_get_prev_nc(pc);
-         chunk_t *next = chunk_get_next_nc(pc);
+      }
+      return;
+   }
+
+   if (  (nl_flag == 0 && !(mode_local & (TP_FORCE | TP_BREAK)))
+      || (nl_flag == 3 && !(mode_local & TP_FORCE)))
+   {
+      // No newlines and not adding any or both and not forcing
+      return;
+   }
+
+   if (  ((mode_local & TP_LEAD) && nl_flag == 1)
+      || ((mode_local & TP_TRAIL) && nl_flag == 2))
+   {
+      // Already a newline before (lead) or after (trail)
+      return;
+   }
+
+   // If there were no newlines, we need to add one
+   if (nl_flag == 0)
+   {
+      if (mode_local & TP_LEAD)
+      {
+         newline_add_before(pc);
+      }
+      else
+      {
+         newline_add_after(pc);
+      }
+      return;
+   }
+
+   // If there were both newlines, we need to remove one
+   if (nl_flag == 3)
+   {
+      if (mode_local & TP_LEAD)
+      {
+         remove_next_newlines(pc);
+      }
+      else
+      {
+         remove_next_newlines(chunk_get_prev_ncnlni(pc));   // Issue #2279
+      }
+      return;
+   }
 
-         LOG_FMT(LNEWLINE, "%s(%d): mode_local is %s\n",
-                 __func__, __LINE__, to_string(mode_local));
+   // we need to move the newline
+   if (mode_local & TP_LEAD)
+   {
+      chunk_t *next2 = chunk_get_next(next);
 
+      if (  chunk_is_token(next2, CT_PREPROC)
+         || (  chunk_type == CT_ASSIGN
+            && chunk_is_token(next2, CT_BRACE_OPEN)))
+      {
+         return;
+      }
+
+      if (next->nl_count == 1)
+      {
+         // move the CT_BOOL to after the newline
+         chunk_move_after(pc, next);
+      }
+   }
+   else
+   {
+      LOG_FMT(LNEWLINE, "%s(%d): prev->orig_line is %zu, orig_col is %zu, text() is '%s', nl_count is %zu\n",
+              __func__, __LINE__, prev->orig_line, prev->orig_col, prev->text(), prev->nl_count);
+
+      if (prev->nl_count == 1)
+      {
+         // Back up to the next non-comment item
+         prev = chunk_get_prev_nc(prev);
          LOG_FMT(LNEWLINE, "%s(%d): prev->orig_line is %zu, orig_col is %zu, text() is '%s'\n",
                  __func__, __LINE__, prev->orig_line, prev->orig_col, prev->text());
-         LOG_FMT(LNEWLINE, "%s(%d): next->orig_line is %zu, orig_col is %zu, text() is '%s'\n",
-                 __func__, __LINE__, next->orig_line, next->orig_col, next->text());
-         size_t nl_flag = ((chunk_is_newline(prev) ? 1 : 0) |
-                           (chunk_is_newline(next) ? 2 : 0));
-         LOG_FMT(LNEWLINE, "%s(%d): nl_flag is %zu\n",
-                 __func__, __LINE__, nl_flag);
 
-         if (mode_local & TP_JOIN)
+         if (  prev != nullptr
+            && !chunk_is_newline(prev)
+            && !prev->flags.test(PCF_IN_PREPROC)
+            && !prev->flags.test(PCF_IN_OC_MSG))
          {
-            if (nl_flag & 1)
-            {
-               // remove newline if not preceded by a comment
-               chunk_t *prev2 = chunk_get_prev(prev);
+            chunk_move_after(pc, prev);
+         }
+      }
+   }
+} // newline_chunk_pos
 
-               if (prev2 != nullptr && !(chunk_is_comment(prev2)))
-               {
-                  remove_next_newlines(prev2);
-               }
-            }
 
-            if (nl_flag & 2)
-            {
-               // remove newline if not followed by a comment
-               chunk_t *next2 = chunk_get_next(next);
+//! What newline_class_colon_pos() does for one type of colon
+struct class_colon_pos_t
+{
+   c_token_t   tok;              //! CT_CLASS_COLON or CT_CONSTR_COLON
+   token_pos_e tpc;              //! where the colon goes
+   token_pos_e pcc;              //! where the commas after it go
+   iarf_e      anc;              //! newline after the colon
+   iarf_e      ncia;             //! newlines between the args
+   chunk_t     *ccolon;          //! the colon whose args are being broken up
+   bool        with_acv;
+   AlignStack  constructorValue; // ABC_Member(abc_value)
+};
+
+
+//! Moves one class or constructor colon, and breaks up the args after it
+static void newline_class_colon_pos(class_colon_pos_t &cc, chunk_t *pc)
+{
+   if (!cc.ccolon && pc->type != cc.tok)
+   {
+      return;
+   }
+   chunk_t *prev;
+   chunk_t *next;
 
-               if (next2 != nullptr && !(chunk_is_comment(next2)))
-               {
-                  remove_next_newlines(pc);
-               }
-            }
-            continue;
+   if (pc->type == cc.tok)
+   {
+      LOG_FMT(LBLANKD, "%s(%d): orig_line is %zu, orig_col is %zu, text() '%s', type is %s\n",
+              __func__, __LINE__, pc->orig_line, pc->orig_col, pc->text(), get_token_name(pc->type));
+      cc.ccolon = pc;
+      prev      = chunk_get_prev_nc(pc);
+      next      = chunk_get_next_nc(pc);
+
+      if (chunk_is_token(pc, CT_CONSTR_COLON))
+      {
+         LOG_FMT(LBLANKD, "%s(%d): pc->orig_line is %zu, orig_col is %zu, text() '%s', type is %s\n",
+                 __func__, __LINE__, pc->orig_line, pc->orig_col, pc->text(), get_token_name(pc->type));
+         chunk_t *paren_vor_value = chunk_get_next_type(pc, CT_FPAREN_OPEN, pc->level);
+
+         if (cc.with_acv && paren_vor_value != nullptr)
+         {
+            LOG_FMT(LBLANKD, "%s(%d): paren_vor_value->orig_line is %zu, orig_col is %zu, text() '%s', type is %s\n",
+                    __func__, __LINE__, paren_vor_value->orig_line, paren_vor_value->orig_col,
+                    paren_vor_value->text(), get_token_name(paren_vor_value->type));
+            cc.constructorValue.NewLines(paren_vor_value->nl_count);
+            cc.constructorValue.Add(paren_vor_value);
          }
+      }
 
-         if (  (nl_flag == 0 && !(mode_local & (TP_FORCE | TP_BREAK)))
-            || (nl_flag == 3 && !(mode_local & TP_FORCE)))
+      if (  !chunk_is_newline(prev)
+         && !chunk_is_newline(next)
+         && (cc.anc & IARF_ADD))
+      {
+         newline_add_after(pc);
+         prev = chunk_get_prev_nc(pc);
+         next = chunk_get_next_nc(pc);
+      }
+
+      if (cc.anc == IARF_REMOVE)
+      {
+         if (chunk_is_newline(prev) && chunk_safe_to_del_nl(prev))
          {
-            // No newlines and not adding any or both and not forcing
-            continue;
+            chunk_del(prev);
+            MARK_CHANGE();
+            prev = chunk_get_prev_nc(pc);
          }
 
-         if (  ((mode_local & TP_LEAD) && nl_flag == 1)
-            || ((mode_local & TP_TRAIL) && nl_flag == 2))
+         if (chunk_is_newline(next) && chunk_safe_to_del_nl(next))
          {
-            // Already a newline before (lead) or after (trail)
-            continue;
+            chunk_del(next);
+            MARK_CHANGE();
+            next = chunk_get_next_nc(pc);
          }
+      }
 
-         // If there were no newlines, we need to add one
-         if (nl_flag == 0)
+      if (cc.tpc & TP_TRAIL)
+      {
+         if (  chunk_is_newline(prev)
+            && prev->nl_count == 1
+            && chunk_safe_to_del_nl(prev))
          {
-            if (mode_local & TP_LEAD)
-            {
-               newline_add_before(pc);
-            }
-            else
-            {
-               newline_add_after(pc);
-            }
-            continue;
+            chunk_swap(pc, prev);
          }
+      }
+      else if (cc.tpc & TP_LEAD)
+      {
+         if (  chunk_is_newline(next)
+            && next->nl_count == 1
+            && chunk_safe_to_del_nl(next))
+         {
+            chunk_swap(pc, next);
+         }
+      }
+   }
+   else
+   {
+      if (chunk_is_token(pc, CT_BRACE_OPEN) || chunk_is_token(pc, CT_SEMICOLON))
+      {
+         cc.ccolon = nullptr;
 
-         // If there were both newlines, we need to remove one
-         if (nl_flag == 3)
+         if (cc.with_acv)
          {
-            if (mode_local & TP_LEAD)
-            {
-               remove_next_newlines(pc);
-            }
-            else
-            {
-               remove_next_newlines(chunk_get_prev_ncnlni(pc));   // Issue #2279
-            }
-            continue;
+            cc.constructorValue.End();
          }
+         return;
+      }
 
-         // we need to move the newline
-         if (mode_local & TP_LEAD)
+      if (chunk_is_token(pc, CT_COMMA) && pc->level == cc.ccolon->level)
+      {
+         LOG_FMT(LBLANKD, "%s(%d): orig_line is %zu, orig_col is %zu, text() '%s', type is %s\n",
+                 __func__, __LINE__, pc->orig_line, pc->orig_col, pc->text(), get_token_name(pc->type));
+         chunk_t *paren_vor_value = chunk_get_next_type(pc, CT_FPAREN_OPEN, pc->level);
+
+         if (cc.with_acv && paren_vor_value != nullptr)
          {
-            chunk_t *next2 = chunk_get_next(next);
+            LOG_FMT(LBLANKD, "%s(%d): paren_vor_value->orig_line is %zu, orig_col is %zu, text() '%s', type is %s\n",
+                    __func__, __LINE__, paren_vor_value->orig_line, paren_vor_value->orig_col,
+                    paren_vor_value->text(), get_token_name(paren_vor_value->type));
+            cc.constructorValue.NewLines(paren_vor_value->nl_count);
+            cc.constructorValue.Add(paren_vor_value);
+         }
 
-            if (  chunk_is_token(next2, CT_PREPROC)
-               || (  chunk_type == CT_ASSIGN
-                  && chunk_is_token(next2, CT_BRACE_OPEN)))
+         if (cc.ncia & IARF_ADD)
+         {
+            if (cc.pcc & TP_TRAIL)
             {
-               continue;
-            }
+               if (cc.ncia == IARF_FORCE)
+               {
+                  newline_force_after(pc);
+               }
+               else
+               {
+                  newline_add_after(pc);
+               }
+               prev = chunk_get_prev_nc(pc);
 
-            if (next->nl_count == 1)
+               if (chunk_is_newline(prev) && chunk_safe_to_del_nl(prev))
+               {
+                  chunk_del(prev);
+                  MARK_CHANGE();
+               }
+            }
+            else if (cc.pcc & TP_LEAD)
             {
-               // move the CT_BOOL to after the newline
-               chunk_move_after(pc, next);
+               if (cc.ncia == IARF_FORCE)
+               {
+                  newline_force_before(pc);
+               }
+               else
+               {
+                  newline_add_before(pc);
+               }
+               next = chunk_get_next_nc(pc);
+
+               if (chunk_is_newline(next) && chunk_safe_to_del_nl(next))
+               {
+                  chunk_del(next);
+                  MARK_CHANGE();
+               }
             }
          }
-         else
+         else if (cc.ncia == IARF_REMOVE)
          {
-            LOG_FMT(LNEWLINE, "%s(%d): prev->orig_line is %zu, orig_col is %zu, text() is '%s', nl_count is %zu\n",
-                    __func__, __LINE__, prev->orig_line, prev->orig_col, prev->text(), prev->nl_count);
+            next = chunk_get_next(pc);
 
-            if (prev->nl_count == 1)
+            if (chunk_is_newline(next) && chunk_safe_to_del_nl(next))
             {
-               // Back up to the next non-comment item
-               prev = chunk_get_prev_nc(prev);
-               LOG_FMT(LNEWLINE, "%s(%d): prev->orig_line is %zu, orig_col is %zu, text() is '%s'\n",
-                       __func__, __LINE__, prev->orig_line, prev->orig_col, prev->text());
-
-               if (  prev != nullptr
-                  && !chunk_is_newline(prev)
-                  && !prev->flags.test(PCF_IN_PREPROC)
-                  && !prev->flags.test(PCF_IN_OC_MSG))
-               {
-                  chunk_move_after(pc, prev);
-               }
+               chunk_del(next);
+               MARK_CHANGE();
             }
          }
       }
    }
-} // newlines_chunk_pos
+} // newline_class_colon_pos
 
 
-void newlines_class_colon_pos(c_token_t tok)
+/**
+ * Moves the class or constructor colons of one type, and breaks up the
+ * args after them
+ *
+ * @param chunks  the colons, braces, semicolons and commas of the file
+ */
+static void newlines_class_colon_pos(c_token_t tok, const vector<chunk_t *> &chunks)
 {
    LOG_FUNC_ENTRY();
 
-   token_pos_e tpc;
-   token_pos_e pcc;
-   iarf_e      anc;
-   iarf_e      ncia;
+   class_colon_pos_t cc;
+
+   cc.tok = tok;
 
    if (tok == CT_CLASS_COLON)
    {
-      tpc = options::pos_class_colon();
+      cc.tpc = options::pos_class_colon();
       log_rule_B("pos_class_colon");
-      anc = options::nl_class_colon();
+      cc.anc = options::nl_class_colon();
       log_rule_B("nl_class_colon");
-      ncia = options::nl_class_init_args();
+      cc.ncia = options::nl_class_init_args();
       log_rule_B("nl_class_init_args");
-      pcc = options::pos_class_comma();
+      cc.pcc = options::pos_class_comma();
       log_rule_B("pos_class_comma");
    }
    else // tok == CT_CONSTR_COLON
    {
-      tpc = options::pos_constr_colon();
+      cc.tpc = options::pos_constr_colon();
       log_rule_B("pos_constr_colon");
-      anc = options::nl_constr_colon();
+      cc.anc = options::nl_constr_colon();
       log_rule_B("nl_constr_colon");
-      ncia = options::nl_constr_init_args();
+      cc.ncia = options::nl_constr_init_args();
       log_rule_B("nl_constr_init_args");
-      pcc = options::pos_constr_comma();
+      cc.pcc = options::pos_constr_comma();
       log_rule_B("pos_constr_comma");
    }
-   chunk_t *ccolon  = nullptr;
-   size_t  acv_span = options::align_constr_value_span();
+   cc.ccolon = nullptr;
+   size_t acv_span = options::align_constr_value_span();
 
    log_rule_B("align_constr_value_span");
-   bool       with_acv = (acv_span > 0) && language_is_set(LANG_CPP);
-   AlignStack constructorValue;    // ABC_Member(abc_value)
+   cc.with_acv = (acv_span > 0) && language_is_set(LANG_CPP);
 
-   if (with_acv)
+   if (cc.with_acv)
    {
       int    acv_thresh = options::align_constr_value_thresh();
       log_rule_B("align_constr_value_thresh");
       size_t acv_gap = options::align_constr_value_gap();
       log_rule_B("align_constr_value_gap");
-      constructorValue.Start(acv_span, acv_thresh);
-      constructorValue.m_gap         = acv_gap;
-      constructorValue.m_right_align = !options::align_on_tabstop();
+      cc.constructorValue.Start(acv_span, acv_thresh);
+      cc.constructorValue.m_gap         = acv_gap;
+      cc.constructorValue.m_right_align = !options::align_on_tabstop();
       log_rule_B("align_on_tabstop");
    }
 
-   for (chunk_t *pc = chunk_get_head(); pc != nullptr; pc = chunk_get_next_ncnl(pc))
+   for (chunk_t *pc : chunks)
    {
-      if (!ccolon && pc->type != tok)
-      {
-         continue;
-      }
-      chunk_t *prev;
-      chunk_t *next;
-
-      if (pc->type == tok)
-      {
-         LOG_FMT(LBLANKD, "%s(%d): orig_line is %zu, orig_col is %zu, text() '%s', type is %s\n",
-                 __func__, __LINE__, pc->orig_line, pc->orig_col, pc->text(), get_token_name(pc->type));
-         ccolon = pc;
-         prev   = chunk_get_prev_nc(pc);
-         next   = chunk_get_next_nc(pc);
+      newline_class_colon_pos(cc, pc);
+   }
+} // newlines_class_colon_pos
 
-         if (chunk_is_token(pc, CT_CONSTR_COLON))
-         {
-            LOG_FMT(LBLANKD, "%s(%d): pc->orig_line is %zu, orig_col is %zu, text() '%s', type is %s\n",
-                    __func__, __LINE__, pc->orig_line, pc->orig_col, pc->text(), get_token_name(pc->type));
-            chunk_t *paren_vor_value = chunk_get_next_type(pc, CT_FPAREN_OPEN, pc->level);
 
-            if (with_acv && paren_vor_value != nullptr)
-            {
-               LOG_FMT(LBLANKD, "%s(%d): paren_vor_value->orig_line is %zu, orig_col is %zu, text() '%s', type is %s\n",
-                       __func__, __LINE__, paren_vor_value->orig_line, paren_vor_value->orig_col,
-                       paren_vor_value->text(), get_token_name(paren_vor_value->type));
-               constructorValue.NewLines(paren_vor_value->nl_count);
-               constructorValue.Add(paren_vor_value);
-            }
-         }
+void newlines_chunk_pos(const vector<chunk_pos_t> &positions)
+{
+   LOG_FUNC_ENTRY();
 
-         if (  !chunk_is_newline(prev)
-            && !chunk_is_newline(next)
-            && (anc & IARF_ADD))
-         {
-            newline_add_after(pc);
-            prev = chunk_get_prev_nc(pc);
-            next = chunk_get_next_nc(pc);
-         }
+   /*
+    * Each token type is still handled over the whole file before the next
+    * one, as the handlers see what the ones before them changed nearby.
+    * The single walk only finds the chunks each of them needs, the handlers
+    * change nothing but newlines and never reorder the other chunks.
+    */
+   vector<chunk_pos_t>        moved;
+   vector<vector<chunk_t *> > chunks_of;
+   size_t                     slot_of[CT_TOKEN_COUNT_];
 
-         if (anc == IARF_REMOVE)
-         {
-            if (chunk_is_newline(prev) && chunk_safe_to_del_nl(prev))
-            {
-               chunk_del(prev);
-               MARK_CHANGE();
-               prev = chunk_get_prev_nc(pc);
-            }
+   std::fill(std::begin(slot_of), std::end(slot_of), positions.size());
 
-            if (chunk_is_newline(next) && chunk_safe_to_del_nl(next))
-            {
-               chunk_del(next);
-               MARK_CHANGE();
-               next = chunk_get_next_nc(pc);
-            }
-         }
+   for (const chunk_pos_t &pos : positions)
+   {
+      LOG_FMT(LNEWLINE, "%s(%d): type is %s, mode is %s\n",
+              __func__, __LINE__, get_token_name(pos.type), to_string(pos.mode));
 
-         if (tpc & TP_TRAIL)
-         {
-            if (  chunk_is_newline(prev)
-               && prev->nl_count == 1
-               && chunk_safe_to_del_nl(prev))
-            {
-               chunk_swap(pc, prev);
-            }
-         }
-         else if (tpc & TP_LEAD)
-         {
-            if (  chunk_is_newline(next)
-               && next->nl_count == 1
-               && chunk_safe_to_del_nl(next))
-            {
-               chunk_swap(pc, next);
-            }
-         }
-      }
-      else
+      if (  (pos.mode & (TP_JOIN | TP_LEAD | TP_TRAIL))
+         || pos.type == CT_COMMA)
       {
-         if (chunk_is_token(pc, CT_BRACE_OPEN) || chunk_is_token(pc, CT_SEMICOLON))
-         {
-            ccolon = nullptr;
-
-            if (with_acv)
-            {
-               constructorValue.End();
-            }
-            continue;
-         }
-
-         if (chunk_is_token(pc, CT_COMMA) && pc->level == ccolon->level)
-         {
-            LOG_FMT(LBLANKD, "%s(%d): orig_line is %zu, orig_col is %zu, text() '%s', type is %s\n",
-                    __func__, __LINE__, pc->orig_line, pc->orig_col, pc->text(), get_token_name(pc->type));
-            chunk_t *paren_vor_value = chunk_get_next_type(pc, CT_FPAREN_OPEN, pc->level);
+         slot_of[pos.type] = moved.size();
+         moved.push_back(pos);
+      }
+   }
 
-            if (with_acv && paren_vor_value != nullptr)
-            {
-               LOG_FMT(LBLANKD, "%s(%d): paren_vor_value->orig_line is %zu, orig_col is %zu, text() '%s', type is %s\n",
-                       __func__, __LINE__, paren_vor_value->orig_line, paren_vor_value->orig_col,
-                       paren_vor_value->text(), get_token_name(paren_vor_value->type));
-               constructorValue.NewLines(paren_vor_value->nl_count);
-               constructorValue.Add(paren_vor_value);
-            }
+   chunks_of.resize(moved.size());
 
-            if (ncia & IARF_ADD)
-            {
-               if (pcc & TP_TRAIL)
-               {
-                  if (ncia == IARF_FORCE)
-                  {
-                     newline_force_after(pc);
-                  }
-                  else
-                  {
-                     newline_add_after(pc);
-                  }
-                  prev = chunk_get_prev_nc(pc);
+   // the chunks that newlines_class_colon_pos() acts on
+   vector<chunk_t *> colon_chunks;
 
-                  if (chunk_is_newline(prev) && chunk_safe_to_del_nl(prev))
-                  {
-                     chunk_del(prev);
-                     MARK_CHANGE();
-                  }
-               }
-               else if (pcc & TP_LEAD)
-               {
-                  if (ncia == IARF_FORCE)
-                  {
-                     newline_force_before(pc);
-                  }
-                  else
-                  {
-                     newline_add_before(pc);
-                  }
-                  next = chunk_get_next_nc(pc);
+   for (chunk_t *pc = chunk_get_head(); pc != nullptr; pc = chunk_get_next_ncnl(pc))
+   {
+      if (slot_of[pc->type] < moved.size())
+      {
+         chunks_of[slot_of[pc->type]].push_back(pc);
+      }
 
-                  if (chunk_is_newline(next) && chunk_safe_to_del_nl(next))
-                  {
-                     chunk_del(next);
-                     MARK_CHANGE();
-                  }
-               }
-            }
-            else if (ncia == IARF_REMOVE)
-            {
-               next = chunk_get_next(pc);
+      if (  chunk_is_token(pc, CT_CLASS_COLON)
+         || chunk_is_token(pc, CT_CONSTR_COLON)
+         || chunk_is_token(pc, CT_BRACE_OPEN)
+         || chunk_is_token(pc, CT_SEMICOLON)
+         || chunk_is_token(pc, CT_COMMA))
+      {
+         colon_chunks.push_back(pc);
+      }
+   }
 
-               if (chunk_is_newline(next) && chunk_safe_to_del_nl(next))
-               {
-                  chunk_del(next);
-                  MARK_CHANGE();
-               }
-            }
-         }
+   for (size_t idx = 0; idx < moved.size(); idx++)
+   {
+      for (chunk_t *pc : chunks_of[idx])
+      {
+         newline_chunk_pos(pc, moved[idx].type, moved[idx].mode);
       }
    }
-} // newlines_class_colon_pos
+
+   newlines_class_colon_pos(CT_CLASS_COLON, colon_chunks);
+   newlines_class_colon_pos(CT_CONSTR_COLON, colon_chunks);
+} // newlines_chunk_pos
 
 
 static void blank_line_max(chunk_t *pc, Option<unsigned> &opt)
@@ -5578,7 +5638,7 @@ static void blank_line_max(chunk_t *pc, Option<unsigned> &opt)
    {
       LOG_FMT(LBLANKD, "%s(%d): do_blank_lines: %s max line %zu\n",
               __func__, __LINE__, opt.name(), pc->orig_line);
-      pc->nl_count = optval;
+      set_chunk_nl_count(pc, optval);
       MARK_CHANGE();
    }
 }
@@ -5690,7 +5750,7 @@ void do_blank_lines(void)
 
          if (pc->nl_count != 1)
          {
-            pc->nl_count = 1;
+            set_chunk_nl_count(pc, 1);
             MARK_CHANGE();
          }
          continue;
@@ -5867,7 +5927,7 @@ void do_blank_lines(void)
          if (options::nl_after_func_proto() > pc->nl_count)
          {
             log_rule_B("nl_after_func_proto");
-            pc->nl_count = options::nl_after_func_proto();
+            set_chunk_nl_count(pc, options::nl_after_func_proto());
             MARK_CHANGE();
          }
 
@@ -5889,7 +5949,7 @@ void do_blank_lines(void)
          if (options::nl_after_func_class_proto() > pc->nl_count)
          {
             log_rule_B("nl_after_func_class_proto");
-            pc->nl_count = options::nl_after_func_class_proto();
+            set_chunk_nl_count(pc, options::nl_after_func_class_proto());
             MARK_CHANGE();
          }
 
@@ -6146,7 +6206,7 @@ void newlines_cleanup_dup(void)
 
       if (chunk_is_token(pc, CT_NEWLINE) && chunk_is_token(next, CT_NEWLINE))
       {
-         next->nl_count = max(pc->nl_count, next->nl_count);
+         set_chunk_nl_count(next, max(pc->nl_count, next->nl_count));
          chunk_del(pc);
          MARK_CHANGE();
       }
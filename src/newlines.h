@@ -12,6 +12,8 @@
 #include "chunk_list.h"
 #include "uncrustify_types.h"
 
+#include <vector>
+
 /**
  * Double the newline, if allowed.
  */
@@ -32,7 +34,12 @@ void newlines_sparens();
 void newlines_cleanup_braces(bool first);
 
 
-void newlines_cleanup_angles();
+/**
+ * Adds the newlines of nl_template_start, nl_template_args and
+ * nl_template_end if pc opens a template.
+ * A visitor pass, called for each chunk in turn.
+ */
+void newlines_cleanup_angles(chunk_t *pc);
 
 
 //! Handle insertion/removal of blank lines before if/for/while/do and functions
@@ -75,20 +82,23 @@ void newlines_squeeze_paren_close(void);
 void newlines_eat_start_end(void);
 
 
+//! A type of token that newlines_chunk_pos() moves, and where to
+struct chunk_pos_t
+{
+   c_token_t               type;
+   uncrustify::token_pos_e mode;
+};
+
+
 /**
- * Searches for a chunk of type chunk_type and moves them, if needed.
+ * Moves the chunks of the given types, if needed, and moves the class and
+ * constructor colons and breaks up the args after them, all in a single walk
+ * of the chunk list.
  * Will not move tokens that are on their own line or have other than
  * exactly 1 newline before (UO_pos_comma == TRAIL) or after (UO_pos_comma == LEAD).
  * We can't remove a newline if it is right before a preprocessor.
  */
-void newlines_chunk_pos(c_token_t chunk_type, uncrustify::token_pos_e mode);
-
-
-/**
- * Searches for CT_CLASS_COLON and moves them, if needed.
- * Also breaks up the args
- */
-void newlines_class_colon_pos(c_token_t tok);
+void newlines_chunk_pos(const std::vector<chunk_pos_t> &positions);
 
 
 void newlines_cleanup_dup(void);
@@ -97,11 +107,12 @@ void newlines_cleanup_dup(void);
 void annotations_newlines(void);
 
 
-void newline_after_multiline_comment(void);
+//! Ends the line after pc if it is a multi-line comment followed by code, a visitor pass
+void newline_after_multiline_comment(chunk_t *pc);
 
 
-//! Handle insertion of blank lines after label colons
-void newline_after_label_colon(void);
+//! Handle insertion of blank lines after label colons, a visitor pass
+void newline_after_label_colon(chunk_t *pc);
 
 
 /**
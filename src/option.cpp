@@ -387,6 +387,10 @@ void OptionWarning::operator()(const char *fmt, ...)
 }
 
 
+//-----------------------------------------------------------------------------
+size_t GenericOption::s_generation = 0;
+
+
 //-----------------------------------------------------------------------------
 void GenericOption::warnUnexpectedValue(const char *actual) const
 {
@@ -431,6 +435,7 @@ template<typename T>
 bool read_enum(const char *in, Option<T> &out)
 {
    assert(in);
+   ++GenericOption::s_generation;
 
    if (convert_string(in, out.m_val))
    {
@@ -458,6 +463,7 @@ template<typename T>
 bool read_number(const char *in, Option<T> &out)
 {
    assert(in);
+   ++GenericOption::s_generation;
 
    char       *c;
    const auto val = std::strtol(in, &c, 10);
@@ -518,6 +524,7 @@ template<typename T>
 void Option<T>::reset()
 {
    m_val = m_default;
+   ++s_generation;
 }
 
 
@@ -575,6 +582,7 @@ template<>
 bool Option<bool>::read(const char *in)
 {
    assert(in);
+   ++s_generation;
 
    if (convert_string(in, m_val))
    {
@@ -787,6 +795,7 @@ template<>
 bool Option<std::string>::read(const char *in)
 {
    m_val = in;
+   ++s_generation;
    return(true);
 }
 
@@ -130,6 +130,9 @@ public:
    virtual bool read(const char *s) = 0;
    virtual std::string str() const = 0;
 
+   //! counts the changes of option values, for what is derived from them
+   static size_t generation() { return(s_generation); }
+
 protected:
    template<typename V> friend bool read_enum(const char *s, Option<V> &o);
    template<typename V> friend bool read_number(const char *s, Option<V> &o);
@@ -139,6 +142,8 @@ protected:
 
    const char *const m_name;
    const char *const m_desc;
+
+   static size_t     s_generation;
 };
 
 //-----------------------------------------------------------------------------
@@ -193,7 +198,7 @@ public:
    std::string str() const override;
 
    T operator()() const { return(m_val); }
-   Option &operator=(T val) { m_val = val; return(*this); }
+   Option &operator=(T val) { m_val = val; ++s_generation; return(*this); }
 
 protected:
    template<typename V> friend bool read_enum(const char *s, Option<V> &o);
@@ -24,11 +24,21 @@
 #include "unicode.h"
 
 #include <cstdlib>
+#include <vector>
 
 
 using namespace uncrustify;
 
 
+//! The token stream is written in blocks of about this many bytes
+static constexpr size_t TOKEN_BLOCK_SIZE = 64 * 1024;
+
+//! Sizes in the token stream, see documentation/token_stream.txt
+static constexpr UINT32 TOKEN_VERSION     = 1;
+static constexpr UINT32 TOKEN_HEADER_SIZE = 64;
+static constexpr UINT32 TOKEN_RECORD_SIZE = 56;
+
+
 struct cmt_reflow
 {
    chunk_t  *pc;
@@ -116,6 +126,15 @@ static void add_text(const char *ascii_text);
 static void add_text(const unc_text &text, bool is_ignored, bool is_literal);
 
 
+/**
+ * Copies the input region of an ignored chunk to the output unchanged,
+ * apart from converting the line endings. As when such regions were
+ * tokenized line by line, the blanks of lines that hold nothing else are
+ * dropped.
+ */
+static void add_span(const text_span_t &span);
+
+
 /**
  * Count the number of characters to the end of the next chunk of text.
  * If it exceeds the limit, return true.
@@ -337,19 +356,55 @@ static void add_text(const char *ascii_text)
 
 static void add_text(const unc_text &text, bool is_ignored = false, bool is_literal = false)
 {
+   if (is_ignored)
+   {
+      write_string(text);
+      return;
+   }
+
    for (size_t idx = 0; idx < text.size(); idx++)
    {
-      int ch = text[idx];
+      add_char(text[idx], is_literal);
+   }
+}
+
+
+static void add_span(const text_span_t &span)
+{
+   const std::deque<int> &data = *span.data;
+   const size_t          end   = span.idx + span.len;
+   size_t                start = span.idx;
+
+   for (size_t idx = span.idx; idx < end; idx++)
+   {
+      int ch = data[idx];
 
-      if (is_ignored)
+      if ((ch == '\r') || (ch == '\n'))
       {
-         write_char(ch);
-      }
-      else
-      {
-         add_char(ch, is_literal);
+         size_t blank = start;
+
+         while (  blank < idx
+               && (data[blank] == ' ' || data[blank] == '\t'))
+         {
+            blank++;
+         }
+
+         if (blank < idx)
+         {
+            write_chars(data, start, idx - start);
+         }
+
+         // convert a line ending into the LF/CRLF/CR sequence
+         if (ch == '\r' && idx + 1 < end && data[idx + 1] == '\n')
+         {
+            idx++;
+         }
+         write_string(cpd.newline);
+         start = idx + 1;
       }
    }
+
+   write_chars(data, start, end - start);
 }
 
 
@@ -437,6 +492,28 @@ static void cmt_output_indent(size_t brace_col, size_t base_col, size_t column)
 } // cmt_output_indent
 
 
+//! Adds the UTF-8 text of a chunk, or of its span of the input if it has one
+static void encode_chunk_text(const chunk_t *pc, std::vector<UINT8> &text)
+{
+   if (pc->span.data != nullptr)
+   {
+      const std::deque<int> &data = *pc->span.data;
+
+      for (size_t idx = pc->span.idx; idx < pc->span.idx + pc->span.len; idx++)
+      {
+         encode_utf8(data[idx], text);
+      }
+
+      return;
+   }
+
+   for (int ch : pc->str.get())
+   {
+      encode_utf8(ch, text);
+   }
+}
+
+
 void output_parsed(FILE *pfile)
 {
    const char *eol_marker = get_eol_marker();
@@ -478,14 +555,22 @@ void output_parsed(FILE *pfile)
               pc->nl_count, pc->after_tab);
 #endif // ifdef WIN32
 
-      if (pc->type != CT_NEWLINE && (pc->len() != 0))
+      if (  pc->type != CT_NEWLINE
+         && (pc->len() != 0 || pc->span.data != nullptr))
       {
          for (size_t cnt = 0; cnt < pc->column; cnt++)
          {
             fprintf(pfile, " ");
          }
 
-         if (pc->type != CT_NL_CONT)
+         if (pc->span.data != nullptr)
+         {
+            std::vector<UINT8> text;
+
+            encode_chunk_text(pc, text);
+            fwrite(text.data(), 1, text.size(), pfile);
+         }
+         else if (pc->type != CT_NL_CONT)
          {
             fprintf(pfile, "%s", pc->text());
          }
@@ -501,6 +586,119 @@ void output_parsed(FILE *pfile)
 } // output_parsed
 
 
+//! Collects the token stream to write it in blocks
+struct token_stream
+{
+   token_stream(FILE *pfile)
+      : file(pfile)
+   {
+      buf.reserve(TOKEN_BLOCK_SIZE);
+   }
+
+
+   template<typename T>
+   void put(T value)
+   {
+      put(reinterpret_cast<const char *>(&value), sizeof(value));
+   }
+
+
+   void put(const char *text, size_t len)
+   {
+      buf.insert(buf.end(), text, text + len);
+
+      if (buf.size() >= TOKEN_BLOCK_SIZE)
+      {
+         flush();
+      }
+   }
+
+
+   //! writes a large block directly, after what is buffered
+   void write(const UINT8 *data, size_t len)
+   {
+      flush();
+      fwrite(data, 1, len, file);
+   }
+
+
+   void flush()
+   {
+      fwrite(buf.data(), 1, buf.size(), file);
+      buf.clear();
+   }
+
+
+   FILE               *file;
+   std::vector<UINT8> buf;
+};
+
+
+void output_tokens(FILE *pfile, unc_stage_e stage)
+{
+   // the text is encoded first, the header has to locate the tables after the records
+   std::vector<UINT8>  text;
+   std::vector<UINT64> text_end;
+
+   for (chunk_t *pc = chunk_get_head(); pc != nullptr; pc = chunk_get_next(pc))
+   {
+      encode_chunk_text(pc, text);
+      text.push_back(0);
+      text_end.push_back(text.size());
+   }
+
+   const UINT64 count        = text_end.size();
+   const UINT64 text_offset  = TOKEN_HEADER_SIZE + count * TOKEN_RECORD_SIZE;
+   const UINT64 names_offset = text_offset + text.size();
+   token_stream out(pfile);
+
+   out.put("UNCTOKEN", 8);
+   out.put(TOKEN_VERSION);
+   out.put(TOKEN_HEADER_SIZE);
+   out.put(TOKEN_RECORD_SIZE);
+   out.put(static_cast<UINT32>(stage));
+   out.put(count);
+   out.put(text_offset);
+   out.put(static_cast<UINT64>(text.size()));
+   out.put(names_offset);
+   out.put(static_cast<UINT32>(CT_TOKEN_COUNT_));
+   out.put(static_cast<UINT32>(0x01020304));   // tells the byte order
+
+   UINT64 text_pos = 0;
+   size_t idx      = 0;
+
+   for (chunk_t *pc = chunk_get_head(); pc != nullptr; pc = chunk_get_next(pc))
+   {
+      out.put(static_cast<UINT64>(static_cast<pcf_flags_t::int_t>(pc->flags)));
+      out.put(static_cast<UINT16>(pc->type));
+      out.put(static_cast<UINT16>(get_chunk_parent_type(pc)));
+      out.put(static_cast<UINT32>(pc->level));
+      out.put(static_cast<UINT32>(pc->brace_level));
+      out.put(static_cast<UINT32>(pc->pp_level));
+      out.put(static_cast<UINT32>(pc->orig_line));
+      out.put(static_cast<UINT32>(pc->orig_col));
+      out.put(static_cast<UINT32>(pc->orig_col_end));
+      out.put(static_cast<UINT32>(pc->column));
+      out.put(static_cast<UINT32>(pc->nl_count));
+      out.put(static_cast<UINT32>(text_end[idx] - text_pos - 1));
+      out.put(text_pos);
+      text_pos = text_end[idx++];
+   }
+
+   out.write(text.data(), text.size());
+
+   for (int tt = 0; tt < CT_TOKEN_COUNT_; tt++)
+   {
+      const char *name = get_token_name(static_cast<c_token_t>(tt));
+
+      out.put(name, strlen(name) + 1);
+   }
+
+   out.flush();
+   fflush(pfile);
+} // output_tokens
+
+
 void output_text(FILE *pfile)
 {
    cpd.fout        = pfile;
@@ -664,8 +862,16 @@ void output_text(FILE *pfile)
       {
          LOG_FMT(LOUTIND, "%s(%d): orig_line is %zu, orig_col is %zu,\npc->text() >%s<, pc->str.size() is %zu\n",
                  __func__, __LINE__, pc->orig_line, pc->orig_col, pc->text(), pc->str.size());
+
          // do not adjust the column for junk
-         add_text(pc->str, true);
+         if (pc->span.data != nullptr)
+         {
+            add_span(pc->span);
+         }
+         else
+         {
+            add_text(pc->str, true);
+         }
       }
       else if (pc->len() == 0)
       {
@@ -10,6 +10,7 @@
 #define OUTPUT_H_INCLUDED
 
 #include "unc_text.h"
+#include "uncrustify_types.h"
 
 #include <stdio.h>
 
@@ -18,6 +19,16 @@
 void output_parsed(FILE *pfile);
 
 
+/**
+ * Writes the chunk list as a binary token stream for other tools, see
+ * documentation/token_stream.txt for the format.
+ *
+ * @param pfile  The file to write to, opened in binary mode
+ * @param stage  The stage the chunk list is in, recorded in the header
+ */
+void output_tokens(FILE *pfile, unc_stage_e stage);
+
+
 //! This renders the chunk list to a file.
 void output_text(FILE *pfile);
 
@@ -0,0 +1,218 @@
+/**
+ * @file pipeline.cpp
+ * Runs lists of passes over the chunk list.
+ *
+ * @license GPL v2+
+ */
+
+#include "pipeline.h"
+
+#include "log_rules.h"
+#include "profile.h"
+
+#include <vector>
+
+
+using namespace std;
+
+
+//! the function that runs the passes, the options are logged as its rules
+static const char *rules_func = "run_passes";
+
+
+bool options_changed(const GenericOption *const *options)
+{
+   for (const GenericOption *const *opt = options; *opt != nullptr; opt++)
+   {
+      if (!(*opt)->isDefault())
+      {
+         return(true);
+      }
+   }
+
+   return(false);
+}
+
+
+void log_pass_rules(const GenericOption *const *options)
+{
+   if (!log_sev_on(LSPACE))
+   {
+      return;
+   }
+
+   for (const GenericOption *const *opt = options; *opt != nullptr; opt++)
+   {
+      log_rule3(rules_func, __LINE__, (*opt)->name());
+   }
+}
+
+
+bool pass_is_active(const pass_t &pass)
+{
+   if (  pass.options != nullptr
+      && !options_changed(pass.options))
+   {
+      return(false);
+   }
+   return(  pass.enabled == nullptr
+         || pass.enabled());
+}
+
+
+static const size_t NO_STAMP = static_cast<size_t>(-1);
+
+
+size_t chunk_change_stamp(void)
+{
+   const chunk_counts_t counts = chunk_get_counts();
+
+   return(static_cast<size_t>(cpd.changes) + counts.inserts + counts.deletes + counts.moves
+          + counts.edits);
+}
+
+
+//! Checks if a pass changed nothing when it last ran, and nothing changed since
+static bool is_quiet(const pass_history_t *history, size_t idx)
+{
+   return(  history != nullptr
+         && history->quiet_at[idx] == chunk_change_stamp());
+}
+
+
+//! Notes if a pass that started at change stamp 'before' changed something
+static void remember(pass_history_t *history, size_t idx, size_t before)
+{
+   if (history != nullptr)
+   {
+      const size_t after = chunk_change_stamp();
+
+      history->quiet_at[idx] = (after == before) ? after : NO_STAMP;
+   }
+}
+
+
+//! Walks the list once, calling the visitors in order for each chunk
+static void walk_chunks(const pass_list_t &list, const vector<size_t> &visitors,
+                        pass_history_t *history)
+{
+   if (visitors.empty())
+   {
+      return;
+   }
+
+   if (profile_enabled())
+   {
+      string name = list.passes[visitors[0]].name;
+
+      for (size_t idx = 1; idx < visitors.size(); idx++)
+      {
+         name += " + ";
+         name += list.passes[visitors[idx]].name;
+      }
+
+      profile_stage(name.c_str());
+   }
+   const size_t before = chunk_change_stamp();
+
+   for (chunk_t *pc = chunk_get_head(); pc != nullptr; pc = chunk_get_next(pc))
+   {
+      for (size_t idx : visitors)
+      {
+         list.passes[idx].visit(pc);
+      }
+   }
+
+   // If the walk changed nothing, none of the visitors did
+   for (size_t idx : visitors)
+   {
+      remember(history, idx, before);
+   }
+}
+
+
+void run_passes(const pass_list_t &list, const char *func, pass_history_t *history)
+{
+   vector<size_t> visitors;
+
+   rules_func = func;
+
+   if (history != nullptr)
+   {
+      history->quiet_at.resize(list.count, NO_STAMP);
+   }
+
+   for (size_t idx = 0; idx < list.count; idx++)
+   {
+      const pass_t &pass = list.passes[idx];
+
+      if (pass.options != nullptr)
+      {
+         log_pass_rules(pass.options);
+      }
+
+      if (  !pass_is_active(pass)
+         || is_quiet(history, idx))
+      {
+         continue;
+      }
+
+      if (pass.visit != nullptr)
+      {
+         visitors.push_back(idx);
+         continue;
+      }
+      walk_chunks(list, visitors, history);
+      visitors.clear();
+
+      profile_stage(pass.name);
+      const size_t before = chunk_change_stamp();
+
+      pass.run();
+      remember(history, idx, before);
+   }
+
+   walk_chunks(list, visitors, history);
+   profile_stage(nullptr);
+} // run_passes
+
+
+void forget_pass(pass_history_t &history, const pass_list_t &list, pass_run_t run)
+{
+   for (size_t idx = 0; idx < list.count && idx < history.quiet_at.size(); idx++)
+   {
+      if (list.passes[idx].run == run)
+      {
+         history.quiet_at[idx] = NO_STAMP;
+      }
+   }
+}
+
+
+void show_passes(FILE *pfile, const pass_list_t &list)
+{
+   bool walking = false;
+
+   fprintf(pfile, "%s:\n", list.name);
+
+   for (size_t idx = 0; idx < list.count; idx++)
+   {
+      const pass_t &pass   = list.passes[idx];
+      const char   *action = "skip";
+
+      if (pass_is_active(pass))
+      {
+         if (pass.visit == nullptr)
+         {
+            action  = "run";
+            walking = false;
+         }
+         else
+         {
+            action  = walking ? "+" : "walk";
+            walking = true;
+         }
+      }
+      fprintf(pfile, "   %-5s %s\n", action, pass.name);
+   }
+}
@@ -0,0 +1,128 @@
+/**
+ * @file pipeline.h
+ * Runs lists of passes over the chunk list. Passes whose options are all at
+ * their default are skipped, and visitor passes that follow each other share
+ * a single walk over the list.
+ *
+ * @license GPL v2+
+ */
+
+#ifndef PIPELINE_H_INCLUDED
+#define PIPELINE_H_INCLUDED
+
+#include "chunk_list.h"
+#include "option.h"
+
+#include <cstdio>
+#include <vector>
+
+
+//! does a pass over the whole chunk list
+typedef void (*pass_run_t)(void);
+
+//! does a pass for one chunk
+typedef void (*pass_visit_t)(chunk_t *pc);
+
+//! checks an extra condition of a pass
+typedef bool (*pass_check_t)(void);
+
+
+/**
+ * A pass over the chunk list, either a function that does the whole list
+ * (run) or one that is called for each chunk in turn (visit).
+ */
+struct pass_t
+{
+   //! shown by --show-pipeline
+   const char *name;
+
+   //! does the pass, or nullptr for a visitor
+   pass_run_t run;
+
+   /**
+    * does the pass for one chunk, or nullptr.
+    * Visitors may add chunks, but must not delete the chunk they are given.
+    */
+   pass_visit_t visit;
+
+   /**
+    * the options the pass depends on, terminated by nullptr.
+    * The pass is skipped if all of them are at their default value.
+    * They are logged as the rules of the function that runs the list.
+    * nullptr if the pass always runs.
+    */
+   const uncrustify::GenericOption *const *options;
+
+   //! the pass is skipped if this returns false, or nullptr; checked after the options
+   pass_check_t                           enabled;
+};
+
+
+struct pass_list_t
+{
+   const char   *name;         //! shown by --show-pipeline
+   const pass_t *passes;
+   size_t       count;
+};
+
+
+/**
+ * Remembers the passes of a list that changed nothing when they last ran.
+ * A fixed-point loop can skip such a pass while nothing else changes the
+ * list either, it would find nothing to do.
+ *
+ * Only the changes chunk_change_stamp() counts are seen, so the passes of
+ * such a list may only change the chunks in the list with mark_change(),
+ * the chunk_list functions and the set_chunk_* setters. The other fields,
+ * like the text, the levels and the original position, are left alone by
+ * the newline passes, except in the chunks they add.
+ */
+struct pass_history_t
+{
+   //! per pass, the change stamp after a run that changed nothing, or NO_STAMP
+   std::vector<size_t> quiet_at;
+};
+
+
+/**
+ * Counts the changes made to the chunk list: those marked with
+ * mark_change() plus the chunks that were added, deleted, moved or
+ * changed, see chunk_counts_t.
+ */
+size_t chunk_change_stamp(void);
+
+
+//! Checks if any of a list of options, terminated by nullptr, is not at its default
+bool options_changed(const uncrustify::GenericOption *const *options);
+
+
+/**
+ * Logs a list of options, terminated by nullptr, as the rules of the
+ * function that runs the passes, see log_rule_B()
+ */
+void log_pass_rules(const uncrustify::GenericOption *const *options);
+
+
+//! Checks if a pass will run for the loaded config
+bool pass_is_active(const pass_t &pass);
+
+
+/**
+ * Runs the active passes of a list in order.
+ *
+ * @param func     the function that runs the list, the options of the
+ *                 passes are logged as its rules
+ * @param history  nullptr, or where a loop keeps which passes it may skip
+ */
+void run_passes(const pass_list_t &list, const char *func, pass_history_t *history = nullptr);
+
+
+//! Lets a pass run again, for a pass that does something else from now on
+void forget_pass(pass_history_t &history, const pass_list_t &list, pass_run_t run);
+
+
+//! Prints which passes of a list run, and which of them share a walk
+void show_passes(FILE *pfile, const pass_list_t &list);
+
+
+#endif /* PIPELINE_H_INCLUDED */
@@ -0,0 +1,358 @@
+/**
+ * @file profile.cpp
+ * Measures the stages and passes of each file for --profile.
+ *
+ * @license GPL v2+
+ */
+
+#include "profile.h"
+
+#include "chunk_list.h"
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+
+using namespace std;
+
+
+struct profile_stage_t
+{
+   string name;
+   size_t calls;
+   double seconds;
+   size_t visits;  //! calls of chunk_get_next() and chunk_get_prev()
+   size_t inserts; //! chunks added to the list
+   size_t deletes; //! chunks deleted from the list
+};
+
+
+struct profile_loop_t
+{
+   string name;
+   size_t rounds;
+};
+
+
+struct profile_cache_t
+{
+   string name;
+   size_t lookups;
+   size_t hits;
+};
+
+
+struct profile_file_t
+{
+   string                  filename;
+   vector<profile_stage_t> stages; //! in the order they first ran
+   vector<profile_loop_t>  loops;
+   vector<profile_cache_t> caches;
+};
+
+
+static bool is_enabled = false;
+static bool as_json    = false;
+
+//! the measurements of the file being processed
+static profile_file_t current;
+
+//! the measurements of the files that are done
+static vector<profile_file_t> files;
+
+//! the index of the stage being measured in current.stages, or NO_STAGE
+static const size_t NO_STAGE = static_cast<size_t>(-1);
+static size_t       running  = NO_STAGE;
+
+//! the time and chunk counts when the running stage started
+static chrono::steady_clock::time_point started;
+static chunk_counts_t                   started_counts;
+
+
+static profile_stage_t &find_stage(vector<profile_stage_t> &stages, const string &name)
+{
+   for (profile_stage_t &stage : stages)
+   {
+      if (stage.name == name)
+      {
+         return(stage);
+      }
+   }
+
+   stages.push_back({ name, 0, 0.0, 0, 0, 0 });
+   return(stages.back());
+}
+
+
+static profile_loop_t &find_loop(vector<profile_loop_t> &loops, const string &name)
+{
+   for (profile_loop_t &loop : loops)
+   {
+      if (loop.name == name)
+      {
+         return(loop);
+      }
+   }
+
+   loops.push_back({ name, 0 });
+   return(loops.back());
+}
+
+
+static profile_cache_t &find_cache(vector<profile_cache_t> &caches, const char *name)
+{
+   for (profile_cache_t &cache : caches)
+   {
+      if (cache.name == name)
+      {
+         return(cache);
+      }
+   }
+
+   caches.push_back({ name, 0, 0 });
+   return(caches.back());
+}
+
+
+void profile_enable(bool json)
+{
+   is_enabled = true;
+   as_json    = json;
+}
+
+
+bool profile_enabled(void)
+{
+   return(is_enabled);
+}
+
+
+void profile_stage(const char *name)
+{
+   if (!is_enabled)
+   {
+      return;
+   }
+   const chrono::steady_clock::time_point now    = chrono::steady_clock::now();
+   const chunk_counts_t                   counts = chunk_get_counts();
+
+   if (running != NO_STAGE)
+   {
+      profile_stage_t &stage = current.stages[running];
+
+      stage.seconds += chrono::duration<double>(now - started).count();
+      stage.visits  += counts.visits - started_counts.visits;
+      stage.inserts += counts.inserts - started_counts.inserts;
+      stage.deletes += counts.deletes - started_counts.deletes;
+      running        = NO_STAGE;
+   }
+
+   if (name == nullptr)
+   {
+      return;
+   }
+   profile_stage_t &stage = find_stage(current.stages, name);
+
+   stage.calls++;
+   running        = static_cast<size_t>(&stage - &current.stages[0]);
+   started_counts = counts;
+   started        = chrono::steady_clock::now();
+}
+
+
+void profile_loop(const char *name)
+{
+   if (is_enabled)
+   {
+      find_loop(current.loops, name).rounds++;
+   }
+}
+
+
+void profile_cache(const char *name, bool hit)
+{
+   if (is_enabled)
+   {
+      profile_cache_t &cache = find_cache(current.caches, name);
+
+      cache.lookups++;
+      cache.hits += hit ? 1 : 0;
+   }
+}
+
+
+void profile_file_end(const char *filename)
+{
+   if (!is_enabled)
+   {
+      return;
+   }
+   profile_stage(nullptr);
+
+   current.filename = filename;
+   files.push_back(current);
+   current = profile_file_t();
+}
+
+
+//! Adds the measurements of a file to the totals
+static void add_file(profile_file_t &total, const profile_file_t &file)
+{
+   for (const profile_stage_t &stage : file.stages)
+   {
+      profile_stage_t &sum = find_stage(total.stages, stage.name);
+
+      sum.calls   += stage.calls;
+      sum.seconds += stage.seconds;
+      sum.visits  += stage.visits;
+      sum.inserts += stage.inserts;
+      sum.deletes += stage.deletes;
+   }
+
+   for (const profile_loop_t &loop : file.loops)
+   {
+      find_loop(total.loops, loop.name).rounds += loop.rounds;
+   }
+
+   for (const profile_cache_t &cache : file.caches)
+   {
+      profile_cache_t &sum = find_cache(total.caches, cache.name.c_str());
+
+      sum.lookups += cache.lookups;
+      sum.hits    += cache.hits;
+   }
+}
+
+
+static void print_text(FILE *pfile, const profile_file_t &file)
+{
+   fprintf(pfile, "Profile of %s:\n", file.filename.c_str());
+   fprintf(pfile, "   %-50s %6s %10s %10s %8s %8s\n",
+           "stage", "calls", "ms", "visits", "inserts", "deletes");
+
+   for (const profile_stage_t &stage : file.stages)
+   {
+      fprintf(pfile, "   %-50s %6zu %10.3f %10zu %8zu %8zu\n",
+              stage.name.c_str(), stage.calls, stage.seconds * 1000.0,
+              stage.visits, stage.inserts, stage.deletes);
+   }
+
+   for (const profile_loop_t &loop : file.loops)
+   {
+      fprintf(pfile, "   %s loop: %zu rounds\n", loop.name.c_str(), loop.rounds);
+   }
+
+   for (const profile_cache_t &cache : file.caches)
+   {
+      fprintf(pfile, "   %s cache: %zu lookups, %zu hits (%.1f%%)\n",
+              cache.name.c_str(), cache.lookups, cache.hits,
+              (cache.lookups > 0) ? 100.0 * cache.hits / cache.lookups : 0.0);
+   }
+}
+
+
+static void print_json_string(FILE *pfile, const string &text)
+{
+   fputc('"', pfile);
+
+   for (char ch : text)
+   {
+      if (ch == '"' || ch == '\\')
+      {
+         fprintf(pfile, "\\%c", ch);
+      }
+      else if (static_cast<unsigned char>(ch) < 0x20)
+      {
+         fprintf(pfile, "\\u%04x", ch);
+      }
+      else
+      {
+         fputc(ch, pfile);
+      }
+   }
+
+   fputc('"', pfile);
+}
+
+
+static void print_json(FILE *pfile, const profile_file_t &file, const char *indent)
+{
+   fprintf(pfile, "%s\"stages\": [", indent);
+
+   for (size_t idx = 0; idx < file.stages.size(); idx++)
+   {
+      const profile_stage_t &stage = file.stages[idx];
+
+      fprintf(pfile, "%s\n%s  { \"stage\": ", (idx > 0) ? "," : "", indent);
+      print_json_string(pfile, stage.name);
+      fprintf(pfile, ", \"calls\": %zu, \"ms\": %.3f, \"visits\": %zu, \"inserts\": %zu, \"deletes\": %zu }",
+              stage.calls, stage.seconds * 1000.0, stage.visits, stage.inserts, stage.deletes);
+   }
+
+   fprintf(pfile, "\n%s],\n%s\"loops\": {", indent, indent);
+
+   for (size_t idx = 0; idx < file.loops.size(); idx++)
+   {
+      fprintf(pfile, "%s ", (idx > 0) ? "," : "");
+      print_json_string(pfile, file.loops[idx].name);
+      fprintf(pfile, ": %zu", file.loops[idx].rounds);
+   }
+
+   fprintf(pfile, " },\n%s\"caches\": {", indent);
+
+   for (size_t idx = 0; idx < file.caches.size(); idx++)
+   {
+      const profile_cache_t &cache = file.caches[idx];
+
+      fprintf(pfile, "%s ", (idx > 0) ? "," : "");
+      print_json_string(pfile, cache.name);
+      fprintf(pfile, ": { \"lookups\": %zu, \"hits\": %zu }", cache.lookups, cache.hits);
+   }
+
+   fprintf(pfile, " }\n");
+}
+
+
+void profile_report(FILE *pfile)
+{
+   if (!is_enabled)
+   {
+      return;
+   }
+   profile_file_t total;
+
+   for (const profile_file_t &file : files)
+   {
+      add_file(total, file);
+   }
+
+   if (!as_json)
+   {
+      for (const profile_file_t &file : files)
+      {
+         print_text(pfile, file);
+      }
+
+      if (files.size() > 1)
+      {
+         total.filename = "all " + to_string(files.size()) + " files";
+         print_text(pfile, total);
+      }
+      return;
+   }
+   fprintf(pfile, "{\n  \"files\": [");
+
+   for (size_t idx = 0; idx < files.size(); idx++)
+   {
+      fprintf(pfile, "%s\n    {\n      \"file\": ", (idx > 0) ? "," : "");
+      print_json_string(pfile, files[idx].filename);
+      fprintf(pfile, ",\n");
+      print_json(pfile, files[idx], "      ");
+      fprintf(pfile, "    }");
+   }
+
+   fprintf(pfile, "\n  ],\n  \"total\": {\n    \"files\": %zu,\n", files.size());
+   print_json(pfile, total, "    ");
+   fprintf(pfile, "  }\n}\n");
+} // profile_report
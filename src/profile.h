@@ -0,0 +1,48 @@
+/**
+ * @file profile.h
+ * Measures the stages and passes of each file for --profile, and reports
+ * them per file and for the whole run.
+ *
+ * @license GPL v2+
+ */
+
+#ifndef PROFILE_H_INCLUDED
+#define PROFILE_H_INCLUDED
+
+#include <cstdio>
+
+
+//! Turns the profiler on, the report is JSON if json is set
+void profile_enable(bool json);
+
+
+//! Checks if --profile was given
+bool profile_enabled(void);
+
+
+/**
+ * Ends the stage that is measured, if any, and starts measuring the next one.
+ * Stages with the same name are added up.
+ *
+ * @param name  the name of the stage, or nullptr to only end the current one
+ */
+void profile_stage(const char *name);
+
+
+//! Counts one round of a fixed-point loop, such as the newline loop
+void profile_loop(const char *name);
+
+
+//! Counts a lookup in a cache, such as the one of the spacing rules
+void profile_cache(const char *name, bool hit);
+
+
+//! Ends the measurements of a file and keeps them for the report
+void profile_file_end(const char *filename);
+
+
+//! Prints the measurements of each file and their totals
+void profile_report(FILE *pfile);
+
+
+#endif /* PROFILE_H_INCLUDED */
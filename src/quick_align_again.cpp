@@ -12,41 +12,267 @@
 #include "align_stack.h"
 #include "chunk_list.h"
 
+#include <unordered_map>
+#include <vector>
 
-void quick_align_again(void)
+
+using namespace std;
+
+
+//! Where a chunk of a chain was when the chain was last lined up
+struct aligned_chunk_t
 {
-   LOG_FUNC_ENTRY();
+   chunk_t *pc;
+   size_t  column;
+   chunk_t *start;
+   chunk_t *ref;
+};
+
+
+//! A chain of aligned chunks, from the chunk with PCF_ALIGN_START on
+struct aligned_chain_t
+{
+   chunk_t                 *head;
+   vector<aligned_chunk_t> chunks;  //! empty until the chain was lined up here
+   vector<size_t>          columns; //! per chunk, the columns from its ref to its start, which AlignStack::Add() tightens
+   bool                    right_align;
+   size_t                  star_style;
+   size_t                  amp_style;
+   int                     gap;
+};
+
+
+//! The chains in the order of the chunk list
+static vector<aligned_chain_t> chains;
+
+//! false if Flush() started a chain that is not in 'chains' yet
+static bool chains_complete = false;
+
+//! inserts, deletes and moves of chunks when 'chains' was collected
+static size_t chains_stamp = 0;
+
+
+static size_t structure_stamp(void)
+{
+   const chunk_counts_t counts = chunk_get_counts();
+
+   return(counts.inserts + counts.deletes + counts.moves);
+}
+
+
+/**
+ * Walks the list for the chunks that start a chain. Keeps where the chains
+ * were lined up, unless chunks were added, deleted or moved since then, as
+ * a chain might then refer to chunks that are gone.
+ */
+static void collect_chains(void)
+{
+   unordered_map<chunk_t *, aligned_chain_t> known;
+   const size_t                              stamp = structure_stamp();
+
+   if (stamp == chains_stamp)
+   {
+      for (aligned_chain_t &chain : chains)
+      {
+         known.emplace(chain.head, std::move(chain));
+      }
+   }
+   chains.clear();
 
    for (chunk_t *pc = chunk_get_head(); pc != nullptr; pc = chunk_get_next(pc))
    {
       LOG_FMT(LALAGAIN, "%s(%d): orig_line is %zu, orig_col is %zu, column is %zu, text() '%s'\n",
               __func__, __LINE__, pc->orig_line, pc->orig_col, pc->column, pc->text());
 
-      if (  pc->align.next != nullptr
-         && pc->flags.test(PCF_ALIGN_START))
+      if (pc->flags.test(PCF_ALIGN_START))
       {
-         AlignStack as;
-         as.Start(100, 0);
-         as.m_right_align = pc->align.right_align;
-         as.m_star_style  = static_cast<AlignStack::StarStyle>(pc->align.star_style);
-         as.m_amp_style   = static_cast<AlignStack::StarStyle>(pc->align.amp_style);
-         as.m_gap         = pc->align.gap;
+         auto it = known.find(pc);
 
-         LOG_FMT(LALAGAIN, "%s(%d):   pc->text() is '%s', orig_line is %zu\n",
-                 __func__, __LINE__, pc->text(), pc->orig_line);
-         as.Add(pc->align.start);
-         chunk_flags_set(pc, PCF_WAS_ALIGNED);
-
-         for (chunk_t *tmp = pc->align.next; tmp != nullptr; tmp = tmp->align.next)
+         if (it != known.end())
+         {
+            chains.push_back(std::move(it->second));
+         }
+         else
          {
-            chunk_flags_set(tmp, PCF_WAS_ALIGNED);
-            as.Add(tmp->align.start);
-            LOG_FMT(LALAGAIN, "%s(%d):    => tmp->text() is '%s', orig_line is %zu\n",
-                    __func__, __LINE__, tmp->text(), tmp->orig_line);
+            chains.push_back(aligned_chain_t{ pc, {}, {}, false, 0, 0, 0 });
          }
+      }
+   }
+
+   chains_complete = true;
+   chains_stamp    = stamp;
+}
+
+
+/**
+ * Calls visit() with the column of each chunk from the ref of an aligned
+ * chunk to its start, as AlignStack::Add() walks them. Stops when visit()
+ * returns false.
+ *
+ * @return false if visit() did
+ */
+template<typename F>
+static bool for_each_tightened(chunk_t *pc, F visit)
+{
+   chunk_t *tmp = (pc->align.ref != nullptr) ? pc->align.ref : pc->align.start;
 
-         LOG_FMT(LALAGAIN, "\n");
-         as.End();
+   for ( ; tmp != nullptr; tmp = chunk_get_next(tmp))
+   {
+      if (!visit(tmp->column))
+      {
+         return(false);
+      }
+
+      if (tmp == pc->align.start)
+      {
+         break;
       }
    }
+
+   return(true);
+}
+
+
+//! Checks if nothing of a chain moved since it was last lined up
+static bool chain_unchanged(const aligned_chain_t &chain)
+{
+   const chunk_t *head = chain.head;
+
+   if (  chain.chunks.empty()
+      || head->align.right_align != chain.right_align
+      || head->align.star_style != chain.star_style
+      || head->align.amp_style != chain.amp_style
+      || head->align.gap != chain.gap)
+   {
+      return(false);
+   }
+   size_t idx = 0;
+   size_t col = 0;
+
+   for (chunk_t *pc = chain.head; pc != nullptr; pc = pc->align.next, idx++)
+   {
+      if (idx >= chain.chunks.size())
+      {
+         return(false);
+      }
+      const aligned_chunk_t &was = chain.chunks[idx];
+
+      if (  pc != was.pc
+         || pc->column != was.column
+         || pc->align.start != was.start
+         || pc->align.ref != was.ref)
+      {
+         return(false);
+      }
+      const bool same_columns = for_each_tightened(pc, [&chain, &col](size_t column)
+      {
+         return(  col < chain.columns.size()
+               && chain.columns[col++] == column);
+      });
+
+      if (!same_columns)
+      {
+         return(false);
+      }
+   }
+
+   return(  idx == chain.chunks.size()
+         && col == chain.columns.size());
+} // chain_unchanged
+
+
+//! Notes where the chunks of a chain were lined up
+static void remember_chain(aligned_chain_t &chain)
+{
+   const chunk_t *head = chain.head;
+
+   chain.right_align = head->align.right_align;
+   chain.star_style  = head->align.star_style;
+   chain.amp_style   = head->align.amp_style;
+   chain.gap         = head->align.gap;
+   chain.chunks.clear();
+   chain.columns.clear();
+
+   for (chunk_t *pc = chain.head; pc != nullptr; pc = pc->align.next)
+   {
+      aligned_chunk_t now;
+      now.pc     = pc;
+      now.column = pc->column;
+      now.start  = pc->align.start;
+      now.ref    = pc->align.ref;
+      chain.chunks.push_back(now);
+
+      for_each_tightened(pc, [&chain](size_t column)
+      {
+         chain.columns.push_back(column);
+         return(true);
+      });
+   }
+}
+
+
+void quick_align_again(void)
+{
+   LOG_FUNC_ENTRY();
+
+   if (  !chains_complete
+      || chains_stamp != structure_stamp())
+   {
+      collect_chains();
+   }
+
+   for (aligned_chain_t &chain : chains)
+   {
+      chunk_t *pc = chain.head;
+
+      if (  pc->align.next == nullptr
+         || !pc->flags.test(PCF_ALIGN_START))
+      {
+         continue;
+      }
+
+      if (chain_unchanged(chain))
+      {
+         LOG_FMT(LALAGAIN, "%s(%d):   pc->text() is '%s', orig_line is %zu, did not move\n",
+                 __func__, __LINE__, pc->text(), pc->orig_line);
+         continue;
+      }
+      AlignStack as;
+      as.Start(100, 0);
+      as.m_right_align = pc->align.right_align;
+      as.m_star_style  = static_cast<AlignStack::StarStyle>(pc->align.star_style);
+      as.m_amp_style   = static_cast<AlignStack::StarStyle>(pc->align.amp_style);
+      as.m_gap         = pc->align.gap;
+
+      LOG_FMT(LALAGAIN, "%s(%d):   pc->text() is '%s', orig_line is %zu\n",
+              __func__, __LINE__, pc->text(), pc->orig_line);
+      as.Add(pc->align.start);
+      chunk_flags_set(pc, PCF_WAS_ALIGNED);
+
+      for (chunk_t *tmp = pc->align.next; tmp != nullptr; tmp = tmp->align.next)
+      {
+         chunk_flags_set(tmp, PCF_WAS_ALIGNED);
+         as.Add(tmp->align.start);
+         LOG_FMT(LALAGAIN, "%s(%d):    => tmp->text() is '%s', orig_line is %zu\n",
+                 __func__, __LINE__, tmp->text(), tmp->orig_line);
+      }
+
+      LOG_FMT(LALAGAIN, "\n");
+      as.End();
+
+      remember_chain(chain);
+   }
 } // quick_align_again
+
+
+void quick_align_new_chain(void)
+{
+   chains_complete = false;
+}
+
+
+void quick_align_forget(void)
+{
+   chains.clear();
+   chains_complete = false;
+}
@@ -12,6 +12,22 @@
 
 #include "uncrustify_types.h"
 
+/**
+ * Lines up again the chains of chunks AlignStack::Flush() aligned, after
+ * indenting may have moved them. A chain is only aligned again if one of
+ * its chunks moved since it was last lined up here.
+ */
 void quick_align_again(void);
 
+
+/**
+ * Tells quick_align_again() that AlignStack::Flush() made a chunk the
+ * start of a chain for the first time, so its list of chains is incomplete.
+ */
+void quick_align_new_chain(void);
+
+
+//! Drops the chains quick_align_again() keeps, to be called when a file is done
+void quick_align_forget(void);
+
 #endif /* QUICK_ALIGN_AGAIN_H_INCLUDED */
@@ -12,8 +12,12 @@
 #include "log_rules.h"
 #include "newlines.h"
 #include "prototypes.h"
+#include "unc_ctype.h"
 
+#include <algorithm>
+#include <numeric>
 #include <regex>
+#include <vector>
 
 using namespace uncrustify;
 
@@ -40,22 +44,9 @@ include_category *include_categories[kIncludeCategoriesCount];
 
 
 /**
- * Compare two series of chunks, starting with the given ones.
- * @param pc1   first  instance to compare
- * @param pc2   second instance to compare
- * @param tcare take care of case (lower case/ upper case)   Issue #2091
- *
- * @retval == 0  both text elements are equal
- * @retval  > 0
- * @retval  < 0
- */
-static int compare_chunks(chunk_t *pc1, chunk_t *pc2, bool tcare = false);
-
-
-/**
- * Sorting should be pretty rare and should usually only include a few chunks.
- * We need to minimize the number of swaps, as those are expensive.
- * So, we do a min sort.
+ * Sorts the lines of a block of imports with a stable sort, so lines that
+ * compare equal keep their order. The sort key of each line is computed
+ * once, and the lines are moved with a single relink.
  */
 static void do_the_sort(chunk_t **chunks, size_t num_chunks);
 
@@ -125,10 +116,11 @@ static int get_chunk_priority(chunk_t *pc)
 }
 
 
-/**
- * Returns true if the text contains filename without extension.
- */
-static bool text_contains_filename_without_ext(const char *text)
+//! Matches a text that contains the name of the file without its extension
+static std::regex filename_pattern;
+
+
+static void prepare_filename_pattern()
 {
    std::string filepath             = cpd.filename;
    size_t      slash_idx            = filepath.find_last_of("/\\");
@@ -142,8 +134,16 @@ static bool text_contains_filename_without_ext(const char *text)
    }
    const std::regex  special_chars      = std::regex(R"([-[\]{}()*+?.,\^$|#\s])");
    const std::string sanitized_filename = std::regex_replace(filename_without_ext, special_chars, R"(\$&)");
-   const std::regex  filename_pattern   = std::regex("\\S?" + sanitized_filename + "\\b.*");
 
+   filename_pattern = std::regex("\\S?" + sanitized_filename + "\\b.*");
+}
+
+
+/**
+ * Returns true if the text contains filename without extension.
+ */
+static bool text_contains_filename_without_ext(const char *text)
+{
    return(std::regex_match(text, filename_pattern));
 }
 
@@ -189,152 +189,173 @@ static unc_text chunk_sort_str(chunk_t *pc)
 }
 
 
-//! Compare two chunks
-static int compare_chunks(chunk_t *pc1, chunk_t *pc2, bool tcare)
+//! What a chunk of an import line sorts by
+struct sort_token_t
 {
-   LOG_FUNC_ENTRY();
-   LOG_FMT(LSORT, "%s(%d): @begin pc1->len is %zu, line is %zu, column is %zu\n",
-           __func__, __LINE__, pc1->len(), pc1->orig_line, pc1->orig_col);
-   LOG_FMT(LSORT, "%s(%d): @begin pc2->len is %zu, line is %zu, column is %zu\n",
-           __func__, __LINE__, pc2->len(), pc2->orig_line, pc2->orig_col);
-
-   if (pc1 == pc2) // same chunk is always identical thus return 0 differences
-   {
-      return(0);
-   }
+   size_t              sym;          //! intern id of the chunk text
+   bool                is_include;   //! the sort text drops the last char
+   std::vector<UINT64> text;         //! sort text, see sort_char()
+   std::vector<UINT64> full;         //! whole chunk text, breaks ties of the sort text
+   int                 priority;     //! see get_chunk_priority()
+   int                 lead;         //! 0 for '<', 1 for '"', 2 for others, see prioritize_angle_over_quotes
+   bool                has_filename; //! sort text contains the name of the file
+   bool                has_dot;      //! text has an extension
+};
 
-   while (pc1 != nullptr && pc2 != nullptr)
-   {
-      auto const &s1_ext = chunk_sort_str(pc1);
-      auto const &s2_ext = chunk_sort_str(pc2);
 
-      auto const &s1 = (options::mod_sort_incl_import_ignore_extension()) ? get_text_without_ext(s1_ext) : s1_ext;
-      auto const &s2 = (options::mod_sort_incl_import_ignore_extension()) ? get_text_without_ext(s2_ext) : s2_ext;
+//! The chunks of an import line that are compared, from the imported name on
+typedef std::vector<sort_token_t> sort_key_t;
 
-      if (options::mod_sort_incl_import_prioritize_filename())
-      {
-         log_rule_B("mod_sort_incl_import_prioritize_filename");
-         bool s1_contains_filename = text_contains_filename_without_ext(s1.c_str());
-         bool s2_contains_filename = text_contains_filename_without_ext(s2.c_str());
 
-         if (s1_contains_filename && !s2_contains_filename)
-         {
-            return(-1);
-         }
-         else if (!s1_contains_filename && s2_contains_filename)
-         {
-            return(1);
-         }
-      }
+/**
+ * Maps a character so that comparing the values orders the texts as
+ * unc_text::compare() does: case-insensitive unless tcare, and a lower
+ * case letter before the upper case one.
+ */
+static UINT64 sort_char(int ch, bool tcare)
+{
+   if (tcare)
+   {
+      return(static_cast<UINT32>(ch));
+   }
+   return((static_cast<UINT64>(static_cast<UINT32>(unc_tolower(ch))) << 32)
+          | (0xFFFFFFFFu - static_cast<UINT32>(ch)));
+}
 
-      if (options::mod_sort_incl_import_prioritize_extensionless())
-      {
-         log_rule_B("mod_sort_incl_import_prioritize_extensionless");
-         const bool s1_has_dot = has_dot(s1_ext);
-         const bool s2_has_dot = has_dot(s2_ext);
 
-         if (s1_has_dot && !s2_has_dot)
-         {
-            return(1);
-         }
-         else if (!s1_has_dot && s2_has_dot)
-         {
-            return(-1);
-         }
-      }
+//! Computes what the chunks of the line starting at pc are sorted by
+static sort_key_t make_sort_key(chunk_t *pc, bool tcare)
+{
+   const bool ignore_ext    = options::mod_sort_incl_import_ignore_extension();
+   const bool want_filename = options::mod_sort_incl_import_prioritize_filename();
+   const bool want_dot      = options::mod_sort_incl_import_prioritize_extensionless();
+   const bool want_angle    = options::mod_sort_incl_import_prioritize_angle_over_quotes();
+   sort_key_t key;
 
-      if (options::mod_sort_incl_import_prioritize_angle_over_quotes())
-      {
-         log_rule_B("mod_sort_incl_import_prioritize_angle_over_quotes");
+   while (pc != nullptr)
+   {
+      const unc_text s_ext = chunk_sort_str(pc);
+      const unc_text s     = ignore_ext ? get_text_without_ext(s_ext) : s_ext;
+      sort_token_t   token;
 
-         if (s1.startswith("<") && s2.startswith("\""))
-         {
-            return(-1);
-         }
-         else if (s1.startswith("\"") && s2.startswith("<"))
-         {
-            return(1);
-         }
-      }
-      int ppc1 = get_chunk_priority(pc1);
-      int ppc2 = get_chunk_priority(pc2);
+      token.sym        = pc->str.intern_id();
+      token.is_include = get_chunk_parent_type(pc) == CT_PP_INCLUDE;
+      token.text.reserve(s.size());
 
-      if (ppc1 != ppc2)
+      for (int ch : s.get())
       {
-         return(ppc1 - ppc2);
+         token.text.push_back(sort_char(ch, tcare));
       }
-      LOG_FMT(LSORT, "%s(%d): text is %s, pc1->len is %zu, line is %zu, column is %zu\n",
-              __func__, __LINE__, pc1->text(), pc1->len(), pc1->orig_line, pc1->orig_col);
-      LOG_FMT(LSORT, "%s(%d): text is %s, pc2->len is %zu, line is %zu, column is %zu\n",
-              __func__, __LINE__, pc2->text(), pc2->len(), pc2->orig_line, pc2->orig_col);
 
-      int ret_val = unc_text::compare(s1, s2, std::min(s1.size(), s2.size()), tcare);
-      LOG_FMT(LSORT, "%s(%d): ret_val is %d\n",
-              __func__, __LINE__, ret_val);
+      token.full.reserve(pc->len());
 
-      if (ret_val != 0)
+      for (int ch : pc->str.get())
       {
-         return(ret_val);
+         token.full.push_back(sort_char(ch, tcare));
       }
 
-      if (pc1->len() != pc2->len())
-      {
-         return(pc1->len() - pc2->len());
-      }
-      // Same word, same length. Step to the next chunk.
-      pc1 = chunk_get_next(pc1);
-      LOG_FMT(LSORT, "%s(%d): text is %s, pc1->len is %zu, line is %zu, column is %zu\n",
-              __func__, __LINE__, pc1->text(), pc1->len(), pc1->orig_line, pc1->orig_col);
+      token.priority = get_chunk_priority(pc);
+      token.lead     = 2;
 
-      if (chunk_is_token(pc1, CT_MEMBER))
+      if (want_angle && s.size() > 0)
       {
-         pc1 = chunk_get_next(pc1);
-         LOG_FMT(LSORT, "%s(%d): text is %s, pc1->len is %zu, line is %zu, column is %zu\n",
-                 __func__, __LINE__, pc1->text(), pc1->len(), pc1->orig_line, pc1->orig_col);
+         token.lead = (s[0] == '<') ? 0 : (s[0] == '"') ? 1 : 2;
       }
-      pc2 = chunk_get_next(pc2);
-      LOG_FMT(LSORT, "%s(%d): text is %s, pc2->len is %zu, line is %zu, column is %zu\n",
-              __func__, __LINE__, pc2->text(), pc2->len(), pc2->orig_line, pc2->orig_col);
+      token.has_filename = want_filename && text_contains_filename_without_ext(s.c_str());
+      token.has_dot      = want_dot && has_dot(s_ext);
+      key.push_back(std::move(token));
 
-      if (chunk_is_token(pc2, CT_MEMBER))
+      // Step to the next chunk, over a '.' between the parts of a name
+      pc = chunk_get_next(pc);
+
+      if (chunk_is_token(pc, CT_MEMBER))
       {
-         pc2 = chunk_get_next(pc2);
-         LOG_FMT(LSORT, "%s(%d): text is %s, pc2->len is %zu, line is %zu, column is %zu\n",
-                 __func__, __LINE__, pc2->text(), pc2->len(), pc2->orig_line, pc2->orig_col);
+         pc = chunk_get_next(pc);
       }
-      LOG_FMT(LSORT, "%s(%d): >>>text is %s, pc1->len is %zu, line is %zu, column is %zu\n",
-              __func__, __LINE__, pc1->text(), pc1->len(), pc1->orig_line, pc1->orig_col);
-      LOG_FMT(LSORT, "%s(%d): >>>text is %s, pc2->len is %zu, line is %zu, column is %zu\n",
-              __func__, __LINE__, pc2->text(), pc2->len(), pc2->orig_line, pc2->orig_col);
 
       // If we hit a newline or nullptr, we are done
-      if (  pc1 == nullptr
-         || chunk_is_newline(pc1)
-         || pc2 == nullptr
-         || chunk_is_newline(pc2))
+      if (chunk_is_newline(pc))
       {
          break;
       }
    }
+   return(key);
+} // make_sort_key
+
+
+//! Compare two chunks by their sort keys
+static int compare_tokens(const sort_token_t &t1, const sort_token_t &t2)
+{
+   // the rest of the key follows from the text
+   if (  t1.sym == t2.sym
+      && t1.is_include == t2.is_include)
+   {
+      return(0);
+   }
 
-   if (pc1 == nullptr || !chunk_is_newline(pc2))
+   if (  options::mod_sort_incl_import_prioritize_filename()
+      && t1.has_filename != t2.has_filename)
    {
-      return(-1);
+      return(t1.has_filename ? -1 : 1);
    }
 
-   if (!chunk_is_newline(pc1))
+   if (  options::mod_sort_incl_import_prioritize_extensionless()
+      && t1.has_dot != t2.has_dot)
    {
-      return(1);
+      return(t1.has_dot ? 1 : -1);
+   }
+
+   if (t1.lead != t2.lead)
+   {
+      return(t1.lead - t2.lead);
+   }
+
+   if (t1.priority != t2.priority)
+   {
+      return(t1.priority - t2.priority);
+   }
+
+   /*
+    * Each step orders all tokens, so the comparison is a strict weak
+    * ordering as std::stable_sort() needs: the sort text with a prefix
+    * first, then the whole text for tokens whose sort texts are equal.
+    */
+   if (t1.text != t2.text)
+   {
+      return((t1.text < t2.text) ? -1 : 1);
+   }
+
+   if (t1.full != t2.full)
+   {
+      return((t1.full < t2.full) ? -1 : 1);
    }
    return(0);
-} // compare_chunks
+} // compare_tokens
+
+
+//! Compare two lines by their sort keys, a shorter line sorts first
+static int compare_keys(const sort_key_t &k1, const sort_key_t &k2)
+{
+   const size_t len = std::min(k1.size(), k2.size());
+
+   for (size_t idx = 0; idx < len; idx++)
+   {
+      const int ret_val = compare_tokens(k1[idx], k2[idx]);
+
+      if (ret_val != 0)
+      {
+         return(ret_val);
+      }
+   }
+
+   if (k1.size() != k2.size())
+   {
+      return((k1.size() < k2.size()) ? -1 : 1);
+   }
+   return(0);
+}
 
 
-/**
- * Sorting should be pretty rare and should usually only include a few chunks.
- * We need to minimize the number of swaps, as those are expensive.
- * So, we do a min sort.
- */
 static void do_the_sort(chunk_t **chunks, size_t num_chunks)
 {
    LOG_FUNC_ENTRY();
@@ -349,41 +370,50 @@ static void do_the_sort(chunk_t **chunks, size_t num_chunks)
 
    LOG_FMT(LSORT, "\n");
 
-   size_t start_idx;
-
    log_rule_B("mod_sort_case_sensitive");
    bool take_care = options::mod_sort_case_sensitive();                    // Issue #2091
 
-   for (start_idx = 0; start_idx < (num_chunks - 1); start_idx++)
+   log_rule_B("mod_sort_incl_import_ignore_extension");
+   log_rule_B("mod_sort_incl_import_prioritize_filename");
+   log_rule_B("mod_sort_incl_import_prioritize_extensionless");
+   log_rule_B("mod_sort_incl_import_prioritize_angle_over_quotes");
+
+   std::vector<sort_key_t> keys;
+
+   keys.reserve(num_chunks);
+
+   for (size_t idx = 0; idx < num_chunks; idx++)
    {
-      // Find the index of the minimum value
-      size_t min_idx = start_idx;
+      keys.push_back(make_sort_key(chunks[idx], take_care));
+   }
 
-      for (size_t idx = start_idx + 1; idx < num_chunks; idx++)
-      {
-         if (compare_chunks(chunks[idx], chunks[min_idx], take_care) < 0)  // Issue #2091
-         {
-            min_idx = idx;
-         }
-      }
+   std::vector<size_t> order(num_chunks);
 
-      // Swap the lines if the minimum isn't the first entry
-      if (min_idx != start_idx)
-      {
-         chunk_swap_lines(chunks[start_idx], chunks[min_idx]);
+   std::iota(order.begin(), order.end(), 0);
+   std::stable_sort(order.begin(), order.end(),
+                    [&keys](size_t idx1, size_t idx2)
+   {
+      return(compare_keys(keys[idx1], keys[idx2]) < 0);
+   });
 
-         if (options::mod_sort_incl_import_grouping_enabled())
-         {
-            chunk_t *pc = chunks[min_idx];
-            chunks[min_idx]   = chunks[start_idx];
-            chunks[start_idx] = pc;
-         }
-         else
-         {
-            // Don't need to swap, since we only want the side-effects
-            chunks[min_idx] = chunks[start_idx];
-         }
-      }
+   bool moved = false;
+
+   for (size_t idx = 0; idx < num_chunks; idx++)
+   {
+      moved |= (order[idx] != idx);
+   }
+
+   if (!moved)
+   {
+      return;
+   }
+   chunk_reorder_lines(chunks, order.data(), num_chunks);
+
+   const std::vector<chunk_t *> unsorted(chunks, chunks + num_chunks);
+
+   for (size_t idx = 0; idx < num_chunks; idx++)
+   {
+      chunks[idx] = unsorted[order[idx]];
    }
 } // do_the_sort
 
@@ -558,18 +588,21 @@ static void group_imports_by_adding_newlines(chunk_t **chunks, size_t num_chunks
 void sort_imports(void)
 {
    LOG_FUNC_ENTRY();
-   const int max_number_to_sort                        = 1024;
-   const int max_lines_to_check_for_sort_after_include = 128;
-   const int max_gap_threshold_between_include_to_sort = 32;
+   const int              max_lines_to_check_for_sort_after_include = 128;
+   const int              max_gap_threshold_between_include_to_sort = 32;
 
-   chunk_t   *chunks[max_number_to_sort];
-   size_t    num_chunks  = 0;
-   chunk_t   *p_last     = nullptr;
-   chunk_t   *p_imp      = nullptr;
-   chunk_t   *p_imp_last = nullptr;
+   std::vector<chunk_t *> chunks;
+   chunk_t                *p_last     = nullptr;
+   chunk_t                *p_imp      = nullptr;
+   chunk_t                *p_imp_last = nullptr;
 
    prepare_categories();
 
+   if (  options::mod_sort_incl_import_prioritize_filename()
+      || options::mod_sort_incl_import_grouping_enabled())
+   {
+      prepare_filename_pattern();
+   }
    chunk_t *pc = chunk_get_head();
 
    while (pc != nullptr)
@@ -593,20 +626,9 @@ void sort_imports(void)
             && (  chunk_is_token(p_last, CT_SEMICOLON)
                || p_imp->flags.test(PCF_IN_PREPROC)))
          {
-            if (num_chunks < max_number_to_sort)
-            {
-               LOG_FMT(LSORT, "%s(%d): p_imp is %s\n",
-                       __func__, __LINE__, p_imp->text());
-               chunks[num_chunks++] = p_imp;
-            }
-            else
-            {
-               fprintf(stderr, "Number of 'import' to be sorted is too big for the current value %d.\n", max_number_to_sort);
-               fprintf(stderr, "Please make a report.\n");
-               log_flush(true);
-               cpd.error_count++;
-               exit(2);
-            }
+            LOG_FMT(LSORT, "%s(%d): p_imp is %s\n",
+                    __func__, __LINE__, p_imp->text());
+            chunks.push_back(p_imp);
             did_import = true;
          }
 
@@ -618,21 +640,21 @@ void sort_imports(void)
                && (pc->orig_line - p_imp_last->orig_line) > max_gap_threshold_between_include_to_sort)
             || next == nullptr)
          {
-            if (num_chunks > 1)
+            if (chunks.size() > 1)
             {
                if (options::mod_sort_incl_import_grouping_enabled())
                {
-                  remove_blank_lines_between_imports(chunks, num_chunks);
-                  do_the_sort(chunks, num_chunks);
-                  group_imports_by_adding_newlines(chunks, num_chunks);
-                  dedupe_imports(chunks, num_chunks);
+                  remove_blank_lines_between_imports(chunks.data(), chunks.size());
+                  do_the_sort(chunks.data(), chunks.size());
+                  group_imports_by_adding_newlines(chunks.data(), chunks.size());
+                  dedupe_imports(chunks.data(), chunks.size());
                }
                else
                {
-                  do_the_sort(chunks, num_chunks);
+                  do_the_sort(chunks.data(), chunks.size());
                }
             }
-            num_chunks = 0;
+            chunks.clear();
          }
          p_imp_last = p_imp;
          p_imp      = nullptr;
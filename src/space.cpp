@@ -22,9 +22,11 @@
 
 #include "char_table.h"
 #include "chunk_list.h"
+#include "error_types.h"
 #include "language_tools.h"
 #include "log_rules.h"
 #include "options_for_QT.h"
+#include "profile.h"
 #include "prototypes.h"
 #include "punctuators.h"
 #include "unc_ctype.h"
@@ -43,14 +45,18 @@ using namespace uncrustify;
 
 /**
  * Decides how to change inter-chunk spacing.
- * Note that the order of the if statements is VERY important.
+ * Note that the order of the rules is VERY important.
+ * Each rule is a SPACE_RULE of do_space(), with the types of the chunks it
+ * checks for, so that only the rules for them are tried.
  *
- * @param first   The first chunk
- * @param second  The second chunk
+ * @param first      The first chunk
+ * @param second     The second chunk
+ * @param cacheable  Set to false if a rule looked at more than the chunks'
+ *                   space_context_t, the result must not be remembered then
  *
  * @return IARF_IGNORE, IARF_ADD, IARF_REMOVE or IARF_FORCE
  */
-static iarf_e do_space(chunk_t *first, chunk_t *second, int &min_sp);
+static iarf_e do_space(chunk_t *first, chunk_t *second, int &min_sp, bool &cacheable);
 
 /**
  * Ensure to force the space between the \a first and the \a second chunks
@@ -118,3299 +124,4686 @@ const no_space_table_t no_space_table[] =
 };
 
 
-/*
- * this function is called for every chunk in the input file.
- * Thus it is important to keep this function efficient
- */
-static iarf_e do_space(chunk_t *first, chunk_t *second, int &min_sp)
+//! a pair of chunk types that a rule of do_space() can apply to
+struct space_rule_key_t
 {
-   LOG_FUNC_ENTRY();
-
-   LOG_FMT(LSPACE, "%s(%d): orig_line is %zu, orig_col is %zu, first->text() '%s', type is %s\n",
-           __func__, __LINE__, first->orig_line, first->orig_col, first->text(), get_token_name(first->type));
-
-   min_sp = 1;
+   UINT16    rule;   //! the case of the rule in do_space()
+   c_token_t first;  //! CT_UNKNOWN matches any type
+   c_token_t second; //! CT_UNKNOWN matches any type
+};
 
-   if (chunk_is_token(first, CT_IGNORED) || chunk_is_token(second, CT_IGNORED))
-   {
-      log_rule("REMOVE");
-      return(IARF_REMOVE);
-   }
 
-   if (chunk_is_token(first, CT_PP_IGNORE) && chunk_is_token(second, CT_PP_IGNORE))
-   {
-      // Leave spacing alone between PP_IGNORE tokens as we don't want the default behavior (which is ADD).
-      log_rule("PP_IGNORE");
-      return(IARF_IGNORE);
-   }
+//! ends a list of the rules of do_space()
+static const UINT16 SPACE_RULE_END = 0xffff;
 
-   if (chunk_is_token(first, CT_PP) || chunk_is_token(second, CT_PP))
-   {
-      // Add or remove space around preprocessor '##' concatenation operator.
-      log_rule("sp_pp_concat");
-      return(options::sp_pp_concat());
-   }
+//! while build_space_rule_table() runs, the rules of do_space() only add their keys here
+static vector<space_rule_key_t> *space_rule_keys_out = nullptr;
 
-   if (chunk_is_token(first, CT_POUND))
-   {
-      // Add or remove space after preprocessor '#' stringify operator.
-      // Also affects the '#@' charizing operator.
-      log_rule("sp_pp_stringify");
-      return(options::sp_pp_stringify());
-   }
 
-   if (  chunk_is_token(second, CT_POUND)
-      && second->flags.test(PCF_IN_PREPROC)
-      && get_chunk_parent_type(first) != CT_MACRO_FUNC)
+//! Adds the keys of a rule of do_space() to space_rule_keys_out
+static void add_space_rule_keys(UINT16 rule, const no_space_table_t *pair, const no_space_table_t *end)
+{
+   for ( ; pair < end; pair++)
    {
-      // Add or remove space before preprocessor '#' stringify operator
-      // as in '#define x(y) L#y'.
-      log_rule("sp_before_pp_stringify");
-      return(options::sp_before_pp_stringify());
+      space_rule_keys_out->push_back({ rule, pair->first, pair->second });
    }
+}
 
-   if (chunk_is_token(first, CT_SPACE) || chunk_is_token(second, CT_SPACE))
-   {
-      log_rule("REMOVE");
-      return(IARF_REMOVE);
-   }
 
-   if (chunk_is_token(first, CT_DECLSPEC))  // Issue 1289
-   {
-      log_rule("REMOVE");
-      return(IARF_REMOVE);
-   }
+/**
+ * Starts the case of a rule of do_space(), followed by the pairs of chunk
+ * types it checks for. A rule that doesn't check the types of both chunks
+ * has CT_UNKNOWN for the other one.
+ *
+ * The rules are numbered by __COUNTER__ in the order they are written, and
+ * run in that order. Two rules can't get the same number, the compiler
+ * rejects a second case for it; build_space_rule_table() checks there are
+ * no gaps.
+ *
+ * build_space_rule_table() calls do_space() once on two blank chunks with
+ * space_rule_keys_out set, and every rule listed. Then each case only adds
+ * its keys and breaks before the code of the rule runs, so only the code
+ * of do_space() before the switch sees the blank chunks. No code may sit
+ * between the rules outside of a case, and the rules may not use
+ * __COUNTER__ themselves.
+ */
+#define SPACE_RULE(...)    SPACE_RULE_AT(__COUNTER__ - SPACE_RULE_FIRST, __VA_ARGS__)
 
-   if (chunk_is_token(second, CT_NEWLINE) || chunk_is_token(second, CT_VBRACE_OPEN))
-   {
-      log_rule("REMOVE");
-      return(IARF_REMOVE);
+#define SPACE_RULE_AT(num, ...)                                   \
+case num:                                                         \
+   if (space_rule_keys_out != nullptr)                            \
+   {                                                              \
+      static const no_space_table_t keys[] = { __VA_ARGS__ };     \
+      add_space_rule_keys(num, std::begin(keys), std::end(keys)); \
+      break;                                                      \
    }
 
-   if (  chunk_is_token(first, CT_VBRACE_OPEN)
-      && second->type != CT_NL_CONT
-      && second->type != CT_SEMICOLON) // # Issue 1158
-   {
-      log_rule("FORCE");
-      return(IARF_FORCE);
-   }
+//! Starts the case of a rule of do_space() that checks for the pairs of a table
+#define SPACE_RULE_TABLE(table)    SPACE_RULE_TABLE_AT(__COUNTER__ - SPACE_RULE_FIRST, table)
 
-   if (chunk_is_token(first, CT_VBRACE_CLOSE) && second->type != CT_NL_CONT)
-   {
-      log_rule("REMOVE");
-      return(IARF_REMOVE);
+#define SPACE_RULE_TABLE_AT(num, table)                             \
+case num:                                                           \
+   if (space_rule_keys_out != nullptr)                              \
+   {                                                                \
+      add_space_rule_keys(num, std::begin(table), std::end(table)); \
+      break;                                                        \
    }
 
-   if (chunk_is_token(second, CT_VSEMICOLON))
-   {
-      log_rule("REMOVE");
-      return(IARF_REMOVE);
-   }
+/**
+ * The rules of do_space() that can apply, for each pair of chunk types.
+ * The types that no rule checks for share a row or a column of the cells.
+ *
+ * A cell is filled in when its pair is first seen, from the keys for its
+ * first type, the keys for its second type only and the keys for any pair.
+ * Most files only have a few hundred pairs, so the rules they use stay
+ * close together.
+ */
+struct space_rule_table_t
+{
+   size_t                   first_class[CT_TOKEN_COUNT_];  //! per first type, the row of its cell
+   size_t                   second_class[CT_TOKEN_COUNT_]; //! per second type, the column of its cell
+   size_t                   columns;
+   vector<space_rule_key_t> row_keys;                      //! the keys for a first type, by row and rule
+   vector<size_t>           row_start;                     //! per row, where its keys start in row_keys
+   vector<space_rule_key_t> column_keys;                   //! the keys for any first type and a second type, by column and rule
+   vector<size_t>           column_start;                  //! per column, where its keys start in column_keys
+   vector<space_rule_key_t> any_keys;                      //! the keys for any pair, by rule
+   vector<vector<UINT32> >  cells;                         //! per row and column, where the rules start in rules, 0 if not filled in
+   vector<UINT16>           rules;                         //! the rules of the cells, each ending with SPACE_RULE_END
+   size_t                   all_rules;                     //! where a list of every rule starts in rules
+};
 
-   if (chunk_is_token(first, CT_MACRO_FUNC))
-   {
-      log_rule("REMOVE");
-      return(IARF_REMOVE);
-   }
+static space_rule_table_t space_rules;
 
-   if (chunk_is_token(second, CT_NL_CONT))
-   {
-      // Add or remove space before a backslash-newline at the end of a line.
-      log_rule("sp_before_nl_cont");
-      return(options::sp_before_nl_cont());
-   }
 
-   if (chunk_is_token(first, CT_D_ARRAY_COLON) || chunk_is_token(second, CT_D_ARRAY_COLON))
-   {
-      // (D) Add or remove around the D named array initializer ':' operator.
-      log_rule("sp_d_array_colon");
-      return(options::sp_d_array_colon());
-   }
+/**
+ * Finds the rules of do_space() that check for each chunk type, with a dry
+ * run of it, and sets up space_rules for them.
+ */
+static void build_space_rule_table(void);
 
-   if (  chunk_is_token(first, CT_CASE)
-      && ((CharTable::IsKw1(second->str[0]) || chunk_is_token(second, CT_NUMBER))))
-   {
-      // Fix the spacing between 'case' and the label. Only 'ignore' and 'force' make
-      // sense here.
-      log_rule("sp_case_label");
-      return(options::sp_case_label() | IARF_ADD);
-   }
 
-   if (chunk_is_token(first, CT_FOR_COLON))
-   {
-      // java
-      // Add or remove space after ':' in a Java/C++11 range-based 'for',
-      // as in 'for (Type var : expr)'.
-      log_rule("sp_after_for_colon");
-      return(options::sp_after_for_colon());
-   }
+//! Adds the rules of a cell to space_rules.rules, merging the keys that apply to it
+static void fill_space_rule_cell(size_t row, size_t col)
+{
+   const space_rule_key_t *row_key = space_rules.row_keys.data() + space_rules.row_start[row];
+   const space_rule_key_t *row_end = space_rules.row_keys.data() + space_rules.row_start[row + 1];
+   const space_rule_key_t *col_key = space_rules.column_keys.data() + space_rules.column_start[col];
+   const space_rule_key_t *col_end = space_rules.column_keys.data() + space_rules.column_start[col + 1];
+   const space_rule_key_t *any_key = space_rules.any_keys.data();
+   const space_rule_key_t *any_end = any_key + space_rules.any_keys.size();
+   UINT16                 last     = SPACE_RULE_END;
 
-   if (chunk_is_token(second, CT_FOR_COLON))
+   while (true)
    {
-      // java
-      // Add or remove space before ':' in a Java/C++11 range-based 'for',
-      // as in 'for (Type var : expr)'.
-      log_rule("sp_before_for_colon");
-      return(options::sp_before_for_colon());
-   }
+      // skip the keys of the row that are for another second type
+      while (  row_key < row_end
+            && row_key->second != CT_UNKNOWN
+            && space_rules.second_class[row_key->second] != col)
+      {
+         row_key++;
+      }
+      // take the key with the lowest rule
+      const space_rule_key_t **next = nullptr;
 
-   if (chunk_is_token(first, CT_QUESTION) && chunk_is_token(second, CT_COND_COLON))
-   {
-      if (options::sp_cond_ternary_short() != IARF_IGNORE)
+      if (row_key < row_end)
       {
-         // In the abbreviated ternary form '(a ?: b)', add or remove space between '?'
-         // and ':'.
-         // Overrides all other sp_cond_* options.
-         log_rule("sp_cond_ternary_short");
-         return(options::sp_cond_ternary_short());
+         next = &row_key;
       }
-   }
 
-   if (chunk_is_token(first, CT_QUESTION) || chunk_is_token(second, CT_QUESTION))
-   {
-      if (  chunk_is_token(second, CT_QUESTION)
-         && (options::sp_cond_question_before() != IARF_IGNORE))
+      if (col_key < col_end && (next == nullptr || col_key->rule < (*next)->rule))
       {
-         // Add or remove space before the '?' in 'b ? t : f'.
-         // Overrides sp_cond_question.
-         log_rule("sp_cond_question_before");
-         return(options::sp_cond_question_before());
+         next = &col_key;
       }
 
-      if (  chunk_is_token(first, CT_QUESTION)
-         && (options::sp_cond_question_after() != IARF_IGNORE))
+      if (any_key < any_end && (next == nullptr || any_key->rule < (*next)->rule))
       {
-         // Add or remove space after the '?' in 'b ? t : f'.
-         // Overrides sp_cond_question.
-         log_rule("sp_cond_question_after");
-         return(options::sp_cond_question_after());
+         next = &any_key;
       }
-      // Issue #2596
-      // Add or remove space around the '?' in 'b ? t : f'.
-      // replace "if (chunk_is_token(first, CT_PAREN_CLOSE) && chunk_is_token(second, CT_QUESTION))"
-      log_rule("sp_cond_question");
-      return(options::sp_cond_question());
-   }
 
-   if (chunk_is_token(first, CT_COND_COLON) || chunk_is_token(second, CT_COND_COLON))
-   {
-      if (  chunk_is_token(second, CT_COND_COLON)
-         && (options::sp_cond_colon_before() != IARF_IGNORE))
+      if (next == nullptr)
       {
-         // Add or remove space before the ':' in 'b ? t : f'.
-         // Overrides sp_cond_colon.
-         log_rule("sp_cond_colon_before");
-         return(options::sp_cond_colon_before());
+         break;
       }
 
-      if (  chunk_is_token(first, CT_COND_COLON)
-         && (options::sp_cond_colon_after() != IARF_IGNORE))
+      if ((*next)->rule != last)
       {
-         // Add or remove space after the ':' in 'b ? t : f'.
-         // Overrides sp_cond_colon.
-         log_rule("sp_cond_colon_after");
-         return(options::sp_cond_colon_after());
+         last = (*next)->rule;
+         space_rules.rules.push_back(last);
       }
-      // Issue #2596
-      // replace "if (chunk_is_token(first, CT_WORD) && chunk_is_token(second, CT_COND_COLON))"
-      // Add or remove space around the ':' in 'b ? t : f'.
-      log_rule("sp_cond_colon");
-      return(options::sp_cond_colon());
+      (*next)++;
    }
+   space_rules.rules.push_back(SPACE_RULE_END);
+} // fill_space_rule_cell
 
-   if (chunk_is_token(first, CT_RANGE) || chunk_is_token(second, CT_RANGE))
-   {
-      // (D) Add or remove space around the D '..' operator.
-      log_rule("sp_range");
-      return(options::sp_range());
-   }
 
-   if (chunk_is_token(first, CT_COLON) && get_chunk_parent_type(first) == CT_SQL_EXEC)
+/**
+ * Gets the rules of do_space() that can apply to two chunks.
+ *
+ * @return where they start in space_rules.rules, in order
+ */
+static size_t space_rules_for(const chunk_t *first, const chunk_t *second)
+{
+   if (space_rule_keys_out != nullptr)
    {
-      log_rule("REMOVE");
-      return(IARF_REMOVE);
+      return(space_rules.all_rules);
    }
 
-   // Macro stuff can only return IGNORE, ADD, or FORCE
-   if (chunk_is_token(first, CT_MACRO))
+   if (space_rules.cells.empty())
    {
-      // Add or remove space between a macro name and its definition.
-      log_rule("sp_macro");
-      iarf_e arg = options::sp_macro();
-      return(arg | ((arg != IARF_IGNORE) ? IARF_ADD : IARF_IGNORE));
+      // the types the rules check for don't depend on the config
+      build_space_rule_table();
    }
+   const size_t   row     = space_rules.first_class[first->type];
+   const size_t   col     = space_rules.second_class[second->type];
+   vector<UINT32> &starts = space_rules.cells[row];
 
-   if (chunk_is_token(first, CT_FPAREN_CLOSE) && get_chunk_parent_type(first) == CT_MACRO_FUNC)
+   if (starts.empty())
    {
-      // Add or remove space between a macro function ')' and its definition.
-      log_rule("sp_macro_func");
-      iarf_e arg = options::sp_macro_func();
-      return(arg | ((arg != IARF_IGNORE) ? IARF_ADD : IARF_IGNORE));
+      starts.assign(space_rules.columns, 0);
    }
 
-   if (chunk_is_token(first, CT_PREPROC))
+   if (starts[col] == 0)
    {
-      // Remove spaces, unless we are ignoring. See indent_preproc()
-      if (options::pp_space() == IARF_IGNORE)
-      {
-         log_rule("pp_space");
-         log_rule("IGNORE");
-         return(IARF_IGNORE);
-      }
-      log_rule("REMOVE");
-      return(IARF_REMOVE);
+      starts[col] = space_rules.rules.size();
+      fill_space_rule_cell(row, col);
    }
+   return(starts[col]);
+} // space_rules_for
 
-   if (chunk_is_token(second, CT_SEMICOLON))
-   {
-      if (get_chunk_parent_type(second) == CT_FOR)
-      {
-         if (  chunk_is_token(first, CT_SPAREN_OPEN) // a
-            || chunk_is_token(first, CT_SEMICOLON))  // b
-         {
-            // empty, ie for (;;)
-            //               ^ is first    // a
-            //                ^ is second  // a
-            // or
-            //                ^ is first   // b
-            //                 ^ is second // b
-            // Add or remove space before a semicolon of an empty part of a for statement.
-            log_rule("sp_before_semi_for_empty");
-            return(options::sp_before_semi_for_empty());
-         }
 
-         if (options::sp_before_semi_for() != IARF_IGNORE)
-         {
-            // Add or remove space before ';' in non-empty 'for' statements.
-            log_rule("sp_before_semi_for");
-            return(options::sp_before_semi_for());
-         }
-      }
-      iarf_e arg = options::sp_before_semi();
+/**
+ * What the rules of do_space() look at, apart from the options: most of them
+ * only check the types, parents and a few flags of the two chunks, and some
+ * the text of '(' and ')'.
+ */
+struct space_context_t
+{
+   UINT64 tokens; //! the types and parents of both chunks, and their text if it is one character
+   UINT64 flags;  //! the SPACE_RULE_FLAGS of the first chunk, those of the second one shifted by one
+};
 
-      if (  chunk_is_token(first, CT_SPAREN_CLOSE)
-         && get_chunk_parent_type(first) != CT_WHILE_OF_DO)
-      {
-         // Add or remove space before empty statement ';' on 'if', 'for' and 'while'.
-         log_rule("sp_before_semi|sp_special_semi");
-         arg = arg | options::sp_special_semi();
-      }
-      else
-      {
-         // Add or remove space before ';'.
-         log_rule("sp_before_semi");
-      }
-      return(arg);
-   }
 
-   if (  (  chunk_is_token(second, CT_COMMENT)
-         || chunk_is_token(second, CT_COMMENT_CPP))
-      && (  chunk_is_token(first, CT_PP_ELSE)
-         || chunk_is_token(first, CT_PP_ENDIF)))
-   {
-      if (options::sp_endif_cmt() != IARF_IGNORE)
-      {
-         set_chunk_type(second, CT_COMMENT_ENDIF);
-         // Add or remove space between #else or #endif and a trailing comment.
-         log_rule("sp_endif_cmt");
-         return(options::sp_endif_cmt());
-      }
-   }
+//! the flags the rules of do_space() test
+static const UINT64 SPACE_RULE_FLAGS =
+   UINT64(PCF_IN_ENUM) | UINT64(PCF_IN_OC_MSG) | UINT64(PCF_IN_PREPROC)
+   | UINT64(PCF_IN_SPAREN) | UINT64(PCF_IN_TYPEDEF) | UINT64(PCF_OC_RTYPE)
+   | UINT64(PCF_PUNCTUATOR) | UINT64(PCF_VAR_DEF);
 
-   if (  (options::sp_before_tr_emb_cmt() != IARF_IGNORE)
-      && (  get_chunk_parent_type(second) == CT_COMMENT_END
-         || get_chunk_parent_type(second) == CT_COMMENT_EMBED))
-   {
-      // Add or remove space before a trailing or embedded comment.
-      // Number of spaces before a trailing or embedded comment.
-      log_rule("sp_num_before_tr_emb_cmt");
-      min_sp = options::sp_num_before_tr_emb_cmt();
-      return(options::sp_before_tr_emb_cmt());
-   }
+static_assert((SPACE_RULE_FLAGS & (SPACE_RULE_FLAGS << 1)) == 0,
+              "the flags of both chunks must fit into space_context_t::flags");
+static_assert(CT_TOKEN_COUNT_ <= 1024,
+              "four types must fit into space_context_t::tokens");
 
-   if (get_chunk_parent_type(second) == CT_COMMENT_END)
-   {
-      switch (second->orig_prev_sp)
-      {
-      case 0:
-         log_rule("orig_prev_sp-REMOVE");
-         return(IARF_REMOVE);
 
-      case 1:
-         log_rule("orig_prev_sp-FORCE");
-         return(IARF_FORCE);
+//! a result of do_space() for a context
+struct space_memo_entry_t
+{
+   space_context_t context;
+   iarf_e          av;
+   int             min_sp;
+   bool            used;
+};
 
-      default:
-         log_rule("orig_prev_sp-ADD");
-         return(IARF_ADD);
-      }
-   }
 
-   // "for (;;)" vs "for (;; )" and "for (a;b;c)" vs "for (a; b; c)"
-   if (chunk_is_token(first, CT_SEMICOLON))
-   {
-      if (get_chunk_parent_type(first) == CT_FOR)
-      {
-         if (  (options::sp_after_semi_for_empty() != IARF_IGNORE)
-            && chunk_is_token(second, CT_SPAREN_CLOSE))
-         {
-            // Add or remove space after the final semicolon of an empty part of a for
-            // statement, as in 'for ( ; ; <here> )'.
-            log_rule("sp_after_semi_for_empty");
-            return(options::sp_after_semi_for_empty());
-         }
+//! the number of entries of space_memo, a power of 2
+static const size_t SPACE_MEMO_SIZE = 1024;
 
-         if (  (options::sp_after_semi_for() != IARF_IGNORE)
-            && second->type != CT_SPAREN_CLOSE)  // Issue 1324
-         {
-            // Add or remove space after ';' in non-empty 'for' statements.
-            log_rule("sp_after_semi_for");
-            return(options::sp_after_semi_for());
-         }
-      }
-      else if (!chunk_is_comment(second) && second->type != CT_BRACE_CLOSE) // issue #197
-      {
-         // Add or remove space after ';', except when followed by a comment.
-         log_rule("sp_after_semi");
-         return(options::sp_after_semi());
-      }
-      // Let the comment spacing rules handle this
-   }
+/**
+ * The results of do_space() for the contexts seen last, by a hash of the
+ * context. They depend on the options and on the language of the file.
+ */
+static vector<space_memo_entry_t> space_memo;
 
-   // puts a space in the rare '+-' or '-+'
-   if (  (  chunk_is_token(first, CT_NEG)
-         || chunk_is_token(first, CT_POS)
-         || chunk_is_token(first, CT_ARITH))
-      && (  chunk_is_token(second, CT_NEG)
-         || chunk_is_token(second, CT_POS)
-         || chunk_is_token(second, CT_ARITH)))
-   {
-      log_rule("ADD");
-      return(IARF_ADD);
-   }
+//! the language the entries of space_memo were made for
+static size_t space_memo_lang;
 
-   // "return(a);" vs "return (foo_t)a + 3;" vs "return a;" vs "return;"
-   if (chunk_is_token(first, CT_RETURN))
-   {
-      if (  chunk_is_token(second, CT_PAREN_OPEN)
-         && get_chunk_parent_type(second) == CT_RETURN)
-      {
-         // Add or remove space between 'return' and '('.
-         log_rule("sp_return_paren");
-         return(options::sp_return_paren());
-      }
-      else if (  chunk_is_token(second, CT_BRACE_OPEN)
-              && get_chunk_parent_type(second) == CT_BRACED_INIT_LIST)
-      {
-         // Add or remove space between 'return' and '{'.
-         log_rule("sp_return_brace");
-         return(options::sp_return_brace());
-      }
-      // everything else requires a space
-      log_rule("FORCE");
-      return(IARF_FORCE);
-   }
+//! the GenericOption::generation() the entries of space_memo were made for
+static size_t space_memo_options;
 
-   // "sizeof(foo_t)" vs "sizeof (foo_t)"
-   if (chunk_is_token(first, CT_SIZEOF))
-   {
-      if (chunk_is_token(second, CT_PAREN_OPEN))
-      {
-         // Add or remove space between 'sizeof' and '('.
-         log_rule("sp_sizeof_paren");
-         return(options::sp_sizeof_paren());
-      }
 
-      if (chunk_is_token(second, CT_ELLIPSIS))
-      {
-         // Add or remove space between 'sizeof' and '...'.
-         log_rule("sp_sizeof_ellipsis");
-         return(options::sp_sizeof_ellipsis());
-      }
-      log_rule("FORCE");
-      return(IARF_FORCE);
-   }
+static space_context_t space_context_of(chunk_t *first, chunk_t *second)
+{
+   const UINT64    first_char  = (first->len() == 1) ? static_cast<unsigned char>(first->str[0]) : 0;
+   const UINT64    second_char = (second->len() == 1) ? static_cast<unsigned char>(second->str[0]) : 0;
+
+   space_context_t ctx;
+
+   ctx.tokens = UINT64(first->type)
+                | (UINT64(second->type) << 10)
+                | (UINT64(get_chunk_parent_type(first)) << 20)
+                | (UINT64(get_chunk_parent_type(second)) << 30)
+                | (first_char << 40)
+                | (second_char << 48);
+   ctx.flags = (static_cast<pcf_flags_t::int_t>(first->flags) & SPACE_RULE_FLAGS)
+               | ((static_cast<pcf_flags_t::int_t>(second->flags) & SPACE_RULE_FLAGS) << 1);
+   return(ctx);
+}
+
+
+static size_t hash_space_context(const space_context_t &ctx)
+{
+   const UINT64 hash = (ctx.tokens ^ (ctx.flags * 31)) * 0x9E3779B97F4A7C15ULL;
+
+   return(static_cast<size_t>(hash >> 32) & (SPACE_MEMO_SIZE - 1));
+}
+
 
-   // "decltype(foo_t)" vs "decltype (foo_t)"
-   if (chunk_is_token(first, CT_DECLTYPE))
+/**
+ * Calls do_space(), but reuses the result for chunks with the same
+ * space_context_t if none of the rules looked any further.
+ * Not while spacing is logged, nor while options are overridden for a Qt
+ * SIGNAL/SLOT macro.
+ */
+static iarf_e do_space_cached(chunk_t *first, chunk_t *second, int &min_sp)
+{
+   bool cacheable;
+
+   if (  log_sev_on(LSPACE)
+      || QT_SIGNAL_SLOT_found
+      || restoreValues)
    {
-      if (chunk_is_token(second, CT_PAREN_OPEN))
-      {
-         // Add or remove space between 'decltype' and '('.
-         log_rule("sp_decltype_paren");
-         return(options::sp_decltype_paren());
-      }
-      log_rule("FORCE");
-      return(IARF_FORCE);
+      return(do_space(first, second, min_sp, cacheable));
    }
 
-   // handle '::'
-   if (chunk_is_token(first, CT_DC_MEMBER))
+   if (  space_memo.empty()
+      || space_memo_lang != cpd.lang_flags
+      || space_memo_options != GenericOption::generation())
    {
-      // Add or remove space after the '::' operator.
-      log_rule("sp_after_dc");
-      return(options::sp_after_dc());
+      space_memo.assign(SPACE_MEMO_SIZE, space_memo_entry_t());
+      space_memo_lang    = cpd.lang_flags;
+      space_memo_options = GenericOption::generation();
    }
+   const space_context_t ctx    = space_context_of(first, second);
+   space_memo_entry_t    &entry = space_memo[hash_space_context(ctx)];
 
-   // Issue #889
-   // mapped_file_source abc((int) ::CW2A(sTemp));
-   if (  chunk_is_token(first, CT_PAREN_CLOSE)
-      && chunk_is_token(second, CT_DC_MEMBER)
-      && second->next != nullptr
-      && second->next->type == CT_FUNC_CALL)
+   if (  entry.used
+      && entry.context.tokens == ctx.tokens
+      && entry.context.flags == ctx.flags)
    {
-      log_rule("sp_after_cast");
-      return(options::sp_after_cast());
+      profile_cache("space", true);
+      min_sp = entry.min_sp;
+      return(entry.av);
    }
+   profile_cache("space", false);
+   iarf_e av = do_space(first, second, min_sp, cacheable);
 
-   if (chunk_is_token(second, CT_DC_MEMBER))
+   if (cacheable)
    {
-      /* '::' at the start of an identifier is not member access, but global scope operator.
-       * Detect if previous chunk is keyword
-       */
-      switch (first->type)
-      {
-      case CT_SBOOL:
-      case CT_SASSIGN:
-      case CT_ARITH:
-      case CT_CASE:
-      case CT_CLASS:
-      case CT_DELETE:
-      case CT_FRIEND:
-      case CT_NAMESPACE:
-      case CT_NEW:
-      case CT_SARITH:
-      case CT_SCOMPARE:
-      case CT_OPERATOR:
-      case CT_ACCESS:
-      case CT_QUALIFIER:
-      case CT_RETURN:
-      case CT_SIZEOF:
-      case CT_DECLTYPE:
-      case CT_STRUCT:
-      case CT_THROW:
-      case CT_TYPEDEF:
-      case CT_TYPENAME:
-      case CT_UNION:
-      case CT_USING:
-         log_rule("FORCE");
-         return(IARF_FORCE);
+      entry.context = ctx;
+      entry.av      = av;
+      entry.min_sp  = min_sp;
+      entry.used    = true;
+   }
+   return(av);
+} // do_space_cached
 
-      default:
-         break;
-      }
 
-      // Issue #1005
-      /* '::' at the start of an identifier is not member access, but global scope operator.
-       * Detect if previous chunk is a type and previous-previous is "friend"
-       */
-      if (  chunk_is_token(first, CT_TYPE)
-         && first->prev != nullptr
-         && (first->prev->type == CT_FRIEND && first->next->type != CT_DC_MEMBER))
-      {
-         log_rule("FORCE");
-         return(IARF_FORCE);
-      }
+/*
+ * this function is called for every chunk in the input file.
+ * Thus it is important to keep this function efficient
+ */
+//! the __COUNTER__ of the first SPACE_RULE
+static const UINT16 SPACE_RULE_FIRST = __COUNTER__ + 1;
 
-      if (  (  chunk_is_token(first, CT_WORD)
-            || chunk_is_token(first, CT_TYPE)
-            || chunk_is_token(first, CT_PAREN_CLOSE)
-            || CharTable::IsKw1(first->str[0]))
-         && (strcmp(first->text(), "void") != 0)) // Issue 1249
-      {
-         // Add or remove space before the '::' operator.
-         log_rule("sp_before_dc");
-         return(options::sp_before_dc());
-      }
-   }
 
-   // "a,b" vs "a, b"
-   if (chunk_is_token(first, CT_COMMA))
+static iarf_e do_space(chunk_t *first, chunk_t *second, int &min_sp, bool &cacheable)
+{
+   LOG_FUNC_ENTRY();
+
+   LOG_FMT(LSPACE, "%s(%d): orig_line is %zu, orig_col is %zu, first->text() '%s', type is %s\n",
+           __func__, __LINE__, first->orig_line, first->orig_col, first->text(), get_token_name(first->type));
+
+   min_sp    = 1;
+   cacheable = true;
+
+   // Try the rules for the types of the chunks in order, the first one that matches decides
+   for (size_t idx = space_rules_for(first, second); space_rules.rules[idx] != SPACE_RULE_END; idx++)
    {
-      if (get_chunk_parent_type(first) == CT_TYPE)
+      switch (space_rules.rules[idx])
       {
-         // C# multidimensional array type: ',,' vs ', ,' or ',]' vs ', ]'
-         if (chunk_is_token(second, CT_COMMA))
+         SPACE_RULE({ CT_IGNORED, CT_UNKNOWN },
+                    { CT_UNKNOWN, CT_IGNORED })
+
+         if (chunk_is_token(first, CT_IGNORED) || chunk_is_token(second, CT_IGNORED))
          {
-            // (C#) Add or remove space between ',' in multidimensional array type
-            // like 'int[,,]'.
-            log_rule("sp_between_mdatype_commas");
-            return(options::sp_between_mdatype_commas());
+            log_rule("REMOVE");
+            return(IARF_REMOVE);
          }
-         // (C#) Add or remove space between ',' and ']' in multidimensional array type
-         // like 'int[,,]'.
-         log_rule("sp_after_mdatype_commas");
-         return(options::sp_after_mdatype_commas());
-      }
+         break;
 
-      // Fix for issue #1243
-      // Don't add extra space after comma immediately followed by Angle close
-      if (chunk_is_token(second, CT_ANGLE_CLOSE))
-      {
-         log_rule("IGNORE");
-         return(IARF_IGNORE);
-      }
-      // Add or remove space after ',', i.e. 'a,b' vs. 'a, b'.
-      log_rule("sp_after_comma");
-      return(options::sp_after_comma());
-   }
+         SPACE_RULE({ CT_PP_IGNORE, CT_PP_IGNORE })
 
-   // test if we are within a SIGNAL/SLOT call
-   if (QT_SIGNAL_SLOT_found)
-   {
-      if (  chunk_is_token(first, CT_FPAREN_CLOSE)
-         && (chunk_is_token(second, CT_FPAREN_CLOSE) || chunk_is_token(second, CT_COMMA)))
-      {
-         if (second->level == QT_SIGNAL_SLOT_level)
+         if (chunk_is_token(first, CT_PP_IGNORE) && chunk_is_token(second, CT_PP_IGNORE))
          {
-            restoreValues = true;
+            // Leave spacing alone between PP_IGNORE tokens as we don't want the default behavior (which is ADD).
+            log_rule("PP_IGNORE");
+            return(IARF_IGNORE);
          }
-      }
-   }
+         break;
 
-   if (chunk_is_token(second, CT_COMMA))
-   {
-      if (chunk_is_token(first, CT_SQUARE_OPEN) && get_chunk_parent_type(first) == CT_TYPE)
-      {
-         // Only for C#.
-         // (C#) Add or remove space between '[' and ',' in multidimensional array type
-         // like 'int[,,]'.
-         log_rule("sp_before_mdatype_commas");
-         return(options::sp_before_mdatype_commas());
-      }
+         SPACE_RULE({ CT_PP, CT_UNKNOWN },
+                    { CT_UNKNOWN, CT_PP })
 
-      if (  chunk_is_token(first, CT_PAREN_OPEN)
-         && (options::sp_paren_comma() != IARF_IGNORE))
-      {
-         // Add or remove space between an open parenthesis and comma,
-         // i.e. '(,' vs. '( ,'.
-         log_rule("sp_paren_comma");
-         return(options::sp_paren_comma());
-      }
-      // Add or remove space before ','.
-      log_rule("sp_before_comma");
-      return(options::sp_before_comma());
-   }
+         if (chunk_is_token(first, CT_PP) || chunk_is_token(second, CT_PP))
+         {
+            // Add or remove space around preprocessor '##' concatenation operator.
+            log_rule("sp_pp_concat");
+            return(options::sp_pp_concat());
+         }
+         break;
 
-   if (chunk_is_token(second, CT_ELLIPSIS))
-   {
-      // type followed by a ellipsis
-      chunk_t *tmp = first;
+         SPACE_RULE({ CT_POUND, CT_UNKNOWN })
 
-      if (  chunk_is_token(tmp, CT_PTR_TYPE)
-         || chunk_is_token(tmp, CT_BYREF))
-      {
-         tmp = chunk_get_prev_ncnl(tmp);
-      }
+         if (chunk_is_token(first, CT_POUND))
+         {
+            // Add or remove space after preprocessor '#' stringify operator.
+            // Also affects the '#@' charizing operator.
+            log_rule("sp_pp_stringify");
+            return(options::sp_pp_stringify());
+         }
+         break;
 
-      if (  chunk_is_token(tmp, CT_TYPE)
-         || chunk_is_token(tmp, CT_QUALIFIER))
-      {
-         // Add or remove space between a type and '...'.
-         log_rule("sp_type_ellipsis");
-         return(options::sp_type_ellipsis());
-      }
+         SPACE_RULE({ CT_UNKNOWN, CT_POUND })
 
-      // non-punc followed by a ellipsis
-      if (  !first->flags.test(PCF_PUNCTUATOR)
-         && (options::sp_before_ellipsis() != IARF_IGNORE))
-      {
-         // Add or remove space before the variadic '...' when preceded by a
-         // non-punctuator.
-         log_rule("sp_before_ellipsis");
-         return(options::sp_before_ellipsis());
-      }
+         if (  chunk_is_token(second, CT_POUND)
+            && second->flags.test(PCF_IN_PREPROC)
+            && get_chunk_parent_type(first) != CT_MACRO_FUNC)
+         {
+            // Add or remove space before preprocessor '#' stringify operator
+            // as in '#define x(y) L#y'.
+            log_rule("sp_before_pp_stringify");
+            return(options::sp_before_pp_stringify());
+         }
+         break;
 
-      if (  chunk_is_token(first, CT_FPAREN_CLOSE)
-         || chunk_is_token(first, CT_PAREN_CLOSE))
-      {
-         // Add or remove space between ')' and '...'.
-         log_rule("sp_paren_ellipsis");
-         return(options::sp_paren_ellipsis());
-      }
+         SPACE_RULE({ CT_SPACE, CT_UNKNOWN },
+                    { CT_UNKNOWN, CT_SPACE })
 
-      if (chunk_is_token(first, CT_TAG_COLON))
-      {
-         log_rule("FORCE");
-         return(IARF_FORCE);
-      }
-   }
+         if (chunk_is_token(first, CT_SPACE) || chunk_is_token(second, CT_SPACE))
+         {
+            log_rule("REMOVE");
+            return(IARF_REMOVE);
+         }
+         break;
 
-   if (chunk_is_token(first, CT_ELLIPSIS))
-   {
-      if (CharTable::IsKw1(second->str[0]))
-      {
-         log_rule("FORCE");
-         return(IARF_FORCE);
-      }
+         SPACE_RULE({ CT_DECLSPEC, CT_UNKNOWN })
 
-      if (  chunk_is_token(second, CT_PAREN_OPEN)
-         && first->prev && chunk_is_token(first->prev, CT_SIZEOF))
-      {
-         // Add or remove space between 'sizeof...' and '('.
-         log_rule("sp_sizeof_ellipsis_paren");
-         return(options::sp_sizeof_ellipsis_paren());
-      }
-   }
+         if (chunk_is_token(first, CT_DECLSPEC))  // Issue 1289
+         {
+            log_rule("REMOVE");
+            return(IARF_REMOVE);
+         }
+         break;
 
-   if (chunk_is_token(first, CT_TAG_COLON))
-   {
-      // (Pawn) Add or remove space after the tag keyword.
-      log_rule("sp_after_tag");
-      return(options::sp_after_tag());
-   }
+         SPACE_RULE({ CT_UNKNOWN, CT_NEWLINE },
+                    { CT_UNKNOWN, CT_VBRACE_OPEN })
 
-   if (chunk_is_token(second, CT_TAG_COLON))
-   {
-      log_rule("REMOVE");
-      return(IARF_REMOVE);
-   }
+         if (chunk_is_token(second, CT_NEWLINE) || chunk_is_token(second, CT_VBRACE_OPEN))
+         {
+            log_rule("REMOVE");
+            return(IARF_REMOVE);
+         }
+         break;
 
-   // handle '~'
-   if (chunk_is_token(first, CT_DESTRUCTOR))
-   {
-      log_rule("REMOVE");
-      return(IARF_REMOVE);
-   }
+         SPACE_RULE({ CT_VBRACE_OPEN, CT_UNKNOWN })
 
-   if (  language_is_set(LANG_OC)
-      && chunk_is_token(first, CT_CATCH)
-      && chunk_is_token(second, CT_SPAREN_OPEN)
-      && (options::sp_oc_catch_paren() != IARF_IGNORE))
-   {
-      // (OC) Add or remove space between '@catch' and '('
-      // in '@catch (something) { }'. If set to ignore, sp_catch_paren is used.
-      log_rule("sp_oc_catch_paren");
-      return(options::sp_oc_catch_paren());
-   }
+         if (  chunk_is_token(first, CT_VBRACE_OPEN)
+            && second->type != CT_NL_CONT
+            && second->type != CT_SEMICOLON) // # Issue 1158
+         {
+            log_rule("FORCE");
+            return(IARF_FORCE);
+         }
+         break;
 
-   if (  language_is_set(LANG_OC)
-      && (chunk_is_token(first, CT_PAREN_CLOSE) || chunk_is_token(first, CT_OC_CLASS) || chunk_is_token(first, CT_WORD))
-      && chunk_is_token(second, CT_ANGLE_OPEN)
-      && (get_chunk_parent_type(second) == CT_OC_PROTO_LIST || get_chunk_parent_type(second) == CT_OC_GENERIC_SPEC)
-      && (options::sp_before_oc_proto_list() != IARF_IGNORE))
-   {
-      // (OC) Add or remove space before Objective-C protocol list
-      // as in '@protocol Protocol<here><Protocol_A>' or '@interface MyClass : NSObject<here><MyProtocol>'.
-      log_rule("sp_before_oc_proto_list");
-      return(options::sp_before_oc_proto_list());
-   }
+         SPACE_RULE({ CT_VBRACE_CLOSE, CT_UNKNOWN })
 
-   if (  language_is_set(LANG_OC)
-      && chunk_is_token(first, CT_OC_CLASS)
-      && chunk_is_token(second, CT_PAREN_OPEN)
-      && (options::sp_oc_classname_paren() != IARF_IGNORE))
-   {
-      // (OC) Add or remove space between class name and '('
-      // in '@interface className(categoryName)<ProtocolName>:BaseClass'
-      log_rule("sp_oc_classname_paren");
-      return(options::sp_oc_classname_paren());
-   }
+         if (chunk_is_token(first, CT_VBRACE_CLOSE) && second->type != CT_NL_CONT)
+         {
+            log_rule("REMOVE");
+            return(IARF_REMOVE);
+         }
+         break;
 
-   if (  chunk_is_token(first, CT_CATCH)
-      && chunk_is_token(second, CT_SPAREN_OPEN)
-      && (options::sp_catch_paren() != IARF_IGNORE))
-   {
-      // Add or remove space between 'catch' and '(' in 'catch (something) { }'.
-      // If set to ignore, sp_before_sparen is used.
-      log_rule("sp_catch_paren");
-      return(options::sp_catch_paren());
-   }
+         SPACE_RULE({ CT_UNKNOWN, CT_VSEMICOLON })
 
-   if (  chunk_is_token(first, CT_D_VERSION_IF)
-      && chunk_is_token(second, CT_SPAREN_OPEN)
-      && (options::sp_version_paren() != IARF_IGNORE))
-   {
-      // (D) Add or remove space between 'version' and '('
-      // in 'version (something) { }'. If set to ignore, sp_before_sparen is used.
-      log_rule("sp_version_paren");
-      return(options::sp_version_paren());
-   }
+         if (chunk_is_token(second, CT_VSEMICOLON))
+         {
+            log_rule("REMOVE");
+            return(IARF_REMOVE);
+         }
+         break;
 
-   if (  chunk_is_token(first, CT_D_SCOPE_IF)
-      && chunk_is_token(second, CT_SPAREN_OPEN)
-      && (options::sp_scope_paren() != IARF_IGNORE))
-   {
-      // (D) Add or remove space between 'scope' and '('
-      // in 'scope (something) { }'. If set to ignore, sp_before_sparen is used.
-      log_rule("sp_scope_paren");
-      return(options::sp_scope_paren());
-   }
+         SPACE_RULE({ CT_MACRO_FUNC, CT_UNKNOWN })
 
-   if (  language_is_set(LANG_OC)
-      && chunk_is_token(first, CT_SYNCHRONIZED) && chunk_is_token(second, CT_SPAREN_OPEN))
-   {
-      // (OC) Add or remove space between '@synchronized' and the open parenthesis,
-      // i.e. '@synchronized(foo)' vs. '@synchronized (foo)'.
-      log_rule("sp_after_oc_synchronized");
-      return(options::sp_after_oc_synchronized());
-   }
+         if (chunk_is_token(first, CT_MACRO_FUNC))
+         {
+            log_rule("REMOVE");
+            return(IARF_REMOVE);
+         }
+         break;
 
-   // "if (" vs "if("
-   if (chunk_is_token(second, CT_SPAREN_OPEN))
-   {
-      // Add or remove space before '(' of control statements ('if', 'for', 'switch',
-      // 'while', etc.).
-      log_rule("sp_before_sparen");
-      return(options::sp_before_sparen());
-   }
+         SPACE_RULE({ CT_UNKNOWN, CT_NL_CONT })
 
-   if (chunk_is_token(first, CT_LAMBDA) || chunk_is_token(second, CT_LAMBDA))
-   {
-      log_rule("sp_assign (lambda)");
-      return(options::sp_assign());
-   }
+         if (chunk_is_token(second, CT_NL_CONT))
+         {
+            // Add or remove space before a backslash-newline at the end of a line.
+            log_rule("sp_before_nl_cont");
+            return(options::sp_before_nl_cont());
+         }
+         break;
+
+         SPACE_RULE({ CT_D_ARRAY_COLON, CT_UNKNOWN },
+                    { CT_UNKNOWN, CT_D_ARRAY_COLON })
+
+         if (chunk_is_token(first, CT_D_ARRAY_COLON) || chunk_is_token(second, CT_D_ARRAY_COLON))
+         {
+            // (D) Add or remove around the D named array initializer ':' operator.
+            log_rule("sp_d_array_colon");
+            return(options::sp_d_array_colon());
+         }
+         break;
+
+         SPACE_RULE({ CT_CASE, CT_UNKNOWN })
+
+         cacheable = false;
+
+         if (  chunk_is_token(first, CT_CASE)
+            && ((CharTable::IsKw1(second->str[0]) || chunk_is_token(second, CT_NUMBER))))
+         {
+            // Fix the spacing between 'case' and the label. Only 'ignore' and 'force' make
+            // sense here.
+            log_rule("sp_case_label");
+            return(options::sp_case_label() | IARF_ADD);
+         }
+         break;
+
+         SPACE_RULE({ CT_FOR_COLON, CT_UNKNOWN })
+
+         if (chunk_is_token(first, CT_FOR_COLON))
+         {
+            // java
+            // Add or remove space after ':' in a Java/C++11 range-based 'for',
+            // as in 'for (Type var : expr)'.
+            log_rule("sp_after_for_colon");
+            return(options::sp_after_for_colon());
+         }
+         break;
+
+         SPACE_RULE({ CT_UNKNOWN, CT_FOR_COLON })
+
+         if (chunk_is_token(second, CT_FOR_COLON))
+         {
+            // java
+            // Add or remove space before ':' in a Java/C++11 range-based 'for',
+            // as in 'for (Type var : expr)'.
+            log_rule("sp_before_for_colon");
+            return(options::sp_before_for_colon());
+         }
+         break;
+
+         SPACE_RULE({ CT_QUESTION, CT_COND_COLON })
+
+         if (chunk_is_token(first, CT_QUESTION) && chunk_is_token(second, CT_COND_COLON))
+         {
+            if (options::sp_cond_ternary_short() != IARF_IGNORE)
+            {
+               // In the abbreviated ternary form '(a ?: b)', add or remove space between '?'
+               // and ':'.
+               // Overrides all other sp_cond_* options.
+               log_rule("sp_cond_ternary_short");
+               return(options::sp_cond_ternary_short());
+            }
+         }
+         break;
+
+         SPACE_RULE({ CT_QUESTION, CT_UNKNOWN },
+                    { CT_UNKNOWN, CT_QUESTION })
+
+         if (chunk_is_token(first, CT_QUESTION) || chunk_is_token(second, CT_QUESTION))
+         {
+            if (  chunk_is_token(second, CT_QUESTION)
+               && (options::sp_cond_question_before() != IARF_IGNORE))
+            {
+               // Add or remove space before the '?' in 'b ? t : f'.
+               // Overrides sp_cond_question.
+               log_rule("sp_cond_question_before");
+               return(options::sp_cond_question_before());
+            }
+
+            if (  chunk_is_token(first, CT_QUESTION)
+               && (options::sp_cond_question_after() != IARF_IGNORE))
+            {
+               // Add or remove space after the '?' in 'b ? t : f'.
+               // Overrides sp_cond_question.
+               log_rule("sp_cond_question_after");
+               return(options::sp_cond_question_after());
+            }
+            // Issue #2596
+            // Add or remove space around the '?' in 'b ? t : f'.
+            // replace "if (chunk_is_token(first, CT_PAREN_CLOSE) && chunk_is_token(second, CT_QUESTION))"
+            log_rule("sp_cond_question");
+            return(options::sp_cond_question());
+         }
+         break;
+
+         SPACE_RULE({ CT_COND_COLON, CT_UNKNOWN },
+                    { CT_UNKNOWN, CT_COND_COLON })
+
+         if (chunk_is_token(first, CT_COND_COLON) || chunk_is_token(second, CT_COND_COLON))
+         {
+            if (  chunk_is_token(second, CT_COND_COLON)
+               && (options::sp_cond_colon_before() != IARF_IGNORE))
+            {
+               // Add or remove space before the ':' in 'b ? t : f'.
+               // Overrides sp_cond_colon.
+               log_rule("sp_cond_colon_before");
+               return(options::sp_cond_colon_before());
+            }
+
+            if (  chunk_is_token(first, CT_COND_COLON)
+               && (options::sp_cond_colon_after() != IARF_IGNORE))
+            {
+               // Add or remove space after the ':' in 'b ? t : f'.
+               // Overrides sp_cond_colon.
+               log_rule("sp_cond_colon_after");
+               return(options::sp_cond_colon_after());
+            }
+            // Issue #2596
+            // replace "if (chunk_is_token(first, CT_WORD) && chunk_is_token(second, CT_COND_COLON))"
+            // Add or remove space around the ':' in 'b ? t : f'.
+            log_rule("sp_cond_colon");
+            return(options::sp_cond_colon());
+         }
+         break;
+
+         SPACE_RULE({ CT_RANGE, CT_UNKNOWN },
+                    { CT_UNKNOWN, CT_RANGE })
+
+         if (chunk_is_token(first, CT_RANGE) || chunk_is_token(second, CT_RANGE))
+         {
+            // (D) Add or remove space around the D '..' operator.
+            log_rule("sp_range");
+            return(options::sp_range());
+         }
+         break;
+
+         SPACE_RULE({ CT_COLON, CT_UNKNOWN })
+
+         if (chunk_is_token(first, CT_COLON) && get_chunk_parent_type(first) == CT_SQL_EXEC)
+         {
+            log_rule("REMOVE");
+            return(IARF_REMOVE);
+         }
+         break;
+
+         SPACE_RULE({ CT_MACRO, CT_UNKNOWN })
+
+         // Macro stuff can only return IGNORE, ADD, or FORCE
+         if (chunk_is_token(first, CT_MACRO))
+         {
+            // Add or remove space between a macro name and its definition.
+            log_rule("sp_macro");
+            iarf_e arg = options::sp_macro();
+            return(arg | ((arg != IARF_IGNORE) ? IARF_ADD : IARF_IGNORE));
+         }
+         break;
+
+         SPACE_RULE({ CT_FPAREN_CLOSE, CT_UNKNOWN })
+
+         if (chunk_is_token(first, CT_FPAREN_CLOSE) && get_chunk_parent_type(first) == CT_MACRO_FUNC)
+         {
+            // Add or remove space between a macro function ')' and its definition.
+            log_rule("sp_macro_func");
+            iarf_e arg = options::sp_macro_func();
+            return(arg | ((arg != IARF_IGNORE) ? IARF_ADD : IARF_IGNORE));
+         }
+         break;
+
+         SPACE_RULE({ CT_PREPROC, CT_UNKNOWN })
+
+         if (chunk_is_token(first, CT_PREPROC))
+         {
+            // Remove spaces, unless we are ignoring. See indent_preproc()
+            if (options::pp_space() == IARF_IGNORE)
+            {
+               log_rule("pp_space");
+               log_rule("IGNORE");
+               return(IARF_IGNORE);
+            }
+            log_rule("REMOVE");
+            return(IARF_REMOVE);
+         }
+         break;
+
+         SPACE_RULE({ CT_UNKNOWN, CT_SEMICOLON })
+
+         if (chunk_is_token(second, CT_SEMICOLON))
+         {
+            if (get_chunk_parent_type(second) == CT_FOR)
+            {
+               if (  chunk_is_token(first, CT_SPAREN_OPEN) // a
+                  || chunk_is_token(first, CT_SEMICOLON))  // b
+               {
+                  // empty, ie for (;;)
+                  //               ^ is first    // a
+                  //                ^ is second  // a
+                  // or
+                  //                ^ is first   // b
+                  //                 ^ is second // b
+                  // Add or remove space before a semicolon of an empty part of a for statement.
+                  log_rule("sp_before_semi_for_empty");
+                  return(options::sp_before_semi_for_empty());
+               }
+
+               if (options::sp_before_semi_for() != IARF_IGNORE)
+               {
+                  // Add or remove space before ';' in non-empty 'for' statements.
+                  log_rule("sp_before_semi_for");
+                  return(options::sp_before_semi_for());
+               }
+            }
+            iarf_e arg = options::sp_before_semi();
+
+            if (  chunk_is_token(first, CT_SPAREN_CLOSE)
+               && get_chunk_parent_type(first) != CT_WHILE_OF_DO)
+            {
+               // Add or remove space before empty statement ';' on 'if', 'for' and 'while'.
+               log_rule("sp_before_semi|sp_special_semi");
+               arg = arg | options::sp_special_semi();
+            }
+            else
+            {
+               // Add or remove space before ';'.
+               log_rule("sp_before_semi");
+            }
+            return(arg);
+         }
+         break;
+
+         SPACE_RULE({ CT_PP_ELSE, CT_COMMENT },
+                    { CT_PP_ENDIF, CT_COMMENT },
+                    { CT_PP_ELSE, CT_COMMENT_CPP },
+                    { CT_PP_ENDIF, CT_COMMENT_CPP })
+
+         cacheable = false;
+
+         if (  (  chunk_is_token(second, CT_COMMENT)
+               || chunk_is_token(second, CT_COMMENT_CPP))
+            && (  chunk_is_token(first, CT_PP_ELSE)
+               || chunk_is_token(first, CT_PP_ENDIF)))
+         {
+            if (options::sp_endif_cmt() != IARF_IGNORE)
+            {
+               set_chunk_type(second, CT_COMMENT_ENDIF);
+               // Add or remove space between #else or #endif and a trailing comment.
+               log_rule("sp_endif_cmt");
+               return(options::sp_endif_cmt());
+            }
+         }
+         break;
+
+         SPACE_RULE({ CT_UNKNOWN, CT_UNKNOWN })
+
+         if (  (options::sp_before_tr_emb_cmt() != IARF_IGNORE)
+            && (  get_chunk_parent_type(second) == CT_COMMENT_END
+               || get_chunk_parent_type(second) == CT_COMMENT_EMBED))
+         {
+            // Add or remove space before a trailing or embedded comment.
+            // Number of spaces before a trailing or embedded comment.
+            log_rule("sp_num_before_tr_emb_cmt");
+            min_sp = options::sp_num_before_tr_emb_cmt();
+            return(options::sp_before_tr_emb_cmt());
+         }
+         break;
+
+         SPACE_RULE({ CT_UNKNOWN, CT_UNKNOWN })
+
+         if (get_chunk_parent_type(second) == CT_COMMENT_END)
+         {
+            cacheable = false;
+
+            switch (second->orig_prev_sp)
+            {
+            case 0:
+               log_rule("orig_prev_sp-REMOVE");
+               return(IARF_REMOVE);
+
+            case 1:
+               log_rule("orig_prev_sp-FORCE");
+               return(IARF_FORCE);
+
+            default:
+               log_rule("orig_prev_sp-ADD");
+               return(IARF_ADD);
+            }
+         }
+         break;
+
+         SPACE_RULE({ CT_SEMICOLON, CT_UNKNOWN })
+
+         // "for (;;)" vs "for (;; )" and "for (a;b;c)" vs "for (a; b; c)"
+         if (chunk_is_token(first, CT_SEMICOLON))
+         {
+            if (get_chunk_parent_type(first) == CT_FOR)
+            {
+               if (  (options::sp_after_semi_for_empty() != IARF_IGNORE)
+                  && chunk_is_token(second, CT_SPAREN_CLOSE))
+               {
+                  // Add or remove space after the final semicolon of an empty part of a for
+                  // statement, as in 'for ( ; ; <here> )'.
+                  log_rule("sp_after_semi_for_empty");
+                  return(options::sp_after_semi_for_empty());
+               }
+
+               if (  (options::sp_after_semi_for() != IARF_IGNORE)
+                  && second->type != CT_SPAREN_CLOSE)  // Issue 1324
+               {
+                  // Add or remove space after ';' in non-empty 'for' statements.
+                  log_rule("sp_after_semi_for");
+                  return(options::sp_after_semi_for());
+               }
+            }
+            else if (!chunk_is_comment(second) && second->type != CT_BRACE_CLOSE) // issue #197
+            {
+               // Add or remove space after ';', except when followed by a comment.
+               log_rule("sp_after_semi");
+               return(options::sp_after_semi());
+            }
+            // Let the comment spacing rules handle this
+         }
+         break;
+
+         SPACE_RULE({ CT_NEG, CT_NEG },
+                    { CT_NEG, CT_POS },
+                    { CT_NEG, CT_ARITH },
+                    { CT_POS, CT_NEG },
+                    { CT_POS, CT_POS },
+                    { CT_POS, CT_ARITH },
+                    { CT_ARITH, CT_NEG },
+                    { CT_ARITH, CT_POS },
+                    { CT_ARITH, CT_ARITH })
+
+         // puts a space in the rare '+-' or '-+'
+         if (  (  chunk_is_token(first, CT_NEG)
+               || chunk_is_token(first, CT_POS)
+               || chunk_is_token(first, CT_ARITH))
+            && (  chunk_is_token(second, CT_NEG)
+               || chunk_is_token(second, CT_POS)
+               || chunk_is_token(second, CT_ARITH)))
+         {
+            log_rule("ADD");
+            return(IARF_ADD);
+         }
+         break;
+
+         SPACE_RULE({ CT_RETURN, CT_UNKNOWN })
+
+         // "return(a);" vs "return (foo_t)a + 3;" vs "return a;" vs "return;"
+         if (chunk_is_token(first, CT_RETURN))
+         {
+            if (  chunk_is_token(second, CT_PAREN_OPEN)
+               && get_chunk_parent_type(second) == CT_RETURN)
+            {
+               // Add or remove space between 'return' and '('.
+               log_rule("sp_return_paren");
+               return(options::sp_return_paren());
+            }
+            else if (  chunk_is_token(second, CT_BRACE_OPEN)
+                    && get_chunk_parent_type(second) == CT_BRACED_INIT_LIST)
+            {
+               // Add or remove space between 'return' and '{'.
+               log_rule("sp_return_brace");
+               return(options::sp_return_brace());
+            }
+            // everything else requires a space
+            log_rule("FORCE");
+            return(IARF_FORCE);
+         }
+         break;
+
+         SPACE_RULE({ CT_SIZEOF, CT_UNKNOWN })
+
+         // "sizeof(foo_t)" vs "sizeof (foo_t)"
+         if (chunk_is_token(first, CT_SIZEOF))
+         {
+            if (chunk_is_token(second, CT_PAREN_OPEN))
+            {
+               // Add or remove space between 'sizeof' and '('.
+               log_rule("sp_sizeof_paren");
+               return(options::sp_sizeof_paren());
+            }
+
+            if (chunk_is_token(second, CT_ELLIPSIS))
+            {
+               // Add or remove space between 'sizeof' and '...'.
+               log_rule("sp_sizeof_ellipsis");
+               return(options::sp_sizeof_ellipsis());
+            }
+            log_rule("FORCE");
+            return(IARF_FORCE);
+         }
+         break;
+
+         SPACE_RULE({ CT_DECLTYPE, CT_UNKNOWN })
+
+         // "decltype(foo_t)" vs "decltype (foo_t)"
+         if (chunk_is_token(first, CT_DECLTYPE))
+         {
+            if (chunk_is_token(second, CT_PAREN_OPEN))
+            {
+               // Add or remove space between 'decltype' and '('.
+               log_rule("sp_decltype_paren");
+               return(options::sp_decltype_paren());
+            }
+            log_rule("FORCE");
+            return(IARF_FORCE);
+         }
+         break;
+
+         SPACE_RULE({ CT_DC_MEMBER, CT_UNKNOWN })
+
+         // handle '::'
+         if (chunk_is_token(first, CT_DC_MEMBER))
+         {
+            // Add or remove space after the '::' operator.
+            log_rule("sp_after_dc");
+            return(options::sp_after_dc());
+         }
+         break;
+
+         SPACE_RULE({ CT_PAREN_CLOSE, CT_DC_MEMBER })
+
+         cacheable = false;
+
+         // Issue #889
+         // mapped_file_source abc((int) ::CW2A(sTemp));
+         if (  chunk_is_token(first, CT_PAREN_CLOSE)
+            && chunk_is_token(second, CT_DC_MEMBER)
+            && second->next != nullptr
+            && second->next->type == CT_FUNC_CALL)
+         {
+            log_rule("sp_after_cast");
+            return(options::sp_after_cast());
+         }
+         break;
+
+         SPACE_RULE({ CT_UNKNOWN, CT_DC_MEMBER })
+
+         cacheable = false;
+
+         if (chunk_is_token(second, CT_DC_MEMBER))
+         {
+            /* '::' at the start of an identifier is not member access, but global scope operator.
+             * Detect if previous chunk is keyword
+             */
+            switch (first->type)
+            {
+            case CT_SBOOL:
+            case CT_SASSIGN:
+            case CT_ARITH:
+            case CT_CASE:
+            case CT_CLASS:
+            case CT_DELETE:
+            case CT_FRIEND:
+            case CT_NAMESPACE:
+            case CT_NEW:
+            case CT_SARITH:
+            case CT_SCOMPARE:
+            case CT_OPERATOR:
+            case CT_ACCESS:
+            case CT_QUALIFIER:
+            case CT_RETURN:
+            case CT_SIZEOF:
+            case CT_DECLTYPE:
+            case CT_STRUCT:
+            case CT_THROW:
+            case CT_TYPEDEF:
+            case CT_TYPENAME:
+            case CT_UNION:
+            case CT_USING:
+               log_rule("FORCE");
+               return(IARF_FORCE);
+
+            default:
+               break;
+            }
+
+            // Issue #1005
+            /* '::' at the start of an identifier is not member access, but global scope operator.
+             * Detect if previous chunk is a type and previous-previous is "friend"
+             */
+            if (  chunk_is_token(first, CT_TYPE)
+               && first->prev != nullptr
+               && (first->prev->type == CT_FRIEND && first->next->type != CT_DC_MEMBER))
+            {
+               log_rule("FORCE");
+               return(IARF_FORCE);
+            }
+
+            if (  (  chunk_is_token(first, CT_WORD)
+                  || chunk_is_token(first, CT_TYPE)
+                  || chunk_is_token(first, CT_PAREN_CLOSE)
+                  || CharTable::IsKw1(first->str[0]))
+               && (strcmp(first->text(), "void") != 0)) // Issue 1249
+            {
+               // Add or remove space before the '::' operator.
+               log_rule("sp_before_dc");
+               return(options::sp_before_dc());
+            }
+         }
+         break;
+
+         SPACE_RULE({ CT_COMMA, CT_UNKNOWN })
+
+         // "a,b" vs "a, b"
+         if (chunk_is_token(first, CT_COMMA))
+         {
+            if (get_chunk_parent_type(first) == CT_TYPE)
+            {
+               // C# multidimensional array type: ',,' vs ', ,' or ',]' vs ', ]'
+               if (chunk_is_token(second, CT_COMMA))
+               {
+                  // (C#) Add or remove space between ',' in multidimensional array type
+                  // like 'int[,,]'.
+                  log_rule("sp_between_mdatype_commas");
+                  return(options::sp_between_mdatype_commas());
+               }
+               // (C#) Add or remove space between ',' and ']' in multidimensional array type
+               // like 'int[,,]'.
+               log_rule("sp_after_mdatype_commas");
+               return(options::sp_after_mdatype_commas());
+            }
+
+            // Fix for issue #1243
+            // Don't add extra space after comma immediately followed by Angle close
+            if (chunk_is_token(second, CT_ANGLE_CLOSE))
+            {
+               log_rule("IGNORE");
+               return(IARF_IGNORE);
+            }
+            // Add or remove space after ',', i.e. 'a,b' vs. 'a, b'.
+            log_rule("sp_after_comma");
+            return(options::sp_after_comma());
+         }
+         break;
+
+         SPACE_RULE({ CT_UNKNOWN, CT_UNKNOWN })
+
+         // test if we are within a SIGNAL/SLOT call
+         if (QT_SIGNAL_SLOT_found)
+         {
+            cacheable = false;
+
+            if (  chunk_is_token(first, CT_FPAREN_CLOSE)
+               && (chunk_is_token(second, CT_FPAREN_CLOSE) || chunk_is_token(second, CT_COMMA)))
+            {
+               if (second->level == QT_SIGNAL_SLOT_level)
+               {
+                  restoreValues = true;
+               }
+            }
+         }
+         break;
+
+         SPACE_RULE({ CT_UNKNOWN, CT_COMMA })
+
+         if (chunk_is_token(second, CT_COMMA))
+         {
+            if (chunk_is_token(first, CT_SQUARE_OPEN) && get_chunk_parent_type(first) == CT_TYPE)
+            {
+               // Only for C#.
+               // (C#) Add or remove space between '[' and ',' in multidimensional array type
+               // like 'int[,,]'.
+               log_rule("sp_before_mdatype_commas");
+               return(options::sp_before_mdatype_commas());
+            }
+
+            if (  chunk_is_token(first, CT_PAREN_OPEN)
+               && (options::sp_paren_comma() != IARF_IGNORE))
+            {
+               // Add or remove space between an open parenthesis and comma,
+               // i.e. '(,' vs. '( ,'.
+               log_rule("sp_paren_comma");
+               return(options::sp_paren_comma());
+            }
+            // Add or remove space before ','.
+            log_rule("sp_before_comma");
+            return(options::sp_before_comma());
+         }
+         break;
+
+         SPACE_RULE({ CT_UNKNOWN, CT_ELLIPSIS })
+
+         cacheable = false;
+
+         if (chunk_is_token(second, CT_ELLIPSIS))
+         {
+            // type followed by a ellipsis
+            chunk_t *tmp = first;
+
+            if (  chunk_is_token(tmp, CT_PTR_TYPE)
+               || chunk_is_token(tmp, CT_BYREF))
+            {
+               tmp = chunk_get_prev_ncnl(tmp);
+            }
+
+            if (  chunk_is_token(tmp, CT_TYPE)
+               || chunk_is_token(tmp, CT_QUALIFIER))
+            {
+               // Add or remove space between a type and '...'.
+               log_rule("sp_type_ellipsis");
+               return(options::sp_type_ellipsis());
+            }
+
+            // non-punc followed by a ellipsis
+            if (  !first->flags.test(PCF_PUNCTUATOR)
+               && (options::sp_before_ellipsis() != IARF_IGNORE))
+            {
+               // Add or remove space before the variadic '...' when preceded by a
+               // non-punctuator.
+               log_rule("sp_before_ellipsis");
+               return(options::sp_before_ellipsis());
+            }
+
+            if (  chunk_is_token(first, CT_FPAREN_CLOSE)
+               || chunk_is_token(first, CT_PAREN_CLOSE))
+            {
+               // Add or remove space between ')' and '...'.
+               log_rule("sp_paren_ellipsis");
+               return(options::sp_paren_ellipsis());
+            }
+
+            if (chunk_is_token(first, CT_TAG_COLON))
+            {
+               log_rule("FORCE");
+               return(IARF_FORCE);
+            }
+         }
+         break;
+
+         SPACE_RULE({ CT_ELLIPSIS, CT_UNKNOWN })
+
+         cacheable = false;
+
+         if (chunk_is_token(first, CT_ELLIPSIS))
+         {
+            if (CharTable::IsKw1(second->str[0]))
+            {
+               log_rule("FORCE");
+               return(IARF_FORCE);
+            }
+
+            if (  chunk_is_token(second, CT_PAREN_OPEN)
+               && first->prev && chunk_is_token(first->prev, CT_SIZEOF))
+            {
+               // Add or remove space between 'sizeof...' and '('.
+               log_rule("sp_sizeof_ellipsis_paren");
+               return(options::sp_sizeof_ellipsis_paren());
+            }
+         }
+         break;
+
+         SPACE_RULE({ CT_TAG_COLON, CT_UNKNOWN })
+
+         if (chunk_is_token(first, CT_TAG_COLON))
+         {
+            // (Pawn) Add or remove space after the tag keyword.
+            log_rule("sp_after_tag");
+            return(options::sp_after_tag());
+         }
+         break;
+
+         SPACE_RULE({ CT_UNKNOWN, CT_TAG_COLON })
+
+         if (chunk_is_token(second, CT_TAG_COLON))
+         {
+            log_rule("REMOVE");
+            return(IARF_REMOVE);
+         }
+         break;
+
+         SPACE_RULE({ CT_DESTRUCTOR, CT_UNKNOWN })
+
+         // handle '~'
+         if (chunk_is_token(first, CT_DESTRUCTOR))
+         {
+            log_rule("REMOVE");
+            return(IARF_REMOVE);
+         }
+         break;
+
+         SPACE_RULE({ CT_CATCH, CT_SPAREN_OPEN })
+
+         if (  language_is_set(LANG_OC)
+            && chunk_is_token(first, CT_CATCH)
+            && chunk_is_token(second, CT_SPAREN_OPEN)
+            && (options::sp_oc_catch_paren() != IARF_IGNORE))
+         {
+            // (OC) Add or remove space between '@catch' and '('
+            // in '@catch (something) { }'. If set to ignore, sp_catch_paren is used.
+            log_rule("sp_oc_catch_paren");
+            return(options::sp_oc_catch_paren());
+         }
+         break;
+
+         SPACE_RULE({ CT_PAREN_CLOSE, CT_ANGLE_OPEN },
+                    { CT_OC_CLASS, CT_ANGLE_OPEN },
+                    { CT_WORD, CT_ANGLE_OPEN })
+
+         if (  language_is_set(LANG_OC)
+            && (chunk_is_token(first, CT_PAREN_CLOSE) || chunk_is_token(first, CT_OC_CLASS) || chunk_is_token(first, CT_WORD))
+            && chunk_is_token(second, CT_ANGLE_OPEN)
+            && (get_chunk_parent_type(second) == CT_OC_PROTO_LIST || get_chunk_parent_type(second) == CT_OC_GENERIC_SPEC)
+            && (options::sp_before_oc_proto_list() != IARF_IGNORE))
+         {
+            // (OC) Add or remove space before Objective-C protocol list
+            // as in '@protocol Protocol<here><Protocol_A>' or '@interface MyClass : NSObject<here><MyProtocol>'.
+            log_rule("sp_before_oc_proto_list");
+            return(options::sp_before_oc_proto_list());
+         }
+         break;
+
+         SPACE_RULE({ CT_OC_CLASS, CT_PAREN_OPEN })
+
+         if (  language_is_set(LANG_OC)
+            && chunk_is_token(first, CT_OC_CLASS)
+            && chunk_is_token(second, CT_PAREN_OPEN)
+            && (options::sp_oc_classname_paren() != IARF_IGNORE))
+         {
+            // (OC) Add or remove space between class name and '('
+            // in '@interface className(categoryName)<ProtocolName>:BaseClass'
+            log_rule("sp_oc_classname_paren");
+            return(options::sp_oc_classname_paren());
+         }
+         break;
+
+         SPACE_RULE({ CT_CATCH, CT_SPAREN_OPEN })
+
+         if (  chunk_is_token(first, CT_CATCH)
+            && chunk_is_token(second, CT_SPAREN_OPEN)
+            && (options::sp_catch_paren() != IARF_IGNORE))
+         {
+            // Add or remove space between 'catch' and '(' in 'catch (something) { }'.
+            // If set to ignore, sp_before_sparen is used.
+            log_rule("sp_catch_paren");
+            return(options::sp_catch_paren());
+         }
+         break;
+
+         SPACE_RULE({ CT_D_VERSION_IF, CT_SPAREN_OPEN })
+
+         if (  chunk_is_token(first, CT_D_VERSION_IF)
+            && chunk_is_token(second, CT_SPAREN_OPEN)
+            && (options::sp_version_paren() != IARF_IGNORE))
+         {
+            // (D) Add or remove space between 'version' and '('
+            // in 'version (something) { }'. If set to ignore, sp_before_sparen is used.
+            log_rule("sp_version_paren");
+            return(options::sp_version_paren());
+         }
+         break;
+
+         SPACE_RULE({ CT_D_SCOPE_IF, CT_SPAREN_OPEN })
+
+         if (  chunk_is_token(first, CT_D_SCOPE_IF)
+            && chunk_is_token(second, CT_SPAREN_OPEN)
+            && (options::sp_scope_paren() != IARF_IGNORE))
+         {
+            // (D) Add or remove space between 'scope' and '('
+            // in 'scope (something) { }'. If set to ignore, sp_before_sparen is used.
+            log_rule("sp_scope_paren");
+            return(options::sp_scope_paren());
+         }
+         break;
+
+         SPACE_RULE({ CT_SYNCHRONIZED, CT_SPAREN_OPEN })
+
+         if (  language_is_set(LANG_OC)
+            && chunk_is_token(first, CT_SYNCHRONIZED) && chunk_is_token(second, CT_SPAREN_OPEN))
+         {
+            // (OC) Add or remove space between '@synchronized' and the open parenthesis,
+            // i.e. '@synchronized(foo)' vs. '@synchronized (foo)'.
+            log_rule("sp_after_oc_synchronized");
+            return(options::sp_after_oc_synchronized());
+         }
+         break;
+
+         SPACE_RULE({ CT_UNKNOWN, CT_SPAREN_OPEN })
+
+         // "if (" vs "if("
+         if (chunk_is_token(second, CT_SPAREN_OPEN))
+         {
+            // Add or remove space before '(' of control statements ('if', 'for', 'switch',
+            // 'while', etc.).
+            log_rule("sp_before_sparen");
+            return(options::sp_before_sparen());
+         }
+         break;
+
+         SPACE_RULE({ CT_LAMBDA, CT_UNKNOWN },
+                    { CT_UNKNOWN, CT_LAMBDA })
+
+         if (chunk_is_token(first, CT_LAMBDA) || chunk_is_token(second, CT_LAMBDA))
+         {
+            log_rule("sp_assign (lambda)");
+            return(options::sp_assign());
+         }
+         break;
+
+         SPACE_RULE({ CT_SQUARE_OPEN, CT_ASSIGN },
+                    { CT_ASSIGN, CT_SQUARE_CLOSE })
+
+         // Handle the special lambda case for C++11:
+         //    [=](Something arg){.....}
+         // Add or remove space around '=' in C++11 lambda capture specifications.
+         // Overrides sp_assign.
+         if (  (options::sp_cpp_lambda_assign() != IARF_IGNORE)
+            && (  (  chunk_is_token(first, CT_SQUARE_OPEN)
+                  && get_chunk_parent_type(first) == CT_CPP_LAMBDA
+                  && chunk_is_token(second, CT_ASSIGN))
+               || (  chunk_is_token(first, CT_ASSIGN)
+                  && chunk_is_token(second, CT_SQUARE_CLOSE)
+                  && get_chunk_parent_type(second) == CT_CPP_LAMBDA)))
+         {
+            log_rule("sp_cpp_lambda_assign");
+            return(options::sp_cpp_lambda_assign());
+         }
+         break;
+
+         SPACE_RULE({ CT_SQUARE_CLOSE, CT_UNKNOWN })
+
+         if (  chunk_is_token(first, CT_SQUARE_CLOSE)
+            && get_chunk_parent_type(first) == CT_CPP_LAMBDA)
+         {
+            // Handle the special lambda case for C++11:
+            //    [](Something arg){.....}
+            // Add or remove space after the capture specification in C++11 lambda.
+            if (  (options::sp_cpp_lambda_square_paren() != IARF_IGNORE)
+               && chunk_is_token(second, CT_FPAREN_OPEN))
+            {
+               log_rule("sp_cpp_lambda_square_paren");
+               return(options::sp_cpp_lambda_square_paren());
+            }
+            else if (  (options::sp_cpp_lambda_square_brace() != IARF_IGNORE)
+                    && chunk_is_token(second, CT_BRACE_OPEN))
+            {
+               log_rule("sp_cpp_lambda_square_brace");
+               return(options::sp_cpp_lambda_square_brace());
+            }
+         }
+         break;
+
+         SPACE_RULE({ CT_BRACE_CLOSE, CT_FPAREN_OPEN })
+
+         if (  chunk_is_token(first, CT_BRACE_CLOSE)
+            && get_chunk_parent_type(first) == CT_CPP_LAMBDA
+            && chunk_is_token(second, CT_FPAREN_OPEN))
+         {
+            log_rule("sp_cpp_lambda_fparen");
+            return(options::sp_cpp_lambda_fparen());
+         }
+         break;
+
+         SPACE_RULE({ CT_FPAREN_CLOSE, CT_BRACE_OPEN })
+
+         if (  (options::sp_cpp_lambda_paren_brace() != IARF_IGNORE)
+            && chunk_is_token(first, CT_FPAREN_CLOSE)
+            && get_chunk_parent_type(first) == CT_CPP_LAMBDA
+            && chunk_is_token(second, CT_BRACE_OPEN))
+         {
+            log_rule("sp_cpp_lambda_paren_brace");
+            return(options::sp_cpp_lambda_paren_brace());
+         }
+         break;
+
+         SPACE_RULE({ CT_ENUM, CT_FPAREN_OPEN })
+
+         if (chunk_is_token(first, CT_ENUM) && chunk_is_token(second, CT_FPAREN_OPEN))
+         {
+            // Add or remove space in 'NS_ENUM ('.
+            if (options::sp_enum_paren() != IARF_IGNORE)
+            {
+               log_rule("sp_enum_paren");
+               return(options::sp_enum_paren());
+            }
+         }
+         break;
+
+         SPACE_RULE({ CT_UNKNOWN, CT_ASSIGN })
+
+         if (chunk_is_token(second, CT_ASSIGN))
+         {
+            if (second->flags.test(PCF_IN_ENUM))
+            {
+               // Add or remove space before assignment '=' in enum.
+               // Overrides sp_enum_assign.
+               if (options::sp_enum_before_assign() != IARF_IGNORE)
+               {
+                  log_rule("sp_enum_before_assign");
+                  return(options::sp_enum_before_assign());
+               }
+               // Add or remove space around assignment '=' in enum.
+               log_rule("sp_enum_assign");
+               return(options::sp_enum_assign());
+            }
+
+            // Add or remove space around assignment operator '=' in a prototype.
+            // If set to ignore, use sp_assign.
+            if (  (options::sp_assign_default() != IARF_IGNORE)
+               && get_chunk_parent_type(second) == CT_FUNC_PROTO)
+            {
+               log_rule("sp_assign_default");
+               return(options::sp_assign_default());
+            }
+
+            // Add or remove space before assignment operator '=', '+=', etc.
+            // Overrides sp_assign.
+            if (options::sp_before_assign() != IARF_IGNORE)
+            {
+               log_rule("sp_before_assign");
+               return(options::sp_before_assign());
+            }
+            // Add or remove space around assignment operator '=', '+=', etc.
+            log_rule("sp_assign");
+            return(options::sp_assign());
+         }
+         break;
+
+         SPACE_RULE({ CT_UNKNOWN, CT_ASSIGN_DEFAULT_ARG })
+
+         if (chunk_is_token(second, CT_ASSIGN_DEFAULT_ARG))
+         {
+            if (  (options::sp_assign_default() != IARF_IGNORE)
+               && get_chunk_parent_type(second) == CT_FUNC_PROTO)
+            {
+               log_rule("sp_assign_default");
+               return(options::sp_assign_default());
+            }
+
+            if (options::sp_before_assign() != IARF_IGNORE)
+            {
+               log_rule("sp_before_assign");
+               return(options::sp_before_assign());
+            }
+            log_rule("sp_assign");
+            return(options::sp_assign());
+         }
+         break;
+
+         SPACE_RULE({ CT_ASSIGN, CT_UNKNOWN })
+
+         if (chunk_is_token(first, CT_ASSIGN))
+         {
+            if (first->flags.test(PCF_IN_ENUM))
+            {
+               // Add or remove space after assignment '=' in enum.
+               // Overrides sp_enum_assign.
+               if (options::sp_enum_after_assign() != IARF_IGNORE)
+               {
+                  log_rule("sp_enum_after_assign");
+                  return(options::sp_enum_after_assign());
+               }
+               // Add or remove space around assignment '=' in enum.
+               log_rule("sp_enum_assign");
+               return(options::sp_enum_assign());
+            }
+
+            if (  (options::sp_assign_default() != IARF_IGNORE)
+               && get_chunk_parent_type(first) == CT_FUNC_PROTO)
+            {
+               log_rule("sp_assign_default");
+               return(options::sp_assign_default());
+            }
+
+            // Add or remove space after assignment operator '=', '+=', etc.
+            // Overrides sp_assign.
+            if (options::sp_after_assign() != IARF_IGNORE)
+            {
+               log_rule("sp_after_assign");
+               return(options::sp_after_assign());
+            }
+            log_rule("sp_assign");
+            return(options::sp_assign());
+         }
+         break;
+
+         SPACE_RULE({ CT_TRAILING_RET, CT_UNKNOWN },
+                    { CT_CPP_LAMBDA_RET, CT_UNKNOWN },
+                    { CT_UNKNOWN, CT_TRAILING_RET },
+                    { CT_UNKNOWN, CT_CPP_LAMBDA_RET })
+
+         if (  chunk_is_token(first, CT_TRAILING_RET)
+            || chunk_is_token(first, CT_CPP_LAMBDA_RET)
+            || chunk_is_token(second, CT_TRAILING_RET)
+            || chunk_is_token(second, CT_CPP_LAMBDA_RET))
+         {
+            // Add or remove space around trailing return operator '->'.
+            log_rule("sp_trailing_return");
+            return(options::sp_trailing_return());
+         }
+         break;
+
+         SPACE_RULE({ CT_ASSIGN_DEFAULT_ARG, CT_UNKNOWN })
+
+         if (chunk_is_token(first, CT_ASSIGN_DEFAULT_ARG))
+         {
+            if (  (options::sp_assign_default() != IARF_IGNORE)
+               && get_chunk_parent_type(first) == CT_FUNC_PROTO)
+            {
+               log_rule("sp_assign_default");
+               return(options::sp_assign_default());
+            }
+
+            // Add or remove space after assignment operator '=', '+=', etc.
+            // Overrides sp_assign.
+            if (options::sp_after_assign() != IARF_IGNORE)
+            {
+               log_rule("sp_after_assign");
+               return(options::sp_after_assign());
+            }
+            log_rule("sp_assign");
+            return(options::sp_assign());
+         }
+         break;
+
+         SPACE_RULE({ CT_BIT_COLON, CT_UNKNOWN })
+
+         if (chunk_is_token(first, CT_BIT_COLON))
+         {
+            if (first->flags.test(PCF_IN_ENUM))
+            {
+               // Add or remove space around assignment ':' in enum.
+               log_rule("sp_enum_colon");
+               return(options::sp_enum_colon());
+            }
+         }
+         break;
+
+         SPACE_RULE({ CT_UNKNOWN, CT_BIT_COLON })
+
+         if (chunk_is_token(second, CT_BIT_COLON))
+         {
+            if (second->flags.test(PCF_IN_ENUM))
+            {
+               // Add or remove space around assignment ':' in enum.
+               log_rule("sp_enum_colon");
+               return(options::sp_enum_colon());
+            }
+         }
+         break;
+
+         SPACE_RULE({ CT_OC_AVAILABLE_VALUE, CT_UNKNOWN },
+                    { CT_UNKNOWN, CT_OC_AVAILABLE_VALUE })
+
+         if (chunk_is_token(first, CT_OC_AVAILABLE_VALUE) || chunk_is_token(second, CT_OC_AVAILABLE_VALUE))
+         {
+            log_rule("IGNORE");
+            return(IARF_IGNORE);
+         }
+         break;
+
+         SPACE_RULE({ CT_UNKNOWN, CT_OC_BLOCK_CARET })
+
+         if (chunk_is_token(second, CT_OC_BLOCK_CARET))
+         {
+            // (OC) Add or remove space before a block pointer caret,
+            // i.e. '^int (int arg){...}' vs. ' ^int (int arg){...}'.
+            log_rule("sp_before_oc_block_caret");
+            return(options::sp_before_oc_block_caret());
+         }
+         break;
+
+         SPACE_RULE({ CT_OC_BLOCK_CARET, CT_UNKNOWN })
+
+         if (chunk_is_token(first, CT_OC_BLOCK_CARET))
+         {
+            // (OC) Add or remove space after a block pointer caret,
+            // i.e. '^int (int arg){...}' vs. '^ int (int arg){...}'.
+            log_rule("sp_after_oc_block_caret");
+            return(options::sp_after_oc_block_caret());
+         }
+         break;
+
+         SPACE_RULE({ CT_UNKNOWN, CT_OC_MSG_FUNC })
+
+         if (chunk_is_token(second, CT_OC_MSG_FUNC))
+         {
+            if (  (options::sp_after_oc_msg_receiver() == IARF_REMOVE)
+               && (  (first->type != CT_SQUARE_CLOSE)
+                  && (first->type != CT_FPAREN_CLOSE)
+                  && (first->type != CT_PAREN_CLOSE)))
+            {
+               log_rule("FORCE");
+               return(IARF_FORCE);
+            }
+            // (OC) Add or remove space between the receiver and selector in a message,
+            // as in '[receiver selector ...]'.
+            log_rule("sp_after_oc_msg_receiver");
+            return(options::sp_after_oc_msg_receiver());
+         }
+         break;
+
+         SPACE_RULE({ CT_BYREF, CT_SQUARE_OPEN },
+                    { CT_QUALIFIER, CT_SQUARE_OPEN },
+                    { CT_TYPE, CT_SQUARE_OPEN })
+
+         // c++17 structured bindings e.g., "auto [x, y, z]" vs a[x, y, z]" or "auto const [x, y, z]" vs "auto const[x, y, z]"
+         if (  language_is_set(LANG_CPP)
+            && (  chunk_is_token(first, CT_BYREF)
+               || chunk_is_token(first, CT_QUALIFIER)
+               || chunk_is_token(first, CT_TYPE))
+            && chunk_is_token(second, CT_SQUARE_OPEN)
+            && get_chunk_parent_type(second) != CT_OC_MSG
+            && get_chunk_parent_type(second) != CT_CS_SQ_STMT)
+         {
+            // Add or remove space before C++17 structured bindings.
+            log_rule("sp_cpp_before_struct_binding");
+            return(options::sp_cpp_before_struct_binding());
+         }
+         break;
+
+         SPACE_RULE({ CT_UNKNOWN, CT_SQUARE_OPEN })
+
+         // "a [x]" vs "a[x]"
+         if (  chunk_is_token(second, CT_SQUARE_OPEN)
+            && (  get_chunk_parent_type(second) != CT_OC_MSG
+               && get_chunk_parent_type(second) != CT_CS_SQ_STMT
+               && get_chunk_parent_type(second) != CT_CPP_LAMBDA))
+         {
+            if (second->flags.test(PCF_IN_SPAREN) && (chunk_is_token(first, CT_IN)))
+            {
+               log_rule("FORCE");
+               return(IARF_FORCE);
+            }
+
+            if (chunk_is_token(first, CT_ASM_COLON))
+            {
+               // Add or remove space before '[' for asm block.
+               log_rule("sp_before_square_asm_block");
+               return(options::sp_before_square_asm_block());
+            }
+
+            if (first->flags.test(PCF_VAR_DEF))
+            {
+               // Add or remove space before '[' for a variable definition.
+               log_rule("sp_before_vardef_square");
+               return(options::sp_before_vardef_square());
+            }
+            // Add or remove space before '[' (except '[]').
+            log_rule("sp_before_square");
+            return(options::sp_before_square());
+         }
+         break;
+
+         SPACE_RULE({ CT_UNKNOWN, CT_TSQUARE })
+
+         // "byte[]" vs "byte []"
+         if (chunk_is_token(second, CT_TSQUARE))
+         {
+            // Add or remove space before '[]'.
+            log_rule("sp_before_squares");
+            return(options::sp_before_squares());
+         }
+         break;
+
+         SPACE_RULE({ CT_ANGLE_CLOSE, CT_ANGLE_CLOSE })
+
+         if (  (options::sp_angle_shift() != IARF_IGNORE)
+            && chunk_is_token(first, CT_ANGLE_CLOSE)
+            && chunk_is_token(second, CT_ANGLE_CLOSE))
+         {
+            // Add or remove space between '>' and '>' in '>>' (template stuff).
+            log_rule("sp_angle_shift");
+            return(options::sp_angle_shift());
+         }
+         break;
+
+         SPACE_RULE({ CT_ANGLE_OPEN, CT_UNKNOWN },
+                    { CT_UNKNOWN, CT_ANGLE_CLOSE })
+
+         // spacing around template < > stuff
+         if (  chunk_is_token(first, CT_ANGLE_OPEN)
+            || chunk_is_token(second, CT_ANGLE_CLOSE))
+         {
+            if (  chunk_is_token(first, CT_ANGLE_OPEN)
+               && chunk_is_token(second, CT_ANGLE_CLOSE))
+            {
+               // Add or remove space inside '<>'.
+               log_rule("sp_inside_angle_empty");
+               return(options::sp_inside_angle_empty());
+            }
+            // Add or remove space inside '<' and '>'.
+            log_rule("sp_inside_angle");
+            iarf_e op = options::sp_inside_angle();
+
+            // special: if we're not supporting digraphs, then we shouldn't create them!
+            if (  (op == IARF_REMOVE)
+               && !options::enable_digraphs()
+               && chunk_is_token(first, CT_ANGLE_OPEN)
+               && chunk_is_token(second, CT_DC_MEMBER))
+            {
+               op = IARF_IGNORE;
+            }
+            // TODO log_rule??
+            return(op);
+         }
+         break;
+
+         SPACE_RULE({ CT_UNKNOWN, CT_ANGLE_OPEN })
+
+         if (chunk_is_token(second, CT_ANGLE_OPEN))
+         {
+            if (  chunk_is_token(first, CT_TEMPLATE)
+               && (options::sp_template_angle() != IARF_IGNORE))
+            {
+               // Add or remove space between 'template' and '<'.
+               // If set to ignore, sp_before_angle is used.
+               log_rule("sp_template_angle");
+               return(options::sp_template_angle());
+            }
+
+            if (first->type != CT_QUALIFIER)
+            {
+               // Add or remove space before '<'.
+               log_rule("sp_before_angle");
+               return(options::sp_before_angle());
+            }
+         }
+         break;
+
+         SPACE_RULE({ CT_ANGLE_CLOSE, CT_UNKNOWN })
+
+         cacheable = false;
+
+         if (chunk_is_token(first, CT_ANGLE_CLOSE))
+         {
+            if (chunk_is_token(second, CT_WORD) || CharTable::IsKw1(second->str[0]))
+            {
+               // Add or remove space between '>' and a word as in 'List<byte> m;' or
+               // 'template <typename T> static ...'.
+               if (options::sp_angle_word() != IARF_IGNORE)
+               {
+                  log_rule("sp_angle_word");
+                  return(options::sp_angle_word());
+               }
+            }
+
+            if (chunk_is_token(second, CT_FPAREN_OPEN) || chunk_is_token(second, CT_PAREN_OPEN))
+            {
+               chunk_t *next = chunk_get_next_ncnl(second);
+
+               if (chunk_is_token(next, CT_FPAREN_CLOSE))
+               {
+                  // Add or remove space between '>' and '()' as found in 'new List<byte>();'.
+                  log_rule("sp_angle_paren_empty");
+                  return(options::sp_angle_paren_empty());
+               }
+               // Add or remove space between '>' and '(' as found in 'new List<byte>(foo);'.
+               log_rule("sp_angle_paren");
+               return(options::sp_angle_paren());
+            }
+
+            if (chunk_is_token(second, CT_DC_MEMBER))
+            {
+               // Add or remove space before the '::' operator.
+               log_rule("sp_before_dc");
+               return(options::sp_before_dc());
+            }
+
+            if (  second->type != CT_BYREF
+               && second->type != CT_PTR_TYPE
+               && second->type != CT_BRACE_OPEN
+               && second->type != CT_PAREN_CLOSE)
+            {
+               if (  chunk_is_token(second, CT_CLASS_COLON)
+                  && options::sp_angle_colon() != IARF_IGNORE)
+               {
+                  // Add or remove space between '>' and ':'.
+                  log_rule("sp_angle_colon");
+                  return(options::sp_angle_colon());
+               }
+
+               if (  chunk_is_token(second, CT_FPAREN_CLOSE)
+                  && options::sp_inside_fparen() != IARF_IGNORE
+                  && options::use_sp_after_angle_always() == false)
+               {
+                  // Add or remove space between '>' and ')'.
+                  log_rule("sp_inside_fparen");
+                  return(options::sp_inside_fparen());
+               }
+               // Add or remove space after '>'.
+               log_rule("sp_after_angle");
+               return(options::sp_after_angle());
+            }
+         }
+         break;
+
+         SPACE_RULE({ CT_BYREF, CT_UNKNOWN })
+
+         cacheable = false;
+
+         if (chunk_is_token(first, CT_BYREF))
+         {
+            if (  options::sp_after_byref_func() != IARF_IGNORE
+               && (  get_chunk_parent_type(first) == CT_FUNC_DEF
+                  || get_chunk_parent_type(first) == CT_FUNC_PROTO))
+            {
+               // Add or remove space after a reference sign '&', if followed by a function
+               // prototype or function definition.
+               log_rule("sp_after_byref_func");
+               return(options::sp_after_byref_func());
+            }
+
+            if (  (  CharTable::IsKw1(second->str[0])
+                  && (  options::sp_after_byref() != IARF_IGNORE
+                     || (  !chunk_is_token(second, CT_FUNC_PROTO)
+                        && !chunk_is_token(second, CT_FUNC_DEF))))
+               || chunk_is_token(second, CT_PAREN_OPEN))
+            {
+               // Add or remove space after reference sign '&', if followed by a word.
+               log_rule("sp_after_byref");
+               return(options::sp_after_byref());
+            }
+         }
+         break;
+
+         SPACE_RULE({ CT_UNKNOWN, CT_BYREF })
+
+         cacheable = false;
+
+         if (  chunk_is_token(second, CT_BYREF)
+            && !chunk_is_token(first, CT_PAREN_OPEN))
+         {
+            // Add or remove space before a reference sign '&', if followed by a function
+            // prototype or function definition.
+            if (options::sp_before_byref_func() != IARF_IGNORE)
+            {
+               chunk_t *next = chunk_get_next(second);
+
+               if (  next != nullptr
+                  && (  get_chunk_parent_type(next) == CT_FUNC_DEF
+                     || get_chunk_parent_type(next) == CT_FUNC_PROTO))
+               {
+                  log_rule("sp_before_byref_func");
+                  return(options::sp_before_byref_func());
+               }
+            }
+
+            // Add or remove space before a reference sign '&' that isn't followed by a
+            // variable name. If set to 'ignore', sp_before_byref is used instead.
+            if (options::sp_before_unnamed_byref() != IARF_IGNORE)
+            {
+               chunk_t *next = chunk_get_next_nc(second);
+
+               if (next != nullptr && next->type != CT_WORD)
+               {
+                  log_rule("sp_before_unnamed_byref");
+                  return(options::sp_before_unnamed_byref());
+               }
+            }
+            // Add or remove space before a reference sign '&'.
+            log_rule("sp_before_byref");
+            return(options::sp_before_byref());
+         }
+         break;
+
+         SPACE_RULE({ CT_SPAREN_CLOSE, CT_UNKNOWN })
+
+         if (chunk_is_token(first, CT_SPAREN_CLOSE))
+         {
+            if (chunk_is_token(second, CT_BRACE_OPEN))
+            {
+               if (get_chunk_parent_type(second) == CT_CATCH)
+               {
+                  if (language_is_set(LANG_OC) && (options::sp_oc_catch_brace() != IARF_IGNORE))
+                  {
+                     // (OC) Add or remove space before the '{' of a '@catch' statement, if the '{'
+                     // and '@catch' are on the same line, as in '@catch (decl) <here> {'.
+                     // If set to ignore, sp_catch_brace is used.
+                     log_rule("sp_oc_catch_brace");
+                     return(options::sp_oc_catch_brace());
+                  }
+
+                  if (options::sp_catch_brace() != IARF_IGNORE)
+                  {
+                     // Add or remove space before the '{' of a 'catch' statement, if the '{' and
+                     // 'catch' are on the same line, as in 'catch (decl) <here> {'.
+                     log_rule("sp_catch_brace");
+                     return(options::sp_catch_brace());
+                  }
+               }
+
+               if (options::sp_sparen_brace() != IARF_IGNORE)
+               {
+                  // Add or remove space between ')' and '{' of of control statements.
+                  log_rule("sp_sparen_brace");
+                  return(options::sp_sparen_brace());
+               }
+            }
+
+            if (  !chunk_is_comment(second)
+               && (options::sp_after_sparen() != IARF_IGNORE))
+            {
+               // Add or remove space after ')' of control statements.
+               log_rule("sp_after_sparen");
+               return(options::sp_after_sparen());
+            }
+         }
+         break;
+
+         SPACE_RULE({ CT_VBRACE_OPEN, CT_SEMICOLON })
+
+         if (  chunk_is_token(first, CT_VBRACE_OPEN)
+            && chunk_is_token(second, CT_SEMICOLON)) // Issue # 1158
+         {
+            // Add or remove space before ';'.
+            log_rule("sp_before_semi");
+            return(options::sp_before_semi());
+         }
+         break;
+
+         SPACE_RULE({ CT_UNKNOWN, CT_FPAREN_OPEN })
+
+         cacheable = false;
+
+         if (  chunk_is_token(second, CT_FPAREN_OPEN)
+            && get_chunk_parent_type(first) == CT_OPERATOR
+            && (options::sp_after_operator_sym() != IARF_IGNORE))
+         {
+            if (  (options::sp_after_operator_sym_empty() != IARF_IGNORE)
+               && chunk_is_token(second, CT_FPAREN_OPEN))
+            {
+               chunk_t *next = chunk_get_next_ncnl(second);
+
+               if (chunk_is_token(next, CT_FPAREN_CLOSE))
+               {
+                  // Overrides sp_after_operator_sym when the operator has no arguments, as in
+                  // 'operator *()'.
+                  log_rule("sp_after_operator_sym_empty");
+                  return(options::sp_after_operator_sym_empty());
+               }
+            }
+            // Add or remove space between the operator symbol and the open parenthesis, as
+            // in 'operator ++('.
+            log_rule("sp_after_operator_sym");
+            return(options::sp_after_operator_sym());
+         }
+         break;
+
+         SPACE_RULE({ CT_FUNC_CALL, CT_UNKNOWN })
+
+         cacheable = false;
+
+         // Issue #2270
+         // Translations under vala
+         if (  language_is_set(LANG_VALA)
+            && chunk_is_token(first, CT_FUNC_CALL))
+         {
+            if (  chunk_is_str(first, "_", 1)
+               && chunk_is_token(second, CT_FPAREN_OPEN)
+               && (options::sp_vala_after_translation() != IARF_IGNORE))
+            {
+               // Add or remove space after '_'.
+               log_rule("sp_vala_after_translation");
+               return(options::sp_vala_after_translation());
+            }
+         }
+         break;
+
+         SPACE_RULE({ CT_FUNC_CALL, CT_UNKNOWN },
+                    { CT_FUNC_CTOR_VAR, CT_UNKNOWN },
+                    { CT_CNG_HASINC, CT_UNKNOWN },
+                    { CT_CNG_HASINCN, CT_UNKNOWN })
+
+         cacheable = false;
+
+         // spaces between function and open paren
+         if (  chunk_is_token(first, CT_FUNC_CALL)
+            || chunk_is_token(first, CT_FUNC_CTOR_VAR)
+            || chunk_is_token(first, CT_CNG_HASINC)
+            || chunk_is_token(first, CT_CNG_HASINCN))
+         {
+            if (  (options::sp_func_call_paren_empty() != IARF_IGNORE)
+               && chunk_is_token(second, CT_FPAREN_OPEN))
+            {
+               chunk_t *next = chunk_get_next_ncnl(second);
+
+               if (chunk_is_token(next, CT_FPAREN_CLOSE))
+               {
+                  // Add or remove space between function name and '()' on function calls without
+                  // parameters. If set to 'ignore' (the default), sp_func_call_paren is used.
+                  log_rule("sp_func_call_paren_empty");
+                  return(options::sp_func_call_paren_empty());
+               }
+            }
+            // Add or remove space between function name and '(' on function calls.
+            log_rule("sp_func_call_paren");
+            return(options::sp_func_call_paren());
+         }
+         break;
+
+         SPACE_RULE({ CT_FUNC_CALL_USER, CT_UNKNOWN })
+
+         if (chunk_is_token(first, CT_FUNC_CALL_USER))
+         {
+            // Add or remove space between the user function name and '(' on function
+            // calls. You need to set a keyword to be a user function in the config file,
+            // like:
+            //   set func_call_user tr _ i18n
+            log_rule("sp_func_call_user_paren");
+            return(options::sp_func_call_user_paren());
+         }
+         break;
+
+         SPACE_RULE({ CT_ATTRIBUTE, CT_UNKNOWN })
+
+         if (chunk_is_token(first, CT_ATTRIBUTE) && chunk_is_paren_open(second))
+         {
+            // Add or remove space between '__attribute__' and '('.
+            log_rule("sp_attribute_paren");
+            return(options::sp_attribute_paren());
+         }
+         break;
+
+         SPACE_RULE({ CT_FUNC_DEF, CT_UNKNOWN })
+
+         cacheable = false;
+
+         if (chunk_is_token(first, CT_FUNC_DEF))
+         {
+            if (  (options::sp_func_def_paren_empty() != IARF_IGNORE)
+               && chunk_is_token(second, CT_FPAREN_OPEN))
+            {
+               chunk_t *next = chunk_get_next_ncnl(second);
+
+               if (chunk_is_token(next, CT_FPAREN_CLOSE))
+               {
+                  // Add or remove space between function name and '()' on function definition
+                  // without parameters.
+                  log_rule("sp_func_def_paren_empty");
+                  return(options::sp_func_def_paren_empty());
+               }
+            }
+            // Add or remove space between function name and '(' on function definition.
+            log_rule("sp_func_def_paren");
+            return(options::sp_func_def_paren());
+         }
+         break;
+
+         SPACE_RULE({ CT_CPP_CAST, CT_UNKNOWN },
+                    { CT_TYPE_WRAP, CT_UNKNOWN })
+
+         if (chunk_is_token(first, CT_CPP_CAST) || chunk_is_token(first, CT_TYPE_WRAP))
+         {
+            // Add or remove space between the type and open parenthesis in a C++ cast,
+            // i.e. 'int(exp)' vs. 'int (exp)'.
+            log_rule("sp_cpp_cast_paren");
+            return(options::sp_cpp_cast_paren());
+         }
+         break;
+
+         SPACE_RULE({ CT_SPAREN_CLOSE, CT_WHEN })
+
+         if (chunk_is_token(first, CT_SPAREN_CLOSE) && chunk_is_token(second, CT_WHEN))
+         {
+            log_rule("FORCE");
+            return(IARF_FORCE); // TODO: make this configurable?
+         }
+         break;
+
+         SPACE_RULE({ CT_PAREN_CLOSE, CT_PAREN_OPEN },
+                    { CT_PAREN_CLOSE, CT_FPAREN_OPEN })
+
+         if (  chunk_is_token(first, CT_PAREN_CLOSE)
+            && (chunk_is_token(second, CT_PAREN_OPEN) || chunk_is_token(second, CT_FPAREN_OPEN)))
+         {
+            // "(int)a" vs "(int) a" or "cast(int)a" vs "cast(int) a"
+            if (get_chunk_parent_type(first) == CT_C_CAST || get_chunk_parent_type(first) == CT_D_CAST)
+            {
+               // Add or remove space after C/D cast, i.e. 'cast(int)a' vs. 'cast(int) a' or
+               // '(int)a' vs. '(int) a'.
+               log_rule("sp_after_cast");
+               return(options::sp_after_cast());
+            }
+            // Must be an indirect/chained function call?
+            log_rule("REMOVE");
+            return(IARF_REMOVE);  // TODO: make this configurable?
+         }
+         break;
+
+         SPACE_RULE({ CT_TPAREN_CLOSE, CT_UNKNOWN })
+
+         // handle the space between parens in fcn type 'void (*f)(void)'
+         if (chunk_is_token(first, CT_TPAREN_CLOSE))
+         {
+            // Add or remove space between the ')' and '(' in a function type, as in
+            // 'void (*x)(...)'.
+            log_rule("sp_after_tparen_close");
+            return(options::sp_after_tparen_close());
+         }
+         break;
+
+         SPACE_RULE({ CT_UNKNOWN, CT_UNKNOWN })
+
+         // ")(" vs ") ("
+         if (  (  chunk_is_str(first, ")", 1)
+               && chunk_is_str(second, "(", 1))
+            || (chunk_is_paren_close(first) && chunk_is_paren_open(second)))
+         {
+            // Add or remove space between back-to-back parentheses, i.e. ')(' vs. ') ('.
+            log_rule("sp_cparen_oparen");
+            return(options::sp_cparen_oparen());
+         }
+         break;
+
+         SPACE_RULE({ CT_FUNC_PROTO, CT_UNKNOWN },
+                    { CT_UNKNOWN, CT_FPAREN_OPEN })
+
+         cacheable = false;
+
+         if (  chunk_is_token(first, CT_FUNC_PROTO)
+            || (  chunk_is_token(second, CT_FPAREN_OPEN)
+               && get_chunk_parent_type(second) == CT_FUNC_PROTO))
+         {
+            if (  (options::sp_func_proto_paren_empty() != IARF_IGNORE)
+               && chunk_is_token(second, CT_FPAREN_OPEN))
+            {
+               chunk_t *next = chunk_get_next_ncnl(second);
+
+               if (chunk_is_token(next, CT_FPAREN_CLOSE))
+               {
+                  // Add or remove space between function name and '()' on function declaration
+                  // without parameters.
+                  log_rule("sp_func_proto_paren_empty");
+                  return(options::sp_func_proto_paren_empty());
+               }
+            }
+            // Add or remove space between function name and '(' on function declaration.
+            log_rule("sp_func_proto_paren");
+            return(options::sp_func_proto_paren());
+         }
+         break;
+
+         SPACE_RULE({ CT_FUNC_TYPE, CT_FPAREN_OPEN })
+
+         // Issue #2437
+         if (  chunk_is_token(first, CT_FUNC_TYPE)
+            && chunk_is_token(second, CT_FPAREN_OPEN))
+         {
+            // Add or remove space between function name and '(' with a typedef specifier.
+            log_rule("sp_func_type_paren");
+            return(options::sp_func_type_paren());
+         }
+         break;
+
+         SPACE_RULE({ CT_FUNC_CLASS_DEF, CT_UNKNOWN },
+                    { CT_FUNC_CLASS_PROTO, CT_UNKNOWN })
+
+         cacheable = false;
+
+         if (chunk_is_token(first, CT_FUNC_CLASS_DEF) || chunk_is_token(first, CT_FUNC_CLASS_PROTO))
+         {
+            if (  (options::sp_func_class_paren_empty() != IARF_IGNORE)
+               && chunk_is_token(second, CT_FPAREN_OPEN))
+            {
+               chunk_t *next = chunk_get_next_ncnl(second);
+
+               if (chunk_is_token(next, CT_FPAREN_CLOSE))
+               {
+                  // Add or remove space between a constructor without parameters or destructor
+                  // and '()'.
+                  log_rule("sp_func_class_paren_empty");
+                  return(options::sp_func_class_paren_empty());
+               }
+            }
+            // Add or remove space between a constructor/destructor and the open
+            // parenthesis.
+            log_rule("sp_func_class_paren");
+            return(options::sp_func_class_paren());
+         }
+         break;
+
+         SPACE_RULE({ CT_CLASS, CT_UNKNOWN })
+
+         if (chunk_is_token(first, CT_CLASS) && !first->flags.test(PCF_IN_OC_MSG))
+         {
+            log_rule("FORCE");
+            return(IARF_FORCE);
+         }
+         break;
+
+         SPACE_RULE({ CT_BRACE_OPEN, CT_BRACE_CLOSE })
+
+         if (chunk_is_token(first, CT_BRACE_OPEN) && chunk_is_token(second, CT_BRACE_CLOSE))
+         {
+            // Add or remove space inside '{}'.
+            log_rule("sp_inside_braces_empty");
+            return(options::sp_inside_braces_empty());
+         }
+         break;
+
+         SPACE_RULE({ CT_TYPE, CT_BRACE_OPEN },
+                    { CT_ANGLE_CLOSE, CT_BRACE_OPEN })
+
+         if (  (  chunk_is_token(first, CT_TYPE)                           // Issue #2428
+               || chunk_is_token(first, CT_ANGLE_CLOSE))
+            && chunk_is_token(second, CT_BRACE_OPEN)
+            && get_chunk_parent_type(second) == CT_BRACED_INIT_LIST)
+         {
+            auto arg = iarf_flags_t{ options::sp_type_brace_init_lst() };
+
+            if (  arg != iarf_e::IGNORE
+               || get_chunk_parent_type(first) != CT_DECLTYPE)
+            {
+               // 'int{9}' vs 'int {9}'
+               // Add or remove space between type and open brace of an unnamed temporary
+               // direct-list-initialization.
+               log_rule("sp_type_brace_init_lst");
+               return(arg);
+            }
+         }
+         break;
+
+         SPACE_RULE({ CT_WORD, CT_BRACE_OPEN },
+                    { CT_SQUARE_CLOSE, CT_BRACE_OPEN },
+                    { CT_TSQUARE, CT_BRACE_OPEN })
+
+         if (  (  chunk_is_token(first, CT_WORD)                           // Issue #2428
+               || chunk_is_token(first, CT_SQUARE_CLOSE)
+               || chunk_is_token(first, CT_TSQUARE))
+            && chunk_is_token(second, CT_BRACE_OPEN)
+            && get_chunk_parent_type(second) == CT_BRACED_INIT_LIST)
+         {
+            auto arg = iarf_flags_t{ options::sp_word_brace_init_lst() };
+
+            if (  arg != iarf_e::IGNORE
+               || get_chunk_parent_type(first) != CT_DECLTYPE)
+            {
+               // 'a{9}' vs 'a {9}'
+               // Add or remove space between variable/word and open brace of an unnamed
+               // temporary direct-list-initialization.
+               log_rule("sp_word_brace_init_lst");
+               return(arg);
+            }
+         }
+         break;
+
+         SPACE_RULE({ CT_UNKNOWN, CT_BRACE_CLOSE })
+
+         cacheable = false;
+
+         if (chunk_is_token(second, CT_BRACE_CLOSE))
+         {
+            if (get_chunk_parent_type(second) == CT_ENUM)
+            {
+               // Add or remove space inside enum '{' and '}'.
+               log_rule("sp_inside_braces_enum");
+               return(options::sp_inside_braces_enum());
+            }
+
+            if (get_chunk_parent_type(second) == CT_STRUCT || get_chunk_parent_type(second) == CT_UNION)
+            {
+               // Fix for issue #1240  adding space in struct initializers
+               chunk_t *tmp = chunk_get_prev_ncnl(chunk_skip_to_match_rev(second));
+
+               if (chunk_is_token(tmp, CT_ASSIGN))
+               {
+                  log_rule("IGNORE");
+                  return(IARF_IGNORE);
+               }
+               // Add or remove space inside struct/union '{' and '}'.
+               log_rule("sp_inside_braces_struct");
+               return(options::sp_inside_braces_struct());
+            }
+            else if (  get_chunk_parent_type(second) == CT_OC_AT
+                    && options::sp_inside_braces_oc_dict() != IARF_IGNORE)
+            {
+               // (OC) Add or remove space inside Objective-C boxed dictionary '{' and '}'
+               log_rule("sp_inside_braces_oc_dict");
+               return(options::sp_inside_braces_oc_dict());
+            }
+
+            if (get_chunk_parent_type(second) == CT_BRACED_INIT_LIST)
+            {
+               // Add or remove space between nested braces, i.e. '{{' vs '{ {'.
+               if (  options::sp_brace_brace() != IARF_IGNORE
+                  && chunk_is_token(first, CT_BRACE_CLOSE)
+                  && get_chunk_parent_type(first) == CT_BRACED_INIT_LIST)
+               {
+                  log_rule("sp_brace_brace");
+                  return(options::sp_brace_brace());
+               }
+
+               if (options::sp_before_type_brace_init_lst_close() != IARF_IGNORE)
+               {
+                  // Add or remove space before close brace in an unnamed temporary
+                  // direct-list-initialization.
+                  log_rule("sp_before_type_brace_init_lst_close");
+                  return(options::sp_before_type_brace_init_lst_close());
+               }
+
+               if (options::sp_inside_type_brace_init_lst() != IARF_IGNORE)
+               {
+                  // Add or remove space inside an unnamed temporary direct-list-initialization.
+                  log_rule("sp_inside_type_brace_init_lst");
+                  return(options::sp_inside_type_brace_init_lst());
+               }
+            }
+            // Add or remove space inside '{' and '}'.
+            log_rule("sp_inside_braces");
+            return(options::sp_inside_braces());
+         }
+         break;
+
+         SPACE_RULE({ CT_D_CAST, CT_UNKNOWN })
+
+         if (chunk_is_token(first, CT_D_CAST))
+         {
+            log_rule("REMOVE");
+            return(IARF_REMOVE);
+         }
+         break;
+
+         SPACE_RULE({ CT_PP_DEFINED, CT_PAREN_OPEN })
+
+         if (chunk_is_token(first, CT_PP_DEFINED) && chunk_is_token(second, CT_PAREN_OPEN))
+         {
+            // Add or remove space between 'defined' and '(' in '#if defined (FOO)'.
+            log_rule("sp_defined_paren");
+            return(options::sp_defined_paren());
+         }
+         break;
+
+         SPACE_RULE({ CT_THROW, CT_UNKNOWN })
+
+         if (chunk_is_token(first, CT_THROW))
+         {
+            if (chunk_is_token(second, CT_PAREN_OPEN))
+            {
+               // Add or remove space between 'throw' and '(' in 'throw (something)'.
+               log_rule("sp_throw_paren");
+               return(options::sp_throw_paren());
+            }
+            // Add or remove space between 'throw' and anything other than '(' as in
+            // '@throw [...];'.
+            log_rule("sp_after_throw");
+            return(options::sp_after_throw());
+         }
+         break;
+
+         SPACE_RULE({ CT_THIS, CT_PAREN_OPEN })
+
+         if (chunk_is_token(first, CT_THIS) && chunk_is_token(second, CT_PAREN_OPEN))
+         {
+            // Add or remove space between 'this' and '(' in 'this (something)'.
+            log_rule("sp_this_paren");
+            return(options::sp_this_paren());
+         }
+         break;
+
+         SPACE_RULE({ CT_STATE, CT_PAREN_OPEN })
+
+         if (chunk_is_token(first, CT_STATE) && chunk_is_token(second, CT_PAREN_OPEN))
+         {
+            log_rule("ADD");
+            return(IARF_ADD);
+         }
+         break;
+
+         SPACE_RULE({ CT_DELEGATE, CT_PAREN_OPEN })
+
+         if (chunk_is_token(first, CT_DELEGATE) && chunk_is_token(second, CT_PAREN_OPEN))
+         {
+            log_rule("REMOVE");
+            return(IARF_REMOVE);
+         }
+         break;
+
+         SPACE_RULE({ CT_MEMBER, CT_UNKNOWN },
+                    { CT_UNKNOWN, CT_MEMBER })
+
+         if (chunk_is_token(first, CT_MEMBER) || chunk_is_token(second, CT_MEMBER))
+         {
+            // Add or remove space around the '.' or '->' operators.
+            log_rule("sp_member");
+            return(options::sp_member());
+         }
+         break;
+
+         SPACE_RULE({ CT_C99_MEMBER, CT_UNKNOWN })
+
+         if (chunk_is_token(first, CT_C99_MEMBER))
+         {
+            // always remove space(s) after then '.' of a C99-member
+            log_rule("REMOVE");
+            return(IARF_REMOVE);
+         }
+         break;
+
+         SPACE_RULE({ CT_SUPER, CT_PAREN_OPEN })
+
+         if (chunk_is_token(first, CT_SUPER) && chunk_is_token(second, CT_PAREN_OPEN))
+         {
+            // Add or remove space between 'super' and '(' in 'super (something)'.
+            log_rule("sp_super_paren");
+            return(options::sp_super_paren());
+         }
+         break;
+
+         SPACE_RULE({ CT_FPAREN_CLOSE, CT_BRACE_OPEN })
+
+         cacheable = false;
+
+         if (chunk_is_token(first, CT_FPAREN_CLOSE) && chunk_is_token(second, CT_BRACE_OPEN))
+         {
+            if (get_chunk_parent_type(second) == CT_DOUBLE_BRACE)
+            {
+               // (Java) Add or remove space between ')' and '{{' of double brace initializer.
+               log_rule("sp_fparen_dbrace");
+               return(options::sp_fparen_dbrace());
+            }
+
+            // To fix issue #1234
+            // check for initializers and add space or ignore based on the option.
+            if (get_chunk_parent_type(first) == CT_FUNC_CALL)
+            {
+               chunk_t *tmp = chunk_get_prev_type(first, get_chunk_parent_type(first), first->level);
+               tmp = chunk_get_prev_ncnl(tmp);
+
+               if (chunk_is_token(tmp, CT_NEW))
+               {
+                  // Add or remove space between ')' and '{' of s function call in object
+                  // initialization.
+                  // Overrides sp_fparen_brace.
+                  log_rule("sp_fparen_brace_initializer");
+                  return(options::sp_fparen_brace_initializer());
+               }
+            }
+            // Add or remove space between ')' and '{' of function.
+            log_rule("sp_fparen_brace");
+            return(options::sp_fparen_brace());
+         }
+         break;
+
+         SPACE_RULE({ CT_D_TEMPLATE, CT_UNKNOWN },
+                    { CT_UNKNOWN, CT_D_TEMPLATE })
+
+         if (chunk_is_token(first, CT_D_TEMPLATE) || chunk_is_token(second, CT_D_TEMPLATE))
+         {
+            log_rule("REMOVE");
+            return(IARF_REMOVE);
+         }
+         break;
+
+         SPACE_RULE({ CT_ELSE, CT_BRACE_OPEN })
+
+         if (chunk_is_token(first, CT_ELSE) && chunk_is_token(second, CT_BRACE_OPEN))
+         {
+            // Add or remove space between 'else' and '{' if on the same line.
+            log_rule("sp_else_brace");
+            return(options::sp_else_brace());
+         }
+         break;
+
+         SPACE_RULE({ CT_ELSE, CT_ELSEIF })
+
+         if (chunk_is_token(first, CT_ELSE) && chunk_is_token(second, CT_ELSEIF))
+         {
+            log_rule("FORCE");
+            return(IARF_FORCE);
+         }
+         break;
+
+         SPACE_RULE({ CT_FINALLY, CT_BRACE_OPEN })
+
+         if (chunk_is_token(first, CT_FINALLY) && chunk_is_token(second, CT_BRACE_OPEN))
+         {
+            // Add or remove space between 'finally' and '{' if on the same line.
+            log_rule("sp_finally_brace");
+            return(options::sp_finally_brace());
+         }
+         break;
+
+         SPACE_RULE({ CT_TRY, CT_BRACE_OPEN })
+
+         if (chunk_is_token(first, CT_TRY) && chunk_is_token(second, CT_BRACE_OPEN))
+         {
+            // Add or remove space between 'try' and '{' if on the same line.
+            log_rule("sp_try_brace");
+            return(options::sp_try_brace());
+         }
+         break;
+
+         SPACE_RULE({ CT_GETSET, CT_BRACE_OPEN })
+
+         if (chunk_is_token(first, CT_GETSET) && chunk_is_token(second, CT_BRACE_OPEN))
+         {
+            // Add or remove space between get/set and '{' if on the same line.
+            log_rule("sp_getset_brace");
+            return(options::sp_getset_brace());
+         }
+         break;
+
+         SPACE_RULE({ CT_WORD, CT_BRACE_OPEN })
+
+         if (  chunk_is_token(first, CT_WORD)
+            && chunk_is_token(second, CT_BRACE_OPEN))
+         {
+            if (get_chunk_parent_type(first) == CT_NAMESPACE)
+            {
+               // Add or remove space between a variable and '{' for a namespace.
+               log_rule("sp_word_brace_ns");
+               return(options::sp_word_brace_ns());
+            }
+
+            if (  get_chunk_parent_type(first) == CT_NONE
+               && get_chunk_parent_type(second) == CT_BRACED_INIT_LIST)
+            {
+               // Add or remove space between a variable and '{' for C++ uniform
+               // initialization.
+               log_rule("sp_word_brace_init_lst");
+               return(options::sp_word_brace_init_lst());
+            }
+         }
+         break;
+
+         SPACE_RULE({ CT_UNKNOWN, CT_PAREN_OPEN })
+
+         if (chunk_is_token(second, CT_PAREN_OPEN) && get_chunk_parent_type(second) == CT_INVARIANT)
+         {
+            // (D) Add or remove space between 'invariant' and '('.
+            log_rule("sp_invariant_paren");
+            return(options::sp_invariant_paren());
+         }
+         break;
+
+         SPACE_RULE({ CT_PAREN_CLOSE, CT_UNKNOWN })
+
+         if (chunk_is_token(first, CT_PAREN_CLOSE) && get_chunk_parent_type(first) != CT_DECLTYPE)
+         {
+            if (get_chunk_parent_type(first) == CT_INVARIANT)
+            {
+               // (D) Add or remove space after the ')' in 'invariant (C) c'.
+               log_rule("sp_after_invariant_paren");
+               return(options::sp_after_invariant_paren());
+            }
+
+            // "(struct foo) {...}" vs "(struct foo){...}"
+            if (chunk_is_token(second, CT_BRACE_OPEN))
+            {
+               // Add or remove space between ')' and '{'.
+               log_rule("sp_paren_brace");
+               return(options::sp_paren_brace());
+            }
+
+            // D-specific: "delegate(some thing) dg
+            if (get_chunk_parent_type(first) == CT_DELEGATE)
+            {
+               log_rule("ADD");
+               return(IARF_ADD);
+            }
+
+            // PAWN-specific: "state (condition) next"
+            if (get_chunk_parent_type(first) == CT_STATE)
+            {
+               log_rule("ADD");
+               return(IARF_ADD);
+            }
+
+            /* C++ new operator: new(bar) Foo */
+            if (get_chunk_parent_type(first) == CT_NEW)
+            {
+               // Add or remove space between ')' and type in 'new(foo) BAR'.
+               log_rule("sp_after_newop_paren");
+               return(options::sp_after_newop_paren());
+            }
+         }
+         break;
 
-   // Handle the special lambda case for C++11:
-   //    [=](Something arg){.....}
-   // Add or remove space around '=' in C++11 lambda capture specifications.
-   // Overrides sp_assign.
-   if (  (options::sp_cpp_lambda_assign() != IARF_IGNORE)
-      && (  (  chunk_is_token(first, CT_SQUARE_OPEN)
-            && get_chunk_parent_type(first) == CT_CPP_LAMBDA
-            && chunk_is_token(second, CT_ASSIGN))
-         || (  chunk_is_token(first, CT_ASSIGN)
-            && chunk_is_token(second, CT_SQUARE_CLOSE)
-            && get_chunk_parent_type(second) == CT_CPP_LAMBDA)))
-   {
-      log_rule("sp_cpp_lambda_assign");
-      return(options::sp_cpp_lambda_assign());
-   }
+         SPACE_RULE({ CT_UNKNOWN, CT_UNKNOWN })
 
-   if (  chunk_is_token(first, CT_SQUARE_CLOSE)
-      && get_chunk_parent_type(first) == CT_CPP_LAMBDA)
-   {
-      // Handle the special lambda case for C++11:
-      //    [](Something arg){.....}
-      // Add or remove space after the capture specification in C++11 lambda.
-      if (  (options::sp_cpp_lambda_square_paren() != IARF_IGNORE)
-         && chunk_is_token(second, CT_FPAREN_OPEN))
-      {
-         log_rule("sp_cpp_lambda_square_paren");
-         return(options::sp_cpp_lambda_square_paren());
-      }
-      else if (  (options::sp_cpp_lambda_square_brace() != IARF_IGNORE)
-              && chunk_is_token(second, CT_BRACE_OPEN))
-      {
-         log_rule("sp_cpp_lambda_square_brace");
-         return(options::sp_cpp_lambda_square_brace());
-      }
-   }
+         /* "((" vs "( (" or "))" vs ") )" */
+         // Issue #1342
+         if (  (chunk_is_str(first, "(", 1) && chunk_is_str(second, "(", 1))
+            || (chunk_is_str(first, ")", 1) && chunk_is_str(second, ")", 1)))
+         {
+            if (get_chunk_parent_type(second) == CT_FUNC_CALL_USER)
+            {
+               // Add or remove space between nested parentheses with user functions,
+               // i.e. '((' vs. '( ('.
+               log_rule("sp_func_call_user_paren_paren");
+               return(options::sp_func_call_user_paren_paren());
+            }
+            // Add or remove space between nested parentheses, i.e. '((' vs. ') )'.
+            log_rule("sp_paren_paren");
+            return(options::sp_paren_paren());
+         }
+         break;
 
-   if (  chunk_is_token(first, CT_BRACE_CLOSE)
-      && get_chunk_parent_type(first) == CT_CPP_LAMBDA
-      && chunk_is_token(second, CT_FPAREN_OPEN))
-   {
-      log_rule("sp_cpp_lambda_fparen");
-      return(options::sp_cpp_lambda_fparen());
-   }
+         SPACE_RULE({ CT_FPAREN_OPEN, CT_UNKNOWN },
+                    { CT_UNKNOWN, CT_FPAREN_CLOSE })
 
-   if (  (options::sp_cpp_lambda_paren_brace() != IARF_IGNORE)
-      && chunk_is_token(first, CT_FPAREN_CLOSE)
-      && get_chunk_parent_type(first) == CT_CPP_LAMBDA
-      && chunk_is_token(second, CT_BRACE_OPEN))
-   {
-      log_rule("sp_cpp_lambda_paren_brace");
-      return(options::sp_cpp_lambda_paren_brace());
-   }
+         // "foo(...)" vs "foo( ... )"
+         if (chunk_is_token(first, CT_FPAREN_OPEN) || chunk_is_token(second, CT_FPAREN_CLOSE))
+         {
+            if (  (get_chunk_parent_type(first) == CT_FUNC_CALL_USER)
+               || (  (get_chunk_parent_type(second) == CT_FUNC_CALL_USER)
+                  && ((chunk_is_token(first, CT_WORD)) || (chunk_is_token(first, CT_SQUARE_CLOSE)))))
+            {
+               // Add or remove space inside user function '(' and ')'.
+               log_rule("sp_func_call_user_inside_fparen");
+               return(options::sp_func_call_user_inside_fparen());
+            }
 
-   if (chunk_is_token(first, CT_ENUM) && chunk_is_token(second, CT_FPAREN_OPEN))
-   {
-      // Add or remove space in 'NS_ENUM ('.
-      if (options::sp_enum_paren() != IARF_IGNORE)
-      {
-         log_rule("sp_enum_paren");
-         return(options::sp_enum_paren());
-      }
-   }
+            if (chunk_is_token(first, CT_FPAREN_OPEN) && chunk_is_token(second, CT_FPAREN_CLOSE))
+            {
+               // Add or remove space inside empty function '()'.
+               log_rule("sp_inside_fparens");
+               return(options::sp_inside_fparens());
+            }
+            // Add or remove space inside function '(' and ')'.
+            log_rule("sp_inside_fparen");
+            return(options::sp_inside_fparen());
+         }
+         break;
 
-   if (chunk_is_token(second, CT_ASSIGN))
-   {
-      if (second->flags.test(PCF_IN_ENUM))
-      {
-         // Add or remove space before assignment '=' in enum.
-         // Overrides sp_enum_assign.
-         if (options::sp_enum_before_assign() != IARF_IGNORE)
+         SPACE_RULE({ CT_TPAREN_OPEN, CT_UNKNOWN },
+                    { CT_UNKNOWN, CT_TPAREN_CLOSE })
+
+         // "foo(...)" vs "foo( ... )"
+         if (chunk_is_token(first, CT_TPAREN_OPEN) || chunk_is_token(second, CT_TPAREN_CLOSE))
          {
-            log_rule("sp_enum_before_assign");
-            return(options::sp_enum_before_assign());
+            // Add or remove space inside the first parentheses in a function type, as in
+            // 'void (*x)(...)'.
+            log_rule("sp_inside_tparen");
+            return(options::sp_inside_tparen());
          }
-         // Add or remove space around assignment '=' in enum.
-         log_rule("sp_enum_assign");
-         return(options::sp_enum_assign());
-      }
+         break;
 
-      // Add or remove space around assignment operator '=' in a prototype.
-      // If set to ignore, use sp_assign.
-      if (  (options::sp_assign_default() != IARF_IGNORE)
-         && get_chunk_parent_type(second) == CT_FUNC_PROTO)
-      {
-         log_rule("sp_assign_default");
-         return(options::sp_assign_default());
-      }
+         SPACE_RULE({ CT_PAREN_CLOSE, CT_UNKNOWN })
 
-      // Add or remove space before assignment operator '=', '+=', etc.
-      // Overrides sp_assign.
-      if (options::sp_before_assign() != IARF_IGNORE)
-      {
-         log_rule("sp_before_assign");
-         return(options::sp_before_assign());
-      }
-      // Add or remove space around assignment operator '=', '+=', etc.
-      log_rule("sp_assign");
-      return(options::sp_assign());
-   }
+         if (chunk_is_token(first, CT_PAREN_CLOSE))
+         {
+            if (  first->flags.test(PCF_OC_RTYPE) // == CT_OC_RTYPE)
+               && (  get_chunk_parent_type(first) == CT_OC_MSG_DECL
+                  || get_chunk_parent_type(first) == CT_OC_MSG_SPEC))
+            {
+               // (OC) Add or remove space after the first (type) in message specs,
+               // i.e. '-(int) f:(int)x;' vs. '-(int)f:(int)x;'.
+               log_rule("sp_after_oc_return_type");
+               return(options::sp_after_oc_return_type());
+            }
 
-   if (chunk_is_token(second, CT_ASSIGN_DEFAULT_ARG))
-   {
-      if (  (options::sp_assign_default() != IARF_IGNORE)
-         && get_chunk_parent_type(second) == CT_FUNC_PROTO)
-      {
-         log_rule("sp_assign_default");
-         return(options::sp_assign_default());
-      }
+            if (get_chunk_parent_type(first) == CT_OC_MSG_SPEC || get_chunk_parent_type(first) == CT_OC_MSG_DECL)
+            {
+               // (OC) Add or remove space after the (type) in message specs,
+               // i.e. '-(int)f: (int) x;' vs. '-(int)f: (int)x;'.
+               log_rule("sp_after_oc_type");
+               return(options::sp_after_oc_type());
+            }
 
-      if (options::sp_before_assign() != IARF_IGNORE)
-      {
-         log_rule("sp_before_assign");
-         return(options::sp_before_assign());
-      }
-      log_rule("sp_assign");
-      return(options::sp_assign());
-   }
+            if (get_chunk_parent_type(first) == CT_OC_SEL && second->type != CT_SQUARE_CLOSE)
+            {
+               // (OC) Add or remove space between '@selector(x)' and the following word,
+               // i.e. '@selector(foo) a:' vs. '@selector(foo)a:'.
+               log_rule("sp_after_oc_at_sel_parens");
+               return(options::sp_after_oc_at_sel_parens());
+            }
+         }
+         break;
 
-   if (chunk_is_token(first, CT_ASSIGN))
-   {
-      if (first->flags.test(PCF_IN_ENUM))
-      {
-         // Add or remove space after assignment '=' in enum.
-         // Overrides sp_enum_assign.
-         if (options::sp_enum_after_assign() != IARF_IGNORE)
+         SPACE_RULE({ CT_UNKNOWN, CT_UNKNOWN })
+
+         if (options::sp_inside_oc_at_sel_parens() != IARF_IGNORE)
+         {
+            if (  (  chunk_is_token(first, CT_PAREN_OPEN)
+                  && (  get_chunk_parent_type(first) == CT_OC_SEL
+                     || get_chunk_parent_type(first) == CT_OC_PROTOCOL))
+               || (  chunk_is_token(second, CT_PAREN_CLOSE)
+                  && (  get_chunk_parent_type(second) == CT_OC_SEL
+                     || get_chunk_parent_type(second) == CT_OC_PROTOCOL)))
+            {
+               // (OC) Add or remove space inside '@selector' parentheses,
+               // i.e. '@selector(foo)' vs. '@selector( foo )'.
+               // Also applies to '@protocol()' constructs.
+               log_rule("sp_inside_oc_at_sel_parens");
+               return(options::sp_inside_oc_at_sel_parens());
+            }
+         }
+         break;
+
+         SPACE_RULE({ CT_OC_SEL, CT_PAREN_OPEN },
+                    { CT_OC_PROTOCOL, CT_PAREN_OPEN })
+
+         if (  chunk_is_token(second, CT_PAREN_OPEN)
+            && (chunk_is_token(first, CT_OC_SEL) || chunk_is_token(first, CT_OC_PROTOCOL)))
          {
-            log_rule("sp_enum_after_assign");
-            return(options::sp_enum_after_assign());
+            // (OC) Add or remove space between '@selector' and '(',
+            // i.e. '@selector(msgName)' vs. '@selector (msgName)'.
+            // Also applies to '@protocol()' constructs.
+            log_rule("sp_after_oc_at_sel");
+            return(options::sp_after_oc_at_sel());
          }
-         // Add or remove space around assignment '=' in enum.
-         log_rule("sp_enum_assign");
-         return(options::sp_enum_assign());
-      }
+         break;
 
-      if (  (options::sp_assign_default() != IARF_IGNORE)
-         && get_chunk_parent_type(first) == CT_FUNC_PROTO)
-      {
-         log_rule("sp_assign_default");
-         return(options::sp_assign_default());
-      }
+         SPACE_RULE({ CT_PAREN_OPEN, CT_UNKNOWN })
 
-      // Add or remove space after assignment operator '=', '+=', etc.
-      // Overrides sp_assign.
-      if (options::sp_after_assign() != IARF_IGNORE)
-      {
-         log_rule("sp_after_assign");
-         return(options::sp_after_assign());
-      }
-      log_rule("sp_assign");
-      return(options::sp_assign());
-   }
+         /*
+          * C cast:   "(int)"      vs "( int )"
+          * D cast:   "cast(int)"  vs "cast( int )"
+          * CPP cast: "int(a + 3)" vs "int( a + 3 )"
+          */
+         if (chunk_is_token(first, CT_PAREN_OPEN))
+         {
+            if (  get_chunk_parent_type(first) == CT_C_CAST
+               || get_chunk_parent_type(first) == CT_CPP_CAST
+               || get_chunk_parent_type(first) == CT_D_CAST)
+            {
+               // Add or remove spaces inside cast parentheses.
+               log_rule("sp_inside_paren_cast");
+               return(options::sp_inside_paren_cast());
+            }
 
-   if (  chunk_is_token(first, CT_TRAILING_RET)
-      || chunk_is_token(first, CT_CPP_LAMBDA_RET)
-      || chunk_is_token(second, CT_TRAILING_RET)
-      || chunk_is_token(second, CT_CPP_LAMBDA_RET))
-   {
-      // Add or remove space around trailing return operator '->'.
-      log_rule("sp_trailing_return");
-      return(options::sp_trailing_return());
-   }
+            if (get_chunk_parent_type(first) == CT_NEW)
+            {
+               if (options::sp_inside_newop_paren_open() != IARF_IGNORE)
+               {
+                  // Add or remove space after the open parenthesis of the new operator,
+                  // as in 'new(foo) BAR'.
+                  // Overrides sp_inside_newop_paren.
+                  log_rule("sp_inside_newop_paren_open");
+                  return(options::sp_inside_newop_paren_open());
+               }
 
-   if (chunk_is_token(first, CT_ASSIGN_DEFAULT_ARG))
-   {
-      if (  (options::sp_assign_default() != IARF_IGNORE)
-         && get_chunk_parent_type(first) == CT_FUNC_PROTO)
-      {
-         log_rule("sp_assign_default");
-         return(options::sp_assign_default());
-      }
+               if (options::sp_inside_newop_paren() != IARF_IGNORE)
+               {
+                  // Add or remove space inside parenthesis of the new operator
+                  // as in 'new(foo) BAR'.
+                  log_rule("sp_inside_newop_paren");
+                  return(options::sp_inside_newop_paren());
+               }
+            }
+            log_rule("sp_inside_paren");
+            return(options::sp_inside_paren());
+         }
+         break;
 
-      // Add or remove space after assignment operator '=', '+=', etc.
-      // Overrides sp_assign.
-      if (options::sp_after_assign() != IARF_IGNORE)
-      {
-         log_rule("sp_after_assign");
-         return(options::sp_after_assign());
-      }
-      log_rule("sp_assign");
-      return(options::sp_assign());
-   }
+         SPACE_RULE({ CT_UNKNOWN, CT_PAREN_CLOSE })
 
-   if (chunk_is_token(first, CT_BIT_COLON))
-   {
-      if (first->flags.test(PCF_IN_ENUM))
-      {
-         // Add or remove space around assignment ':' in enum.
-         log_rule("sp_enum_colon");
-         return(options::sp_enum_colon());
-      }
-   }
+         if (chunk_is_token(second, CT_PAREN_CLOSE))
+         {
+            if (  get_chunk_parent_type(second) == CT_C_CAST
+               || get_chunk_parent_type(second) == CT_CPP_CAST
+               || get_chunk_parent_type(second) == CT_D_CAST)
+            {
+               // Add or remove spaces inside cast parentheses.
+               log_rule("sp_inside_paren_cast");
+               return(options::sp_inside_paren_cast());
+            }
 
-   if (chunk_is_token(second, CT_BIT_COLON))
-   {
-      if (second->flags.test(PCF_IN_ENUM))
-      {
-         // Add or remove space around assignment ':' in enum.
-         log_rule("sp_enum_colon");
-         return(options::sp_enum_colon());
-      }
-   }
+            if (get_chunk_parent_type(second) == CT_NEW)
+            {
+               if (options::sp_inside_newop_paren_close() != IARF_IGNORE)
+               {
+                  // Add or remove space before the close parenthesis of the new operator,
+                  // as in 'new(foo) BAR'.
+                  // Overrides sp_inside_newop_paren.
+                  log_rule("sp_inside_newop_paren_close");
+                  return(options::sp_inside_newop_paren_close());
+               }
+
+               if (options::sp_inside_newop_paren() != IARF_IGNORE)
+               {
+                  // Add or remove space inside parenthesis of the new operator
+                  // as in 'new(foo) BAR'.
+                  log_rule("sp_inside_newop_paren");
+                  return(options::sp_inside_newop_paren());
+               }
+            }
+            // Add or remove space inside '(' and ')'.
+            log_rule("sp_inside_paren");
+            return(options::sp_inside_paren());
+         }
+         break;
+
+         SPACE_RULE({ CT_SQUARE_OPEN, CT_UNKNOWN },
+                    { CT_UNKNOWN, CT_SQUARE_CLOSE })
+
+         // "[3]" vs "[ 3 ]" or for objective-c "@[@3]" vs "@[ @3 ]"
+         if (chunk_is_token(first, CT_SQUARE_OPEN) || chunk_is_token(second, CT_SQUARE_CLOSE))
+         {
+            if (  language_is_set(LANG_OC)
+               && (  (get_chunk_parent_type(first) == CT_OC_AT && chunk_is_token(first, CT_SQUARE_OPEN))
+                  || (get_chunk_parent_type(second) == CT_OC_AT && chunk_is_token(second, CT_SQUARE_CLOSE)))
+               && (options::sp_inside_square_oc_array() != IARF_IGNORE))
+            {
+               // (OC) Add or remove space inside a non-empty Objective-C boxed array '@[' and
+               // ']'. If set to ignore, sp_inside_square is used.
+               log_rule("sp_inside_square_oc_array");
+               return(options::sp_inside_square_oc_array());
+            }
+            // Add or remove space inside a non-empty '[' and ']'.
+            log_rule("sp_inside_square");
+            return(options::sp_inside_square());
+         }
+         break;
+
+         SPACE_RULE({ CT_SQUARE_CLOSE, CT_FPAREN_OPEN })
+
+         if (chunk_is_token(first, CT_SQUARE_CLOSE) && chunk_is_token(second, CT_FPAREN_OPEN))
+         {
+            // Add or remove space between ']' and '(' when part of a function call.
+            log_rule("sp_square_fparen");
+            return(options::sp_square_fparen());
+         }
+         break;
+
+         SPACE_RULE({ CT_UNKNOWN, CT_SPAREN_CLOSE })
+
+         // "if(...)" vs "if( ... )"
+         if (  chunk_is_token(second, CT_SPAREN_CLOSE)
+            && (options::sp_inside_sparen_close() != IARF_IGNORE))
+         {
+            // Add or remove space before ')' of control statements.
+            // Overrides sp_inside_sparen.
+            log_rule("sp_inside_sparen_close");
+            return(options::sp_inside_sparen_close());
+         }
+         break;
+
+         SPACE_RULE({ CT_SPAREN_OPEN, CT_UNKNOWN })
+
+         if (  chunk_is_token(first, CT_SPAREN_OPEN)
+            && (options::sp_inside_sparen_open() != IARF_IGNORE))
+         {
+            // Add or remove space after '(' of control statements.
+            // Overrides sp_inside_sparen.
+            log_rule("sp_inside_sparen_open");
+            return(options::sp_inside_sparen_open());
+         }
+         break;
+
+         SPACE_RULE({ CT_SPAREN_OPEN, CT_UNKNOWN },
+                    { CT_UNKNOWN, CT_SPAREN_CLOSE })
+
+         if (chunk_is_token(first, CT_SPAREN_OPEN) || chunk_is_token(second, CT_SPAREN_CLOSE))
+         {
+            // Add or remove space inside '(' and ')' of control statements.
+            log_rule("sp_inside_sparen");
+            return(options::sp_inside_sparen());
+         }
+         break;
+
+         SPACE_RULE({ CT_CLASS_COLON, CT_UNKNOWN })
+
+         cacheable = false;
+
+         if (chunk_is_token(first, CT_CLASS_COLON))
+         {
+            if (  get_chunk_parent_type(first) == CT_OC_CLASS
+               && (  !chunk_get_prev_type(first, CT_OC_INTF, first->level, scope_e::ALL)
+                  && !chunk_get_prev_type(first, CT_OC_IMPL, first->level, scope_e::ALL)))
+            {
+               if (options::sp_after_oc_colon() != IARF_IGNORE)
+               {
+                  // (OC) Add or remove space after the colon in message specs,
+                  // i.e. '-(int) f:(int) x;' vs. '-(int) f: (int) x;'.
+                  log_rule("sp_after_oc_colon");
+                  return(options::sp_after_oc_colon());
+               }
+            }
+
+            if (options::sp_after_class_colon() != IARF_IGNORE)
+            {
+               // Add or remove space after class ':'.
+               log_rule("sp_after_class_colon");
+               return(options::sp_after_class_colon());
+            }
+         }
+         break;
+
+         SPACE_RULE({ CT_UNKNOWN, CT_CLASS_COLON })
+
+         cacheable = false;
+
+         if (chunk_is_token(second, CT_CLASS_COLON))
+         {
+            if (  get_chunk_parent_type(second) == CT_OC_CLASS
+               && (  !chunk_get_prev_type(second, CT_OC_INTF, second->level, scope_e::ALL)
+                  && !chunk_get_prev_type(second, CT_OC_IMPL, second->level, scope_e::ALL)))
+            {
+               if (get_chunk_parent_type(second) == CT_OC_CLASS && !chunk_get_prev_type(second, CT_OC_INTF, second->level, scope_e::ALL))
+               {
+                  if (options::sp_before_oc_colon() != IARF_IGNORE)
+                  {
+                     // (OC) Add or remove space before the colon in message specs,
+                     // i.e. '-(int) f: (int) x;' vs. '-(int) f : (int) x;'.
+                     log_rule("sp_before_oc_colon");
+                     return(options::sp_before_oc_colon());
+                  }
+               }
+            }
+
+            if (options::sp_before_class_colon() != IARF_IGNORE)
+            {
+               // Add or remove space before class ':'.
+               log_rule("sp_before_class_colon");
+               return(options::sp_before_class_colon());
+            }
+         }
+         break;
+
+         SPACE_RULE({ CT_CONSTR_COLON, CT_UNKNOWN })
+
+         if (  (options::sp_after_constr_colon() != IARF_IGNORE)
+            && chunk_is_token(first, CT_CONSTR_COLON))
+         {
+            min_sp = options::indent_ctor_init_leading() - 1; // default indent is 1 space
+
+            // Add or remove space after class constructor ':'.
+            log_rule("sp_after_constr_colon");
+            return(options::sp_after_constr_colon());
+         }
+         break;
+
+         SPACE_RULE({ CT_UNKNOWN, CT_CONSTR_COLON })
+
+         if (  (options::sp_before_constr_colon() != IARF_IGNORE)
+            && chunk_is_token(second, CT_CONSTR_COLON))
+         {
+            // Add or remove space before class constructor ':'.
+            log_rule("sp_before_constr_colon");
+            return(options::sp_before_constr_colon());
+         }
+         break;
+
+         SPACE_RULE({ CT_UNKNOWN, CT_CASE_COLON })
+
+         if (  (options::sp_before_case_colon() != IARF_IGNORE)
+            && chunk_is_token(second, CT_CASE_COLON))
+         {
+            // Add or remove space before case ':'.
+            log_rule("sp_before_case_colon");
+            return(options::sp_before_case_colon());
+         }
+         break;
+
+         SPACE_RULE({ CT_DOT, CT_UNKNOWN })
+
+         if (chunk_is_token(first, CT_DOT))
+         {
+            log_rule("REMOVE");
+            return(IARF_REMOVE);
+         }
+         break;
+
+         SPACE_RULE({ CT_UNKNOWN, CT_DOT })
+
+         if (chunk_is_token(second, CT_DOT))
+         {
+            log_rule("ADD");
+            return(IARF_ADD);
+         }
+         break;
+
+         SPACE_RULE({ CT_NULLCOND, CT_UNKNOWN },
+                    { CT_UNKNOWN, CT_NULLCOND })
+
+         if (chunk_is_token(first, CT_NULLCOND) || chunk_is_token(second, CT_NULLCOND))
+         {
+            // Add or remove space around the '.' or '->' operators.
+            log_rule("sp_member");
+            return(options::sp_member());
+         }
+         break;
+
+         SPACE_RULE({ CT_ARITH, CT_UNKNOWN },
+                    { CT_CARET, CT_UNKNOWN },
+                    { CT_UNKNOWN, CT_ARITH },
+                    { CT_UNKNOWN, CT_CARET })
+
+         cacheable = false;
+
+         if (  chunk_is_token(first, CT_ARITH)
+            || chunk_is_token(first, CT_CARET)
+            || chunk_is_token(second, CT_ARITH)
+            || chunk_is_token(second, CT_CARET))
+         {
+            // Add or remove space around arithmetic operators '+' and '-'.
+            // Overrides sp_arith.
+            if (options::sp_arith_additive() != IARF_IGNORE)
+            {
+               auto arith_char = (chunk_is_token(first, CT_ARITH) || chunk_is_token(first, CT_CARET))
+                                 ? first->str[0] : second->str[0];
+
+               if (arith_char == '+' || arith_char == '-')
+               {
+                  log_rule("sp_arith_additive");
+                  return(options::sp_arith_additive());
+               }
+            }
+            // Add or remove space around non-assignment symbolic operators ('+', '/', '%',
+            // '<<', and so forth).
+            log_rule("sp_arith");
+            return(options::sp_arith());
+         }
+         break;
+
+         SPACE_RULE({ CT_BOOL, CT_UNKNOWN },
+                    { CT_UNKNOWN, CT_BOOL })
+
+         cacheable = false;
+
+         if (chunk_is_token(first, CT_BOOL) || chunk_is_token(second, CT_BOOL))
+         {
+            // Add or remove space around boolean operators '&&' and '||'.
+            iarf_e arg = options::sp_bool();
+
+            if (  (options::pos_bool() != TP_IGNORE)
+               && first->orig_line != second->orig_line
+               && arg != IARF_REMOVE)
+            {
+               arg = arg | IARF_ADD;
+            }
+            // TODO check it
+            log_rule("sp_bool");
+            return(arg);
+         }
+         break;
+
+         SPACE_RULE({ CT_COMPARE, CT_UNKNOWN },
+                    { CT_UNKNOWN, CT_COMPARE })
+
+         if (chunk_is_token(first, CT_COMPARE) || chunk_is_token(second, CT_COMPARE))
+         {
+            // Add or remove space around compare operator '<', '>', '==', etc.
+            log_rule("sp_compare");
+            return(options::sp_compare());
+         }
+         break;
+
+         SPACE_RULE({ CT_PAREN_OPEN, CT_PTR_TYPE })
+
+         if (chunk_is_token(first, CT_PAREN_OPEN) && chunk_is_token(second, CT_PTR_TYPE))
+         {
+            log_rule("REMOVE");
+            return(IARF_REMOVE);
+         }
+         break;
+
+         SPACE_RULE({ CT_PTR_TYPE, CT_FPAREN_OPEN },
+                    { CT_PTR_TYPE, CT_TPAREN_OPEN })
+
+         if (  chunk_is_token(first, CT_PTR_TYPE)
+            && (options::sp_ptr_star_paren() != IARF_IGNORE)
+            && (chunk_is_token(second, CT_FPAREN_OPEN) || chunk_is_token(second, CT_TPAREN_OPEN)))
+         {
+            // Add or remove space after a pointer star '*', if followed by an open
+            // parenthesis, as in 'void* (*)().
+            log_rule("sp_ptr_star_paren");
+            return(options::sp_ptr_star_paren());
+         }
+         break;
+
+         SPACE_RULE({ CT_PTR_TYPE, CT_PTR_TYPE })
+
+         if (  chunk_is_token(first, CT_PTR_TYPE)
+            && chunk_is_token(second, CT_PTR_TYPE)
+            && (options::sp_between_ptr_star() != IARF_IGNORE))
+         {
+            // Add or remove space between pointer stars '*'.
+            log_rule("sp_between_ptr_star");
+            return(options::sp_between_ptr_star());
+         }
+         break;
+
+         SPACE_RULE({ CT_PTR_TYPE, CT_UNKNOWN })
+
+         if (  chunk_is_token(first, CT_PTR_TYPE)
+            && (options::sp_after_ptr_star_func() != IARF_IGNORE)
+            && (  get_chunk_parent_type(first) == CT_FUNC_DEF
+               || get_chunk_parent_type(first) == CT_FUNC_PROTO
+               || get_chunk_parent_type(first) == CT_FUNC_VAR))
+         {
+            // Add or remove space after a pointer star '*', if followed by a function
+            // prototype or function definition.
+            log_rule("sp_after_ptr_star_func");
+            return(options::sp_after_ptr_star_func());
+         }
+         break;
+
+         SPACE_RULE({ CT_PTR_TYPE, CT_UNKNOWN })
+
+         cacheable = false;
+
+         if (chunk_is_token(first, CT_PTR_TYPE) && CharTable::IsKw1(second->str[0]))
+         {
+            chunk_t *prev = chunk_get_prev(first);
+
+            if (chunk_is_token(prev, CT_IN))
+            {
+               // Add or remove space after the '*' (dereference) unary operator. This does
+               // not affect the spacing after a '*' that is part of a type.
+               log_rule("sp_deref");
+               return(options::sp_deref());
+            }
 
-   if (chunk_is_token(first, CT_OC_AVAILABLE_VALUE) || chunk_is_token(second, CT_OC_AVAILABLE_VALUE))
-   {
-      log_rule("IGNORE");
-      return(IARF_IGNORE);
-   }
+            if (  (  get_chunk_parent_type(first) == CT_FUNC_VAR
+                  || get_chunk_parent_type(first) == CT_FUNC_TYPE)
+               && options::sp_after_ptr_block_caret() != IARF_IGNORE)
+            {
+               // Add or remove space after pointer caret '^', if followed by a word.
+               log_rule("sp_after_ptr_block_caret");
+               return(options::sp_after_ptr_block_caret());
+            }
 
-   if (chunk_is_token(second, CT_OC_BLOCK_CARET))
-   {
-      // (OC) Add or remove space before a block pointer caret,
-      // i.e. '^int (int arg){...}' vs. ' ^int (int arg){...}'.
-      log_rule("sp_before_oc_block_caret");
-      return(options::sp_before_oc_block_caret());
-   }
+            if (  chunk_is_token(second, CT_QUALIFIER)
+               && (options::sp_after_ptr_star_qualifier() != IARF_IGNORE))
+            {
+               // Add or remove space after pointer star '*', if followed by a qualifier.
+               log_rule("sp_after_ptr_star_qualifier");
+               return(options::sp_after_ptr_star_qualifier());
+            }
 
-   if (chunk_is_token(first, CT_OC_BLOCK_CARET))
-   {
-      // (OC) Add or remove space after a block pointer caret,
-      // i.e. '^int (int arg){...}' vs. '^ int (int arg){...}'.
-      log_rule("sp_after_oc_block_caret");
-      return(options::sp_after_oc_block_caret());
-   }
+            // Add or remove space after pointer star '*', if followed by a word.
+            if (options::sp_after_ptr_star() != IARF_IGNORE)
+            {
+               log_rule("sp_after_ptr_star");
+               return(options::sp_after_ptr_star());
+            }
+         }
+         break;
 
-   if (chunk_is_token(second, CT_OC_MSG_FUNC))
-   {
-      if (  (options::sp_after_oc_msg_receiver() == IARF_REMOVE)
-         && (  (first->type != CT_SQUARE_CLOSE)
-            && (first->type != CT_FPAREN_CLOSE)
-            && (first->type != CT_PAREN_CLOSE)))
-      {
-         log_rule("FORCE");
-         return(IARF_FORCE);
-      }
-      // (OC) Add or remove space between the receiver and selector in a message,
-      // as in '[receiver selector ...]'.
-      log_rule("sp_after_oc_msg_receiver");
-      return(options::sp_after_oc_msg_receiver());
-   }
+         SPACE_RULE({ CT_PTR_TYPE, CT_PAREN_OPEN })
 
-   // c++17 structured bindings e.g., "auto [x, y, z]" vs a[x, y, z]" or "auto const [x, y, z]" vs "auto const[x, y, z]"
-   if (  language_is_set(LANG_CPP)
-      && (  chunk_is_token(first, CT_BYREF)
-         || chunk_is_token(first, CT_QUALIFIER)
-         || chunk_is_token(first, CT_TYPE))
-      && chunk_is_token(second, CT_SQUARE_OPEN)
-      && get_chunk_parent_type(second) != CT_OC_MSG
-      && get_chunk_parent_type(second) != CT_CS_SQ_STMT)
-   {
-      // Add or remove space before C++17 structured bindings.
-      log_rule("sp_cpp_before_struct_binding");
-      return(options::sp_cpp_before_struct_binding());
-   }
+         if (  chunk_is_token(first, CT_PTR_TYPE)
+            && chunk_is_token(second, CT_PAREN_OPEN))
+         {
+            // Add or remove space after pointer star '*', if followed by a word.
+            log_rule("sp_after_ptr_star");
+            return(options::sp_after_ptr_star());
+         }
+         break;
 
-   // "a [x]" vs "a[x]"
-   if (  chunk_is_token(second, CT_SQUARE_OPEN)
-      && (  get_chunk_parent_type(second) != CT_OC_MSG
-         && get_chunk_parent_type(second) != CT_CS_SQ_STMT
-         && get_chunk_parent_type(second) != CT_CPP_LAMBDA))
-   {
-      if (second->flags.test(PCF_IN_SPAREN) && (chunk_is_token(first, CT_IN)))
-      {
-         log_rule("FORCE");
-         return(IARF_FORCE);
-      }
+         SPACE_RULE({ CT_UNKNOWN, CT_PTR_TYPE })
 
-      if (chunk_is_token(first, CT_ASM_COLON))
-      {
-         // Add or remove space before '[' for asm block.
-         log_rule("sp_before_square_asm_block");
-         return(options::sp_before_square_asm_block());
-      }
+         cacheable = false;
 
-      if (first->flags.test(PCF_VAR_DEF))
-      {
-         // Add or remove space before '[' for a variable definition.
-         log_rule("sp_before_vardef_square");
-         return(options::sp_before_vardef_square());
-      }
-      // Add or remove space before '[' (except '[]').
-      log_rule("sp_before_square");
-      return(options::sp_before_square());
-   }
+         if (chunk_is_token(second, CT_PTR_TYPE) && first->type != CT_IN)
+         {
+            if (language_is_set(LANG_CS) && chunk_is_nullable(second))
+            {
+               min_sp = 0;
+               log_rule("REMOVE");
+               return(IARF_REMOVE);
+            }
 
-   // "byte[]" vs "byte []"
-   if (chunk_is_token(second, CT_TSQUARE))
-   {
-      // Add or remove space before '[]'.
-      log_rule("sp_before_squares");
-      return(options::sp_before_squares());
-   }
+            // Add or remove space before a pointer star '*', if followed by a function
+            // prototype or function definition.
+            if (options::sp_before_ptr_star_func() != IARF_IGNORE)
+            {
+               // Find the next non-'*' chunk
+               chunk_t *next = second;
 
-   if (  (options::sp_angle_shift() != IARF_IGNORE)
-      && chunk_is_token(first, CT_ANGLE_CLOSE)
-      && chunk_is_token(second, CT_ANGLE_CLOSE))
-   {
-      // Add or remove space between '>' and '>' in '>>' (template stuff).
-      log_rule("sp_angle_shift");
-      return(options::sp_angle_shift());
-   }
+               do
+               {
+                  next = chunk_get_next(next);
+               } while (chunk_is_token(next, CT_PTR_TYPE));
 
-   // spacing around template < > stuff
-   if (  chunk_is_token(first, CT_ANGLE_OPEN)
-      || chunk_is_token(second, CT_ANGLE_CLOSE))
-   {
-      if (  chunk_is_token(first, CT_ANGLE_OPEN)
-         && chunk_is_token(second, CT_ANGLE_CLOSE))
-      {
-         // Add or remove space inside '<>'.
-         log_rule("sp_inside_angle_empty");
-         return(options::sp_inside_angle_empty());
-      }
-      // Add or remove space inside '<' and '>'.
-      log_rule("sp_inside_angle");
-      iarf_e op = options::sp_inside_angle();
-
-      // special: if we're not supporting digraphs, then we shouldn't create them!
-      if (  (op == IARF_REMOVE)
-         && !options::enable_digraphs()
-         && chunk_is_token(first, CT_ANGLE_OPEN)
-         && chunk_is_token(second, CT_DC_MEMBER))
-      {
-         op = IARF_IGNORE;
-      }
-      // TODO log_rule??
-      return(op);
-   }
+               if (chunk_is_token(next, CT_FUNC_DEF) || chunk_is_token(next, CT_FUNC_PROTO))
+               {
+                  log_rule("sp_before_ptr_star_func");
+                  return(options::sp_before_ptr_star_func());
+               }
+            }
 
-   if (chunk_is_token(second, CT_ANGLE_OPEN))
-   {
-      if (  chunk_is_token(first, CT_TEMPLATE)
-         && (options::sp_template_angle() != IARF_IGNORE))
-      {
-         // Add or remove space between 'template' and '<'.
-         // If set to ignore, sp_before_angle is used.
-         log_rule("sp_template_angle");
-         return(options::sp_template_angle());
-      }
+            // Add or remove space before pointer star '*' that isn't followed by a
+            // variable name. If set to 'ignore', sp_before_ptr_star is used instead.
+            if (options::sp_before_unnamed_ptr_star() != IARF_IGNORE)
+            {
+               chunk_t *next = chunk_get_next_nc(second);
 
-      if (first->type != CT_QUALIFIER)
-      {
-         // Add or remove space before '<'.
-         log_rule("sp_before_angle");
-         return(options::sp_before_angle());
-      }
-   }
+               while (chunk_is_token(next, CT_PTR_TYPE))
+               {
+                  next = chunk_get_next_nc(next);
+               }
 
-   if (chunk_is_token(first, CT_ANGLE_CLOSE))
-   {
-      if (chunk_is_token(second, CT_WORD) || CharTable::IsKw1(second->str[0]))
-      {
-         // Add or remove space between '>' and a word as in 'List<byte> m;' or
-         // 'template <typename T> static ...'.
-         if (options::sp_angle_word() != IARF_IGNORE)
-         {
-            log_rule("sp_angle_word");
-            return(options::sp_angle_word());
+               if (next != nullptr && next->type != CT_WORD)
+               {
+                  log_rule("sp_before_unnamed_ptr_star");
+                  return(options::sp_before_unnamed_ptr_star());
+               }
+            }
+
+            // Add or remove space before pointer star '*'.
+            if (options::sp_before_ptr_star() != IARF_IGNORE)
+            {
+               log_rule("sp_before_ptr_star");
+               return(options::sp_before_ptr_star());
+            }
          }
-      }
+         break;
 
-      if (chunk_is_token(second, CT_FPAREN_OPEN) || chunk_is_token(second, CT_PAREN_OPEN))
-      {
-         chunk_t *next = chunk_get_next_ncnl(second);
+         SPACE_RULE({ CT_OPERATOR, CT_UNKNOWN })
 
-         if (chunk_is_token(next, CT_FPAREN_CLOSE))
+         if (chunk_is_token(first, CT_OPERATOR))
          {
-            // Add or remove space between '>' and '()' as found in 'new List<byte>();'.
-            log_rule("sp_angle_paren_empty");
-            return(options::sp_angle_paren_empty());
+            // Add or remove space between 'operator' and operator sign.
+            log_rule("sp_after_operator");
+            return(options::sp_after_operator());
          }
-         // Add or remove space between '>' and '(' as found in 'new List<byte>(foo);'.
-         log_rule("sp_angle_paren");
-         return(options::sp_angle_paren());
-      }
+         break;
 
-      if (chunk_is_token(second, CT_DC_MEMBER))
-      {
-         // Add or remove space before the '::' operator.
-         log_rule("sp_before_dc");
-         return(options::sp_before_dc());
-      }
+         SPACE_RULE({ CT_UNKNOWN, CT_FUNC_PROTO },
+                    { CT_UNKNOWN, CT_FUNC_DEF })
 
-      if (  second->type != CT_BYREF
-         && second->type != CT_PTR_TYPE
-         && second->type != CT_BRACE_OPEN
-         && second->type != CT_PAREN_CLOSE)
-      {
-         if (  chunk_is_token(second, CT_CLASS_COLON)
-            && options::sp_angle_colon() != IARF_IGNORE)
+         if (chunk_is_token(second, CT_FUNC_PROTO) || chunk_is_token(second, CT_FUNC_DEF))
          {
-            // Add or remove space between '>' and ':'.
-            log_rule("sp_angle_colon");
-            return(options::sp_angle_colon());
+            if (first->type != CT_PTR_TYPE && first->type != CT_BYREF)
+            {
+               // Add or remove space between return type and function name. A
+               // minimum of 1 is forced except for pointer/reference return types.
+               log_rule("sp_type_func|ADD");
+               return(options::sp_type_func() | IARF_ADD);
+            }
+            // Add or remove space between return type and function name. A
+            // minimum of 1 is forced except for pointer/reference return types.
+            log_rule("sp_type_func");
+            return(options::sp_type_func());
          }
+         break;
 
-         if (  chunk_is_token(second, CT_FPAREN_CLOSE)
-            && options::sp_inside_fparen() != IARF_IGNORE
-            && options::use_sp_after_angle_always() == false)
+         SPACE_RULE({ CT_PAREN_CLOSE, CT_UNKNOWN })
+
+         // "(int)a" vs "(int) a" or "cast(int)a" vs "cast(int) a"
+         if (  (get_chunk_parent_type(first) == CT_C_CAST || get_chunk_parent_type(first) == CT_D_CAST)
+            && chunk_is_token(first, CT_PAREN_CLOSE))
          {
-            // Add or remove space between '>' and ')'.
-            log_rule("sp_inside_fparen");
-            return(options::sp_inside_fparen());
+            log_rule("sp_after_cast");
+            return(options::sp_after_cast());
          }
-         // Add or remove space after '>'.
-         log_rule("sp_after_angle");
-         return(options::sp_after_angle());
-      }
-   }
+         break;
 
-   if (chunk_is_token(first, CT_BYREF))
-   {
-      if (  options::sp_after_byref_func() != IARF_IGNORE
-         && (  get_chunk_parent_type(first) == CT_FUNC_DEF
-            || get_chunk_parent_type(first) == CT_FUNC_PROTO))
-      {
-         // Add or remove space after a reference sign '&', if followed by a function
-         // prototype or function definition.
-         log_rule("sp_after_byref_func");
-         return(options::sp_after_byref_func());
-      }
+         SPACE_RULE({ CT_BRACE_CLOSE, CT_UNKNOWN })
 
-      if (  (  CharTable::IsKw1(second->str[0])
-            && (  options::sp_after_byref() != IARF_IGNORE
-               || (  !chunk_is_token(second, CT_FUNC_PROTO)
-                  && !chunk_is_token(second, CT_FUNC_DEF))))
-         || chunk_is_token(second, CT_PAREN_OPEN))
-      {
-         // Add or remove space after reference sign '&', if followed by a word.
-         log_rule("sp_after_byref");
-         return(options::sp_after_byref());
-      }
-   }
+         if (chunk_is_token(first, CT_BRACE_CLOSE))
+         {
+            if (chunk_is_token(second, CT_ELSE))
+            {
+               // Add or remove space between '}' and 'else' if on the same line.
+               log_rule("sp_brace_else");
+               return(options::sp_brace_else());
+            }
 
-   if (  chunk_is_token(second, CT_BYREF)
-      && !chunk_is_token(first, CT_PAREN_OPEN))
-   {
-      // Add or remove space before a reference sign '&', if followed by a function
-      // prototype or function definition.
-      if (options::sp_before_byref_func() != IARF_IGNORE)
-      {
-         chunk_t *next = chunk_get_next(second);
+            if (  language_is_set(LANG_OC)
+               && chunk_is_token(second, CT_CATCH)
+               && (options::sp_oc_brace_catch() != IARF_IGNORE))
+            {
+               // (OC) Add or remove space between '}' and '@catch' if on the same line.
+               // If set to ignore, sp_brace_catch is used.
+               log_rule("sp_oc_brace_catch");
+               return(options::sp_oc_brace_catch());
+            }
 
-         if (  next != nullptr
-            && (  get_chunk_parent_type(next) == CT_FUNC_DEF
-               || get_chunk_parent_type(next) == CT_FUNC_PROTO))
-         {
-            log_rule("sp_before_byref_func");
-            return(options::sp_before_byref_func());
+            if (chunk_is_token(second, CT_CATCH))
+            {
+               // Add or remove space between '}' and 'catch' if on the same line.
+               log_rule("sp_brace_catch");
+               return(options::sp_brace_catch());
+            }
+
+            if (chunk_is_token(second, CT_FINALLY))
+            {
+               // Add or remove space between '}' and 'finally' if on the same line.
+               log_rule("sp_brace_finally");
+               return(options::sp_brace_finally());
+            }
          }
-      }
+         break;
 
-      // Add or remove space before a reference sign '&' that isn't followed by a
-      // variable name. If set to 'ignore', sp_before_byref is used instead.
-      if (options::sp_before_unnamed_byref() != IARF_IGNORE)
-      {
-         chunk_t *next = chunk_get_next_nc(second);
+         SPACE_RULE({ CT_BRACE_OPEN, CT_UNKNOWN })
 
-         if (next != nullptr && next->type != CT_WORD)
-         {
-            log_rule("sp_before_unnamed_byref");
-            return(options::sp_before_unnamed_byref());
-         }
-      }
-      // Add or remove space before a reference sign '&'.
-      log_rule("sp_before_byref");
-      return(options::sp_before_byref());
-   }
+         cacheable = false;
 
-   if (chunk_is_token(first, CT_SPAREN_CLOSE))
-   {
-      if (chunk_is_token(second, CT_BRACE_OPEN))
-      {
-         if (get_chunk_parent_type(second) == CT_CATCH)
+         if (chunk_is_token(first, CT_BRACE_OPEN))
          {
-            if (language_is_set(LANG_OC) && (options::sp_oc_catch_brace() != IARF_IGNORE))
+            if (get_chunk_parent_type(first) == CT_ENUM)
             {
-               // (OC) Add or remove space before the '{' of a '@catch' statement, if the '{'
-               // and '@catch' are on the same line, as in '@catch (decl) <here> {'.
-               // If set to ignore, sp_catch_brace is used.
-               log_rule("sp_oc_catch_brace");
-               return(options::sp_oc_catch_brace());
+               // Add or remove space inside enum '{' and '}'.
+               log_rule("sp_inside_braces_enum");
+               return(options::sp_inside_braces_enum());
+            }
+
+            if (get_chunk_parent_type(first) == CT_STRUCT || get_chunk_parent_type(first) == CT_UNION)
+            {
+               // Fix for issue #1240  adding space in struct initializers
+               chunk_t *tmp = chunk_get_prev_ncnl(first);
+
+               if (chunk_is_token(tmp, CT_ASSIGN))
+               {
+                  log_rule("IGNORE");
+                  return(IARF_IGNORE);
+               }
+               // Add or remove space inside struct/union '{' and '}'.
+               log_rule("sp_inside_braces_struct");
+               return(options::sp_inside_braces_struct());
+            }
+            else if (  get_chunk_parent_type(first) == CT_OC_AT
+                    && options::sp_inside_braces_oc_dict() != IARF_IGNORE)
+            {
+               // (OC) Add or remove space inside Objective-C boxed dictionary '{' and '}'
+               log_rule("sp_inside_braces_oc_dict");
+               return(options::sp_inside_braces_oc_dict());
+            }
+
+            if (get_chunk_parent_type(first) == CT_BRACED_INIT_LIST)
+            {
+               // Add or remove space between nested braces, i.e. '{{' vs '{ {'.
+               if (  options::sp_brace_brace() != IARF_IGNORE
+                  && chunk_is_token(second, CT_BRACE_OPEN)
+                  && get_chunk_parent_type(second) == CT_BRACED_INIT_LIST)
+               {
+                  log_rule("sp_brace_brace");
+                  return(options::sp_brace_brace());
+               }
+
+               if (options::sp_after_type_brace_init_lst_open() != IARF_IGNORE)
+               {
+                  // Add or remove space after open brace in an unnamed temporary
+                  // direct-list-initialization.
+                  log_rule("sp_after_type_brace_init_lst_open");
+                  return(options::sp_after_type_brace_init_lst_open());
+               }
+
+               if (options::sp_inside_type_brace_init_lst() != IARF_IGNORE)
+               {
+                  // Add or remove space inside an unnamed temporary direct-list-initialization.
+                  log_rule("sp_inside_type_brace_init_lst");
+                  return(options::sp_inside_type_brace_init_lst());
+               }
             }
 
-            if (options::sp_catch_brace() != IARF_IGNORE)
+            if (!chunk_is_comment(second))
             {
-               // Add or remove space before the '{' of a 'catch' statement, if the '{' and
-               // 'catch' are on the same line, as in 'catch (decl) <here> {'.
-               log_rule("sp_catch_brace");
-               return(options::sp_catch_brace());
+               // Add or remove space inside '{' and '}'.
+               log_rule("sp_inside_braces");
+               return(options::sp_inside_braces());
             }
          }
+         break;
 
-         if (options::sp_sparen_brace() != IARF_IGNORE)
+         SPACE_RULE({ CT_BRACE_CLOSE, CT_UNKNOWN })
+
+         if (  chunk_is_token(first, CT_BRACE_CLOSE)
+            && first->flags.test(PCF_IN_TYPEDEF)
+            && (  get_chunk_parent_type(first) == CT_ENUM
+               || get_chunk_parent_type(first) == CT_STRUCT
+               || get_chunk_parent_type(first) == CT_UNION))
          {
-            // Add or remove space between ')' and '{' of of control statements.
-            log_rule("sp_sparen_brace");
-            return(options::sp_sparen_brace());
+            // Add or remove space between '}' and the name of a typedef on the same line.
+            log_rule("sp_brace_typedef");
+            return(options::sp_brace_typedef());
          }
-      }
+         break;
 
-      if (  !chunk_is_comment(second)
-         && (options::sp_after_sparen() != IARF_IGNORE))
-      {
-         // Add or remove space after ')' of control statements.
-         log_rule("sp_after_sparen");
-         return(options::sp_after_sparen());
-      }
-   }
+         SPACE_RULE({ CT_UNKNOWN, CT_PAREN_OPEN })
 
-   if (  chunk_is_token(first, CT_VBRACE_OPEN)
-      && chunk_is_token(second, CT_SEMICOLON)) // Issue # 1158
-   {
-      // Add or remove space before ';'.
-      log_rule("sp_before_semi");
-      return(options::sp_before_semi());
-   }
+         if (chunk_is_token(second, CT_PAREN_OPEN) && get_chunk_parent_type(second) == CT_TEMPLATE)
+         {
+            // (D) Add or remove space before the parenthesis in the D constructs
+            // 'template Foo(' and 'class Foo('.
+            log_rule("sp_before_template_paren");
+            return(options::sp_before_template_paren());
+         }
+         break;
 
-   if (  chunk_is_token(second, CT_FPAREN_OPEN)
-      && get_chunk_parent_type(first) == CT_OPERATOR
-      && (options::sp_after_operator_sym() != IARF_IGNORE))
-   {
-      if (  (options::sp_after_operator_sym_empty() != IARF_IGNORE)
-         && chunk_is_token(second, CT_FPAREN_OPEN))
-      {
-         chunk_t *next = chunk_get_next_ncnl(second);
+         SPACE_RULE({ CT_PAREN_CLOSE, CT_UNKNOWN })
 
-         if (chunk_is_token(next, CT_FPAREN_CLOSE))
+         if (  !chunk_is_token(second, CT_PTR_TYPE)
+            && chunk_is_token(first, CT_PAREN_CLOSE)
+            && get_chunk_parent_type(first) == CT_DECLTYPE)
          {
-            // Overrides sp_after_operator_sym when the operator has no arguments, as in
-            // 'operator *()'.
-            log_rule("sp_after_operator_sym_empty");
-            return(options::sp_after_operator_sym_empty());
+            if (auto arg = iarf_flags_t{ options::sp_after_decltype() })
+            {
+               // Add or remove space between 'decltype(...)' and word.
+               log_rule("sp_after_decltype");
+               return(arg);
+            }
+            // Add or remove space between type and word.
+            log_rule("sp_after_type");
+            return(options::sp_after_type());
          }
-      }
-      // Add or remove space between the operator symbol and the open parenthesis, as
-      // in 'operator ++('.
-      log_rule("sp_after_operator_sym");
-      return(options::sp_after_operator_sym());
-   }
-
-   // Issue #2270
-   // Translations under vala
-   if (  language_is_set(LANG_VALA)
-      && chunk_is_token(first, CT_FUNC_CALL))
-   {
-      if (  chunk_is_str(first, "_", 1)
-         && chunk_is_token(second, CT_FPAREN_OPEN)
-         && (options::sp_vala_after_translation() != IARF_IGNORE))
-      {
-         // Add or remove space after '_'.
-         log_rule("sp_vala_after_translation");
-         return(options::sp_vala_after_translation());
-      }
-   }
+         break;
 
-   // spaces between function and open paren
-   if (  chunk_is_token(first, CT_FUNC_CALL)
-      || chunk_is_token(first, CT_FUNC_CTOR_VAR)
-      || chunk_is_token(first, CT_CNG_HASINC)
-      || chunk_is_token(first, CT_CNG_HASINCN))
-   {
-      if (  (options::sp_func_call_paren_empty() != IARF_IGNORE)
-         && chunk_is_token(second, CT_FPAREN_OPEN))
-      {
-         chunk_t *next = chunk_get_next_ncnl(second);
+         SPACE_RULE({ CT_UNKNOWN, CT_QUESTION })
 
-         if (chunk_is_token(next, CT_FPAREN_CLOSE))
+         if (  language_is_set(LANG_VALA)
+            && chunk_is_token(second, CT_QUESTION))
          {
-            // Add or remove space between function name and '()' on function calls without
-            // parameters. If set to 'ignore' (the default), sp_func_call_paren is used.
-            log_rule("sp_func_call_paren_empty");
-            return(options::sp_func_call_paren_empty());
+            // Issue #2090
+            // (D) Add or remove space between a type and '?'.
+            log_rule("sp_type_question");
+            return(options::sp_type_question());
          }
-      }
-      // Add or remove space between function name and '(' on function calls.
-      log_rule("sp_func_call_paren");
-      return(options::sp_func_call_paren());
-   }
+         break;
 
-   if (chunk_is_token(first, CT_FUNC_CALL_USER))
-   {
-      // Add or remove space between the user function name and '(' on function
-      // calls. You need to set a keyword to be a user function in the config file,
-      // like:
-      //   set func_call_user tr _ i18n
-      log_rule("sp_func_call_user_paren");
-      return(options::sp_func_call_user_paren());
-   }
+         SPACE_RULE({ CT_PAREN_CLOSE, CT_UNKNOWN })
 
-   if (chunk_is_token(first, CT_ATTRIBUTE) && chunk_is_paren_open(second))
-   {
-      // Add or remove space between '__attribute__' and '('.
-      log_rule("sp_attribute_paren");
-      return(options::sp_attribute_paren());
-   }
+         cacheable = false;
 
-   if (chunk_is_token(first, CT_FUNC_DEF))
-   {
-      if (  (options::sp_func_def_paren_empty() != IARF_IGNORE)
-         && chunk_is_token(second, CT_FPAREN_OPEN))
-      {
-         chunk_t *next = chunk_get_next_ncnl(second);
+         // see if the D template expression is used as a type
+         if (  language_is_set(LANG_D)
+            && chunk_is_token(first, CT_PAREN_CLOSE)
+            && get_chunk_parent_type(first) == CT_D_TEMPLATE)
+         {
+            if (get_chunk_parent_type(second) == CT_USING_ALIAS)
+            {
+               log_rule("sp_after_type | ADD");
+               return(options::sp_after_type() | IARF_ADD);
+            }
+
+            if (chunk_is_token(second, CT_WORD))
+            {
+               chunk_t *open_paren = chunk_skip_to_match_rev(first);
+               chunk_t *type       = chunk_get_prev(chunk_get_prev(open_paren));
+
+               if (chunk_is_token(type, CT_TYPE))
+               {
+                  log_rule("sp_after_type");
+                  return(options::sp_after_type());
+               }
+            }
+         }
+         break;
+
+         SPACE_RULE({ CT_QUALIFIER, CT_UNKNOWN },
+                    { CT_TYPE, CT_UNKNOWN })
 
-         if (chunk_is_token(next, CT_FPAREN_CLOSE))
+         if (  !chunk_is_token(second, CT_PTR_TYPE)
+            && (chunk_is_token(first, CT_QUALIFIER) || chunk_is_token(first, CT_TYPE)))
          {
-            // Add or remove space between function name and '()' on function definition
-            // without parameters.
-            log_rule("sp_func_def_paren_empty");
-            return(options::sp_func_def_paren_empty());
+            // Add or remove space between type and word.
+            iarf_e arg = options::sp_after_type();
+            log_rule("sp_after_type");
+            return(arg);
          }
-      }
-      // Add or remove space between function name and '(' on function definition.
-      log_rule("sp_func_def_paren");
-      return(options::sp_func_def_paren());
-   }
+         break;
 
-   if (chunk_is_token(first, CT_CPP_CAST) || chunk_is_token(first, CT_TYPE_WRAP))
-   {
-      // Add or remove space between the type and open parenthesis in a C++ cast,
-      // i.e. 'int(exp)' vs. 'int (exp)'.
-      log_rule("sp_cpp_cast_paren");
-      return(options::sp_cpp_cast_paren());
-   }
+         SPACE_RULE({ CT_MACRO_OPEN, CT_UNKNOWN },
+                    { CT_MACRO_CLOSE, CT_UNKNOWN },
+                    { CT_MACRO_ELSE, CT_UNKNOWN })
 
-   if (chunk_is_token(first, CT_SPAREN_CLOSE) && chunk_is_token(second, CT_WHEN))
-   {
-      log_rule("FORCE");
-      return(IARF_FORCE); // TODO: make this configurable?
-   }
+         if (  chunk_is_token(first, CT_MACRO_OPEN)
+            || chunk_is_token(first, CT_MACRO_CLOSE)
+            || chunk_is_token(first, CT_MACRO_ELSE))
+         {
+            if (chunk_is_token(second, CT_PAREN_OPEN))
+            {
+               // Add or remove space between function name and '(' on function calls.
+               log_rule("sp_func_call_paren");
+               return(options::sp_func_call_paren());
+            }
+            log_rule("IGNORE");
+            return(IARF_IGNORE);
+         }
+         break;
 
-   if (  chunk_is_token(first, CT_PAREN_CLOSE)
-      && (chunk_is_token(second, CT_PAREN_OPEN) || chunk_is_token(second, CT_FPAREN_OPEN)))
-   {
-      // "(int)a" vs "(int) a" or "cast(int)a" vs "cast(int) a"
-      if (get_chunk_parent_type(first) == CT_C_CAST || get_chunk_parent_type(first) == CT_D_CAST)
-      {
-         // Add or remove space after C/D cast, i.e. 'cast(int)a' vs. 'cast(int) a' or
-         // '(int)a' vs. '(int) a'.
-         log_rule("sp_after_cast");
-         return(options::sp_after_cast());
-      }
-      // Must be an indirect/chained function call?
-      log_rule("REMOVE");
-      return(IARF_REMOVE);  // TODO: make this configurable?
-   }
+         SPACE_RULE({ CT_PTR_TYPE, CT_UNKNOWN },
+                    { CT_UNKNOWN, CT_PTR_TYPE })
 
-   // handle the space between parens in fcn type 'void (*f)(void)'
-   if (chunk_is_token(first, CT_TPAREN_CLOSE))
-   {
-      // Add or remove space between the ')' and '(' in a function type, as in
-      // 'void (*x)(...)'.
-      log_rule("sp_after_tparen_close");
-      return(options::sp_after_tparen_close());
-   }
+         // If nothing claimed the PTR_TYPE, then return ignore
+         if (chunk_is_token(first, CT_PTR_TYPE) || chunk_is_token(second, CT_PTR_TYPE))
+         {
+            log_rule("IGNORE");
+            return(IARF_IGNORE);
+         }
+         break;
 
-   // ")(" vs ") ("
-   if (  (  chunk_is_str(first, ")", 1)
-         && chunk_is_str(second, "(", 1))
-      || (chunk_is_paren_close(first) && chunk_is_paren_open(second)))
-   {
-      // Add or remove space between back-to-back parentheses, i.e. ')(' vs. ') ('.
-      log_rule("sp_cparen_oparen");
-      return(options::sp_cparen_oparen());
-   }
+         SPACE_RULE({ CT_NOT, CT_UNKNOWN })
 
-   if (  chunk_is_token(first, CT_FUNC_PROTO)
-      || (  chunk_is_token(second, CT_FPAREN_OPEN)
-         && get_chunk_parent_type(second) == CT_FUNC_PROTO))
-   {
-      if (  (options::sp_func_proto_paren_empty() != IARF_IGNORE)
-         && chunk_is_token(second, CT_FPAREN_OPEN))
-      {
-         chunk_t *next = chunk_get_next_ncnl(second);
+         if (chunk_is_token(first, CT_NOT))
+         {
+            // Add or remove space after the '!' (not) unary operator.
+            log_rule("sp_not");
+            return(options::sp_not());
+         }
+         break;
+
+         SPACE_RULE({ CT_INV, CT_UNKNOWN })
 
-         if (chunk_is_token(next, CT_FPAREN_CLOSE))
+         if (chunk_is_token(first, CT_INV))
          {
-            // Add or remove space between function name and '()' on function declaration
-            // without parameters.
-            log_rule("sp_func_proto_paren_empty");
-            return(options::sp_func_proto_paren_empty());
+            // Add or remove space after the '~' (invert) unary operator.
+            log_rule("sp_inv");
+            return(options::sp_inv());
          }
-      }
-      // Add or remove space between function name and '(' on function declaration.
-      log_rule("sp_func_proto_paren");
-      return(options::sp_func_proto_paren());
-   }
+         break;
 
-   // Issue #2437
-   if (  chunk_is_token(first, CT_FUNC_TYPE)
-      && chunk_is_token(second, CT_FPAREN_OPEN))
-   {
-      // Add or remove space between function name and '(' with a typedef specifier.
-      log_rule("sp_func_type_paren");
-      return(options::sp_func_type_paren());
-   }
+         SPACE_RULE({ CT_ADDR, CT_UNKNOWN })
 
-   if (chunk_is_token(first, CT_FUNC_CLASS_DEF) || chunk_is_token(first, CT_FUNC_CLASS_PROTO))
-   {
-      if (  (options::sp_func_class_paren_empty() != IARF_IGNORE)
-         && chunk_is_token(second, CT_FPAREN_OPEN))
-      {
-         chunk_t *next = chunk_get_next_ncnl(second);
+         if (chunk_is_token(first, CT_ADDR))
+         {
+            // Add or remove space after the '&' (address-of) unary operator. This does not
+            // affect the spacing after a '&' that is part of a type.
+            log_rule("sp_addr");
+            return(options::sp_addr());
+         }
+         break;
 
-         if (chunk_is_token(next, CT_FPAREN_CLOSE))
+         SPACE_RULE({ CT_DEREF, CT_UNKNOWN })
+
+         if (chunk_is_token(first, CT_DEREF))
          {
-            // Add or remove space between a constructor without parameters or destructor
-            // and '()'.
-            log_rule("sp_func_class_paren_empty");
-            return(options::sp_func_class_paren_empty());
+            // Add or remove space after the '*' (dereference) unary operator. This does
+            // not affect the spacing after a '*' that is part of a type.
+            log_rule("sp_deref");
+            return(options::sp_deref());
          }
-      }
-      // Add or remove space between a constructor/destructor and the open
-      // parenthesis.
-      log_rule("sp_func_class_paren");
-      return(options::sp_func_class_paren());
-   }
+         break;
 
-   if (chunk_is_token(first, CT_CLASS) && !first->flags.test(PCF_IN_OC_MSG))
-   {
-      log_rule("FORCE");
-      return(IARF_FORCE);
-   }
+         SPACE_RULE({ CT_POS, CT_UNKNOWN },
+                    { CT_NEG, CT_UNKNOWN })
 
-   if (chunk_is_token(first, CT_BRACE_OPEN) && chunk_is_token(second, CT_BRACE_CLOSE))
-   {
-      // Add or remove space inside '{}'.
-      log_rule("sp_inside_braces_empty");
-      return(options::sp_inside_braces_empty());
-   }
+         if (chunk_is_token(first, CT_POS) || chunk_is_token(first, CT_NEG))
+         {
+            // Add or remove space after '+' or '-', as in 'x = -5' or 'y = +7'.
+            log_rule("sp_sign");
+            return(options::sp_sign());
+         }
+         break;
 
-   if (  (  chunk_is_token(first, CT_TYPE)                           // Issue #2428
-         || chunk_is_token(first, CT_ANGLE_CLOSE))
-      && chunk_is_token(second, CT_BRACE_OPEN)
-      && get_chunk_parent_type(second) == CT_BRACED_INIT_LIST)
-   {
-      auto arg = iarf_flags_t{ options::sp_type_brace_init_lst() };
+         SPACE_RULE({ CT_INCDEC_BEFORE, CT_UNKNOWN },
+                    { CT_UNKNOWN, CT_INCDEC_AFTER })
 
-      if (  arg != iarf_e::IGNORE
-         || get_chunk_parent_type(first) != CT_DECLTYPE)
-      {
-         // 'int{9}' vs 'int {9}'
-         // Add or remove space between type and open brace of an unnamed temporary
-         // direct-list-initialization.
-         log_rule("sp_type_brace_init_lst");
-         return(arg);
-      }
-   }
+         if (chunk_is_token(first, CT_INCDEC_BEFORE) || chunk_is_token(second, CT_INCDEC_AFTER))
+         {
+            // Add or remove space between '++' and '--' the word to which it is being
+            // applied, as in '(--x)' or 'y++;'.
+            log_rule("sp_incdec");
+            return(options::sp_incdec());
+         }
+         break;
 
-   if (  (  chunk_is_token(first, CT_WORD)                           // Issue #2428
-         || chunk_is_token(first, CT_SQUARE_CLOSE)
-         || chunk_is_token(first, CT_TSQUARE))
-      && chunk_is_token(second, CT_BRACE_OPEN)
-      && get_chunk_parent_type(second) == CT_BRACED_INIT_LIST)
-   {
-      auto arg = iarf_flags_t{ options::sp_word_brace_init_lst() };
+         SPACE_RULE({ CT_UNKNOWN, CT_CS_SQ_COLON })
 
-      if (  arg != iarf_e::IGNORE
-         || get_chunk_parent_type(first) != CT_DECLTYPE)
-      {
-         // 'a{9}' vs 'a {9}'
-         // Add or remove space between variable/word and open brace of an unnamed
-         // temporary direct-list-initialization.
-         log_rule("sp_word_brace_init_lst");
-         return(arg);
-      }
-   }
+         if (chunk_is_token(second, CT_CS_SQ_COLON))
+         {
+            log_rule("REMOVE");
+            return(IARF_REMOVE);
+         }
+         break;
 
-   if (chunk_is_token(second, CT_BRACE_CLOSE))
-   {
-      if (get_chunk_parent_type(second) == CT_ENUM)
-      {
-         // Add or remove space inside enum '{' and '}'.
-         log_rule("sp_inside_braces_enum");
-         return(options::sp_inside_braces_enum());
-      }
+         SPACE_RULE({ CT_CS_SQ_COLON, CT_UNKNOWN })
+
+         if (chunk_is_token(first, CT_CS_SQ_COLON))
+         {
+            log_rule("FORCE");
+            return(IARF_FORCE);
+         }
+         break;
 
-      if (get_chunk_parent_type(second) == CT_STRUCT || get_chunk_parent_type(second) == CT_UNION)
-      {
-         // Fix for issue #1240  adding space in struct initializers
-         chunk_t *tmp = chunk_get_prev_ncnl(chunk_skip_to_match_rev(second));
+         SPACE_RULE({ CT_OC_SCOPE, CT_UNKNOWN })
 
-         if (chunk_is_token(tmp, CT_ASSIGN))
+         if (chunk_is_token(first, CT_OC_SCOPE))
          {
-            log_rule("IGNORE");
-            return(IARF_IGNORE);
+            // (OC) Add or remove space after the scope '+' or '-', as in '-(void) foo;'
+            // or '+(int) bar;'.
+            log_rule("sp_after_oc_scope");
+            return(options::sp_after_oc_scope());
          }
-         // Add or remove space inside struct/union '{' and '}'.
-         log_rule("sp_inside_braces_struct");
-         return(options::sp_inside_braces_struct());
-      }
-      else if (  get_chunk_parent_type(second) == CT_OC_AT
-              && options::sp_inside_braces_oc_dict() != IARF_IGNORE)
-      {
-         // (OC) Add or remove space inside Objective-C boxed dictionary '{' and '}'
-         log_rule("sp_inside_braces_oc_dict");
-         return(options::sp_inside_braces_oc_dict());
-      }
+         break;
 
-      if (get_chunk_parent_type(second) == CT_BRACED_INIT_LIST)
-      {
-         // Add or remove space between nested braces, i.e. '{{' vs '{ {'.
-         if (  options::sp_brace_brace() != IARF_IGNORE
-            && chunk_is_token(first, CT_BRACE_CLOSE)
-            && get_chunk_parent_type(first) == CT_BRACED_INIT_LIST)
+         SPACE_RULE({ CT_OC_DICT_COLON, CT_UNKNOWN })
+
+         if (chunk_is_token(first, CT_OC_DICT_COLON))
          {
-            log_rule("sp_brace_brace");
-            return(options::sp_brace_brace());
+            // (OC) Add or remove space after the colon in immutable dictionary expression
+            // 'NSDictionary *test = @{@"foo" :@"bar"};'.
+            log_rule("sp_after_oc_dict_colon");
+            return(options::sp_after_oc_dict_colon());
          }
+         break;
 
-         if (options::sp_before_type_brace_init_lst_close() != IARF_IGNORE)
+         SPACE_RULE({ CT_UNKNOWN, CT_OC_DICT_COLON })
+
+         if (chunk_is_token(second, CT_OC_DICT_COLON))
          {
-            // Add or remove space before close brace in an unnamed temporary
-            // direct-list-initialization.
-            log_rule("sp_before_type_brace_init_lst_close");
-            return(options::sp_before_type_brace_init_lst_close());
+            // (OC) Add or remove space before the colon in immutable dictionary expression
+            // 'NSDictionary *test = @{@"foo" :@"bar"};'.
+            log_rule("sp_before_oc_dict_colon");
+            return(options::sp_before_oc_dict_colon());
          }
+         break;
 
-         if (options::sp_inside_type_brace_init_lst() != IARF_IGNORE)
+         SPACE_RULE({ CT_OC_COLON, CT_UNKNOWN })
+
+         if (chunk_is_token(first, CT_OC_COLON))
          {
-            // Add or remove space inside an unnamed temporary direct-list-initialization.
-            log_rule("sp_inside_type_brace_init_lst");
-            return(options::sp_inside_type_brace_init_lst());
+            if (first->flags.test(PCF_IN_OC_MSG))
+            {
+               // (OC) Add or remove space after the colon in message specs,
+               // i.e. '[object setValue:1];' vs. '[object setValue: 1];'.
+               log_rule("sp_after_send_oc_colon");
+               return(options::sp_after_send_oc_colon());
+            }
+            // (OC) Add or remove space after the colon in message specs,
+            // i.e. '-(int) f:(int) x;' vs. '-(int) f: (int) x;'.
+            log_rule("sp_after_oc_colon");
+            return(options::sp_after_oc_colon());
          }
-      }
-      // Add or remove space inside '{' and '}'.
-      log_rule("sp_inside_braces");
-      return(options::sp_inside_braces());
-   }
+         break;
 
-   if (chunk_is_token(first, CT_D_CAST))
-   {
-      log_rule("REMOVE");
-      return(IARF_REMOVE);
-   }
+         SPACE_RULE({ CT_UNKNOWN, CT_OC_COLON })
 
-   if (chunk_is_token(first, CT_PP_DEFINED) && chunk_is_token(second, CT_PAREN_OPEN))
-   {
-      // Add or remove space between 'defined' and '(' in '#if defined (FOO)'.
-      log_rule("sp_defined_paren");
-      return(options::sp_defined_paren());
-   }
+         if (chunk_is_token(second, CT_OC_COLON))
+         {
+            if (  first->flags.test(PCF_IN_OC_MSG)
+               && (chunk_is_token(first, CT_OC_MSG_FUNC) || chunk_is_token(first, CT_OC_MSG_NAME)))
+            {
+               // (OC) Add or remove space before the colon in message specs,
+               // i.e. '[object setValue:1];' vs. '[object setValue :1];'.
+               log_rule("sp_before_send_oc_colon");
+               return(options::sp_before_send_oc_colon());
+            }
+            // (OC) Add or remove space before the colon in message specs,
+            // i.e. '-(int) f: (int) x;' vs. '-(int) f : (int) x;'.
+            log_rule("sp_before_oc_colon");
+            return(options::sp_before_oc_colon());
+         }
+         break;
 
-   if (chunk_is_token(first, CT_THROW))
-   {
-      if (chunk_is_token(second, CT_PAREN_OPEN))
-      {
-         // Add or remove space between 'throw' and '(' in 'throw (something)'.
-         log_rule("sp_throw_paren");
-         return(options::sp_throw_paren());
-      }
-      // Add or remove space between 'throw' and anything other than '(' as in
-      // '@throw [...];'.
-      log_rule("sp_after_throw");
-      return(options::sp_after_throw());
-   }
+         SPACE_RULE({ CT_UNKNOWN, CT_COMMENT })
 
-   if (chunk_is_token(first, CT_THIS) && chunk_is_token(second, CT_PAREN_OPEN))
-   {
-      // Add or remove space between 'this' and '(' in 'this (something)'.
-      log_rule("sp_this_paren");
-      return(options::sp_this_paren());
-   }
+         if (chunk_is_token(second, CT_COMMENT) && get_chunk_parent_type(second) == CT_COMMENT_EMBED)
+         {
+            log_rule("FORCE");
+            return(IARF_FORCE);
+         }
+         break;
 
-   if (chunk_is_token(first, CT_STATE) && chunk_is_token(second, CT_PAREN_OPEN))
-   {
-      log_rule("ADD");
-      return(IARF_ADD);
-   }
+         SPACE_RULE({ CT_COMMENT, CT_UNKNOWN })
 
-   if (chunk_is_token(first, CT_DELEGATE) && chunk_is_token(second, CT_PAREN_OPEN))
-   {
-      log_rule("REMOVE");
-      return(IARF_REMOVE);
-   }
+         if (chunk_is_token(first, CT_COMMENT))
+         {
+            log_rule("FORCE");
+            return(IARF_FORCE);
+         }
+         break;
 
-   if (chunk_is_token(first, CT_MEMBER) || chunk_is_token(second, CT_MEMBER))
-   {
-      // Add or remove space around the '.' or '->' operators.
-      log_rule("sp_member");
-      return(options::sp_member());
-   }
+         SPACE_RULE({ CT_NEW, CT_PAREN_OPEN })
 
-   if (chunk_is_token(first, CT_C99_MEMBER))
-   {
-      // always remove space(s) after then '.' of a C99-member
-      log_rule("REMOVE");
-      return(IARF_REMOVE);
-   }
+         if (chunk_is_token(first, CT_NEW) && chunk_is_token(second, CT_PAREN_OPEN))
+         {
+            // c# new Constraint, c++ new operator
+            // Add or remove space between 'new' and '(' in 'new()'.
+            log_rule("sp_between_new_paren");
+            return(options::sp_between_new_paren());
+         }
+         break;
 
-   if (chunk_is_token(first, CT_SUPER) && chunk_is_token(second, CT_PAREN_OPEN))
-   {
-      // Add or remove space between 'super' and '(' in 'super (something)'.
-      log_rule("sp_super_paren");
-      return(options::sp_super_paren());
-   }
+         SPACE_RULE({ CT_NEW, CT_UNKNOWN },
+                    { CT_DELETE, CT_UNKNOWN },
+                    { CT_TSQUARE, CT_UNKNOWN })
 
-   if (chunk_is_token(first, CT_FPAREN_CLOSE) && chunk_is_token(second, CT_BRACE_OPEN))
-   {
-      if (get_chunk_parent_type(second) == CT_DOUBLE_BRACE)
-      {
-         // (Java) Add or remove space between ')' and '{{' of double brace initializer.
-         log_rule("sp_fparen_dbrace");
-         return(options::sp_fparen_dbrace());
-      }
+         if (  chunk_is_token(first, CT_NEW)
+            || chunk_is_token(first, CT_DELETE)
+            || (chunk_is_token(first, CT_TSQUARE) && get_chunk_parent_type(first) == CT_DELETE))
+         {
+            // Add or remove space after 'new', 'delete' and 'delete[]'.
+            log_rule("sp_after_new");
+            return(options::sp_after_new());
+         }
+         break;
 
-      // To fix issue #1234
-      // check for initializers and add space or ignore based on the option.
-      if (get_chunk_parent_type(first) == CT_FUNC_CALL)
-      {
-         chunk_t *tmp = chunk_get_prev_type(first, get_chunk_parent_type(first), first->level);
-         tmp = chunk_get_prev_ncnl(tmp);
+         SPACE_RULE({ CT_ANNOTATION, CT_UNKNOWN })
 
-         if (chunk_is_token(tmp, CT_NEW))
+         if (chunk_is_token(first, CT_ANNOTATION) && chunk_is_paren_open(second))
          {
-            // Add or remove space between ')' and '{' of s function call in object
-            // initialization.
-            // Overrides sp_fparen_brace.
-            log_rule("sp_fparen_brace_initializer");
-            return(options::sp_fparen_brace_initializer());
+            // (Java) Add or remove space between an annotation and the open parenthesis.
+            log_rule("sp_annotation_paren");
+            return(options::sp_annotation_paren());
          }
-      }
-      // Add or remove space between ')' and '{' of function.
-      log_rule("sp_fparen_brace");
-      return(options::sp_fparen_brace());
-   }
+         break;
 
-   if (chunk_is_token(first, CT_D_TEMPLATE) || chunk_is_token(second, CT_D_TEMPLATE))
-   {
-      log_rule("REMOVE");
-      return(IARF_REMOVE);
-   }
+         SPACE_RULE({ CT_OC_PROPERTY, CT_UNKNOWN })
 
-   if (chunk_is_token(first, CT_ELSE) && chunk_is_token(second, CT_BRACE_OPEN))
-   {
-      // Add or remove space between 'else' and '{' if on the same line.
-      log_rule("sp_else_brace");
-      return(options::sp_else_brace());
-   }
+         if (chunk_is_token(first, CT_OC_PROPERTY))
+         {
+            // (OC) Add or remove space after '@property'.
+            log_rule("sp_after_oc_property");
+            return(options::sp_after_oc_property());
+         }
+         break;
 
-   if (chunk_is_token(first, CT_ELSE) && chunk_is_token(second, CT_ELSEIF))
-   {
-      log_rule("FORCE");
-      return(IARF_FORCE);
-   }
+         SPACE_RULE({ CT_EXTERN, CT_PAREN_OPEN })
 
-   if (chunk_is_token(first, CT_FINALLY) && chunk_is_token(second, CT_BRACE_OPEN))
-   {
-      // Add or remove space between 'finally' and '{' if on the same line.
-      log_rule("sp_finally_brace");
-      return(options::sp_finally_brace());
-   }
+         if (chunk_is_token(first, CT_EXTERN) && chunk_is_token(second, CT_PAREN_OPEN))
+         {
+            // (D) Add or remove space between 'extern' and '(' as in 'extern (C)'.
+            log_rule("sp_extern_paren");
+            return(options::sp_extern_paren());
+         }
+         break;
 
-   if (chunk_is_token(first, CT_TRY) && chunk_is_token(second, CT_BRACE_OPEN))
-   {
-      // Add or remove space between 'try' and '{' if on the same line.
-      log_rule("sp_try_brace");
-      return(options::sp_try_brace());
-   }
+         SPACE_RULE({ CT_STRING, CT_TYPE },
+                    { CT_FPAREN_CLOSE, CT_TYPE })
 
-   if (chunk_is_token(first, CT_GETSET) && chunk_is_token(second, CT_BRACE_OPEN))
-   {
-      // Add or remove space between get/set and '{' if on the same line.
-      log_rule("sp_getset_brace");
-      return(options::sp_getset_brace());
-   }
+         if (  chunk_is_token(second, CT_TYPE)
+            && (  (chunk_is_token(first, CT_STRING) && get_chunk_parent_type(first) == CT_EXTERN)
+               || (chunk_is_token(first, CT_FPAREN_CLOSE) && get_chunk_parent_type(first) == CT_ATTRIBUTE)))
+         {
+            log_rule("FORCE");
+            return(IARF_FORCE);  /* TODO: make this configurable? */
+         }
+         break;
 
-   if (  chunk_is_token(first, CT_WORD)
-      && chunk_is_token(second, CT_BRACE_OPEN))
-   {
-      if (get_chunk_parent_type(first) == CT_NAMESPACE)
-      {
-         // Add or remove space between a variable and '{' for a namespace.
-         log_rule("sp_word_brace_ns");
-         return(options::sp_word_brace_ns());
-      }
+         SPACE_RULE_TABLE(no_space_table)
 
-      if (  get_chunk_parent_type(first) == CT_NONE
-         && get_chunk_parent_type(second) == CT_BRACED_INIT_LIST)
-      {
-         // Add or remove space between a variable and '{' for C++ uniform
-         // initialization.
-         log_rule("sp_word_brace_init_lst");
-         return(options::sp_word_brace_init_lst());
-      }
-   }
+         // this table lists out all combos where a space should NOT be present
+         // CT_UNKNOWN is a wildcard.
+         for (auto it : no_space_table)
+         {
+            if (  (it.first == CT_UNKNOWN || it.first == first->type)
+               && (it.second == CT_UNKNOWN || it.second == second->type))
+            {
+               log_rule("REMOVE from no_space_table");
+               return(IARF_REMOVE);
+            }
+         }
 
-   if (chunk_is_token(second, CT_PAREN_OPEN) && get_chunk_parent_type(second) == CT_INVARIANT)
-   {
-      // (D) Add or remove space between 'invariant' and '('.
-      log_rule("sp_invariant_paren");
-      return(options::sp_invariant_paren());
-   }
+         break;
 
-   if (chunk_is_token(first, CT_PAREN_CLOSE) && get_chunk_parent_type(first) != CT_DECLTYPE)
-   {
-      if (get_chunk_parent_type(first) == CT_INVARIANT)
-      {
-         // (D) Add or remove space after the ')' in 'invariant (C) c'.
-         log_rule("sp_after_invariant_paren");
-         return(options::sp_after_invariant_paren());
-      }
+         SPACE_RULE({ CT_NOEXCEPT, CT_UNKNOWN })
 
-      // "(struct foo) {...}" vs "(struct foo){...}"
-      if (chunk_is_token(second, CT_BRACE_OPEN))
-      {
-         // Add or remove space between ')' and '{'.
-         log_rule("sp_paren_brace");
-         return(options::sp_paren_brace());
-      }
+         if (chunk_is_token(first, CT_NOEXCEPT))
+         {
+            // Add or remove space after 'noexcept'.
+            log_rule("sp_after_noexcept");
+            return(options::sp_after_noexcept());
+         }
+         break;
 
-      // D-specific: "delegate(some thing) dg
-      if (get_chunk_parent_type(first) == CT_DELEGATE)
-      {
-         log_rule("ADD");
-         return(IARF_ADD);
-      }
+         SPACE_RULE({ CT_FPAREN_CLOSE, CT_UNKNOWN })
 
-      // PAWN-specific: "state (condition) next"
-      if (get_chunk_parent_type(first) == CT_STATE)
-      {
-         log_rule("ADD");
-         return(IARF_ADD);
-      }
+         // Issue #2138
+         if (chunk_is_token(first, CT_FPAREN_CLOSE))
+         {
+            if (chunk_is_token(second, CT_QUALIFIER))
+            {
+               // Add or remove space between ')' and a qualifier such as 'const'.
+               log_rule("sp_paren_qualifier");
+               return(options::sp_paren_qualifier());
+            }
+            else if (chunk_is_token(second, CT_NOEXCEPT))
+            {
+               // Add or remove space between ')' and 'noexcept'.
+               log_rule("sp_paren_noexcept");
+               return(options::sp_paren_noexcept());
+            }
+         }
+         break;
 
-      /* C++ new operator: new(bar) Foo */
-      if (get_chunk_parent_type(first) == CT_NEW)
-      {
-         // Add or remove space between ')' and type in 'new(foo) BAR'.
-         log_rule("sp_after_newop_paren");
-         return(options::sp_after_newop_paren());
-      }
-   }
+         SPACE_RULE({ CT_PP_PRAGMA, CT_PREPROC_BODY })
 
-   /* "((" vs "( (" or "))" vs ") )" */
-   // Issue #1342
-   if (  (chunk_is_str(first, "(", 1) && chunk_is_str(second, "(", 1))
-      || (chunk_is_str(first, ")", 1) && chunk_is_str(second, ")", 1)))
-   {
-      if (get_chunk_parent_type(second) == CT_FUNC_CALL_USER)
-      {
-         // Add or remove space between nested parentheses with user functions,
-         // i.e. '((' vs. '( ('.
-         log_rule("sp_func_call_user_paren_paren");
-         return(options::sp_func_call_user_paren_paren());
-      }
-      // Add or remove space between nested parentheses, i.e. '((' vs. ') )'.
-      log_rule("sp_paren_paren");
-      return(options::sp_paren_paren());
-   }
+         // Issue #2098
+         if (  chunk_is_token(first, CT_PP_PRAGMA)
+            && chunk_is_token(second, CT_PREPROC_BODY))
+         {
+            log_rule("REMOVE");
+            return(IARF_REMOVE);
+         }
+         break;
 
-   // "foo(...)" vs "foo( ... )"
-   if (chunk_is_token(first, CT_FPAREN_OPEN) || chunk_is_token(second, CT_FPAREN_CLOSE))
-   {
-      if (  (get_chunk_parent_type(first) == CT_FUNC_CALL_USER)
-         || (  (get_chunk_parent_type(second) == CT_FUNC_CALL_USER)
-            && ((chunk_is_token(first, CT_WORD)) || (chunk_is_token(first, CT_SQUARE_CLOSE)))))
-      {
-         // Add or remove space inside user function '(' and ')'.
-         log_rule("sp_func_call_user_inside_fparen");
-         return(options::sp_func_call_user_inside_fparen());
-      }
+         SPACE_RULE({ CT_OPERATOR_VAL, CT_TYPE })
 
-      if (chunk_is_token(first, CT_FPAREN_OPEN) && chunk_is_token(second, CT_FPAREN_CLOSE))
-      {
-         // Add or remove space inside empty function '()'.
-         log_rule("sp_inside_fparens");
-         return(options::sp_inside_fparens());
-      }
-      // Add or remove space inside function '(' and ')'.
-      log_rule("sp_inside_fparen");
-      return(options::sp_inside_fparen());
-   }
+         // Issue #1733
+         if (  chunk_is_token(first, CT_OPERATOR_VAL)
+            && chunk_is_token(second, CT_TYPE))
+         {
+            log_rule("IGNORE");
+            return(IARF_IGNORE);
+         }
+         break;
 
-   // "foo(...)" vs "foo( ... )"
-   if (chunk_is_token(first, CT_TPAREN_OPEN) || chunk_is_token(second, CT_TPAREN_CLOSE))
-   {
-      // Add or remove space inside the first parentheses in a function type, as in
-      // 'void (*x)(...)'.
-      log_rule("sp_inside_tparen");
-      return(options::sp_inside_tparen());
-   }
+         SPACE_RULE({ CT_DO, CT_BRACE_OPEN })
 
-   if (chunk_is_token(first, CT_PAREN_CLOSE))
-   {
-      if (  first->flags.test(PCF_OC_RTYPE) // == CT_OC_RTYPE)
-         && (  get_chunk_parent_type(first) == CT_OC_MSG_DECL
-            || get_chunk_parent_type(first) == CT_OC_MSG_SPEC))
-      {
-         // (OC) Add or remove space after the first (type) in message specs,
-         // i.e. '-(int) f:(int)x;' vs. '-(int)f:(int)x;'.
-         log_rule("sp_after_oc_return_type");
-         return(options::sp_after_oc_return_type());
-      }
+         // Issue #995
+         if (chunk_is_token(first, CT_DO) && chunk_is_token(second, CT_BRACE_OPEN))
+         {
+            // Add or remove space between 'do' and '{'.
+            log_rule("sp_do_brace_open");
+            return(options::sp_do_brace_open());
+         }
+         break;
 
-      if (get_chunk_parent_type(first) == CT_OC_MSG_SPEC || get_chunk_parent_type(first) == CT_OC_MSG_DECL)
-      {
-         // (OC) Add or remove space after the (type) in message specs,
-         // i.e. '-(int)f: (int) x;' vs. '-(int)f: (int)x;'.
-         log_rule("sp_after_oc_type");
-         return(options::sp_after_oc_type());
-      }
+         SPACE_RULE({ CT_WHILE_OF_DO, CT_PAREN_OPEN })
 
-      if (get_chunk_parent_type(first) == CT_OC_SEL && second->type != CT_SQUARE_CLOSE)
-      {
-         // (OC) Add or remove space between '@selector(x)' and the following word,
-         // i.e. '@selector(foo) a:' vs. '@selector(foo)a:'.
-         log_rule("sp_after_oc_at_sel_parens");
-         return(options::sp_after_oc_at_sel_parens());
-      }
-   }
+         // Issue #995
+         if (chunk_is_token(first, CT_WHILE_OF_DO) && chunk_is_token(second, CT_PAREN_OPEN))
+         {
+            // Add or remove space between 'while' and '('.
+            log_rule("sp_while_paren_open");
+            return(options::sp_while_paren_open());
+         }
+         break;
 
-   if (options::sp_inside_oc_at_sel_parens() != IARF_IGNORE)
-   {
-      if (  (  chunk_is_token(first, CT_PAREN_OPEN)
-            && (  get_chunk_parent_type(first) == CT_OC_SEL
-               || get_chunk_parent_type(first) == CT_OC_PROTOCOL))
-         || (  chunk_is_token(second, CT_PAREN_CLOSE)
-            && (  get_chunk_parent_type(second) == CT_OC_SEL
-               || get_chunk_parent_type(second) == CT_OC_PROTOCOL)))
-      {
-         // (OC) Add or remove space inside '@selector' parentheses,
-         // i.e. '@selector(foo)' vs. '@selector( foo )'.
-         // Also applies to '@protocol()' constructs.
-         log_rule("sp_inside_oc_at_sel_parens");
-         return(options::sp_inside_oc_at_sel_parens());
-      }
-   }
+         SPACE_RULE({ CT_BRACE_CLOSE, CT_WHILE_OF_DO })
 
-   if (  chunk_is_token(second, CT_PAREN_OPEN)
-      && (chunk_is_token(first, CT_OC_SEL) || chunk_is_token(first, CT_OC_PROTOCOL)))
-   {
-      // (OC) Add or remove space between '@selector' and '(',
-      // i.e. '@selector(msgName)' vs. '@selector (msgName)'.
-      // Also applies to '@protocol()' constructs.
-      log_rule("sp_after_oc_at_sel");
-      return(options::sp_after_oc_at_sel());
-   }
+         // Issue #995
+         if (chunk_is_token(first, CT_BRACE_CLOSE) && chunk_is_token(second, CT_WHILE_OF_DO))
+         {
+            // Add or remove space between '}' and 'while.
+            log_rule("sp_brace_close_while");
+            return(options::sp_brace_close_while());
+         }
+         break;
 
-   /*
-    * C cast:   "(int)"      vs "( int )"
-    * D cast:   "cast(int)"  vs "cast( int )"
-    * CPP cast: "int(a + 3)" vs "int( a + 3 )"
-    */
-   if (chunk_is_token(first, CT_PAREN_OPEN))
-   {
-      if (  get_chunk_parent_type(first) == CT_C_CAST
-         || get_chunk_parent_type(first) == CT_CPP_CAST
-         || get_chunk_parent_type(first) == CT_D_CAST)
-      {
-         // Add or remove spaces inside cast parentheses.
-         log_rule("sp_inside_paren_cast");
-         return(options::sp_inside_paren_cast());
-      }
+         SPACE_RULE({ CT_NEWLINE, CT_BRACE_OPEN })
 
-      if (get_chunk_parent_type(first) == CT_NEW)
-      {
-         if (options::sp_inside_newop_paren_open() != IARF_IGNORE)
+         // TODO: have a look to Issue #2186, why NEWLINE?
+         // Issue #2524
+         if (chunk_is_token(first, CT_NEWLINE) && chunk_is_token(second, CT_BRACE_OPEN))
          {
-            // Add or remove space after the open parenthesis of the new operator,
-            // as in 'new(foo) BAR'.
-            // Overrides sp_inside_newop_paren.
-            log_rule("sp_inside_newop_paren_open");
-            return(options::sp_inside_newop_paren_open());
+            log_rule("IGNORE");
+            return(IARF_IGNORE);
          }
+         break;
+
+         SPACE_RULE({ CT_AMP, CT_WORD })
 
-         if (options::sp_inside_newop_paren() != IARF_IGNORE)
+         // TODO: if necessary create a new option
+         if (chunk_is_token(first, CT_AMP) && chunk_is_token(second, CT_WORD))
          {
-            // Add or remove space inside parenthesis of the new operator
-            // as in 'new(foo) BAR'.
-            log_rule("sp_inside_newop_paren");
-            return(options::sp_inside_newop_paren());
+            log_rule("ADD");
+            return(IARF_ADD);
          }
-      }
-      log_rule("sp_inside_paren");
-      return(options::sp_inside_paren());
-   }
+         break;
 
-   if (chunk_is_token(second, CT_PAREN_CLOSE))
-   {
-      if (  get_chunk_parent_type(second) == CT_C_CAST
-         || get_chunk_parent_type(second) == CT_CPP_CAST
-         || get_chunk_parent_type(second) == CT_D_CAST)
-      {
-         // Add or remove spaces inside cast parentheses.
-         log_rule("sp_inside_paren_cast");
-         return(options::sp_inside_paren_cast());
-      }
+         SPACE_RULE({ CT_ANGLE_CLOSE, CT_BRACE_OPEN })
 
-      if (get_chunk_parent_type(second) == CT_NEW)
-      {
-         if (options::sp_inside_newop_paren_close() != IARF_IGNORE)
+         // TODO: if necessary create a new option
+         if (chunk_is_token(first, CT_ANGLE_CLOSE) && chunk_is_token(second, CT_BRACE_OPEN))
          {
-            // Add or remove space before the close parenthesis of the new operator,
-            // as in 'new(foo) BAR'.
-            // Overrides sp_inside_newop_paren.
-            log_rule("sp_inside_newop_paren_close");
-            return(options::sp_inside_newop_paren_close());
+            log_rule("ADD");
+            return(IARF_ADD);
          }
+         break;
 
-         if (options::sp_inside_newop_paren() != IARF_IGNORE)
+         SPACE_RULE({ CT_ANNOTATION, CT_TYPE })
+
+         // TODO: if necessary create a new option
+         if (chunk_is_token(first, CT_ANNOTATION) && chunk_is_token(second, CT_TYPE))
          {
-            // Add or remove space inside parenthesis of the new operator
-            // as in 'new(foo) BAR'.
-            log_rule("sp_inside_newop_paren");
-            return(options::sp_inside_newop_paren());
+            log_rule("ADD");
+            return(IARF_ADD);
          }
-      }
-      // Add or remove space inside '(' and ')'.
-      log_rule("sp_inside_paren");
-      return(options::sp_inside_paren());
-   }
+         break;
 
-   // "[3]" vs "[ 3 ]" or for objective-c "@[@3]" vs "@[ @3 ]"
-   if (chunk_is_token(first, CT_SQUARE_OPEN) || chunk_is_token(second, CT_SQUARE_CLOSE))
-   {
-      if (  language_is_set(LANG_OC)
-         && (  (get_chunk_parent_type(first) == CT_OC_AT && chunk_is_token(first, CT_SQUARE_OPEN))
-            || (get_chunk_parent_type(second) == CT_OC_AT && chunk_is_token(second, CT_SQUARE_CLOSE)))
-         && (options::sp_inside_square_oc_array() != IARF_IGNORE))
-      {
-         // (OC) Add or remove space inside a non-empty Objective-C boxed array '@[' and
-         // ']'. If set to ignore, sp_inside_square is used.
-         log_rule("sp_inside_square_oc_array");
-         return(options::sp_inside_square_oc_array());
-      }
-      // Add or remove space inside a non-empty '[' and ']'.
-      log_rule("sp_inside_square");
-      return(options::sp_inside_square());
-   }
+         SPACE_RULE({ CT_ASSIGN_FUNC_PROTO, CT_DEFAULT })
 
-   if (chunk_is_token(first, CT_SQUARE_CLOSE) && chunk_is_token(second, CT_FPAREN_OPEN))
-   {
-      // Add or remove space between ']' and '(' when part of a function call.
-      log_rule("sp_square_fparen");
-      return(options::sp_square_fparen());
-   }
+         // TODO: if necessary create a new option
+         if (chunk_is_token(first, CT_ASSIGN_FUNC_PROTO) && chunk_is_token(second, CT_DEFAULT))
+         {
+            log_rule("ADD");
+            return(IARF_ADD);
+         }
+         break;
 
-   // "if(...)" vs "if( ... )"
-   if (  chunk_is_token(second, CT_SPAREN_CLOSE)
-      && (options::sp_inside_sparen_close() != IARF_IGNORE))
-   {
-      // Add or remove space before ')' of control statements.
-      // Overrides sp_inside_sparen.
-      log_rule("sp_inside_sparen_close");
-      return(options::sp_inside_sparen_close());
-   }
+         SPACE_RULE({ CT_ASSIGN_FUNC_PROTO, CT_DELETE })
 
-   if (  chunk_is_token(first, CT_SPAREN_OPEN)
-      && (options::sp_inside_sparen_open() != IARF_IGNORE))
-   {
-      // Add or remove space after '(' of control statements.
-      // Overrides sp_inside_sparen.
-      log_rule("sp_inside_sparen_open");
-      return(options::sp_inside_sparen_open());
-   }
+         // TODO: if necessary create a new option
+         if (chunk_is_token(first, CT_ASSIGN_FUNC_PROTO) && chunk_is_token(second, CT_DELETE))
+         {
+            log_rule("ADD");
+            return(IARF_ADD);
+         }
+         break;
 
-   if (chunk_is_token(first, CT_SPAREN_OPEN) || chunk_is_token(second, CT_SPAREN_CLOSE))
-   {
-      // Add or remove space inside '(' and ')' of control statements.
-      log_rule("sp_inside_sparen");
-      return(options::sp_inside_sparen());
-   }
+         SPACE_RULE({ CT_ASSIGN_FUNC_PROTO, CT_NUMBER })
 
-   if (chunk_is_token(first, CT_CLASS_COLON))
-   {
-      if (  get_chunk_parent_type(first) == CT_OC_CLASS
-         && (  !chunk_get_prev_type(first, CT_OC_INTF, first->level, scope_e::ALL)
-            && !chunk_get_prev_type(first, CT_OC_IMPL, first->level, scope_e::ALL)))
-      {
-         if (options::sp_after_oc_colon() != IARF_IGNORE)
+         // TODO: if necessary create a new option
+         if (chunk_is_token(first, CT_ASSIGN_FUNC_PROTO) && chunk_is_token(second, CT_NUMBER))
          {
-            // (OC) Add or remove space after the colon in message specs,
-            // i.e. '-(int) f:(int) x;' vs. '-(int) f: (int) x;'.
-            log_rule("sp_after_oc_colon");
-            return(options::sp_after_oc_colon());
+            log_rule("ADD");
+            return(IARF_ADD);
          }
-      }
+         break;
 
-      if (options::sp_after_class_colon() != IARF_IGNORE)
-      {
-         // Add or remove space after class ':'.
-         log_rule("sp_after_class_colon");
-         return(options::sp_after_class_colon());
-      }
-   }
+         SPACE_RULE({ CT_BIT_COLON, CT_TYPE })
 
-   if (chunk_is_token(second, CT_CLASS_COLON))
-   {
-      if (  get_chunk_parent_type(second) == CT_OC_CLASS
-         && (  !chunk_get_prev_type(second, CT_OC_INTF, second->level, scope_e::ALL)
-            && !chunk_get_prev_type(second, CT_OC_IMPL, second->level, scope_e::ALL)))
-      {
-         if (get_chunk_parent_type(second) == CT_OC_CLASS && !chunk_get_prev_type(second, CT_OC_INTF, second->level, scope_e::ALL))
+         // TODO: if necessary create a new option
+         if (chunk_is_token(first, CT_BIT_COLON) && chunk_is_token(second, CT_TYPE))
          {
-            if (options::sp_before_oc_colon() != IARF_IGNORE)
-            {
-               // (OC) Add or remove space before the colon in message specs,
-               // i.e. '-(int) f: (int) x;' vs. '-(int) f : (int) x;'.
-               log_rule("sp_before_oc_colon");
-               return(options::sp_before_oc_colon());
-            }
+            log_rule("ADD");
+            return(IARF_ADD);
          }
-      }
+         break;
 
-      if (options::sp_before_class_colon() != IARF_IGNORE)
-      {
-         // Add or remove space before class ':'.
-         log_rule("sp_before_class_colon");
-         return(options::sp_before_class_colon());
-      }
-   }
+         SPACE_RULE({ CT_BRACE_CLOSE, CT_PAREN_OPEN })
 
-   if (  (options::sp_after_constr_colon() != IARF_IGNORE)
-      && chunk_is_token(first, CT_CONSTR_COLON))
-   {
-      min_sp = options::indent_ctor_init_leading() - 1; // default indent is 1 space
+         // TODO: if necessary create a new option
+         if (chunk_is_token(first, CT_BRACE_CLOSE) && chunk_is_token(second, CT_PAREN_OPEN))
+         {
+            log_rule("ADD");
+            return(IARF_ADD);
+         }
+         break;
 
-      // Add or remove space after class constructor ':'.
-      log_rule("sp_after_constr_colon");
-      return(options::sp_after_constr_colon());
-   }
+         SPACE_RULE({ CT_CLASS_COLON, CT_QUALIFIER })
 
-   if (  (options::sp_before_constr_colon() != IARF_IGNORE)
-      && chunk_is_token(second, CT_CONSTR_COLON))
-   {
-      // Add or remove space before class constructor ':'.
-      log_rule("sp_before_constr_colon");
-      return(options::sp_before_constr_colon());
-   }
+         // TODO: if necessary create a new option
+         if (chunk_is_token(first, CT_CLASS_COLON) && chunk_is_token(second, CT_QUALIFIER))
+         {
+            log_rule("ADD");
+            return(IARF_ADD);
+         }
+         break;
 
-   if (  (options::sp_before_case_colon() != IARF_IGNORE)
-      && chunk_is_token(second, CT_CASE_COLON))
-   {
-      // Add or remove space before case ':'.
-      log_rule("sp_before_case_colon");
-      return(options::sp_before_case_colon());
-   }
+         SPACE_RULE({ CT_CLASS_COLON, CT_WORD })
 
-   if (chunk_is_token(first, CT_DOT))
-   {
-      log_rule("REMOVE");
-      return(IARF_REMOVE);
-   }
+         // TODO: if necessary create a new option
+         if (chunk_is_token(first, CT_CLASS_COLON) && chunk_is_token(second, CT_WORD))
+         {
+            log_rule("ADD");
+            return(IARF_ADD);
+         }
+         break;
 
-   if (chunk_is_token(second, CT_DOT))
-   {
-      log_rule("ADD");
-      return(IARF_ADD);
-   }
+         SPACE_RULE({ CT_COLON, CT_NUMBER })
 
-   if (chunk_is_token(first, CT_NULLCOND) || chunk_is_token(second, CT_NULLCOND))
-   {
-      // Add or remove space around the '.' or '->' operators.
-      log_rule("sp_member");
-      return(options::sp_member());
-   }
+         // TODO: if necessary create a new option
+         if (chunk_is_token(first, CT_COLON) && chunk_is_token(second, CT_NUMBER))
+         {
+            log_rule("ADD");
+            return(IARF_ADD);
+         }
+         break;
 
-   if (  chunk_is_token(first, CT_ARITH)
-      || chunk_is_token(first, CT_CARET)
-      || chunk_is_token(second, CT_ARITH)
-      || chunk_is_token(second, CT_CARET))
-   {
-      // Add or remove space around arithmetic operators '+' and '-'.
-      // Overrides sp_arith.
-      if (options::sp_arith_additive() != IARF_IGNORE)
-      {
-         auto arith_char = (chunk_is_token(first, CT_ARITH) || chunk_is_token(first, CT_CARET))
-                           ? first->str[0] : second->str[0];
+         SPACE_RULE({ CT_COND_COLON, CT_FUNC_CALL })
+
+         // TODO: if necessary create a new option
+         if (chunk_is_token(first, CT_COND_COLON) && chunk_is_token(second, CT_FUNC_CALL))
+         {
+            log_rule("ADD");
+            return(IARF_ADD);
+         }
+         break;
+
+         SPACE_RULE({ CT_COND_COLON, CT_STRING })
 
-         if (arith_char == '+' || arith_char == '-')
+         // TODO: if necessary create a new option
+         if (chunk_is_token(first, CT_COND_COLON) && chunk_is_token(second, CT_STRING))
          {
-            log_rule("sp_arith_additive");
-            return(options::sp_arith_additive());
+            log_rule("ADD");
+            return(IARF_ADD);
          }
-      }
-      // Add or remove space around non-assignment symbolic operators ('+', '/', '%',
-      // '<<', and so forth).
-      log_rule("sp_arith");
-      return(options::sp_arith());
-   }
-
-   if (chunk_is_token(first, CT_BOOL) || chunk_is_token(second, CT_BOOL))
-   {
-      // Add or remove space around boolean operators '&&' and '||'.
-      iarf_e arg = options::sp_bool();
-
-      if (  (options::pos_bool() != TP_IGNORE)
-         && first->orig_line != second->orig_line
-         && arg != IARF_REMOVE)
-      {
-         arg = arg | IARF_ADD;
-      }
-      // TODO check it
-      log_rule("sp_bool");
-      return(arg);
-   }
+         break;
 
-   if (chunk_is_token(first, CT_COMPARE) || chunk_is_token(second, CT_COMPARE))
-   {
-      // Add or remove space around compare operator '<', '>', '==', etc.
-      log_rule("sp_compare");
-      return(options::sp_compare());
-   }
+         SPACE_RULE({ CT_COND_COLON, CT_WORD })
 
-   if (chunk_is_token(first, CT_PAREN_OPEN) && chunk_is_token(second, CT_PTR_TYPE))
-   {
-      log_rule("REMOVE");
-      return(IARF_REMOVE);
-   }
+         // TODO: if necessary create a new option
+         if (chunk_is_token(first, CT_COND_COLON) && chunk_is_token(second, CT_WORD))
+         {
+            log_rule("ADD");
+            return(IARF_ADD);
+         }
+         break;
 
-   if (  chunk_is_token(first, CT_PTR_TYPE)
-      && (options::sp_ptr_star_paren() != IARF_IGNORE)
-      && (chunk_is_token(second, CT_FPAREN_OPEN) || chunk_is_token(second, CT_TPAREN_OPEN)))
-   {
-      // Add or remove space after a pointer star '*', if followed by an open
-      // parenthesis, as in 'void* (*)().
-      log_rule("sp_ptr_star_paren");
-      return(options::sp_ptr_star_paren());
-   }
+         SPACE_RULE({ CT_CONSTR_COLON, CT_FUNC_CTOR_VAR })
 
-   if (  chunk_is_token(first, CT_PTR_TYPE)
-      && chunk_is_token(second, CT_PTR_TYPE)
-      && (options::sp_between_ptr_star() != IARF_IGNORE))
-   {
-      // Add or remove space between pointer stars '*'.
-      log_rule("sp_between_ptr_star");
-      return(options::sp_between_ptr_star());
-   }
+         // TODO: if necessary create a new option
+         if (chunk_is_token(first, CT_CONSTR_COLON) && chunk_is_token(second, CT_FUNC_CTOR_VAR))
+         {
+            log_rule("ADD");
+            return(IARF_ADD);
+         }
+         break;
 
-   if (  chunk_is_token(first, CT_PTR_TYPE)
-      && (options::sp_after_ptr_star_func() != IARF_IGNORE)
-      && (  get_chunk_parent_type(first) == CT_FUNC_DEF
-         || get_chunk_parent_type(first) == CT_FUNC_PROTO
-         || get_chunk_parent_type(first) == CT_FUNC_VAR))
-   {
-      // Add or remove space after a pointer star '*', if followed by a function
-      // prototype or function definition.
-      log_rule("sp_after_ptr_star_func");
-      return(options::sp_after_ptr_star_func());
-   }
+         SPACE_RULE({ CT_CS_PROPERTY, CT_BRACE_OPEN })
 
-   if (chunk_is_token(first, CT_PTR_TYPE) && CharTable::IsKw1(second->str[0]))
-   {
-      chunk_t *prev = chunk_get_prev(first);
+         // TODO: if necessary create a new option
+         if (chunk_is_token(first, CT_CS_PROPERTY) && chunk_is_token(second, CT_BRACE_OPEN))
+         {
+            log_rule("ADD");
+            return(IARF_ADD);
+         }
+         break;
 
-      if (chunk_is_token(prev, CT_IN))
-      {
-         // Add or remove space after the '*' (dereference) unary operator. This does
-         // not affect the spacing after a '*' that is part of a type.
-         log_rule("sp_deref");
-         return(options::sp_deref());
-      }
+         SPACE_RULE({ CT_ENUM, CT_BRACE_OPEN })
 
-      if (  (  get_chunk_parent_type(first) == CT_FUNC_VAR
-            || get_chunk_parent_type(first) == CT_FUNC_TYPE)
-         && options::sp_after_ptr_block_caret() != IARF_IGNORE)
-      {
-         // Add or remove space after pointer caret '^', if followed by a word.
-         log_rule("sp_after_ptr_block_caret");
-         return(options::sp_after_ptr_block_caret());
-      }
+         // TODO: if necessary create a new option
+         if (chunk_is_token(first, CT_ENUM) && chunk_is_token(second, CT_BRACE_OPEN))
+         {
+            log_rule("ADD");
+            return(IARF_ADD);
+         }
+         break;
 
-      if (  chunk_is_token(second, CT_QUALIFIER)
-         && (options::sp_after_ptr_star_qualifier() != IARF_IGNORE))
-      {
-         // Add or remove space after pointer star '*', if followed by a qualifier.
-         log_rule("sp_after_ptr_star_qualifier");
-         return(options::sp_after_ptr_star_qualifier());
-      }
+         SPACE_RULE({ CT_ENUM, CT_ENUM_CLASS })
 
-      // Add or remove space after pointer star '*', if followed by a word.
-      if (options::sp_after_ptr_star() != IARF_IGNORE)
-      {
-         log_rule("sp_after_ptr_star");
-         return(options::sp_after_ptr_star());
-      }
-   }
+         // TODO: if necessary create a new option
+         if (chunk_is_token(first, CT_ENUM) && chunk_is_token(second, CT_ENUM_CLASS))
+         {
+            log_rule("ADD");
+            return(IARF_ADD);
+         }
+         break;
 
-   if (  chunk_is_token(first, CT_PTR_TYPE)
-      && chunk_is_token(second, CT_PAREN_OPEN))
-   {
-      // Add or remove space after pointer star '*', if followed by a word.
-      log_rule("sp_after_ptr_star");
-      return(options::sp_after_ptr_star());
-   }
+         SPACE_RULE({ CT_ENUM, CT_TYPE })
 
-   if (chunk_is_token(second, CT_PTR_TYPE) && first->type != CT_IN)
-   {
-      if (language_is_set(LANG_CS) && chunk_is_nullable(second))
-      {
-         min_sp = 0;
-         log_rule("REMOVE");
-         return(IARF_REMOVE);
-      }
+         // TODO: if necessary create a new option
+         if (chunk_is_token(first, CT_ENUM) && chunk_is_token(second, CT_TYPE))
+         {
+            log_rule("ADD");
+            return(IARF_ADD);
+         }
+         break;
 
-      // Add or remove space before a pointer star '*', if followed by a function
-      // prototype or function definition.
-      if (options::sp_before_ptr_star_func() != IARF_IGNORE)
-      {
-         // Find the next non-'*' chunk
-         chunk_t *next = second;
+         SPACE_RULE({ CT_ENUM_CLASS, CT_TYPE })
 
-         do
+         // TODO: if necessary create a new option
+         if (chunk_is_token(first, CT_ENUM_CLASS) && chunk_is_token(second, CT_TYPE))
          {
-            next = chunk_get_next(next);
-         } while (chunk_is_token(next, CT_PTR_TYPE));
+            log_rule("ADD");
+            return(IARF_ADD);
+         }
+         break;
+
+         SPACE_RULE({ CT_FPAREN_CLOSE, CT_ASSIGN_FUNC_PROTO })
 
-         if (chunk_is_token(next, CT_FUNC_DEF) || chunk_is_token(next, CT_FUNC_PROTO))
+         // TODO: if necessary create a new option
+         if (chunk_is_token(first, CT_FPAREN_CLOSE) && chunk_is_token(second, CT_ASSIGN_FUNC_PROTO))
          {
-            log_rule("sp_before_ptr_star_func");
-            return(options::sp_before_ptr_star_func());
+            log_rule("ADD");
+            return(IARF_ADD);
          }
-      }
+         break;
 
-      // Add or remove space before pointer star '*' that isn't followed by a
-      // variable name. If set to 'ignore', sp_before_ptr_star is used instead.
-      if (options::sp_before_unnamed_ptr_star() != IARF_IGNORE)
-      {
-         chunk_t *next = chunk_get_next_nc(second);
+         SPACE_RULE({ CT_FPAREN_CLOSE, CT_COND_COLON })
 
-         while (chunk_is_token(next, CT_PTR_TYPE))
+         // TODO: if necessary create a new option
+         if (chunk_is_token(first, CT_FPAREN_CLOSE) && chunk_is_token(second, CT_COND_COLON))
          {
-            next = chunk_get_next_nc(next);
+            log_rule("ADD");
+            return(IARF_ADD);
          }
+         break;
 
-         if (next != nullptr && next->type != CT_WORD)
+         SPACE_RULE({ CT_FPAREN_CLOSE, CT_CONSTR_COLON })
+
+         // TODO: if necessary create a new option
+         if (chunk_is_token(first, CT_FPAREN_CLOSE) && chunk_is_token(second, CT_CONSTR_COLON))
          {
-            log_rule("sp_before_unnamed_ptr_star");
-            return(options::sp_before_unnamed_ptr_star());
+            log_rule("ADD");
+            return(IARF_ADD);
          }
-      }
-
-      // Add or remove space before pointer star '*'.
-      if (options::sp_before_ptr_star() != IARF_IGNORE)
-      {
-         log_rule("sp_before_ptr_star");
-         return(options::sp_before_ptr_star());
-      }
-   }
+         break;
 
-   if (chunk_is_token(first, CT_OPERATOR))
-   {
-      // Add or remove space between 'operator' and operator sign.
-      log_rule("sp_after_operator");
-      return(options::sp_after_operator());
-   }
+         SPACE_RULE({ CT_FPAREN_CLOSE, CT_QUESTION })
 
-   if (chunk_is_token(second, CT_FUNC_PROTO) || chunk_is_token(second, CT_FUNC_DEF))
-   {
-      if (first->type != CT_PTR_TYPE && first->type != CT_BYREF)
-      {
-         // Add or remove space between return type and function name. A
-         // minimum of 1 is forced except for pointer/reference return types.
-         log_rule("sp_type_func|ADD");
-         return(options::sp_type_func() | IARF_ADD);
-      }
-      // Add or remove space between return type and function name. A
-      // minimum of 1 is forced except for pointer/reference return types.
-      log_rule("sp_type_func");
-      return(options::sp_type_func());
-   }
+         // TODO: if necessary create a new option
+         if (chunk_is_token(first, CT_FPAREN_CLOSE) && chunk_is_token(second, CT_QUESTION))
+         {
+            log_rule("ADD");
+            return(IARF_ADD);
+         }
+         break;
 
-   // "(int)a" vs "(int) a" or "cast(int)a" vs "cast(int) a"
-   if (  (get_chunk_parent_type(first) == CT_C_CAST || get_chunk_parent_type(first) == CT_D_CAST)
-      && chunk_is_token(first, CT_PAREN_CLOSE))
-   {
-      log_rule("sp_after_cast");
-      return(options::sp_after_cast());
-   }
+         SPACE_RULE({ CT_FRIEND, CT_CLASS })
 
-   if (chunk_is_token(first, CT_BRACE_CLOSE))
-   {
-      if (chunk_is_token(second, CT_ELSE))
-      {
-         // Add or remove space between '}' and 'else' if on the same line.
-         log_rule("sp_brace_else");
-         return(options::sp_brace_else());
-      }
+         // TODO: if necessary create a new option
+         if (chunk_is_token(first, CT_FRIEND) && chunk_is_token(second, CT_CLASS))
+         {
+            log_rule("ADD");
+            return(IARF_ADD);
+         }
+         break;
 
-      if (  language_is_set(LANG_OC)
-         && chunk_is_token(second, CT_CATCH)
-         && (options::sp_oc_brace_catch() != IARF_IGNORE))
-      {
-         // (OC) Add or remove space between '}' and '@catch' if on the same line.
-         // If set to ignore, sp_brace_catch is used.
-         log_rule("sp_oc_brace_catch");
-         return(options::sp_oc_brace_catch());
-      }
+         SPACE_RULE({ CT_FRIEND, CT_TYPE })
 
-      if (chunk_is_token(second, CT_CATCH))
-      {
-         // Add or remove space between '}' and 'catch' if on the same line.
-         log_rule("sp_brace_catch");
-         return(options::sp_brace_catch());
-      }
+         // TODO: if necessary create a new option
+         if (chunk_is_token(first, CT_FRIEND) && chunk_is_token(second, CT_TYPE))
+         {
+            log_rule("ADD");
+            return(IARF_ADD);
+         }
+         break;
 
-      if (chunk_is_token(second, CT_FINALLY))
-      {
-         // Add or remove space between '}' and 'finally' if on the same line.
-         log_rule("sp_brace_finally");
-         return(options::sp_brace_finally());
-      }
-   }
+         SPACE_RULE({ CT_LABEL_COLON, CT_NEW })
 
-   if (chunk_is_token(first, CT_BRACE_OPEN))
-   {
-      if (get_chunk_parent_type(first) == CT_ENUM)
-      {
-         // Add or remove space inside enum '{' and '}'.
-         log_rule("sp_inside_braces_enum");
-         return(options::sp_inside_braces_enum());
-      }
+         // TODO: if necessary create a new option
+         if (chunk_is_token(first, CT_LABEL_COLON) && chunk_is_token(second, CT_NEW))
+         {
+            log_rule("ADD");
+            return(IARF_ADD);
+         }
+         break;
 
-      if (get_chunk_parent_type(first) == CT_STRUCT || get_chunk_parent_type(first) == CT_UNION)
-      {
-         // Fix for issue #1240  adding space in struct initializers
-         chunk_t *tmp = chunk_get_prev_ncnl(first);
+         SPACE_RULE({ CT_LABEL_COLON, CT_STRING })
 
-         if (chunk_is_token(tmp, CT_ASSIGN))
+         // TODO: if necessary create a new option
+         if (chunk_is_token(first, CT_LABEL_COLON) && chunk_is_token(second, CT_STRING))
          {
-            log_rule("IGNORE");
-            return(IARF_IGNORE);
+            log_rule("ADD");
+            return(IARF_ADD);
          }
-         // Add or remove space inside struct/union '{' and '}'.
-         log_rule("sp_inside_braces_struct");
-         return(options::sp_inside_braces_struct());
-      }
-      else if (  get_chunk_parent_type(first) == CT_OC_AT
-              && options::sp_inside_braces_oc_dict() != IARF_IGNORE)
-      {
-         // (OC) Add or remove space inside Objective-C boxed dictionary '{' and '}'
-         log_rule("sp_inside_braces_oc_dict");
-         return(options::sp_inside_braces_oc_dict());
-      }
+         break;
 
-      if (get_chunk_parent_type(first) == CT_BRACED_INIT_LIST)
-      {
-         // Add or remove space between nested braces, i.e. '{{' vs '{ {'.
-         if (  options::sp_brace_brace() != IARF_IGNORE
-            && chunk_is_token(second, CT_BRACE_OPEN)
-            && get_chunk_parent_type(second) == CT_BRACED_INIT_LIST)
+         SPACE_RULE({ CT_LABEL_COLON, CT_WORD })
+
+         // TODO: if necessary create a new option
+         if (chunk_is_token(first, CT_LABEL_COLON) && chunk_is_token(second, CT_WORD))
          {
-            log_rule("sp_brace_brace");
-            return(options::sp_brace_brace());
+            log_rule("ADD");
+            return(IARF_ADD);
          }
+         break;
 
-         if (options::sp_after_type_brace_init_lst_open() != IARF_IGNORE)
+         SPACE_RULE({ CT_NAMESPACE, CT_TYPE })
+
+         // TODO: if necessary create a new option
+         if (chunk_is_token(first, CT_NAMESPACE) && chunk_is_token(second, CT_TYPE))
          {
-            // Add or remove space after open brace in an unnamed temporary
-            // direct-list-initialization.
-            log_rule("sp_after_type_brace_init_lst_open");
-            return(options::sp_after_type_brace_init_lst_open());
+            log_rule("ADD");
+            return(IARF_ADD);
          }
+         break;
 
-         if (options::sp_inside_type_brace_init_lst() != IARF_IGNORE)
+         SPACE_RULE({ CT_NAMESPACE, CT_WORD })
+
+         // TODO: if necessary create a new option
+         if (chunk_is_token(first, CT_NAMESPACE) && chunk_is_token(second, CT_WORD))
          {
-            // Add or remove space inside an unnamed temporary direct-list-initialization.
-            log_rule("sp_inside_type_brace_init_lst");
-            return(options::sp_inside_type_brace_init_lst());
+            log_rule("ADD");
+            return(IARF_ADD);
          }
-      }
+         break;
 
-      if (!chunk_is_comment(second))
-      {
-         // Add or remove space inside '{' and '}'.
-         log_rule("sp_inside_braces");
-         return(options::sp_inside_braces());
-      }
-   }
+         SPACE_RULE({ CT_NUMBER, CT_COLON })
 
-   if (  chunk_is_token(first, CT_BRACE_CLOSE)
-      && first->flags.test(PCF_IN_TYPEDEF)
-      && (  get_chunk_parent_type(first) == CT_ENUM
-         || get_chunk_parent_type(first) == CT_STRUCT
-         || get_chunk_parent_type(first) == CT_UNION))
-   {
-      // Add or remove space between '}' and the name of a typedef on the same line.
-      log_rule("sp_brace_typedef");
-      return(options::sp_brace_typedef());
-   }
+         // TODO: if necessary create a new option
+         if (chunk_is_token(first, CT_NUMBER) && chunk_is_token(second, CT_COLON))
+         {
+            log_rule("ADD");
+            return(IARF_ADD);
+         }
+         break;
 
-   if (chunk_is_token(second, CT_PAREN_OPEN) && get_chunk_parent_type(second) == CT_TEMPLATE)
-   {
-      // (D) Add or remove space before the parenthesis in the D constructs
-      // 'template Foo(' and 'class Foo('.
-      log_rule("sp_before_template_paren");
-      return(options::sp_before_template_paren());
-   }
+         SPACE_RULE({ CT_NUMBER, CT_WORD })
 
-   if (  !chunk_is_token(second, CT_PTR_TYPE)
-      && chunk_is_token(first, CT_PAREN_CLOSE)
-      && get_chunk_parent_type(first) == CT_DECLTYPE)
-   {
-      if (auto arg = iarf_flags_t{ options::sp_after_decltype() })
-      {
-         // Add or remove space between 'decltype(...)' and word.
-         log_rule("sp_after_decltype");
-         return(arg);
-      }
-      // Add or remove space between type and word.
-      log_rule("sp_after_type");
-      return(options::sp_after_type());
-   }
+         // TODO: if necessary create a new option
+         if (chunk_is_token(first, CT_NUMBER) && chunk_is_token(second, CT_WORD))
+         {
+            log_rule("ADD");
+            return(IARF_ADD);
+         }
+         break;
 
-   if (  language_is_set(LANG_VALA)
-      && chunk_is_token(second, CT_QUESTION))
-   {
-      // Issue #2090
-      // (D) Add or remove space between a type and '?'.
-      log_rule("sp_type_question");
-      return(options::sp_type_question());
-   }
+         SPACE_RULE({ CT_NUMBER_FP, CT_NUMBER })
 
-   // see if the D template expression is used as a type
-   if (  language_is_set(LANG_D)
-      && chunk_is_token(first, CT_PAREN_CLOSE)
-      && get_chunk_parent_type(first) == CT_D_TEMPLATE)
-   {
-      if (get_chunk_parent_type(second) == CT_USING_ALIAS)
-      {
-         log_rule("sp_after_type | ADD");
-         return(options::sp_after_type() | IARF_ADD);
-      }
+         // TODO: if necessary create a new option
+         if (chunk_is_token(first, CT_NUMBER_FP) && chunk_is_token(second, CT_NUMBER))
+         {
+            log_rule("ADD");
+            return(IARF_ADD);
+         }
+         break;
 
-      if (chunk_is_token(second, CT_WORD))
-      {
-         chunk_t *open_paren = chunk_skip_to_match_rev(first);
-         chunk_t *type       = chunk_get_prev(chunk_get_prev(open_paren));
+         SPACE_RULE({ CT_NUMBER_FP, CT_WORD })
 
-         if (chunk_is_token(type, CT_TYPE))
+         // TODO: if necessary create a new option
+         if (chunk_is_token(first, CT_NUMBER_FP) && chunk_is_token(second, CT_WORD))
          {
-            log_rule("sp_after_type");
-            return(options::sp_after_type());
+            log_rule("ADD");
+            return(IARF_ADD);
          }
-      }
-   }
-
-   if (  !chunk_is_token(second, CT_PTR_TYPE)
-      && (chunk_is_token(first, CT_QUALIFIER) || chunk_is_token(first, CT_TYPE)))
-   {
-      // Add or remove space between type and word.
-      iarf_e arg = options::sp_after_type();
-      log_rule("sp_after_type");
-      return(arg);
-   }
+         break;
 
-   if (  chunk_is_token(first, CT_MACRO_OPEN)
-      || chunk_is_token(first, CT_MACRO_CLOSE)
-      || chunk_is_token(first, CT_MACRO_ELSE))
-   {
-      if (chunk_is_token(second, CT_PAREN_OPEN))
-      {
-         // Add or remove space between function name and '(' on function calls.
-         log_rule("sp_func_call_paren");
-         return(options::sp_func_call_paren());
-      }
-      log_rule("IGNORE");
-      return(IARF_IGNORE);
-   }
+         SPACE_RULE({ CT_OC_CLASS, CT_CLASS_COLON })
 
-   // If nothing claimed the PTR_TYPE, then return ignore
-   if (chunk_is_token(first, CT_PTR_TYPE) || chunk_is_token(second, CT_PTR_TYPE))
-   {
-      log_rule("IGNORE");
-      return(IARF_IGNORE);
-   }
+         // TODO: if necessary create a new option
+         if (chunk_is_token(first, CT_OC_CLASS) && chunk_is_token(second, CT_CLASS_COLON))
+         {
+            log_rule("ADD");
+            return(IARF_ADD);
+         }
+         break;
 
-   if (chunk_is_token(first, CT_NOT))
-   {
-      // Add or remove space after the '!' (not) unary operator.
-      log_rule("sp_not");
-      return(options::sp_not());
-   }
+         SPACE_RULE({ CT_OC_CLASS, CT_PAREN_OPEN })
 
-   if (chunk_is_token(first, CT_INV))
-   {
-      // Add or remove space after the '~' (invert) unary operator.
-      log_rule("sp_inv");
-      return(options::sp_inv());
-   }
+         // TODO: if necessary create a new option
+         if (chunk_is_token(first, CT_OC_CLASS) && chunk_is_token(second, CT_PAREN_OPEN))
+         {
+            log_rule("ADD");
+            return(IARF_ADD);
+         }
+         break;
 
-   if (chunk_is_token(first, CT_ADDR))
-   {
-      // Add or remove space after the '&' (address-of) unary operator. This does not
-      // affect the spacing after a '&' that is part of a type.
-      log_rule("sp_addr");
-      return(options::sp_addr());
-   }
+         SPACE_RULE({ CT_OC_IMPL, CT_OC_CLASS })
 
-   if (chunk_is_token(first, CT_DEREF))
-   {
-      // Add or remove space after the '*' (dereference) unary operator. This does
-      // not affect the spacing after a '*' that is part of a type.
-      log_rule("sp_deref");
-      return(options::sp_deref());
-   }
+         // TODO: if necessary create a new option
+         if (chunk_is_token(first, CT_OC_IMPL) && chunk_is_token(second, CT_OC_CLASS))
+         {
+            log_rule("ADD");
+            return(IARF_ADD);
+         }
+         break;
 
-   if (chunk_is_token(first, CT_POS) || chunk_is_token(first, CT_NEG))
-   {
-      // Add or remove space after '+' or '-', as in 'x = -5' or 'y = +7'.
-      log_rule("sp_sign");
-      return(options::sp_sign());
-   }
+         SPACE_RULE({ CT_OC_INTF, CT_OC_CLASS })
 
-   if (chunk_is_token(first, CT_INCDEC_BEFORE) || chunk_is_token(second, CT_INCDEC_AFTER))
-   {
-      // Add or remove space between '++' and '--' the word to which it is being
-      // applied, as in '(--x)' or 'y++;'.
-      log_rule("sp_incdec");
-      return(options::sp_incdec());
-   }
+         // TODO: if necessary create a new option
+         if (chunk_is_token(first, CT_OC_INTF) && chunk_is_token(second, CT_OC_CLASS))
+         {
+            log_rule("ADD");
+            return(IARF_ADD);
+         }
+         break;
 
-   if (chunk_is_token(second, CT_CS_SQ_COLON))
-   {
-      log_rule("REMOVE");
-      return(IARF_REMOVE);
-   }
+         SPACE_RULE({ CT_OC_MSG_DECL, CT_BRACE_OPEN })
 
-   if (chunk_is_token(first, CT_CS_SQ_COLON))
-   {
-      log_rule("FORCE");
-      return(IARF_FORCE);
-   }
+         // TODO: if necessary create a new option
+         if (chunk_is_token(first, CT_OC_MSG_DECL) && chunk_is_token(second, CT_BRACE_OPEN))
+         {
+            log_rule("ADD");
+            return(IARF_ADD);
+         }
+         break;
 
-   if (chunk_is_token(first, CT_OC_SCOPE))
-   {
-      // (OC) Add or remove space after the scope '+' or '-', as in '-(void) foo;'
-      // or '+(int) bar;'.
-      log_rule("sp_after_oc_scope");
-      return(options::sp_after_oc_scope());
-   }
+         SPACE_RULE({ CT_PAREN_CLOSE, CT_COND_COLON })
 
-   if (chunk_is_token(first, CT_OC_DICT_COLON))
-   {
-      // (OC) Add or remove space after the colon in immutable dictionary expression
-      // 'NSDictionary *test = @{@"foo" :@"bar"};'.
-      log_rule("sp_after_oc_dict_colon");
-      return(options::sp_after_oc_dict_colon());
-   }
+         // TODO: if necessary create a new option
+         if (chunk_is_token(first, CT_PAREN_CLOSE) && chunk_is_token(second, CT_COND_COLON))
+         {
+            log_rule("ADD");
+            return(IARF_ADD);
+         }
+         break;
 
-   if (chunk_is_token(second, CT_OC_DICT_COLON))
-   {
-      // (OC) Add or remove space before the colon in immutable dictionary expression
-      // 'NSDictionary *test = @{@"foo" :@"bar"};'.
-      log_rule("sp_before_oc_dict_colon");
-      return(options::sp_before_oc_dict_colon());
-   }
+         SPACE_RULE({ CT_PAREN_CLOSE, CT_TYPE })
 
-   if (chunk_is_token(first, CT_OC_COLON))
-   {
-      if (first->flags.test(PCF_IN_OC_MSG))
-      {
-         // (OC) Add or remove space after the colon in message specs,
-         // i.e. '[object setValue:1];' vs. '[object setValue: 1];'.
-         log_rule("sp_after_send_oc_colon");
-         return(options::sp_after_send_oc_colon());
-      }
-      // (OC) Add or remove space after the colon in message specs,
-      // i.e. '-(int) f:(int) x;' vs. '-(int) f: (int) x;'.
-      log_rule("sp_after_oc_colon");
-      return(options::sp_after_oc_colon());
-   }
+         // if (chunk_is_token(first, CT_PAREN_CLOSE) && chunk_is_token(second, CT_QUESTION))
+         // Issue #2596
+         // look at "sp_cond_question"
+         // TODO: if necessary create a new option
+         if (chunk_is_token(first, CT_PAREN_CLOSE) && chunk_is_token(second, CT_TYPE))
+         {
+            log_rule("ADD");
+            return(IARF_ADD);
+         }
+         break;
 
-   if (chunk_is_token(second, CT_OC_COLON))
-   {
-      if (  first->flags.test(PCF_IN_OC_MSG)
-         && (chunk_is_token(first, CT_OC_MSG_FUNC) || chunk_is_token(first, CT_OC_MSG_NAME)))
-      {
-         // (OC) Add or remove space before the colon in message specs,
-         // i.e. '[object setValue:1];' vs. '[object setValue :1];'.
-         log_rule("sp_before_send_oc_colon");
-         return(options::sp_before_send_oc_colon());
-      }
-      // (OC) Add or remove space before the colon in message specs,
-      // i.e. '-(int) f: (int) x;' vs. '-(int) f : (int) x;'.
-      log_rule("sp_before_oc_colon");
-      return(options::sp_before_oc_colon());
-   }
+         SPACE_RULE({ CT_PP_DEFINE, CT_MACRO })
 
-   if (chunk_is_token(second, CT_COMMENT) && get_chunk_parent_type(second) == CT_COMMENT_EMBED)
-   {
-      log_rule("FORCE");
-      return(IARF_FORCE);
-   }
+         // TODO: if necessary create a new option
+         if (chunk_is_token(first, CT_PP_DEFINE) && chunk_is_token(second, CT_MACRO))
+         {
+            log_rule("ADD");
+            return(IARF_ADD);
+         }
+         break;
 
-   if (chunk_is_token(first, CT_COMMENT))
-   {
-      log_rule("FORCE");
-      return(IARF_FORCE);
-   }
+         SPACE_RULE({ CT_PP_DEFINE, CT_MACRO_FUNC })
 
-   if (chunk_is_token(first, CT_NEW) && chunk_is_token(second, CT_PAREN_OPEN))
-   {
-      // c# new Constraint, c++ new operator
-      // Add or remove space between 'new' and '(' in 'new()'.
-      log_rule("sp_between_new_paren");
-      return(options::sp_between_new_paren());
-   }
+         // TODO: if necessary create a new option
+         if (chunk_is_token(first, CT_PP_DEFINE) && chunk_is_token(second, CT_MACRO_FUNC))
+         {
+            log_rule("ADD");
+            return(IARF_ADD);
+         }
+         break;
 
-   if (  chunk_is_token(first, CT_NEW)
-      || chunk_is_token(first, CT_DELETE)
-      || (chunk_is_token(first, CT_TSQUARE) && get_chunk_parent_type(first) == CT_DELETE))
-   {
-      // Add or remove space after 'new', 'delete' and 'delete[]'.
-      log_rule("sp_after_new");
-      return(options::sp_after_new());
-   }
+         SPACE_RULE({ CT_PP_ELSE, CT_PAREN_OPEN })
 
-   if (chunk_is_token(first, CT_ANNOTATION) && chunk_is_paren_open(second))
-   {
-      // (Java) Add or remove space between an annotation and the open parenthesis.
-      log_rule("sp_annotation_paren");
-      return(options::sp_annotation_paren());
-   }
+         // TODO: if necessary create a new option
+         if (chunk_is_token(first, CT_PP_ELSE) && chunk_is_token(second, CT_PAREN_OPEN))
+         {
+            log_rule("ADD");
+            return(IARF_ADD);
+         }
+         break;
 
-   if (chunk_is_token(first, CT_OC_PROPERTY))
-   {
-      // (OC) Add or remove space after '@property'.
-      log_rule("sp_after_oc_property");
-      return(options::sp_after_oc_property());
-   }
+         SPACE_RULE({ CT_PP_IF, CT_PAREN_OPEN })
 
-   if (chunk_is_token(first, CT_EXTERN) && chunk_is_token(second, CT_PAREN_OPEN))
-   {
-      // (D) Add or remove space between 'extern' and '(' as in 'extern (C)'.
-      log_rule("sp_extern_paren");
-      return(options::sp_extern_paren());
-   }
+         // TODO: if necessary create a new option
+         if (chunk_is_token(first, CT_PP_IF) && chunk_is_token(second, CT_PAREN_OPEN))
+         {
+            log_rule("ADD");
+            return(IARF_ADD);
+         }
+         break;
 
-   if (  chunk_is_token(second, CT_TYPE)
-      && (  (chunk_is_token(first, CT_STRING) && get_chunk_parent_type(first) == CT_EXTERN)
-         || (chunk_is_token(first, CT_FPAREN_CLOSE) && get_chunk_parent_type(first) == CT_ATTRIBUTE)))
-   {
-      log_rule("FORCE");
-      return(IARF_FORCE);  /* TODO: make this configurable? */
-   }
+         SPACE_RULE({ CT_PP_IF, CT_PP_DEFINE })
 
-   // this table lists out all combos where a space should NOT be present
-   // CT_UNKNOWN is a wildcard.
-   for (auto it : no_space_table)
-   {
-      if (  (it.first == CT_UNKNOWN || it.first == first->type)
-         && (it.second == CT_UNKNOWN || it.second == second->type))
-      {
-         log_rule("REMOVE from no_space_table");
-         return(IARF_REMOVE);
-      }
-   }
+         // TODO: if necessary create a new option
+         if (chunk_is_token(first, CT_PP_IF) && chunk_is_token(second, CT_PP_DEFINE))
+         {
+            log_rule("ADD");
+            return(IARF_ADD);
+         }
+         break;
 
-   if (chunk_is_token(first, CT_NOEXCEPT))
-   {
-      // Add or remove space after 'noexcept'.
-      log_rule("sp_after_noexcept");
-      return(options::sp_after_noexcept());
-   }
+         SPACE_RULE({ CT_PP_IF, CT_PP_DEFINED })
 
-   // Issue #2138
-   if (chunk_is_token(first, CT_FPAREN_CLOSE))
-   {
-      if (chunk_is_token(second, CT_QUALIFIER))
-      {
-         // Add or remove space between ')' and a qualifier such as 'const'.
-         log_rule("sp_paren_qualifier");
-         return(options::sp_paren_qualifier());
-      }
-      else if (chunk_is_token(second, CT_NOEXCEPT))
-      {
-         // Add or remove space between ')' and 'noexcept'.
-         log_rule("sp_paren_noexcept");
-         return(options::sp_paren_noexcept());
-      }
-   }
+         // TODO: if necessary create a new option
+         if (chunk_is_token(first, CT_PP_IF) && chunk_is_token(second, CT_PP_DEFINED))
+         {
+            log_rule("ADD");
+            return(IARF_ADD);
+         }
+         break;
 
-   // Issue #2098
-   if (  chunk_is_token(first, CT_PP_PRAGMA)
-      && chunk_is_token(second, CT_PREPROC_BODY))
-   {
-      log_rule("REMOVE");
-      return(IARF_REMOVE);
-   }
+         SPACE_RULE({ CT_PP_IF, CT_TYPE })
 
-   // Issue #1733
-   if (  chunk_is_token(first, CT_OPERATOR_VAL)
-      && chunk_is_token(second, CT_TYPE))
-   {
-      log_rule("IGNORE");
-      return(IARF_IGNORE);
-   }
+         // TODO: if necessary create a new option
+         if (chunk_is_token(first, CT_PP_IF) && chunk_is_token(second, CT_TYPE))
+         {
+            log_rule("ADD");
+            return(IARF_ADD);
+         }
+         break;
 
-   // Issue #995
-   if (chunk_is_token(first, CT_DO) && chunk_is_token(second, CT_BRACE_OPEN))
-   {
-      // Add or remove space between 'do' and '{'.
-      log_rule("sp_do_brace_open");
-      return(options::sp_do_brace_open());
-   }
+         SPACE_RULE({ CT_PP_IF, CT_WORD })
 
-   // Issue #995
-   if (chunk_is_token(first, CT_WHILE_OF_DO) && chunk_is_token(second, CT_PAREN_OPEN))
-   {
-      // Add or remove space between 'while' and '('.
-      log_rule("sp_while_paren_open");
-      return(options::sp_while_paren_open());
-   }
+         // TODO: if necessary create a new option
+         if (chunk_is_token(first, CT_PP_IF) && chunk_is_token(second, CT_WORD))
+         {
+            log_rule("ADD");
+            return(IARF_ADD);
+         }
+         break;
 
-   // Issue #995
-   if (chunk_is_token(first, CT_BRACE_CLOSE) && chunk_is_token(second, CT_WHILE_OF_DO))
-   {
-      // Add or remove space between '}' and 'while.
-      log_rule("sp_brace_close_while");
-      return(options::sp_brace_close_while());
-   }
+         SPACE_RULE({ CT_PP_INCLUDE, CT_STRING })
 
-   // TODO: have a look to Issue #2186, why NEWLINE?
-   // Issue #2524
-   if (chunk_is_token(first, CT_NEWLINE) && chunk_is_token(second, CT_BRACE_OPEN))
-   {
-      log_rule("IGNORE");
-      return(IARF_IGNORE);
-   }
+         // TODO: if necessary create a new option
+         if (chunk_is_token(first, CT_PP_INCLUDE) && chunk_is_token(second, CT_STRING))
+         {
+            log_rule("ADD");
+            return(IARF_ADD);
+         }
+         break;
 
-   // TODO: if necessary create a new option
-   if (chunk_is_token(first, CT_AMP) && chunk_is_token(second, CT_WORD))
-   {
-      log_rule("ADD");
-      return(IARF_ADD);
-   }
+         SPACE_RULE({ CT_PP_OTHER, CT_PREPROC_BODY })
 
-   // TODO: if necessary create a new option
-   if (chunk_is_token(first, CT_ANGLE_CLOSE) && chunk_is_token(second, CT_BRACE_OPEN))
-   {
-      log_rule("ADD");
-      return(IARF_ADD);
-   }
+         // TODO: if necessary create a new option
+         if (chunk_is_token(first, CT_PP_OTHER) && chunk_is_token(second, CT_PREPROC_BODY))
+         {
+            log_rule("ADD");
+            return(IARF_ADD);
+         }
+         break;
 
-   // TODO: if necessary create a new option
-   if (chunk_is_token(first, CT_ANNOTATION) && chunk_is_token(second, CT_TYPE))
-   {
-      log_rule("ADD");
-      return(IARF_ADD);
-   }
+         SPACE_RULE({ CT_QUESTION, CT_FUNC_CALL })
 
-   // TODO: if necessary create a new option
-   if (chunk_is_token(first, CT_ASSIGN_FUNC_PROTO) && chunk_is_token(second, CT_DEFAULT))
-   {
-      log_rule("ADD");
-      return(IARF_ADD);
-   }
+         // TODO: if necessary create a new option
+         if (chunk_is_token(first, CT_QUESTION) && chunk_is_token(second, CT_FUNC_CALL))
+         {
+            log_rule("ADD");
+            return(IARF_ADD);
+         }
+         break;
 
-   // TODO: if necessary create a new option
-   if (chunk_is_token(first, CT_ASSIGN_FUNC_PROTO) && chunk_is_token(second, CT_DELETE))
-   {
-      log_rule("ADD");
-      return(IARF_ADD);
-   }
+         SPACE_RULE({ CT_QUESTION, CT_PAREN_OPEN })
 
-   // TODO: if necessary create a new option
-   if (chunk_is_token(first, CT_ASSIGN_FUNC_PROTO) && chunk_is_token(second, CT_NUMBER))
-   {
-      log_rule("ADD");
-      return(IARF_ADD);
-   }
+         // TODO: if necessary create a new option
+         if (chunk_is_token(first, CT_QUESTION) && chunk_is_token(second, CT_PAREN_OPEN))
+         {
+            log_rule("ADD");
+            return(IARF_ADD);
+         }
+         break;
 
-   // TODO: if necessary create a new option
-   if (chunk_is_token(first, CT_BIT_COLON) && chunk_is_token(second, CT_TYPE))
-   {
-      log_rule("ADD");
-      return(IARF_ADD);
-   }
+         SPACE_RULE({ CT_QUESTION, CT_STRING })
 
-   // TODO: if necessary create a new option
-   if (chunk_is_token(first, CT_BRACE_CLOSE) && chunk_is_token(second, CT_PAREN_OPEN))
-   {
-      log_rule("ADD");
-      return(IARF_ADD);
-   }
+         // TODO: if necessary create a new option
+         if (chunk_is_token(first, CT_QUESTION) && chunk_is_token(second, CT_STRING))
+         {
+            log_rule("ADD");
+            return(IARF_ADD);
+         }
+         break;
 
-   // TODO: if necessary create a new option
-   if (chunk_is_token(first, CT_CLASS_COLON) && chunk_is_token(second, CT_QUALIFIER))
-   {
-      log_rule("ADD");
-      return(IARF_ADD);
-   }
+         SPACE_RULE({ CT_QUESTION, CT_WORD })
 
-   // TODO: if necessary create a new option
-   if (chunk_is_token(first, CT_CLASS_COLON) && chunk_is_token(second, CT_WORD))
-   {
-      log_rule("ADD");
-      return(IARF_ADD);
-   }
+         // TODO: if necessary create a new option
+         if (chunk_is_token(first, CT_QUESTION) && chunk_is_token(second, CT_WORD))
+         {
+            log_rule("ADD");
+            return(IARF_ADD);
+         }
+         break;
 
-   // TODO: if necessary create a new option
-   if (chunk_is_token(first, CT_COLON) && chunk_is_token(second, CT_NUMBER))
-   {
-      log_rule("ADD");
-      return(IARF_ADD);
-   }
+         SPACE_RULE({ CT_SPAREN_CLOSE, CT_BRACE_OPEN })
 
-   // TODO: if necessary create a new option
-   if (chunk_is_token(first, CT_COND_COLON) && chunk_is_token(second, CT_FUNC_CALL))
-   {
-      log_rule("ADD");
-      return(IARF_ADD);
-   }
+         // TODO: if necessary create a new option
+         if (chunk_is_token(first, CT_SPAREN_CLOSE) && chunk_is_token(second, CT_BRACE_OPEN))
+         {
+            log_rule("ADD");
+            return(IARF_ADD);
+         }
+         break;
 
-   // TODO: if necessary create a new option
-   if (chunk_is_token(first, CT_COND_COLON) && chunk_is_token(second, CT_STRING))
-   {
-      log_rule("ADD");
-      return(IARF_ADD);
-   }
+         SPACE_RULE({ CT_SQL_EXEC, CT_SQL_WORD })
 
-   // TODO: if necessary create a new option
-   if (chunk_is_token(first, CT_COND_COLON) && chunk_is_token(second, CT_WORD))
-   {
-      log_rule("ADD");
-      return(IARF_ADD);
-   }
+         // TODO: if necessary create a new option
+         if (chunk_is_token(first, CT_SQL_EXEC) && chunk_is_token(second, CT_SQL_WORD))
+         {
+            log_rule("ADD");
+            return(IARF_ADD);
+         }
+         break;
 
-   // TODO: if necessary create a new option
-   if (chunk_is_token(first, CT_CONSTR_COLON) && chunk_is_token(second, CT_FUNC_CTOR_VAR))
-   {
-      log_rule("ADD");
-      return(IARF_ADD);
-   }
+         SPACE_RULE({ CT_SQL_WORD, CT_PAREN_OPEN })
 
-   // TODO: if necessary create a new option
-   if (chunk_is_token(first, CT_CS_PROPERTY) && chunk_is_token(second, CT_BRACE_OPEN))
-   {
-      log_rule("ADD");
-      return(IARF_ADD);
-   }
+         // TODO: if necessary create a new option
+         if (chunk_is_token(first, CT_SQL_WORD) && chunk_is_token(second, CT_PAREN_OPEN))
+         {
+            log_rule("ADD");
+            return(IARF_ADD);
+         }
+         break;
 
-   // TODO: if necessary create a new option
-   if (chunk_is_token(first, CT_ENUM) && chunk_is_token(second, CT_BRACE_OPEN))
-   {
-      log_rule("ADD");
-      return(IARF_ADD);
-   }
+         SPACE_RULE({ CT_STRUCT, CT_TYPE })
 
-   // TODO: if necessary create a new option
-   if (chunk_is_token(first, CT_ENUM) && chunk_is_token(second, CT_ENUM_CLASS))
-   {
-      log_rule("ADD");
-      return(IARF_ADD);
-   }
+         // TODO: if necessary create a new option
+         if (chunk_is_token(first, CT_STRUCT) && chunk_is_token(second, CT_TYPE))
+         {
+            log_rule("ADD");
+            return(IARF_ADD);
+         }
+         break;
 
-   // TODO: if necessary create a new option
-   if (chunk_is_token(first, CT_ENUM) && chunk_is_token(second, CT_TYPE))
-   {
-      log_rule("ADD");
-      return(IARF_ADD);
-   }
+         SPACE_RULE({ CT_TSQUARE, CT_BRACE_OPEN })
 
-   // TODO: if necessary create a new option
-   if (chunk_is_token(first, CT_ENUM_CLASS) && chunk_is_token(second, CT_TYPE))
-   {
-      log_rule("ADD");
-      return(IARF_ADD);
-   }
+         // TODO: if necessary create a new option
+         if (chunk_is_token(first, CT_TSQUARE) && chunk_is_token(second, CT_BRACE_OPEN))
+         {
+            log_rule("ADD");
+            return(IARF_ADD);
+         }
+         break;
 
-   // TODO: if necessary create a new option
-   if (chunk_is_token(first, CT_FPAREN_CLOSE) && chunk_is_token(second, CT_ASSIGN_FUNC_PROTO))
-   {
-      log_rule("ADD");
-      return(IARF_ADD);
-   }
+         SPACE_RULE({ CT_TSQUARE, CT_WORD })
 
-   // TODO: if necessary create a new option
-   if (chunk_is_token(first, CT_FPAREN_CLOSE) && chunk_is_token(second, CT_COND_COLON))
-   {
-      log_rule("ADD");
-      return(IARF_ADD);
-   }
+         // TODO: if necessary create a new option
+         if (chunk_is_token(first, CT_TSQUARE) && chunk_is_token(second, CT_WORD))
+         {
+            log_rule("ADD");
+            return(IARF_ADD);
+         }
+         break;
 
-   // TODO: if necessary create a new option
-   if (chunk_is_token(first, CT_FPAREN_CLOSE) && chunk_is_token(second, CT_CONSTR_COLON))
-   {
-      log_rule("ADD");
-      return(IARF_ADD);
-   }
+         SPACE_RULE({ CT_TYPEDEF, CT_ENUM })
 
-   // TODO: if necessary create a new option
-   if (chunk_is_token(first, CT_FPAREN_CLOSE) && chunk_is_token(second, CT_QUESTION))
-   {
-      log_rule("ADD");
-      return(IARF_ADD);
-   }
+         // TODO: if necessary create a new option
+         if (chunk_is_token(first, CT_TYPEDEF) && chunk_is_token(second, CT_ENUM))
+         {
+            log_rule("ADD");
+            return(IARF_ADD);
+         }
+         break;
 
-   // TODO: if necessary create a new option
-   if (chunk_is_token(first, CT_FRIEND) && chunk_is_token(second, CT_CLASS))
-   {
-      log_rule("ADD");
-      return(IARF_ADD);
-   }
+         SPACE_RULE({ CT_TYPEDEF, CT_STRUCT })
 
-   // TODO: if necessary create a new option
-   if (chunk_is_token(first, CT_FRIEND) && chunk_is_token(second, CT_TYPE))
-   {
-      log_rule("ADD");
-      return(IARF_ADD);
-   }
+         // TODO: if necessary create a new option
+         if (chunk_is_token(first, CT_TYPEDEF) && chunk_is_token(second, CT_STRUCT))
+         {
+            log_rule("ADD");
+            return(IARF_ADD);
+         }
+         break;
 
-   // TODO: if necessary create a new option
-   if (chunk_is_token(first, CT_LABEL_COLON) && chunk_is_token(second, CT_NEW))
-   {
-      log_rule("ADD");
-      return(IARF_ADD);
-   }
+         SPACE_RULE({ CT_TYPEDEF, CT_TYPE })
 
-   // TODO: if necessary create a new option
-   if (chunk_is_token(first, CT_LABEL_COLON) && chunk_is_token(second, CT_STRING))
-   {
-      log_rule("ADD");
-      return(IARF_ADD);
-   }
+         // TODO: if necessary create a new option
+         if (chunk_is_token(first, CT_TYPEDEF) && chunk_is_token(second, CT_TYPE))
+         {
+            log_rule("ADD");
+            return(IARF_ADD);
+         }
+         break;
 
-   // TODO: if necessary create a new option
-   if (chunk_is_token(first, CT_LABEL_COLON) && chunk_is_token(second, CT_WORD))
-   {
-      log_rule("ADD");
-      return(IARF_ADD);
-   }
+         SPACE_RULE({ CT_TYPENAME, CT_ELLIPSIS })
 
-   // TODO: if necessary create a new option
-   if (chunk_is_token(first, CT_NAMESPACE) && chunk_is_token(second, CT_TYPE))
-   {
-      log_rule("ADD");
-      return(IARF_ADD);
-   }
+         // TODO: if necessary create a new option
+         if (chunk_is_token(first, CT_TYPENAME) && chunk_is_token(second, CT_ELLIPSIS))
+         {
+            log_rule("ADD");
+            return(IARF_ADD);
+         }
+         break;
 
-   // TODO: if necessary create a new option
-   if (chunk_is_token(first, CT_NAMESPACE) && chunk_is_token(second, CT_WORD))
-   {
-      log_rule("ADD");
-      return(IARF_ADD);
-   }
+         SPACE_RULE({ CT_USING, CT_NAMESPACE })
 
-   // TODO: if necessary create a new option
-   if (chunk_is_token(first, CT_NUMBER) && chunk_is_token(second, CT_COLON))
-   {
-      log_rule("ADD");
-      return(IARF_ADD);
-   }
+         // TODO: if necessary create a new option
+         if (chunk_is_token(first, CT_USING) && chunk_is_token(second, CT_NAMESPACE))
+         {
+            log_rule("ADD");
+            return(IARF_ADD);
+         }
+         break;
 
-   // TODO: if necessary create a new option
-   if (chunk_is_token(first, CT_NUMBER) && chunk_is_token(second, CT_WORD))
-   {
-      log_rule("ADD");
-      return(IARF_ADD);
-   }
+         SPACE_RULE({ CT_USING, CT_WORD })
 
-   // TODO: if necessary create a new option
-   if (chunk_is_token(first, CT_NUMBER_FP) && chunk_is_token(second, CT_NUMBER))
-   {
-      log_rule("ADD");
-      return(IARF_ADD);
-   }
+         // TODO: if necessary create a new option
+         if (chunk_is_token(first, CT_USING) && chunk_is_token(second, CT_WORD))
+         {
+            log_rule("ADD");
+            return(IARF_ADD);
+         }
+         break;
 
-   // TODO: if necessary create a new option
-   if (chunk_is_token(first, CT_NUMBER_FP) && chunk_is_token(second, CT_WORD))
-   {
-      log_rule("ADD");
-      return(IARF_ADD);
-   }
+         SPACE_RULE({ CT_WORD, CT_BRACE_OPEN })
 
-   // TODO: if necessary create a new option
-   if (chunk_is_token(first, CT_OC_CLASS) && chunk_is_token(second, CT_CLASS_COLON))
-   {
-      log_rule("ADD");
-      return(IARF_ADD);
-   }
+         // TODO: if necessary create a new option
+         if (chunk_is_token(first, CT_WORD) && chunk_is_token(second, CT_BRACE_OPEN))
+         {
+            log_rule("ADD");
+            return(IARF_ADD);
+         }
+         break;
 
-   // TODO: if necessary create a new option
-   if (chunk_is_token(first, CT_OC_CLASS) && chunk_is_token(second, CT_PAREN_OPEN))
-   {
-      log_rule("ADD");
-      return(IARF_ADD);
-   }
+         SPACE_RULE({ CT_WORD, CT_NUMBER })
 
-   // TODO: if necessary create a new option
-   if (chunk_is_token(first, CT_OC_IMPL) && chunk_is_token(second, CT_OC_CLASS))
-   {
-      log_rule("ADD");
-      return(IARF_ADD);
-   }
+         // if (chunk_is_token(first, CT_WORD) && chunk_is_token(second, CT_COND_COLON))
+         // Issue #2596
+         // look at "sp_cond_colon"
+         // TODO: if necessary create a new option
+         if (chunk_is_token(first, CT_WORD) && chunk_is_token(second, CT_NUMBER))
+         {
+            log_rule("ADD");
+            return(IARF_ADD);
+         }
+         break;
 
-   // TODO: if necessary create a new option
-   if (chunk_is_token(first, CT_OC_INTF) && chunk_is_token(second, CT_OC_CLASS))
-   {
-      log_rule("ADD");
-      return(IARF_ADD);
-   }
+         SPACE_RULE({ CT_WORD, CT_NUMBER_FP })
 
-   // TODO: if necessary create a new option
-   if (chunk_is_token(first, CT_OC_MSG_DECL) && chunk_is_token(second, CT_BRACE_OPEN))
-   {
-      log_rule("ADD");
-      return(IARF_ADD);
-   }
+         // TODO: if necessary create a new option
+         if (chunk_is_token(first, CT_WORD) && chunk_is_token(second, CT_NUMBER_FP))
+         {
+            log_rule("ADD");
+            return(IARF_ADD);
+         }
+         break;
 
-   // TODO: if necessary create a new option
-   if (chunk_is_token(first, CT_PAREN_CLOSE) && chunk_is_token(second, CT_COND_COLON))
-   {
-      log_rule("ADD");
-      return(IARF_ADD);
-   }
-   // if (chunk_is_token(first, CT_PAREN_CLOSE) && chunk_is_token(second, CT_QUESTION))
-   // Issue #2596
-   // look at "sp_cond_question"
+         SPACE_RULE({ CT_WORD, CT_QUESTION })
 
-   // TODO: if necessary create a new option
-   if (chunk_is_token(first, CT_PAREN_CLOSE) && chunk_is_token(second, CT_TYPE))
-   {
-      log_rule("ADD");
-      return(IARF_ADD);
-   }
+         // TODO: if necessary create a new option
+         if (chunk_is_token(first, CT_WORD) && chunk_is_token(second, CT_QUESTION))
+         {
+            log_rule("ADD");
+            return(IARF_ADD);
+         }
+         break;
 
-   // TODO: if necessary create a new option
-   if (chunk_is_token(first, CT_PP_DEFINE) && chunk_is_token(second, CT_MACRO))
-   {
-      log_rule("ADD");
-      return(IARF_ADD);
-   }
+         SPACE_RULE({ CT_FORM_FEED, CT_UNKNOWN },
+                    { CT_UNKNOWN, CT_FORM_FEED })
 
-   // TODO: if necessary create a new option
-   if (chunk_is_token(first, CT_PP_DEFINE) && chunk_is_token(second, CT_MACRO_FUNC))
-   {
-      log_rule("ADD");
-      return(IARF_ADD);
-   }
+         // Issue #2386
+         if (  chunk_is_token(first, CT_FORM_FEED)
+            || chunk_is_token(second, CT_FORM_FEED))
+         {
+            log_rule("IGNORE");
+            return(IARF_IGNORE);
+         }
+         break;
 
-   // TODO: if necessary create a new option
-   if (chunk_is_token(first, CT_PP_ELSE) && chunk_is_token(second, CT_PAREN_OPEN))
-   {
-      log_rule("ADD");
-      return(IARF_ADD);
+      default:
+         break;
+      } // switch
    }
 
-   // TODO: if necessary create a new option
-   if (chunk_is_token(first, CT_PP_IF) && chunk_is_token(second, CT_PAREN_OPEN))
-   {
-      log_rule("ADD");
-      return(IARF_ADD);
-   }
+   //
+   // these lines are only useful for debugging uncrustify itself
+   LOG_FMT(LSPACE, "\n\n%s(%d): WARNING: unrecognize do_space:\n",
+           __func__, __LINE__);
+   LOG_FMT(LSPACE, "   first->orig_line  is %zu, first->orig_col  is %zu, first->text()  '%s', first->type is  %s\n",
+           first->orig_line, first->orig_col, first->text(), get_token_name(first->type));
+   LOG_FMT(LSPACE, "   second->orig_line is %zu, second->orig_col is %zu, second->text() '%s', second->type is %s\n",
+           second->orig_line, second->orig_col, second->text(), get_token_name(second->type));
 
-   // TODO: if necessary create a new option
-   if (chunk_is_token(first, CT_PP_IF) && chunk_is_token(second, CT_PP_DEFINE))
-   {
-      log_rule("ADD");
-      return(IARF_ADD);
-   }
+   log_rule("ADD as default value");
+   return(IARF_ADD);
+} // do_space
 
-   // TODO: if necessary create a new option
-   if (chunk_is_token(first, CT_PP_IF) && chunk_is_token(second, CT_PP_DEFINED))
-   {
-      log_rule("ADD");
-      return(IARF_ADD);
-   }
 
-   // TODO: if necessary create a new option
-   if (chunk_is_token(first, CT_PP_IF) && chunk_is_token(second, CT_TYPE))
-   {
-      log_rule("ADD");
-      return(IARF_ADD);
-   }
+//! the number of rules in do_space()
+static const UINT16 SPACE_RULE_COUNT = __COUNTER__ - SPACE_RULE_FIRST;
 
-   // TODO: if necessary create a new option
-   if (chunk_is_token(first, CT_PP_IF) && chunk_is_token(second, CT_WORD))
-   {
-      log_rule("ADD");
-      return(IARF_ADD);
-   }
+static_assert(SPACE_RULE_COUNT < SPACE_RULE_END,
+              "the rules of do_space() must be numbered below SPACE_RULE_END");
 
-   // TODO: if necessary create a new option
-   if (chunk_is_token(first, CT_PP_INCLUDE) && chunk_is_token(second, CT_STRING))
-   {
-      log_rule("ADD");
-      return(IARF_ADD);
-   }
 
-   // TODO: if necessary create a new option
-   if (chunk_is_token(first, CT_PP_OTHER) && chunk_is_token(second, CT_PREPROC_BODY))
-   {
-      log_rule("ADD");
-      return(IARF_ADD);
-   }
+/**
+ * Keeps the keys of which class(key) is below classes, grouped by class and
+ * sorted by rule within a class.
+ */
+template<typename F>
+static void group_space_rule_keys(const vector<space_rule_key_t> &keys, size_t classes, F class_of,
+                                  vector<space_rule_key_t> &grouped, vector<size_t> &start)
+{
+   start.assign(classes + 1, 0);
 
-   // TODO: if necessary create a new option
-   if (chunk_is_token(first, CT_QUESTION) && chunk_is_token(second, CT_FUNC_CALL))
+   for (const space_rule_key_t &key : keys)
    {
-      log_rule("ADD");
-      return(IARF_ADD);
+      if (class_of(key) < classes)
+      {
+         start[class_of(key) + 1]++;
+      }
    }
 
-   // TODO: if necessary create a new option
-   if (chunk_is_token(first, CT_QUESTION) && chunk_is_token(second, CT_PAREN_OPEN))
+   for (size_t cls = 1; cls <= classes; cls++)
    {
-      log_rule("ADD");
-      return(IARF_ADD);
+      start[cls] += start[cls - 1];
    }
 
-   // TODO: if necessary create a new option
-   if (chunk_is_token(first, CT_QUESTION) && chunk_is_token(second, CT_STRING))
-   {
-      log_rule("ADD");
-      return(IARF_ADD);
-   }
+   grouped.resize(start[classes]);
+   vector<size_t> next(start.begin(), start.end() - 1);
 
-   // TODO: if necessary create a new option
-   if (chunk_is_token(first, CT_QUESTION) && chunk_is_token(second, CT_WORD))
+   for (const space_rule_key_t &key : keys)
    {
-      log_rule("ADD");
-      return(IARF_ADD);
+      if (class_of(key) < classes)
+      {
+         grouped[next[class_of(key)]++] = key;
+      }
    }
+}
 
-   // TODO: if necessary create a new option
-   if (chunk_is_token(first, CT_SPAREN_CLOSE) && chunk_is_token(second, CT_BRACE_OPEN))
-   {
-      log_rule("ADD");
-      return(IARF_ADD);
-   }
 
-   // TODO: if necessary create a new option
-   if (chunk_is_token(first, CT_SQL_EXEC) && chunk_is_token(second, CT_SQL_WORD))
-   {
-      log_rule("ADD");
-      return(IARF_ADD);
-   }
+static void build_space_rule_table(void)
+{
+   // rules[0] is not used, so that a start of 0 means not filled in
+   space_rules.rules.assign(1, SPACE_RULE_END);
 
-   // TODO: if necessary create a new option
-   if (chunk_is_token(first, CT_SQL_WORD) && chunk_is_token(second, CT_PAREN_OPEN))
-   {
-      log_rule("ADD");
-      return(IARF_ADD);
-   }
+   // do_space() goes through all the rules while they add their keys
+   space_rules.all_rules = space_rules.rules.size();
 
-   // TODO: if necessary create a new option
-   if (chunk_is_token(first, CT_STRUCT) && chunk_is_token(second, CT_TYPE))
+   for (UINT16 rule = 0; rule < SPACE_RULE_COUNT; rule++)
    {
-      log_rule("ADD");
-      return(IARF_ADD);
+      space_rules.rules.push_back(rule);
    }
 
-   // TODO: if necessary create a new option
-   if (chunk_is_token(first, CT_TSQUARE) && chunk_is_token(second, CT_BRACE_OPEN))
-   {
-      log_rule("ADD");
-      return(IARF_ADD);
-   }
+   space_rules.rules.push_back(SPACE_RULE_END);
 
-   // TODO: if necessary create a new option
-   if (chunk_is_token(first, CT_TSQUARE) && chunk_is_token(second, CT_WORD))
-   {
-      log_rule("ADD");
-      return(IARF_ADD);
-   }
+   // Let every rule of do_space() add its keys, in order, without logging it
+   vector<space_rule_key_t> keys;
+   chunk_t                  none;
+   int                      min_sp;
+   bool                     cacheable;
+   const bool               log_space = log_sev_on(LSPACE);
 
-   // TODO: if necessary create a new option
-   if (chunk_is_token(first, CT_TYPEDEF) && chunk_is_token(second, CT_ENUM))
-   {
-      log_rule("ADD");
-      return(IARF_ADD);
-   }
+   log_set_sev(LSPACE, false);
+   space_rule_keys_out = &keys;
+   do_space(&none, &none, min_sp, cacheable);
+   space_rule_keys_out = nullptr;
+   log_set_sev(LSPACE, log_space);
 
-   // TODO: if necessary create a new option
-   if (chunk_is_token(first, CT_TYPEDEF) && chunk_is_token(second, CT_STRUCT))
-   {
-      log_rule("ADD");
-      return(IARF_ADD);
-   }
+   UINT16 listed = 0;                     // the rules up to here are in keys
 
-   // TODO: if necessary create a new option
-   if (chunk_is_token(first, CT_TYPEDEF) && chunk_is_token(second, CT_TYPE))
+   for (const space_rule_key_t &key : keys)
    {
-      log_rule("ADD");
-      return(IARF_ADD);
+      if (key.rule > listed)
+      {
+         break;
+      }
+      listed = key.rule + 1;
    }
 
-   // TODO: if necessary create a new option
-   if (chunk_is_token(first, CT_TYPENAME) && chunk_is_token(second, CT_ELLIPSIS))
+   if (listed != SPACE_RULE_COUNT)
    {
-      log_rule("ADD");
-      return(IARF_ADD);
+      LOG_FMT(LERR, "%s(%d): rule %d of do_space() is not a SPACE_RULE\n",
+              __func__, __LINE__, listed);
+      log_flush(true);
+      exit(EX_SOFTWARE);
    }
+   // Give each type that is checked for its own row or column, the others share the first one
+   size_t rows = 1;
 
-   // TODO: if necessary create a new option
-   if (chunk_is_token(first, CT_USING) && chunk_is_token(second, CT_NAMESPACE))
-   {
-      log_rule("ADD");
-      return(IARF_ADD);
-   }
+   space_rules.columns = 1;
+   fill(begin(space_rules.first_class), end(space_rules.first_class), 0);
+   fill(begin(space_rules.second_class), end(space_rules.second_class), 0);
 
-   // TODO: if necessary create a new option
-   if (chunk_is_token(first, CT_USING) && chunk_is_token(second, CT_WORD))
+   for (const space_rule_key_t &key : keys)
    {
-      log_rule("ADD");
-      return(IARF_ADD);
-   }
+      if (key.first != CT_UNKNOWN && space_rules.first_class[key.first] == 0)
+      {
+         space_rules.first_class[key.first] = rows++;
+      }
 
-   // TODO: if necessary create a new option
-   if (chunk_is_token(first, CT_WORD) && chunk_is_token(second, CT_BRACE_OPEN))
-   {
-      log_rule("ADD");
-      return(IARF_ADD);
+      if (key.second != CT_UNKNOWN && space_rules.second_class[key.second] == 0)
+      {
+         space_rules.second_class[key.second] = space_rules.columns++;
+      }
    }
-   // if (chunk_is_token(first, CT_WORD) && chunk_is_token(second, CT_COND_COLON))
-   // Issue #2596
-   // look at "sp_cond_colon"
 
-   // TODO: if necessary create a new option
-   if (chunk_is_token(first, CT_WORD) && chunk_is_token(second, CT_NUMBER))
-   {
-      log_rule("ADD");
-      return(IARF_ADD);
-   }
+   const size_t columns = space_rules.columns;
 
-   // TODO: if necessary create a new option
-   if (chunk_is_token(first, CT_WORD) && chunk_is_token(second, CT_NUMBER_FP))
+   group_space_rule_keys(keys, rows,
+                         [rows](const space_rule_key_t &key)
    {
-      log_rule("ADD");
-      return(IARF_ADD);
-   }
+      return((key.first == CT_UNKNOWN) ? rows : space_rules.first_class[key.first]);
+   },
+                         space_rules.row_keys, space_rules.row_start);
 
-   // TODO: if necessary create a new option
-   if (chunk_is_token(first, CT_WORD) && chunk_is_token(second, CT_QUESTION))
+   group_space_rule_keys(keys, columns,
+                         [columns](const space_rule_key_t &key)
    {
-      log_rule("ADD");
-      return(IARF_ADD);
-   }
+      return((key.first != CT_UNKNOWN || key.second == CT_UNKNOWN)
+             ? columns : space_rules.second_class[key.second]);
+   },
+                         space_rules.column_keys, space_rules.column_start);
 
-   // Issue #2386
-   if (  chunk_is_token(first, CT_FORM_FEED)
-      || chunk_is_token(second, CT_FORM_FEED))
+   for (const space_rule_key_t &key : keys)
    {
-      log_rule("IGNORE");
-      return(IARF_IGNORE);
+      if (key.first == CT_UNKNOWN && key.second == CT_UNKNOWN)
+      {
+         space_rules.any_keys.push_back(key);
+      }
    }
-   //
-   // these lines are only useful for debugging uncrustify itself
-   LOG_FMT(LSPACE, "\n\n%s(%d): WARNING: unrecognize do_space:\n",
-           __func__, __LINE__);
-   LOG_FMT(LSPACE, "   first->orig_line  is %zu, first->orig_col  is %zu, first->text()  '%s', first->type is  %s\n",
-           first->orig_line, first->orig_col, first->text(), get_token_name(first->type));
-   LOG_FMT(LSPACE, "   second->orig_line is %zu, second->orig_col is %zu, second->text() '%s', second->type is %s\n",
-           second->orig_line, second->orig_col, second->text(), get_token_name(second->type));
 
-   log_rule("ADD as default value");
-   return(IARF_ADD);
-} // do_space
+   space_rules.cells.resize(rows);
+} // build_space_rule_table
 
 
 static iarf_e ensure_force_space(chunk_t *first, chunk_t *second, iarf_e av)
@@ -3427,7 +4820,7 @@ static iarf_e ensure_force_space(chunk_t *first, chunk_t *second, iarf_e av)
 
 static iarf_e do_space_ensured(chunk_t *first, chunk_t *second, int &min_sp)
 {
-   return(ensure_force_space(first, second, do_space(first, second, min_sp)));
+   return(ensure_force_space(first, second, do_space_cached(first, second, min_sp)));
 }
 
 
@@ -21,13 +21,20 @@
 #include "uncrustify.h"
 #include "uncrustify_types.h"
 
+#include <algorithm>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <memory>
 #include <stack>
+#include <vector>
+
+#ifdef HAVE_THREADS
+#include <thread>
+#endif
 
 
-#define LE_COUNT(x)    cpd.le_counts[static_cast<size_t>(LE_ ## x)]
+#define LE_COUNT(x)    ctx.state.le_counts[static_cast<size_t>(LE_ ## x)]
 
 using namespace std;
 using namespace uncrustify;
@@ -50,14 +57,72 @@ struct tok_info
 };
 
 
+//! The part of cpd the tokenizer carries from one token to the next
+struct tok_state
+{
+   tok_state()
+      : in_preproc(CT_NONE)
+      , preproc_ncnl_count(0)
+      , unc_off(false)
+      , unc_off_used(false)
+      , did_newline(0)
+      , le_counts()
+      , warned_tab(false)
+      , error_count(0)
+   {
+   }
+
+   c_token_t in_preproc;
+   int       preproc_ncnl_count;
+   bool      unc_off;
+   bool      unc_off_used;
+   int       did_newline;
+   UINT32    le_counts[uncrustify::line_end_styles];
+   bool      warned_tab;  //! see cp_data_t::warned_unable_string_replace_tab_chars
+   UINT32    error_count; //! errors found, to add to cpd.error_count
+};
+
+
 struct tok_ctx
 {
    tok_ctx(const deque<int> &d)
       : data(d)
+      , end(d.size())
+      , tail(nullptr)
+      , in_worker(false)
+      , failed(false)
    {
    }
 
 
+   //! copy the tokenizer state from cpd
+   void load_state()
+   {
+      state.in_preproc         = cpd.in_preproc;
+      state.preproc_ncnl_count = cpd.preproc_ncnl_count;
+      state.unc_off            = cpd.unc_off;
+      state.unc_off_used       = cpd.unc_off_used;
+      state.did_newline        = cpd.did_newline;
+      memcpy(state.le_counts, cpd.le_counts, sizeof(state.le_counts));
+      state.warned_tab  = cpd.warned_unable_string_replace_tab_chars;
+      state.error_count = 0;
+   }
+
+
+   //! copy the tokenizer state back to cpd
+   void store_state() const
+   {
+      cpd.in_preproc         = state.in_preproc;
+      cpd.preproc_ncnl_count = state.preproc_ncnl_count;
+      cpd.unc_off            = state.unc_off;
+      cpd.unc_off_used       = state.unc_off_used;
+      cpd.did_newline        = state.did_newline;
+      memcpy(cpd.le_counts, state.le_counts, sizeof(cpd.le_counts));
+      cpd.warned_unable_string_replace_tab_chars = state.warned_tab;
+      cpd.error_count                           += state.error_count;
+   }
+
+
    //! save before trying to parse something that may fail
    void save()
    {
@@ -86,7 +151,7 @@ struct tok_ctx
 
    bool more()
    {
-      return(c.idx < data.size());
+      return(c.idx < end);
    }
 
 
@@ -153,8 +218,13 @@ struct tok_ctx
 
 
    const deque<int> &data;
-   tok_info         c; //! current
-   tok_info         s; //! saved
+   size_t           end;       //! index after the last char to tokenize
+   tok_info         c;         //! current
+   tok_info         s;         //! saved
+   tok_state        state;
+   const chunk_t    *tail;     //! the last chunk in the list
+   bool             in_worker; //! tokenizing a segment on a worker thread
+   bool             failed;    //! the segment has to be tokenized serially
 };
 
 
@@ -242,9 +312,33 @@ static bool parse_newline(tok_ctx &ctx);
 static void parse_pawn_pattern(tok_ctx &ctx, chunk_t &pc, c_token_t tt);
 
 
+/**
+ * Parses a region where processing is turned off (see disable_processing_cmt,
+ * '#asm' and '#pragma asm') into a single CT_IGNORED chunk. The chunk holds
+ * no text, only the span of the input, which output_text() copies unchanged.
+ * The span covers the rest of the current line, or, when starting at the
+ * beginning of a line, all the lines up to the one that turns processing
+ * back on. Newlines around the span are returned as CT_NEWLINE.
+ *
+ * @param pc  structure to update
+ *
+ * @return true/false - whether anything was parsed
+ */
 static bool parse_ignored(tok_ctx &ctx, chunk_t &pc);
 
 
+/**
+ * Checks whether the line at the current position turns processing back on,
+ * either through a leading comment holding the enable_processing_cmt text or
+ * through an '#endasm' / '#pragma endasm' directive. Nothing is consumed.
+ */
+static bool ignored_region_ends(tok_ctx &ctx);
+
+
+//! Checks whether the input line starting at idx contains text
+static bool line_has_text(const deque<int> &data, size_t idx, const char *text);
+
+
 /**
  * Skips the next bit of whatever and returns the type of block.
  *
@@ -261,6 +355,53 @@ static bool parse_ignored(tok_ctx &ctx, chunk_t &pc);
 static bool parse_next(tok_ctx &ctx, chunk_t &pc, const chunk_t *prev_pc);
 
 
+/**
+ * Tokenizes the text from ctx.c up to ctx.end.
+ *
+ * @param ref      The chunks are inserted before ref, or appended if it is nullptr
+ * @param segment  Where a worker collects its chunks instead of adding them to the list
+ */
+static void tokenize_chunks(tok_ctx &ctx, chunk_t *ref, vector<chunk_t *> *segment);
+
+
+#ifdef HAVE_THREADS
+//! smallest number of chars worth tokenizing on a thread of its own
+static constexpr size_t MIN_SEGMENT_SIZE = 256 * 1024;
+
+
+/**
+ * Picks where the text can be cut into count segments that tokenize on their
+ * own. A segment starts at a line that does not begin with whitespace, and
+ * that follows a line which ends outside of comments and literals and is
+ * not continued with a backslash. The scan only knows the C family lexing,
+ * a segment that still ends in the middle of something is caught once it is
+ * tokenized.
+ *
+ * @param data    The text
+ * @param count   The number of segments wanted
+ * @param starts  Receives the start of each segment, fewer if there are not
+ *                enough places to cut the text
+ */
+static void find_segments(const deque<int> &data, size_t count, vector<tok_info> &starts);
+
+
+/**
+ * Tokenizes a segment with the logs muted, the chunks stay out of the list.
+ */
+static void tokenize_segment(tok_ctx &ctx, vector<chunk_t *> &chunks);
+
+
+/**
+ * Tokenizes a large text in segments on several threads, and appends the
+ * chunks to the list if every segment ended where the next one started.
+ *
+ * @return false if the text has to be tokenized serially
+ */
+static bool tokenize_parallel(tok_ctx &ctx);
+
+#endif // HAVE_THREADS
+
+
 /**
  * Parses all legal D string constants.
  *
@@ -567,7 +708,7 @@ static bool parse_comment(tok_ctx &ctx, chunk_t &pc)
             pc.str.append(ctx.get());
          }
          pc.nl_count++;
-         cpd.did_newline = true;
+         ctx.state.did_newline = true;
       }
    }
    else if (!ctx.more())
@@ -682,7 +823,7 @@ static bool parse_comment(tok_ctx &ctx, chunk_t &pc)
       }
    }
 
-   if (cpd.unc_off)
+   if (ctx.state.unc_off)
    {
       log_rule_B("enable_processing_cmt");
       const auto &ontext = options::enable_processing_cmt();
@@ -691,7 +832,7 @@ static bool parse_comment(tok_ctx &ctx, chunk_t &pc)
       {
          LOG_FMT(LBCTRL, "%s(%d): Found '%s' on line %zu\n",
                  __func__, __LINE__, ontext.c_str(), pc.orig_line);
-         cpd.unc_off = false;
+         ctx.state.unc_off = false;
       }
    }
    else
@@ -703,9 +844,9 @@ static bool parse_comment(tok_ctx &ctx, chunk_t &pc)
       {
          LOG_FMT(LBCTRL, "%s(%d): Found '%s' on line %zu\n",
                  __func__, __LINE__, offtext.c_str(), pc.orig_line);
-         cpd.unc_off = true;
+         ctx.state.unc_off = true;
          // Issue #842
-         cpd.unc_off_used = true;
+         ctx.state.unc_off_used = true;
       }
    }
    return(true);
@@ -1294,9 +1435,14 @@ static bool parse_cs_string(tok_ctx &ctx, chunk_t &pc)
       {
          if (parseState.top().type & CS_STRING_VERBATIM)
          {
-            if (!cpd.warned_unable_string_replace_tab_chars)
+            if (ctx.in_worker)
+            {
+               // the warning is given once per file
+               ctx.failed = true;
+            }
+            else if (!ctx.state.warned_tab)
             {
-               cpd.warned_unable_string_replace_tab_chars = true;
+               ctx.state.warned_tab = true;
 
                log_rule_B("warn_level_tabs_found_in_verbatim_string_literals");
                log_sev_t warnlevel = (log_sev_t)options::warn_level_tabs_found_in_verbatim_string_literals();
@@ -1312,7 +1458,7 @@ static bool parse_cs_string(tok_ctx &ctx, chunk_t &pc)
 
                if (warnlevel < LWARN)
                {
-                  cpd.error_count++;
+                  ctx.state.error_count++;
                }
             }
          }
@@ -1523,13 +1669,19 @@ static bool parse_word(tok_ctx &ctx, chunk_t &pc, bool skipcheck)
    }
    set_chunk_type(&pc, CT_WORD);
 
+   // intern the word now, so the intern ids follow the order of the tokens
+   if (!ctx.in_worker)
+   {
+      pc.str.intern_id();
+   }
+
    if (skipcheck)
    {
       return(true);
    }
 
    // Detect pre-processor functions now
-   if (cpd.in_preproc == CT_PP_DEFINE && cpd.preproc_ncnl_count == 1)
+   if (ctx.state.in_preproc == CT_PP_DEFINE && ctx.state.preproc_ncnl_count == 1)
    {
       if (ctx.peek() == '(')
       {
@@ -1547,7 +1699,7 @@ static bool parse_word(tok_ctx &ctx, chunk_t &pc, bool skipcheck)
              * We are setting the PP_IGNORE preproc state because the following
              * chunks are part of the macro body and will have to be ignored.
              */
-            cpd.in_preproc = CT_PP_IGNORE;
+            ctx.state.in_preproc = CT_PP_IGNORE;
          }
       }
    }
@@ -1564,16 +1716,16 @@ static bool parse_word(tok_ctx &ctx, chunk_t &pc, bool skipcheck)
       {
          // Turn it into a keyword now
          // Issue #1460 will return "COMMENT_CPP"
-         set_chunk_type(&pc, find_keyword_type(pc.text(), pc.str.size()));
+         set_chunk_type(&pc, find_keyword_type(pc.text(), pc.str.size(), ctx.state.in_preproc));
 
          /* Special pattern: if we're trying to redirect a preprocessor directive to PP_IGNORE,
           * then ensure we're actually part of a preprocessor before doing the swap, or we'll
           * end up with a function named 'define' as PP_IGNORE. This is necessary because with
           * the config 'set' feature, there's no way to do a pair of tokens as a word
           * substitution. */
-         if (pc.type == CT_PP_IGNORE && !cpd.in_preproc)
+         if (pc.type == CT_PP_IGNORE && !ctx.state.in_preproc)
          {
-            set_chunk_type(&pc, find_keyword_type(pc.text(), pc.str.size()));
+            set_chunk_type(&pc, find_keyword_type(pc.text(), pc.str.size(), ctx.state.in_preproc));
          }
          else if (pc.type == CT_COMMENT_CPP)   // Issue #1460
          {
@@ -1624,7 +1776,7 @@ static bool parse_word(tok_ctx &ctx, chunk_t &pc, bool skipcheck)
                   pc.str.append(ctx.get());
                }
                pc.nl_count++;
-               cpd.did_newline = true;
+               ctx.state.did_newline = true;
             }
             // Store off the end column
             pc.orig_col_end = ctx.c.col;
@@ -1915,78 +2067,137 @@ static bool parse_macro(tok_ctx &ctx, chunk_t &pc, const chunk_t *prev_pc)
 }
 
 
-static bool parse_ignored(tok_ctx &ctx, chunk_t &pc)
+static bool line_has_text(const deque<int> &data, size_t idx, const char *text)
 {
-   if (parse_off_newlines(ctx, pc))
-   {
-      return(true);
-   }
-   // See if the UO_enable_processing_cmt or #pragma endasm / #endasm text is on this line
-   ctx.save();
-   pc.str.clear();
+   const size_t t_len = strlen(text);
 
-   while (  ctx.more()
-         && (ctx.peek() != '\r')
-         && (ctx.peek() != '\n'))
+   for ( ; idx < data.size() && data[idx] != '\r' && data[idx] != '\n'; idx++)
    {
-      pc.str.append(ctx.get());
-   }
+      size_t ii = 0;
 
-   if (pc.str.size() == 0)
-   {
-      // end of file?
-      return(false);
+      while (  ii < t_len
+            && idx + ii < data.size()
+            && data[idx + ii] == text[ii])
+      {
+         ii++;
+      }
+
+      if (ii == t_len)
+      {
+         return(true);
+      }
    }
 
+   return(false);
+}
+
+
+static bool ignored_region_ends(tok_ctx &ctx)
+{
+   const deque<int> &data = ctx.data;
+   const size_t     idx   = ctx.c.idx;
+
    // HACK: turn on if we find '#endasm' or '#pragma' and 'endasm' separated by blanks
-   if (  (  ((pc.str.find("#pragma ") >= 0) || (pc.str.find("#pragma	") >= 0))
-         && ((pc.str.find(" endasm") >= 0) || (pc.str.find("	endasm") >= 0)))
-      || (pc.str.find("#endasm") >= 0))
+   if (  (  (line_has_text(data, idx, "#pragma ") || line_has_text(data, idx, "#pragma	"))
+         && (line_has_text(data, idx, " endasm") || line_has_text(data, idx, "\tendasm")))
+      || line_has_text(data, idx, "#endasm"))
    {
-      cpd.unc_off = false;
-      ctx.restore();
-      pc.str.clear();
-      return(false);
+      ctx.state.unc_off = false;
+      return(true);
    }
    // Note that we aren't actually making sure this is in a comment, yet
    log_rule_B("enable_processing_cmt");
    const auto &ontext = options::enable_processing_cmt();
 
-   if (!ontext.empty() && pc.str.find(ontext.c_str()) < 0)
+   if (ontext.empty() || !line_has_text(data, idx, ontext.c_str()))
    {
-      set_chunk_type(&pc, CT_IGNORED);
-      return(true);
+      return(false);
    }
-   ctx.restore();
+   /*
+    * The text must be in a comment that starts the line. Try to parse it,
+    * parse_comment() turns processing on if it holds the text. Then undo
+    * everything, the line is parsed again once the region is done.
+    */
+   tok_info ss;
 
-   // parse off whitespace leading to the comment
-   if (parse_whitespace(ctx, pc))
+   ctx.save(ss);
+
+   while ((ctx.peek() == ' ') || (ctx.peek() == '\t'))
    {
-      set_chunk_type(&pc, CT_IGNORED);
-      return(true);
+      ctx.get();
    }
+   const tok_state st = ctx.state;
+   chunk_t         cmt;
+   const bool      is_end = parse_comment(ctx, cmt) && !ctx.state.unc_off;
 
-   // Look for the ending comment and let it pass
-   if (parse_comment(ctx, pc) && !cpd.unc_off)
+   ctx.state = st;
+   ctx.restore(ss);
+   return(is_end);
+} // ignored_region_ends
+
+
+static bool parse_ignored(tok_ctx &ctx, chunk_t &pc)
+{
+   if (parse_off_newlines(ctx, pc))
    {
       return(true);
    }
-   // Reset the chunk & scan to until a newline
-   pc.str.clear();
 
-   while (  ctx.more()
-         && (ctx.peek() != '\r')
-         && (ctx.peek() != '\n'))
+   if (!ctx.more() || ignored_region_ends(ctx))
    {
-      pc.str.append(ctx.get());
+      return(false);
    }
+   const bool line_start = (ctx.c.col == 1);
+   tok_info   end_info;                           // end of the last line with text
+
+   pc.span.data = &ctx.data;
+   pc.span.idx  = ctx.c.idx;
+   ctx.save(end_info);
 
-   if (pc.str.size() > 0)
+   while (ctx.more())
    {
-      set_chunk_type(&pc, CT_IGNORED);
-      return(true);
+      bool is_blank = true;               // only blanks, which parse_newline() eats
+
+      while (  ctx.more()
+            && (ctx.peek() != '\r')
+            && (ctx.peek() != '\n'))
+      {
+         const int ch = ctx.get();
+
+         is_blank = is_blank && (ch == ' ' || ch == '\t');
+      }
+
+      // the first line is always taken, later ones only if they hold text
+      if (!is_blank || end_info.idx == pc.span.idx)
+      {
+         ctx.save(end_info);
+      }
+
+      if (!line_start)
+      {
+         break;
+      }
+
+      // step onto the next line
+      if (!ctx.expect('\n'))
+      {
+         ctx.get();
+         ctx.expect('\n');
+      }
+
+      if (ctx.more() && ignored_region_ends(ctx))
+      {
+         break;
+      }
    }
-   return(false);
+   // leave trailing newlines and blank lines to parse_off_newlines()
+   ctx.restore(end_info);
+
+   pc.span.len = ctx.c.idx - pc.span.idx;
+   pc.nl_count = ctx.c.row - pc.orig_line;
+   pc.str.clear();
+   set_chunk_type(&pc, CT_IGNORED);
+   return(true);
 } // parse_ignored
 
 
@@ -2005,7 +2216,7 @@ static bool parse_next(tok_ctx &ctx, chunk_t &pc, const chunk_t *prev_pc)
    pc.flags     = PCF_NONE;
 
    // If it is turned off, we put everything except newlines into CT_UNKNOWN
-   if (cpd.unc_off)
+   if (ctx.state.unc_off)
    {
       if (parse_ignored(ctx, pc))
       {
@@ -2029,7 +2240,7 @@ static bool parse_next(tok_ctx &ctx, chunk_t &pc, const chunk_t *prev_pc)
    }
 
    // Handle unknown/unhandled preprocessors
-   if (cpd.in_preproc > CT_PP_BODYCHUNK && cpd.in_preproc <= CT_PP_OTHER)
+   if (ctx.state.in_preproc > CT_PP_BODYCHUNK && ctx.state.in_preproc <= CT_PP_OTHER)
    {
       pc.str.clear();
       tok_info ss;
@@ -2171,8 +2382,8 @@ static bool parse_next(tok_ctx &ctx, chunk_t &pc, const chunk_t *prev_pc)
    // PAWN specific stuff
    if (language_is_set(LANG_PAWN))
    {
-      if (  cpd.preproc_ncnl_count == 1
-         && (cpd.in_preproc == CT_PP_DEFINE || cpd.in_preproc == CT_PP_EMIT))
+      if (  ctx.state.preproc_ncnl_count == 1
+         && (ctx.state.in_preproc == CT_PP_DEFINE || ctx.state.in_preproc == CT_PP_EMIT))
       {
          parse_pawn_pattern(ctx, pc, CT_MACRO);
          return(true);
@@ -2196,7 +2407,7 @@ static bool parse_next(tok_ctx &ctx, chunk_t &pc, const chunk_t *prev_pc)
       }
 
       // handle PAWN preprocessor args %0 .. %9
-      if (  cpd.in_preproc == CT_PP_DEFINE
+      if (  ctx.state.in_preproc == CT_PP_DEFINE
          && (ctx.peek() == '%')
          && unc_isdigit(ctx.peek(1)))
       {
@@ -2236,16 +2447,16 @@ static bool parse_next(tok_ctx &ctx, chunk_t &pc, const chunk_t *prev_pc)
             && ((ch1 == '"') || (ch1 == '\'')))
          || (ch == '"')
          || (ch == '\'')
-         || ((ch == '<') && cpd.in_preproc == CT_PP_INCLUDE))
+         || ((ch == '<') && ctx.state.in_preproc == CT_PP_INCLUDE))
       {
          parse_string(ctx, pc, unc_isalpha(ch) ? 1 : 0, true);
          set_chunk_parent(&pc, CT_PP_INCLUDE);
          return(true);
       }
 
-      if ((ch == '<') && cpd.in_preproc == CT_PP_DEFINE)
+      if ((ch == '<') && ctx.state.in_preproc == CT_PP_DEFINE)
       {
-         if (chunk_is_token(chunk_get_tail(), CT_MACRO))
+         if (chunk_is_token(ctx.tail, CT_MACRO))
          {
             // We have "#define XXX <", assume '<' starts an include string
             parse_string(ctx, pc, 0, false);
@@ -2255,9 +2466,9 @@ static bool parse_next(tok_ctx &ctx, chunk_t &pc, const chunk_t *prev_pc)
 
       /* Inside clang's __has_include() could be "path/to/file.h" or system-style <path/to/file.h> */
       if (  (ch == '(')
-         && (chunk_get_tail() != nullptr)
-         && (  chunk_is_token(chunk_get_tail(), CT_CNG_HASINC)
-            || chunk_is_token(chunk_get_tail(), CT_CNG_HASINCN)))
+         && (ctx.tail != nullptr)
+         && (  chunk_is_token(ctx.tail, CT_CNG_HASINC)
+            || chunk_is_token(ctx.tail, CT_CNG_HASINCN)))
       {
          parse_string(ctx, pc, 0, false);
          return(true);
@@ -2355,7 +2566,15 @@ static bool parse_next(tok_ctx &ctx, chunk_t &pc, const chunk_t *prev_pc)
    {
       if ((punc = find_punctuator(punc_txt, probe_lang_flags)) != NULL)
       {
-         cpd.lang_flags = probe_lang_flags;
+         if (ctx.in_worker)
+         {
+            // the language of the whole file changes
+            ctx.failed = true;
+         }
+         else
+         {
+            cpd.lang_flags = probe_lang_flags;
+         }
          int cnt = strlen(punc->tag);
 
          while (cnt--)
@@ -2373,99 +2592,105 @@ static bool parse_next(tok_ctx &ctx, chunk_t &pc, const chunk_t *prev_pc)
 
    LOG_FMT(LWARN, "%s:%zu Garbage in col %d: %x\n",
            cpd.filename.c_str(), pc.orig_line, (int)ctx.c.col, pc.str[0]);
-   cpd.error_count++;
+   ctx.state.error_count++;
    return(true);
 } // parse_next
 
 
-void tokenize(const deque<int> &data, chunk_t *ref)
+static void tokenize_chunks(tok_ctx &ctx, chunk_t *ref, vector<chunk_t *> *segment)
 {
-   tok_ctx ctx(data);
-   chunk_t chunk;
+   chunk_t *chunk       = nullptr;
    chunk_t *pc          = nullptr;
    chunk_t *rprev       = nullptr;
    bool    last_was_tab = false;
    size_t  prev_sp      = 0;
    int     num_stripped = 0;                    // Issue #1966
 
-   cpd.unc_stage = unc_stage_e::TOKENIZE;
-
    while (ctx.more())
    {
-      chunk.reset();
+      if (chunk == nullptr)
+      {
+         // build the chunk directly in the storage it will keep in the list
+         chunk = new chunk_t;
+      }
+      else
+      {
+         // recycle the chunk of a discarded whitespace token, it holds no text
+         chunk->reset();
+      }
 
-      if (!parse_next(ctx, chunk, pc))
+      if (!parse_next(ctx, *chunk, pc))
       {
          LOG_FMT(LERR, "%s:%zu Bailed before the end?\n",
                  cpd.filename.c_str(), ctx.c.row);
-         cpd.error_count++;
+         ctx.state.error_count++;
          break;
       }
 
       if (  language_is_set(LANG_JAVA)
-         && chunk.type == CT_MEMBER
-         && !memcmp(chunk.text(), "->", 2))
+         && chunk->type == CT_MEMBER
+         && !memcmp(chunk->text(), "->", 2))
       {
-         chunk.type = CT_LAMBDA;
+         chunk->type = CT_LAMBDA;
       }
 
       // Don't create an entry for whitespace
-      if (chunk.type == CT_WHITESPACE)
+      if (chunk->type == CT_WHITESPACE)
       {
-         last_was_tab = chunk.after_tab;
-         prev_sp      = chunk.orig_prev_sp;
+         last_was_tab = chunk->after_tab;
+         prev_sp      = chunk->orig_prev_sp;
          continue;
       }
-      chunk.orig_prev_sp = prev_sp;
-      prev_sp            = 0;
+      chunk->orig_prev_sp = prev_sp;
+      prev_sp             = 0;
 
-      if (chunk.type == CT_NEWLINE)
+      if (chunk->type == CT_NEWLINE)
       {
-         last_was_tab    = chunk.after_tab;
-         chunk.after_tab = false;
-         chunk.str.clear();
+         last_was_tab     = chunk->after_tab;
+         chunk->after_tab = false;
+         chunk->str.clear();
       }
-      else if (chunk.type == CT_NL_CONT)
+      else if (chunk->type == CT_NL_CONT)
       {
-         last_was_tab    = chunk.after_tab;
-         chunk.after_tab = false;
-         chunk.str       = "\\\n";
+         last_was_tab     = chunk->after_tab;
+         chunk->after_tab = false;
+         chunk->str       = "\\\n";
       }
       else
       {
-         chunk.after_tab = last_was_tab;
-         last_was_tab    = false;
+         chunk->after_tab = last_was_tab;
+         last_was_tab     = false;
       }
 
-      if (chunk.type != CT_IGNORED)
+      if (chunk->type != CT_IGNORED)
       {
          // Issue #1338
          // Strip trailing whitespace (for CPP comments and PP blocks)
          num_stripped = 0;                     // Issue #1966
 
-         while (  (chunk.str.size() > 0)
-               && (  (chunk.str[chunk.str.size() - 1] == ' ')
-                  || (chunk.str[chunk.str.size() - 1] == '\t')))
+         while (  (chunk->str.size() > 0)
+               && (  (chunk->str[chunk->str.size() - 1] == ' ')
+                  || (chunk->str[chunk->str.size() - 1] == '\t')))
          {
             // If comment contains backslash '\' followed by whitespace chars, keep last one;
             // this will prevent it from turning '\' into line continuation.
-            if ((chunk.str.size() > 1) && (chunk.str[chunk.str.size() - 2] == '\\'))
+            if ((chunk->str.size() > 1) && (chunk->str[chunk->str.size() - 2] == '\\'))
             {
                break;
             }
-            chunk.str.pop_back();
+            chunk->str.pop_back();
             num_stripped++;                    // Issue #1966
          }
       }
       // Store off the end column
-      chunk.orig_col_end = ctx.c.col;
+      chunk->orig_col_end = ctx.c.col;
 
-      if (  (  chunk.type == CT_COMMENT_MULTI                  // Issue #1966
-            || chunk.type == CT_COMMENT
-            || chunk.type == CT_COMMENT_CPP)
+      if (  (  chunk->type == CT_COMMENT_MULTI                  // Issue #1966
+            || chunk->type == CT_COMMENT
+            || chunk->type == CT_COMMENT_CPP)
          && (pc != nullptr) && chunk_is_token(pc, CT_PP_IGNORE))
       {
-         chunk.orig_col_end -= num_stripped;
+         chunk->orig_col_end -= num_stripped;
       }
       // Add the chunk to the list
       rprev = pc;
@@ -2483,59 +2708,74 @@ void tokenize(const deque<int> &data, chunk_t *ref)
 
       if (ref != nullptr)
       {
-         chunk.flags |= PCF_INSERTED;
+         chunk->flags |= PCF_INSERTED;
+      }
+      else
+      {
+         chunk->flags &= ~PCF_INSERTED;
+      }
+
+      if (segment != nullptr)
+      {
+         segment->push_back(chunk);
+         pc = chunk;
       }
       else
       {
-         chunk.flags &= ~PCF_INSERTED;
+         pc = chunk_link_before(chunk, ref);
+      }
+      chunk = nullptr;
+
+      if (ref == nullptr)
+      {
+         ctx.tail = pc;
       }
-      pc = chunk_add_before(&chunk, ref);
 
       // A newline marks the end of a preprocessor
       if (chunk_is_token(pc, CT_NEWLINE)) // || chunk_is_token(pc, CT_COMMENT_MULTI))
       {
-         cpd.in_preproc         = CT_NONE;
-         cpd.preproc_ncnl_count = 0;
+         ctx.state.in_preproc         = CT_NONE;
+         ctx.state.preproc_ncnl_count = 0;
       }
 
       // Disable indentation when #asm directive found
       if (chunk_is_token(pc, CT_PP_ASM))
       {
          LOG_FMT(LBCTRL, "Found a directive %s on line %zu\n", "#asm", pc->orig_line);
-         cpd.unc_off = true;
+         ctx.state.unc_off = true;
       }
 
       // Special handling for preprocessor stuff
-      if (cpd.in_preproc != CT_NONE)
+      if (ctx.state.in_preproc != CT_NONE)
       {
          chunk_flags_set(pc, PCF_IN_PREPROC);
 
          // Count words after the preprocessor
          if (!chunk_is_comment(pc) && !chunk_is_newline(pc))
          {
-            cpd.preproc_ncnl_count++;
+            ctx.state.preproc_ncnl_count++;
          }
 
          // Disable indentation if a #pragma asm directive is found
-         if (cpd.in_preproc == CT_PP_PRAGMA)
+         if (ctx.state.in_preproc == CT_PP_PRAGMA)
          {
             if (memcmp(pc->text(), "asm", 3) == 0)
             {
                LOG_FMT(LBCTRL, "Found a pragma %s on line %zu\n", "asm", pc->orig_line);
-               cpd.unc_off = true;
+               ctx.state.unc_off = true;
             }
          }
 
          // Figure out the type of preprocessor for #include parsing
-         if (cpd.in_preproc == CT_PREPROC)
+         if (ctx.state.in_preproc == CT_PREPROC)
          {
             if (pc->type < CT_PP_DEFINE || pc->type > CT_PP_OTHER)
             {
                set_chunk_type(pc, CT_PP_OTHER);
             }
-            cpd.in_preproc = pc->type;
+            ctx.state.in_preproc = pc->type;
          }
-         else if (cpd.in_preproc == CT_PP_IGNORE)
+         else if (ctx.state.in_preproc == CT_PP_IGNORE)
          {
             // ASSERT(options::pp_ignore_define_body());
             if (  !chunk_is_token(pc, CT_NL_CONT)
@@ -2546,14 +2786,14 @@ void tokenize(const deque<int> &data, chunk_t *ref)
                set_chunk_type(pc, CT_PP_IGNORE);
             }
          }
-         else if (  cpd.in_preproc == CT_PP_DEFINE
+         else if (  ctx.state.in_preproc == CT_PP_DEFINE
                  && chunk_is_token(pc, CT_PAREN_CLOSE)
                  && options::pp_ignore_define_body())
          {
             log_rule_B("pp_ignore_define_body");
             // When we have a PAREN_CLOSE in a PP_DEFINE we should be terminating a MACRO_FUNC
             // arguments list. Therefore we can enter the PP_IGNORE state and ignore next chunks.
-            cpd.in_preproc = CT_PP_IGNORE;
+            ctx.state.in_preproc = CT_PP_IGNORE;
          }
       }
       else
@@ -2564,7 +2804,7 @@ void tokenize(const deque<int> &data, chunk_t *ref)
          {
             set_chunk_type(pc, CT_PREPROC);
             chunk_flags_set(pc, PCF_IN_PREPROC);
-            cpd.in_preproc = CT_PREPROC;
+            ctx.state.in_preproc = CT_PREPROC;
          }
       }
 
@@ -2584,9 +2824,322 @@ void tokenize(const deque<int> &data, chunk_t *ref)
                  __func__, __LINE__, pc->orig_line, pc->orig_col, pc->text(), get_token_name(pc->type), pc->orig_col_end);
       }
    }
-   // Set the cpd.newline string for this file
-   log_rule_B("newlines");
+   // drop the chunk left over by trailing whitespace or a parse failure
+   delete chunk;
+} // tokenize_chunks
+
+
+#ifdef HAVE_THREADS
+
+
+static void find_segments(const deque<int> &data, size_t count, vector<tok_info> &starts)
+{
+   const size_t size   = data.size();
+   size_t       target = size / count;
+   size_t       row    = 1;
+   size_t       last   = 0;     // char before idx
+   bool         cont   = false; // the line is continued with a backslash
+
+   enum lex_e
+   {
+      CODE,
+      LINE_CMT,
+      BLOCK_CMT,
+      QUOTED,
+      RAW_STR,
+   };
+   lex_e  where     = CODE;
+   size_t quote     = 0;        // the char that closes a QUOTED literal
+   size_t delim_idx = 0;        // index of the delimiter of a raw string
+   size_t delim_len = 0;
+
+   starts.clear();
+   starts.push_back(tok_info());
+
+   for (size_t idx = 0; idx < size; idx++)
+   {
+      const size_t ch    = data[idx];
+      const bool   at_nl = (last == '\n') || (last == '\r' && ch != '\n');
+
+      if (at_nl)
+      {
+         // a newline ends comments and unterminated literals unless it is escaped
+         if (!cont && (where == LINE_CMT || where == QUOTED))
+         {
+            where = CODE;
+         }
+
+         if (  !cont
+            && where == CODE
+            && idx >= target
+            && !unc_isspace(ch))
+         {
+            tok_info start;
+
+            start.last_ch = last;
+            start.idx     = idx;
+            start.row     = row;
+            starts.push_back(start);
 
+            if (starts.size() == count)
+            {
+               break;
+            }
+            target = idx + (size - idx) / (count - starts.size() + 1);
+         }
+         cont = false;
+      }
+
+      if (ch == '\n')
+      {
+         if (last != '\r')
+         {
+            row++;
+         }
+      }
+      else if (ch == '\r')
+      {
+         row++;
+      }
+      else if (ch == '\\')
+      {
+         cont = true;
+      }
+      else if (!unc_isspace(ch))
+      {
+         cont = false;
+      }
+
+      switch (where)
+      {
+      case CODE:
+
+         if (ch == '/' && idx + 1 < size && data[idx + 1] == '/')
+         {
+            where = LINE_CMT;
+         }
+         else if (ch == '/' && idx + 1 < size && data[idx + 1] == '*')
+         {
+            // skip the '*', it does not close the comment
+            where = BLOCK_CMT;
+            idx++;
+            last = 0;
+            continue;
+         }
+         else if (ch == '"' && last == 'R')
+         {
+            // R"delim( ... )delim"
+            delim_idx = idx + 1;
+            delim_len = 0;
+
+            while (  delim_idx + delim_len < size
+                  && delim_len <= 16
+                  && data[delim_idx + delim_len] != '(')
+            {
+               delim_len++;
+            }
+            where = (  delim_idx + delim_len < size
+                    && data[delim_idx + delim_len] == '(') ? RAW_STR : QUOTED;
+            quote = ch;
+         }
+         else if (ch == '"' || ch == '\'')
+         {
+            where = QUOTED;
+            quote = ch;
+         }
+         break;
+
+      case BLOCK_CMT:
+
+         if (ch == '/' && last == '*')
+         {
+            where = CODE;
+            last  = 0;
+            continue;
+         }
+         break;
+
+      case QUOTED:
+
+         if (ch == '\\' && idx + 1 < size && data[idx + 1] != '\n' && data[idx + 1] != '\r')
+         {
+            // skip the escaped char
+            last = data[++idx];
+            continue;
+         }
+
+         if (ch == quote)
+         {
+            where = CODE;
+         }
+         break;
+
+      case RAW_STR:
+
+         if (  ch == '"'
+            && idx > delim_idx + delim_len + 1
+            && data[idx - delim_len - 1] == ')'
+            && equal(data.begin() + (idx - delim_len), data.begin() + idx,
+                     data.begin() + delim_idx))
+         {
+            where = CODE;
+         }
+         break;
+
+      default:
+         break;
+      } // switch
+      last = ch;
+   }
+} // find_segments
+
+
+static void tokenize_segment(tok_ctx &ctx, vector<chunk_t *> &chunks)
+{
+   log_mute(true);
+   tokenize_chunks(ctx, nullptr, &chunks);
+
+   if (log_muted_count() != 0)
+   {
+      // a log must not be lost or printed out of order
+      ctx.failed = true;
+   }
+   log_mute(false);
+}
+
+
+static bool tokenize_parallel(tok_ctx &ctx)
+{
+   size_t count = cpd.threads;
+
+   if (count == 0)
+   {
+      count = thread::hardware_concurrency();
+   }
+   count = min(count, ctx.data.size() / MIN_SEGMENT_SIZE);
+
+   if (count < 2)
+   {
+      return(false);
+   }
+   vector<tok_info> starts;
+
+   find_segments(ctx.data, count, starts);
+   count = starts.size();
+
+   if (count < 2)
+   {
+      return(false);
+   }
+   vector<tok_ctx>            segs(count, ctx);
+   vector<vector<chunk_t *> > chunks(count);
+   vector<thread>             workers;
+
+   for (size_t idx = 0; idx < count; idx++)
+   {
+      tok_ctx &seg = segs[idx];
+
+      seg.c         = starts[idx];
+      seg.end       = (idx + 1 < count) ? starts[idx + 1].idx : ctx.data.size();
+      seg.in_worker = true;
+
+      if (idx == 0)
+      {
+         seg.tail = chunk_get_tail();
+      }
+      else
+      {
+         seg.state = tok_state();
+      }
+   }
+
+   for (size_t idx = 1; idx < count; idx++)
+   {
+      workers.emplace_back(tokenize_segment, std::ref(segs[idx]), std::ref(chunks[idx]));
+   }
+
+   tokenize_segment(segs[0], chunks[0]);
+
+   for (auto &worker : workers)
+   {
+      worker.join();
+   }
+
+   /*
+    * Each segment but the last has to end with a newline where the next one
+    * starts, in the state the next one assumed at its start: outside of a
+    * preprocessor directive and with processing enabled.
+    */
+   bool ok = true;
+
+   for (size_t idx = 0; ok && idx < count; idx++)
+   {
+      const tok_ctx &seg = segs[idx];
+
+      ok = !seg.failed;
+
+      if (ok && idx + 1 < count)
+      {
+         ok = (  seg.c.idx == seg.end
+              && seg.c.row == starts[idx + 1].row
+              && seg.c.col == 1
+              && !chunks[idx].empty()
+              && chunks[idx].back()->type == CT_NEWLINE
+              && seg.state.in_preproc == CT_NONE
+              && seg.state.preproc_ncnl_count == 0
+              && !seg.state.unc_off);
+      }
+   }
+
+   if (!ok)
+   {
+      for (auto &seg : chunks)
+      {
+         for (chunk_t *pc : seg)
+         {
+            delete pc;
+         }
+      }
+
+      return(false);
+   }
+   tok_state &state = ctx.state;
+
+   state = segs[0].state;
+
+   for (size_t idx = 1; idx < count; idx++)
+   {
+      const tok_state &seg = segs[idx].state;
+
+      for (size_t le = 0; le < uncrustify::line_end_styles; le++)
+      {
+         state.le_counts[le] += seg.le_counts[le];
+      }
+
+      state.in_preproc         = seg.in_preproc;
+      state.preproc_ncnl_count = seg.preproc_ncnl_count;
+      state.unc_off            = seg.unc_off;
+      state.unc_off_used       = state.unc_off_used || seg.unc_off_used;
+      state.did_newline        = state.did_newline || seg.did_newline;
+      state.error_count       += seg.error_count;
+   }
+
+   for (auto &seg : chunks)
+   {
+      for (chunk_t *pc : seg)
+      {
+         chunk_link_before(pc, nullptr);
+      }
+   }
+
+   return(true);
+} // tokenize_parallel
+#endif // HAVE_THREADS
+
+
+//! Sets the cpd.newline string for this file from the line ends counted so far
+static void set_newline(const tok_ctx &ctx)
+{
    if (  options::newlines() == LE_LF
       || (  options::newlines() == LE_AUTO
          && (LE_COUNT(LF) >= LE_COUNT(CRLF))
@@ -2611,4 +3164,129 @@ void tokenize(const deque<int> &data, chunk_t *ref)
       cpd.newline = "\r";
       LOG_FMT(LLINEENDS, "Using CR line endings\n");
    }
+} // set_newline
+
+
+void tokenize(const deque<int> &data, chunk_t *ref)
+{
+   tok_ctx ctx(data);
+   bool    done = false;
+
+   cpd.unc_stage = unc_stage_e::TOKENIZE;
+   ctx.load_state();
+
+#ifdef HAVE_THREADS
+   if (ref == nullptr)
+   {
+      done = tokenize_parallel(ctx);
+   }
+#endif
+
+   if (!done)
+   {
+      ctx.tail = chunk_get_tail();
+      tokenize_chunks(ctx, ref, nullptr);
+   }
+   ctx.store_state();
+
+   // Set the cpd.newline string for this file
+   log_rule_B("newlines");
+   set_newline(ctx);
 } // tokenize
+
+
+//! Checks if the tokenizer starts from the same state, the line ends and errors aside
+static bool same_start(const tok_state &a, const tok_state &b)
+{
+   return(  a.in_preproc == b.in_preproc
+         && a.preproc_ncnl_count == b.preproc_ncnl_count
+         && a.unc_off == b.unc_off
+         && a.unc_off_used == b.unc_off_used
+         && a.did_newline == b.did_newline
+         && a.warned_tab == b.warned_tab);
+}
+
+
+void tokenize_cached(const deque<int> &data, chunk_t *ref, tokenized_text_t &text)
+{
+   if (ref == nullptr)
+   {
+      tokenize(data, ref);
+      return;
+   }
+   tok_ctx ctx(data);
+
+   ctx.load_state();
+   chunk_t         *tail     = chunk_get_tail();
+   const c_token_t tail_type = (tail != nullptr) ? tail->type : CT_NONE;
+
+   if (  text.before != nullptr
+      && text.lang_flags == cpd.lang_flags
+      && text.tail_type == tail_type
+      && same_start(*text.before, ctx.state))
+   {
+      // the tokenizer would do the same again
+      cpd.unc_stage = unc_stage_e::TOKENIZE;
+
+      for (const chunk_t &pc : text.chunks)
+      {
+         chunk_add_before(&pc, ref);
+      }
+
+      const tok_state &after = *text.after;
+
+      ctx.state.in_preproc         = after.in_preproc;
+      ctx.state.preproc_ncnl_count = after.preproc_ncnl_count;
+      ctx.state.unc_off            = after.unc_off;
+      ctx.state.unc_off_used       = after.unc_off_used;
+      ctx.state.did_newline        = after.did_newline;
+      ctx.state.warned_tab         = after.warned_tab;
+      ctx.state.error_count        = after.error_count;
+
+      for (size_t le = 0; le < uncrustify::line_end_styles; le++)
+      {
+         ctx.state.le_counts[le] += after.le_counts[le];
+      }
+
+      ctx.store_state();
+      log_rule_B("newlines");
+      set_newline(ctx);
+      return;
+   }
+   const size_t lang_flags  = cpd.lang_flags;
+   const UINT32 error_count = cpd.error_count;
+   chunk_t      *prev       = chunk_get_prev(ref);
+
+   tokenize(data, ref);
+
+   text.before.reset();
+   text.chunks.clear();
+
+   if (cpd.lang_flags != lang_flags)
+   {
+      // the text changed the language, it would not do that again
+      return;
+   }
+   text.lang_flags = lang_flags;
+   text.tail_type  = tail_type;
+   text.before     = std::make_shared<tok_state>(ctx.state);
+   text.after      = std::make_shared<tok_state>();
+   tok_ctx done(data);
+
+   done.load_state();
+   *text.after = done.state;
+
+   for (size_t le = 0; le < uncrustify::line_end_styles; le++)
+   {
+      text.after->le_counts[le] -= ctx.state.le_counts[le];
+   }
+
+   text.after->error_count = cpd.error_count - error_count;
+
+   for (chunk_t *pc = (prev != nullptr) ? chunk_get_next(prev) : chunk_get_head();
+        pc != ref;
+        pc = chunk_get_next(pc))
+   {
+      text.chunks.push_back(*pc);
+   }
+} // tokenize_cached
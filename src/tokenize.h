@@ -11,6 +11,9 @@
 
 #include "uncrustify_types.h"
 
+#include <memory>
+#include <vector>
+
 
 /**
  * @brief Parse the text into chunks
@@ -28,4 +31,27 @@
 void tokenize(const std::deque<int> &data, chunk_t *ref);
 
 
+struct tok_state;
+
+
+//! The chunks a text was tokenized into, to insert copies of them again
+struct tokenized_text_t
+{
+   size_t                     lang_flags = 0;       //! the language it was tokenized for
+   c_token_t                  tail_type  = CT_NONE; //! the type of the last chunk then
+   std::shared_ptr<tok_state> before;               //! the tokenizer state it started from, nullptr if none
+   std::shared_ptr<tok_state> after;                //! the state it left, with the line ends and errors it added
+   std::vector<chunk_t>       chunks;
+};
+
+
+/**
+ * Like tokenize() with a ref, for a text that is inserted at many places.
+ * The first time, or when the tokenizer would start from another state, the
+ * text is tokenized and its chunks are remembered in text. Later on copies of
+ * them are inserted, with the same changes to the tokenizer state.
+ */
+void tokenize_cached(const std::deque<int> &data, chunk_t *ref, tokenized_text_t &text);
+
+
 #endif /* TOKENIZE_H_INCLUDED */
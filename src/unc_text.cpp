@@ -8,11 +8,13 @@
 
 #include "unc_text.h"
 
+#include "interner.h"
 #include "unc_ctype.h"
 #include "unicode.h" // encode_utf8()
 
 #include <algorithm>
 #include <stdexcept>
+#include <utility>
 
 
 using namespace std;
@@ -134,6 +136,15 @@ unc_text::unc_text(const unc_text &ref)
 }
 
 
+unc_text::unc_text(unc_text &&ref)
+   : m_chars(std::move(ref.m_chars))
+   , m_logtext(std::move(ref.m_logtext))
+   , m_intern_id(ref.m_intern_id)
+{
+   ref.clear();
+}
+
+
 unc_text::unc_text(const unc_text &ref, size_t idx, size_t len)
 {
    set(ref, idx, len);
@@ -178,6 +189,19 @@ unc_text &unc_text::operator=(const unc_text &ref)
 }
 
 
+unc_text &unc_text::operator=(unc_text &&ref)
+{
+   if (this != &ref)
+   {
+      m_chars     = std::move(ref.m_chars);
+      m_logtext   = std::move(ref.m_logtext);
+      m_intern_id = ref.m_intern_id;
+      ref.clear();
+   }
+   return(*this);
+}
+
+
 unc_text &unc_text::operator=(const std::string &ascii_text)
 {
    set(ascii_text);
@@ -274,6 +298,8 @@ void unc_text::pop_front()
 
 void unc_text::update_logtext()
 {
+   m_intern_id = 0;
+
    // make a pessimistic guess at the size
    m_logtext.clear();
    m_logtext.reserve(m_chars.size() * 3);
@@ -343,6 +369,14 @@ bool unc_text::equals(const unc_text &ref) const
       return(false);
    }
 
+   // texts with different intern ids differ, no need to look at the chars
+   if (  m_intern_id != ref.m_intern_id
+      && is_current_intern_id(m_intern_id)
+      && is_current_intern_id(ref.m_intern_id))
+   {
+      return(false);
+   }
+
    for (size_t idx = 0; idx < len; idx++)
    {
       if (m_chars[idx] != ref.m_chars[idx])
@@ -355,6 +389,23 @@ bool unc_text::equals(const unc_text &ref) const
 }
 
 
+size_t unc_text::intern_id() const
+{
+   if (!is_current_intern_id(m_intern_id))
+   {
+      m_intern_id = intern_text(reinterpret_cast<const char *>(m_logtext.data()),
+                                m_logtext.size() - 1);
+   }
+   return(m_intern_id);
+}
+
+
+size_t unc_text::known_intern_id() const
+{
+   return(is_current_intern_id(m_intern_id) ? m_intern_id : 0);
+}
+
+
 const char *unc_text::c_str() const
 {
    return(reinterpret_cast<const char *>(&m_logtext[0]));
@@ -375,8 +426,9 @@ void unc_text::set(int ch)
 
 void unc_text::set(const unc_text &ref)
 {
-   m_chars   = ref.m_chars;
-   m_logtext = ref.m_logtext;
+   m_chars     = ref.m_chars;
+   m_logtext   = ref.m_logtext;
+   m_intern_id = ref.m_intern_id;
 }
 
 
@@ -462,6 +514,7 @@ void unc_text::resize(size_t new_size)
 
    m_logtext.resize(log_new_size + 1); // one extra for \0
    m_logtext[log_new_size] = '\0';
+   m_intern_id             = 0;
 
 
    m_chars.resize(new_size);
@@ -472,6 +525,7 @@ void unc_text::clear()
 {
    m_logtext.clear();
    m_logtext.push_back('\0');
+   m_intern_id = 0;
 
 
    m_chars.clear();
@@ -496,6 +550,7 @@ void unc_text::insert(size_t idx, int ch)
    m_logtext.insert(std::next(std::begin(m_logtext), utf8_idx),
                     std::begin(utf8converted), std::end(utf8converted));
    m_logtext.push_back('\0');
+   m_intern_id = 0;
 
 
    m_chars.insert(std::next(std::begin(m_chars), idx), ch);
@@ -522,6 +577,7 @@ void unc_text::insert(size_t idx, const unc_text &ref)
                     std::begin(ref.m_logtext),
                     std::prev(std::end(ref.m_logtext))); // B
    m_logtext.push_back('\0');
+   m_intern_id = 0;
 
 
    m_chars.insert(std::next(std::begin(m_chars), idx),
@@ -547,6 +603,7 @@ void unc_text::append(int ch)
                        std::begin(utf8converted), std::end(utf8converted));
    }
    m_logtext.push_back('\0');
+   m_intern_id = 0;
 
 
    m_chars.push_back(ch);
@@ -562,6 +619,7 @@ void unc_text::append(const unc_text &ref)
    m_logtext.pop_back();
    m_logtext.insert(std::end(m_logtext),
                     std::begin(ref.m_logtext), std::end(ref.m_logtext));
+   m_intern_id = 0;
 
    m_chars.insert(m_chars.end(), ref.m_chars.begin(), ref.m_chars.end());
 }
@@ -719,6 +777,7 @@ void unc_text::erase(size_t start_idx, size_t len)
    m_logtext.erase(std::next(std::begin(m_logtext), pos_s),
                    std::next(std::begin(m_logtext), pos_e + 1));
    m_logtext.push_back('\0');
+   m_intern_id = 0;
 
 
    m_chars.erase(std::next(std::begin(m_chars), start_idx),
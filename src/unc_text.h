@@ -34,6 +34,9 @@ public:
 
    unc_text(const unc_text &ref);
 
+   //! takes over the text of ref without copying, ref is left empty
+   unc_text(unc_text &&ref);
+
    unc_text(const unc_text &ref, size_t idx, size_t len = 0);
 
    unc_text(const char *ascii_text);
@@ -73,6 +76,8 @@ public:
 
    unc_text &operator=(const unc_text &ref);
 
+   unc_text &operator=(unc_text &&ref);
+
    unc_text &operator=(const std::string &ascii_text);
 
    unc_text &operator=(const char *ascii_text);
@@ -138,6 +143,17 @@ public:
    bool equals(const unc_text &ref) const;
 
 
+   /**
+    * Returns the intern id of the UTF-8 text, see interner.h.
+    * The id is looked up once and kept until the text changes.
+    */
+   size_t intern_id() const;
+
+
+   //! Returns the intern id of the text if it has one, 0 if not; never interns
+   size_t known_intern_id() const;
+
+
    //! grab the data as a series of ints for outputting to a file
    const value_type &get() const;
 
@@ -188,8 +204,9 @@ public:
 protected:
    void update_logtext();
 
-   value_type m_chars;           //! this contains the non-encoded 31-bit chars
-   log_type   m_logtext;         //! logging text, utf8 encoded - updated in c_str()
+   value_type     m_chars;         //! this contains the non-encoded 31-bit chars
+   log_type       m_logtext;       //! logging text, utf8 encoded - updated in c_str()
+   mutable size_t m_intern_id = 0; //! cached intern id of m_logtext, 0 if none
 };
 
 
@@ -24,6 +24,7 @@
 #include "detect.h"
 #include "enum_cleanup.h"
 #include "indent.h"
+#include "interner.h"
 #include "keywords.h"
 #include "lang_pawn.h"
 #include "language_tools.h"
@@ -36,7 +37,10 @@
 #include "output.h"
 #include "parens.h"
 #include "pcf_flags.h"
+#include "pipeline.h"
+#include "profile.h"
 #include "prototypes.h"
+#include "quick_align_again.h"
 #include "remove_extra_returns.h"
 #include "semicolons.h"
 #include "sorting.h"
@@ -118,6 +122,21 @@ static bool read_stdin(file_mem &fm);
 static void uncrustify_start(const deque<int> &data);
 
 
+/**
+ * Writes the token stream if it was asked for after this stage,
+ * see --emit-tokens.
+ */
+static void emit_tokens(unc_stage_e stage);
+
+
+//! Finds the stage named by --emit-stage, OTHER is the last one that has chunks
+static bool unc_stage_from_name(const char *name, unc_stage_e &stage);
+
+
+//! Prints the passes uncrustify_file() runs for the loaded config, see --show-pipeline
+static void show_pipeline(FILE *pfile);
+
+
 static bool ends_with(const char *filename, const char *tag, bool case_sensitive);
 
 
@@ -139,10 +158,12 @@ static void add_file_header();
 static void add_file_footer();
 
 
-static void add_func_header(c_token_t type, file_mem &fm);
+//! Adds the function or class header before pc, if it has none yet
+static void add_func_header(chunk_t *pc, file_mem &fm, tokenized_text_t &text);
 
 
-static void add_msg_header(c_token_t type, file_mem &fm);
+//! Adds the Objective-C message header before pc, if it has none yet
+static void add_msg_header(chunk_t *pc, file_mem &fm, tokenized_text_t &text);
 
 
 static void process_source_list(const char *source_list, const char *prefix, const char *suffix, bool no_backup, bool keep_mtime);
@@ -286,6 +307,8 @@ void usage(const char *argv0)
            " --frag       : Code fragment, assume the first line is indented correctly.\n"
            " --assume FN  : Uses the filename FN for automatic language detection if reading\n"
            "                from stdin unless -l is specified.\n"
+           " --threads N  : Tokenize large files on up to N threads, 0 (the default) uses one\n"
+           "                per CPU core and 1 disables it. The output is the same either way.\n"
            "\n"
            "Config/Help Options:\n"
            " -h -? --help --usage     : Print this message and exit.\n"
@@ -298,6 +321,8 @@ void usage(const char *argv0)
            " --detect                 : Detects the config from a source file. Use with '-f FILE'.\n"
            "                            Detection is fairly limited.\n"
            " --set <option>=<value>   : Sets a new value to a config option.\n"
+           " --show-pipeline          : Print the passes that run for the config and exit.\n"
+           "                            Passes for a single language need '-l'.\n"
            "\n"
            "Debug Options:\n"
            " -p FILE      : Dump debug info into FILE, or to stdout if FILE is set to '-'.\n"
@@ -305,6 +330,17 @@ void usage(const char *argv0)
            " -L SEV       : Set the log severity (see log_levels.h; note 'A' = 'all')\n"
            " -s           : Show the log severity in the logs.\n"
            " --decode     : Decode remaining args (chunk flags) and exit.\n"
+           " --emit-tokens FILE : Write the chunks as a binary token stream into FILE, or to\n"
+           "                      stdout if FILE is '-'. See documentation/token_stream.txt.\n"
+           "                      Must be used in combination with '-f FILE', and with\n"
+           "                      '-o FILE' or '--check' if FILE is '-'\n"
+           " --emit-stage STG   : Write the token stream after stage STG: TOKENIZE, HEADER,\n"
+           "                      TOKENIZE_CLEANUP, BRACE_CLEANUP, FIX_SYMBOLS, MARK_COMMENTS,\n"
+           "                      COMBINE_LABELS or OTHER (the default, the formatted chunks).\n"
+           " --profile[=json]   : Print the time, the chunk visits, insertions and deletions of\n"
+           "                      each stage, the rounds of the newline and code width loops\n"
+           "                      and the hits of the spacing rule cache to stderr, for each\n"
+           "                      file and for the whole run.\n"
            "\n"
            "Usage Examples\n"
            "cat foo.d | uncrustify -q -c my.cfg -l d\n"
@@ -507,6 +543,20 @@ int main(int argc, char *argv[])
    }
    cpd.frag = arg.Present("--frag");
 
+   if ((p_arg = arg.Param("--threads")) != nullptr)
+   {
+      cpd.threads = strtoul(p_arg, nullptr, 10);
+   }
+
+   if (arg.Present("--profile"))
+   {
+      profile_enable(false);
+   }
+   else if (arg.Present("--profile=json"))
+   {
+      profile_enable(true);
+   }
+
    if (arg.Present("--decode"))
    {
       size_t idx = 1;
@@ -563,6 +613,20 @@ int main(int argc, char *argv[])
       }
    }
 
+   // Get the token stream file name
+   if ((cpd.tokens_file = arg.Param("--emit-tokens")) != nullptr)
+   {
+      cpd.tokens_stage = unc_stage_e::OTHER;
+
+      if (  ((p_arg = arg.Param("--emit-stage")) != nullptr)
+         && !unc_stage_from_name(p_arg, cpd.tokens_stage))
+      {
+         fprintf(stderr, "FAIL: unknown stage '%s' for --emit-stage\n", p_arg);
+         log_flush(true);
+         exit(EX_CONFIG);
+      }
+   }
+
    // Enable log severities
    if (arg.Present("-s") || arg.Present("--show"))
    {
@@ -862,9 +926,33 @@ int main(int argc, char *argv[])
          return(EX_NOHOST);
       }
    }
+
+   // The token stream would be mixed into the formatted code on stdout
+   if (  cpd.tokens_file != nullptr
+      && cpd.tokens_file[0] == '-'
+      && !cpd.tokens_file[1]
+      && output_file == nullptr
+      && source_list == nullptr
+      && p_arg == nullptr
+      && !cpd.do_check)
+   {
+      fprintf(stderr, "FAIL: --emit-tokens - needs the output in a file, use -o FILE\n");
+      log_flush(true);
+      exit(EX_CONFIG);
+   }
    // This relies on cpd.filename being the config file name
    load_header_files();
 
+   if (arg.Present("--show-pipeline"))
+   {
+      if (auto error = redir_stdout(output_file))
+      {
+         return(error);
+      }
+      show_pipeline(stdout);
+      return(EXIT_SUCCESS);
+   }
+
    if (cpd.do_check || cpd.if_changed)
    {
       cpd.bout = new deque<UINT8>();
@@ -925,6 +1013,13 @@ int main(int argc, char *argv[])
          exit(EX_CONFIG);
       }
 
+      if (cpd.tokens_file != nullptr)
+      {
+         fprintf(stderr, "FAIL: --emit-tokens option must be used with the -f option\n");
+         log_flush(true);
+         exit(EX_CONFIG);
+      }
+
       // Doing multiple files, TODO: multiple threads for parallel processing
       if (prefix != nullptr)
       {
@@ -951,6 +1046,7 @@ int main(int argc, char *argv[])
          process_source_list(source_list, prefix, suffix, no_backup, keep_mtime);
       }
    }
+   profile_report(stderr);
    clear_keyword_file();
 
    if (cpd.error_count != 0)
@@ -1051,7 +1147,7 @@ static bool read_stdin(file_mem &fm)
    }
    // Copy the raw data from the deque to the vector
    fm.raw.insert(fm.raw.end(), dq.begin(), dq.end());
-   return(decode_unicode(fm.raw, fm.data, fm.enc, fm.bom));
+   return(decode_unicode(fm.raw, fm.data, fm.enc, fm.bom, fm.zero_pos));
 }
 
 
@@ -1110,7 +1206,8 @@ static int load_mem_file(const char *filename, file_mem &fm)
 
    fm.raw.clear();
    fm.data.clear();
-   fm.enc = char_encoding_e::e_ASCII;
+   fm.enc           = char_encoding_e::e_ASCII;
+   fm.zero_pos.line = 0;
 
    // Grab the stat info for the file, return if it cannot be read
    if (stat(filename, &my_stat) < 0)
@@ -1147,7 +1244,7 @@ static int load_mem_file(const char *filename, file_mem &fm)
                  __func__, filename, strerror(errno), errno);
          cpd.error_count++;
       }
-      else if (!decode_unicode(fm.raw, fm.data, fm.enc, fm.bom))
+      else if (!decode_unicode(fm.raw, fm.data, fm.enc, fm.bom, fm.zero_pos))
       {
          LOG_FMT(LERR, "%s: failed to decode the file '%s'\n", __func__, filename);
          cpd.error_count++;
@@ -1576,228 +1673,213 @@ static void add_file_footer()
 }
 
 
-static void add_func_header(c_token_t type, file_mem &fm)
+static void add_func_header(chunk_t *pc, file_mem &fm, tokenized_text_t &text)
 {
-   chunk_t *pc;
-   chunk_t *ref;
-   chunk_t *tmp;
-   bool    do_insert;
+   const c_token_t type = pc->type;
+   chunk_t         *ref;
+   chunk_t         *tmp;
+   bool            do_insert;
 
-   for (pc = chunk_get_head(); pc != nullptr; pc = chunk_get_next_ncnlnp(pc))
+   log_rule_B("cmt_insert_before_inlines");
+
+   if (  pc->flags.test(PCF_IN_CLASS)
+      && !options::cmt_insert_before_inlines())
    {
-      if (pc->type != type)
-      {
-         continue;
-      }
-      log_rule_B("cmt_insert_before_inlines");
+      return;
+   }
+   // Check for one liners for classes. Declarations only. Walk down the chunks.
+   ref = pc;
 
-      if (  pc->flags.test(PCF_IN_CLASS)
-         && !options::cmt_insert_before_inlines())
-      {
-         continue;
-      }
-      // Check for one liners for classes. Declarations only. Walk down the chunks.
-      ref = pc;
+   if (  chunk_is_token(ref, CT_CLASS)
+      && get_chunk_parent_type(ref) == CT_NONE
+      && ref->next)
+   {
+      ref = ref->next;
 
-      if (  chunk_is_token(ref, CT_CLASS)
-         && get_chunk_parent_type(ref) == CT_NONE
+      if (  chunk_is_token(ref, CT_TYPE)
+         && get_chunk_parent_type(ref) == type
          && ref->next)
       {
          ref = ref->next;
 
-         if (  chunk_is_token(ref, CT_TYPE)
-            && get_chunk_parent_type(ref) == type
-            && ref->next)
+         if (chunk_is_token(ref, CT_SEMICOLON) && ref->level == pc->level)
          {
-            ref = ref->next;
-
-            if (chunk_is_token(ref, CT_SEMICOLON) && ref->level == pc->level)
-            {
-               continue;
-            }
+            return;
          }
       }
-      // Check for one liners for functions. There'll be a closing brace w/o any newlines. Walk down the chunks.
-      ref = pc;
+   }
+   // Check for one liners for functions. There'll be a closing brace w/o any newlines. Walk down the chunks.
+   ref = pc;
 
-      if (  chunk_is_token(ref, CT_FUNC_DEF)
-         && get_chunk_parent_type(ref) == CT_NONE
-         && ref->next)
-      {
-         int found_brace = 0;                                 // Set if a close brace is found before a newline
+   if (  chunk_is_token(ref, CT_FUNC_DEF)
+      && get_chunk_parent_type(ref) == CT_NONE
+      && ref->next)
+   {
+      int found_brace = 0;                                 // Set if a close brace is found before a newline
 
-         while (ref->type != CT_NEWLINE && (ref = ref->next)) // TODO: is the assignment of ref wanted here?, better move it to the loop
+      while (ref->type != CT_NEWLINE && (ref = ref->next)) // TODO: is the assignment of ref wanted here?, better move it to the loop
+      {
+         if (chunk_is_token(ref, CT_BRACE_CLOSE))
          {
-            if (chunk_is_token(ref, CT_BRACE_CLOSE))
-            {
-               found_brace = 1;
-               break;
-            }
+            found_brace = 1;
+            break;
          }
+      }
 
-         if (found_brace)
-         {
-            continue;
-         }
+      if (found_brace)
+      {
+         return;
       }
-      do_insert = false;
+   }
+   do_insert = false;
 
-      /*
-       * On a function proto or def. Back up to a close brace or semicolon on
-       * the same level
-       */
-      ref = pc;
+   /*
+    * On a function proto or def. Back up to a close brace or semicolon on
+    * the same level
+    */
+   ref = pc;
 
-      while ((ref = chunk_get_prev(ref)) != nullptr)
+   while ((ref = chunk_get_prev(ref)) != nullptr)
+   {
+      // Bail if we change level or find an access specifier colon
+      if (ref->level != pc->level || chunk_is_token(ref, CT_ACCESS_COLON))
       {
-         // Bail if we change level or find an access specifier colon
-         if (ref->level != pc->level || chunk_is_token(ref, CT_ACCESS_COLON))
-         {
-            do_insert = true;
-            break;
-         }
+         do_insert = true;
+         break;
+      }
 
-         // If we hit an angle close, back up to the angle open
-         if (chunk_is_token(ref, CT_ANGLE_CLOSE))
-         {
-            ref = chunk_get_prev_type(ref, CT_ANGLE_OPEN, ref->level, scope_e::PREPROC);
-            continue;
-         }
+      // If we hit an angle close, back up to the angle open
+      if (chunk_is_token(ref, CT_ANGLE_CLOSE))
+      {
+         ref = chunk_get_prev_type(ref, CT_ANGLE_OPEN, ref->level, scope_e::PREPROC);
+         continue;
+      }
 
-         // Bail if we hit a preprocessor and cmt_insert_before_preproc is false
-         if (ref->flags.test(PCF_IN_PREPROC))
-         {
-            tmp = chunk_get_prev_type(ref, CT_PREPROC, ref->level);
+      // Bail if we hit a preprocessor and cmt_insert_before_preproc is false
+      if (ref->flags.test(PCF_IN_PREPROC))
+      {
+         tmp = chunk_get_prev_type(ref, CT_PREPROC, ref->level);
 
-            if (tmp != nullptr && get_chunk_parent_type(tmp) == CT_PP_IF)
-            {
-               tmp = chunk_get_prev_nnl(tmp);
+         if (tmp != nullptr && get_chunk_parent_type(tmp) == CT_PP_IF)
+         {
+            tmp = chunk_get_prev_nnl(tmp);
 
-               log_rule_B("cmt_insert_before_preproc");
+            log_rule_B("cmt_insert_before_preproc");
 
-               if (  chunk_is_comment(tmp)
-                  && !options::cmt_insert_before_preproc())
-               {
-                  break;
-               }
+            if (  chunk_is_comment(tmp)
+               && !options::cmt_insert_before_preproc())
+            {
+               break;
             }
          }
+      }
 
-         // Ignore 'right' comments
-         if (chunk_is_comment(ref) && chunk_is_newline(chunk_get_prev(ref)))
-         {
-            break;
-         }
-
-         if (  ref->level == pc->level
-            && (  ref->flags.test(PCF_IN_PREPROC)
-               || chunk_is_token(ref, CT_SEMICOLON)
-               || chunk_is_token(ref, CT_BRACE_CLOSE)))
-         {
-            do_insert = true;
-            break;
-         }
+      // Ignore 'right' comments
+      if (chunk_is_comment(ref) && chunk_is_newline(chunk_get_prev(ref)))
+      {
+         break;
       }
 
-      if (do_insert)
+      if (  ref->level == pc->level
+         && (  ref->flags.test(PCF_IN_PREPROC)
+            || chunk_is_token(ref, CT_SEMICOLON)
+            || chunk_is_token(ref, CT_BRACE_CLOSE)))
       {
-         // Insert between after and ref
-         chunk_t *after = chunk_get_next_ncnl(ref);
-         tokenize(fm.data, after);
+         do_insert = true;
+         break;
+      }
+   }
 
-         for (tmp = chunk_get_next(ref); tmp != after; tmp = chunk_get_next(tmp))
-         {
-            tmp->level = after->level;
-         }
+   if (do_insert)
+   {
+      // Insert between after and ref
+      chunk_t *after = chunk_get_next_ncnl(ref);
+      tokenize_cached(fm.data, after, text);
+
+      for (tmp = chunk_get_next(ref); tmp != after; tmp = chunk_get_next(tmp))
+      {
+         tmp->level = after->level;
       }
    }
 } // add_func_header
 
 
-static void add_msg_header(c_token_t type, file_mem &fm)
+static void add_msg_header(chunk_t *pc, file_mem &fm, tokenized_text_t &text)
 {
-   chunk_t *pc;
    chunk_t *ref;
    chunk_t *tmp;
    bool    do_insert;
 
-   for (pc = chunk_get_head(); pc != nullptr; pc = chunk_get_next_ncnlnp(pc))
+   do_insert = false;
+
+   /*
+    * On a message declaration back up to a Objective-C scope
+    * the same level
+    */
+   ref = pc;
+
+   while ((ref = chunk_get_prev(ref)) != nullptr)
    {
-      if (pc->type != type)
+      // ignore the CT_TYPE token that is the result type
+      if (  ref->level != pc->level
+         && (chunk_is_token(ref, CT_TYPE) || chunk_is_token(ref, CT_PTR_TYPE)))
       {
          continue;
       }
-      do_insert = false;
 
-      /*
-       * On a message declaration back up to a Objective-C scope
-       * the same level
-       */
-      ref = pc;
+      // If we hit a parentheses around return type, back up to the open parentheses
+      if (chunk_is_token(ref, CT_PAREN_CLOSE))
+      {
+         ref = chunk_get_prev_type(ref, CT_PAREN_OPEN, ref->level, scope_e::PREPROC);
+         continue;
+      }
 
-      while ((ref = chunk_get_prev(ref)) != nullptr)
+      // Bail if we hit a preprocessor and cmt_insert_before_preproc is false
+      if (ref->flags.test(PCF_IN_PREPROC))
       {
-         // ignore the CT_TYPE token that is the result type
-         if (  ref->level != pc->level
-            && (chunk_is_token(ref, CT_TYPE) || chunk_is_token(ref, CT_PTR_TYPE)))
-         {
-            continue;
-         }
+         tmp = chunk_get_prev_type(ref, CT_PREPROC, ref->level);
 
-         // If we hit a parentheses around return type, back up to the open parentheses
-         if (chunk_is_token(ref, CT_PAREN_CLOSE))
+         if (tmp != nullptr && get_chunk_parent_type(tmp) == CT_PP_IF)
          {
-            ref = chunk_get_prev_type(ref, CT_PAREN_OPEN, ref->level, scope_e::PREPROC);
-            continue;
-         }
+            tmp = chunk_get_prev_nnl(tmp);
 
-         // Bail if we hit a preprocessor and cmt_insert_before_preproc is false
-         if (ref->flags.test(PCF_IN_PREPROC))
-         {
-            tmp = chunk_get_prev_type(ref, CT_PREPROC, ref->level);
+            log_rule_B("cmt_insert_before_preproc");
 
-            if (tmp != nullptr && get_chunk_parent_type(tmp) == CT_PP_IF)
+            if (  chunk_is_comment(tmp)
+               && !options::cmt_insert_before_preproc())
             {
-               tmp = chunk_get_prev_nnl(tmp);
-
-               log_rule_B("cmt_insert_before_preproc");
-
-               if (  chunk_is_comment(tmp)
-                  && !options::cmt_insert_before_preproc())
-               {
-                  break;
-               }
+               break;
             }
          }
+      }
 
-         if (  ref->level == pc->level
-            && (ref->flags.test(PCF_IN_PREPROC) || chunk_is_token(ref, CT_OC_SCOPE)))
-         {
-            ref = chunk_get_prev(ref);
+      if (  ref->level == pc->level
+         && (ref->flags.test(PCF_IN_PREPROC) || chunk_is_token(ref, CT_OC_SCOPE)))
+      {
+         ref = chunk_get_prev(ref);
 
-            if (ref != nullptr)
+         if (ref != nullptr)
+         {
+            // Ignore 'right' comments
+            if (chunk_is_newline(ref) && chunk_is_comment(chunk_get_prev(ref)))
             {
-               // Ignore 'right' comments
-               if (chunk_is_newline(ref) && chunk_is_comment(chunk_get_prev(ref)))
-               {
-                  break;
-               }
-               do_insert = true;
+               break;
             }
-            break;
+            do_insert = true;
          }
+         break;
       }
+   }
 
-      if (do_insert)
-      {
-         // Insert between after and ref
-         chunk_t *after = chunk_get_next_ncnl(ref);
-         tokenize(fm.data, after);
+   if (do_insert)
+   {
+      // Insert between after and ref
+      chunk_t *after = chunk_get_next_ncnl(ref);
+      tokenize_cached(fm.data, after, text);
 
-         for (tmp = chunk_get_next(ref); tmp != after; tmp = chunk_get_next(tmp))
-         {
-            tmp->level = after->level;
-         }
+      for (tmp = chunk_get_next(ref); tmp != after; tmp = chunk_get_next(tmp))
+      {
+         tmp->level = after->level;
       }
    }
 } // add_msg_header
@@ -1805,12 +1887,19 @@ static void add_msg_header(c_token_t type, file_mem &fm)
 
 static void uncrustify_start(const deque<int> &data)
 {
+   // The intern ids are per file
+   clear_interned();
+
    // Parse the text into chunks
+   profile_stage("tokenize");
    tokenize(data, nullptr);
+   emit_tokens(unc_stage_e::TOKENIZE);
    PROT_THE_LINE
 
    cpd.unc_stage = unc_stage_e::HEADER;
 
+   profile_stage("header");
+
    // Get the column for the fragment indent
    if (cpd.frag)
    {
@@ -1830,18 +1919,23 @@ static void uncrustify_start(const deque<int> &data)
    {
       add_file_footer();
    }
+   emit_tokens(unc_stage_e::HEADER);
+
    /*
     * Change certain token types based on simple sequence.
     * Example: change '[' + ']' to '[]'
     * Note that level info is not yet available, so it is OK to do all
     * processing that doesn't need to know level info. (that's very little!)
     */
+   profile_stage("tokenize_cleanup");
    tokenize_cleanup();
+   emit_tokens(unc_stage_e::TOKENIZE_CLEANUP);
 
    /*
     * Detect the brace and paren levels and insert virtual braces.
     * This handles all that nasty preprocessor stuff
     */
+   profile_stage("brace_cleanup");
    brace_cleanup();
 
    // At this point, the level information is available and accurate.
@@ -1850,19 +1944,447 @@ static void uncrustify_start(const deque<int> &data)
    {
       pawn_prescan();
    }
+   emit_tokens(unc_stage_e::BRACE_CLEANUP);
+
    // Re-type chunks, combine chunks
+   profile_stage("fix_symbols");
    fix_symbols();
    tokenize_trailing_return_types();
+   emit_tokens(unc_stage_e::FIX_SYMBOLS);
 
+   profile_stage("mark_comments");
    mark_comments();
+   emit_tokens(unc_stage_e::MARK_COMMENTS);
 
    // Look at all colons ':' and mark labels, :? sequences, etc.
+   profile_stage("combine_labels");
    combine_labels();
 
    enum_cleanup();
+   emit_tokens(unc_stage_e::COMBINE_LABELS);
+   profile_stage(nullptr);
 } // uncrustify_start
 
 
+static void emit_tokens(unc_stage_e stage)
+{
+   if (  cpd.tokens_file == nullptr
+      || cpd.tokens_stage != stage)
+   {
+      return;
+   }
+   FILE *p_file;
+
+   if (cpd.tokens_file[0] == '-' && !cpd.tokens_file[1])
+   {
+      p_file = stdout;
+   }
+   else
+   {
+      p_file = fopen(cpd.tokens_file, "wb");
+   }
+
+   if (p_file != nullptr)
+   {
+      output_tokens(p_file, stage);
+
+      if (p_file != stdout)
+      {
+         fclose(p_file);
+      }
+   }
+   else
+   {
+      LOG_FMT(LERR, "%s: Failed to open '%s' for write: %s (%d)\n",
+              __func__, cpd.tokens_file, strerror(errno), errno);
+      cpd.error_count++;
+   }
+} // emit_tokens
+
+
+static bool unc_stage_from_name(const char *name, unc_stage_e &stage)
+{
+   for (unsigned int idx = 0; idx <= static_cast<unsigned int>(unc_stage_e::OTHER); idx++)
+   {
+      if (strcasecmp(name, get_unc_stage_name(static_cast<unc_stage_e>(idx))) == 0)
+      {
+         stage = static_cast<unc_stage_e>(idx);
+         return(true);
+      }
+   }
+
+   return(false);
+}
+
+
+/*
+ * The passes of uncrustify_file(), in the order they run.
+ * A pass with options only runs if one of them is set, see pipeline.h.
+ */
+
+//! set for the first round of the newline loop
+static bool newline_first_round;
+
+//! set until the code width loop has retried the line breaks
+static bool code_width_first_round;
+
+
+static bool has_comment_header(void)
+{
+   return(  !cpd.func_hdr.data.empty()
+         || !cpd.class_hdr.data.empty()
+         || !cpd.oc_msg_hdr.data.empty());
+}
+
+
+//! the headers as chunks, tokenized once for all the places and files
+static tokenized_text_t func_hdr_text;
+static tokenized_text_t class_hdr_text;
+static tokenized_text_t oc_msg_hdr_text;
+
+
+//! Adds the function, class and Objective-C message headers in one walk
+static void add_comment_headers(void)
+{
+   const bool func_hdr  = !cpd.func_hdr.data.empty();
+   const bool class_hdr = !cpd.class_hdr.data.empty();
+   const bool msg_hdr   = !cpd.oc_msg_hdr.data.empty();
+
+   log_rule_B("cmt_insert_before_ctor_dtor");
+   const bool ctor_dtor = func_hdr && options::cmt_insert_before_ctor_dtor();
+
+   for (chunk_t *pc = chunk_get_head(); pc != nullptr; pc = chunk_get_next_ncnlnp(pc))
+   {
+      if (  (func_hdr && pc->type == CT_FUNC_DEF)
+         || (ctor_dtor && pc->type == CT_FUNC_CLASS_DEF))
+      {
+         add_func_header(pc, cpd.func_hdr, func_hdr_text);
+      }
+      else if (class_hdr && pc->type == CT_CLASS)
+      {
+         add_func_header(pc, cpd.class_hdr, class_hdr_text);
+      }
+      else if (msg_hdr && pc->type == CT_OC_MSG_DECL)
+      {
+         add_msg_header(pc, cpd.oc_msg_hdr, oc_msg_hdr_text);
+      }
+   }
+}
+
+
+static bool removes_newlines(void)
+{
+   return(options::nl_remove_extra_newlines() == 2);
+}
+
+
+static void newlines_cleanup_braces_pass(void)
+{
+   newlines_cleanup_braces(newline_first_round);
+}
+
+
+static bool is_pawn(void)
+{
+   return(language_is_set(LANG_PAWN));
+}
+
+
+static void code_width_pass(void)
+{
+   LOG_FMT(LNEWLINE, "%s(%d): Code_width loop start: %d\n",
+           __func__, __LINE__, cpd.changes);
+
+   if (options::debug_max_number_of_loops() > 0)
+   {
+      if (cpd.changes > options::debug_max_number_of_loops())                 // Issue #2432
+      {
+         LOG_FMT(LNEWLINE, "%s(%d): too many loop. Make a report, please.\n",
+                 __func__, __LINE__);
+         log_flush(true);
+         exit(EX_SOFTWARE);
+      }
+   }
+   const int old_changes = cpd.changes;
+
+   do_code_width();
+
+   if (old_changes != cpd.changes && code_width_first_round)
+   {
+      // retry line breaks caused by splitting 1-liners
+      newlines_cleanup_braces(false);
+      newlines_insert_blank_lines();
+      code_width_first_round = false;
+   }
+}
+
+
+static const GenericOption *const semicolon_options[] =
+{
+   &options::mod_remove_extra_semicolon, nullptr
+};
+
+static const GenericOption *const return_options[] =
+{
+   &options::mod_remove_empty_return, nullptr
+};
+
+static const GenericOption *const remove_newline_options[] =
+{
+   &options::nl_remove_extra_newlines, nullptr
+};
+
+static const pass_t prepare_passes[] =
+{
+   { "add_comment_headers",      add_comment_headers,      nullptr, nullptr,                has_comment_header },
+   { "do_braces",                do_braces,                nullptr, nullptr,                nullptr            },
+   { "remove_extra_semicolons",  remove_extra_semicolons,  nullptr, semicolon_options,      nullptr            },
+   { "remove_extra_returns",     remove_extra_returns,     nullptr, return_options,         nullptr            },
+   { "do_parens",                do_parens,                nullptr, nullptr,                nullptr            },
+   { "newlines_remove_newlines", newlines_remove_newlines, nullptr, remove_newline_options, removes_newlines   },
+};
+
+static const pass_list_t prepare_pass_list =
+{
+   "prepare", prepare_passes, ARRAY_SIZE(prepare_passes)
+};
+
+static const GenericOption *const annotation_options[] =
+{
+   &options::nl_between_annotation, &options::nl_after_annotation, nullptr
+};
+
+static const GenericOption *const template_options[] =
+{
+   &options::nl_template_start, &options::nl_template_args, &options::nl_template_end, nullptr
+};
+
+
+// The passes log these options themselves when they run
+static bool has_annotation_newlines(void)
+{
+   return(options_changed(annotation_options));
+}
+
+
+static bool has_template_newlines(void)
+{
+   return(options_changed(template_options));
+}
+
+
+static const GenericOption *const multiline_comment_options[] =
+{
+   &options::nl_after_multiline_comment, nullptr
+};
+
+static const GenericOption *const label_colon_options[] =
+{
+   &options::nl_after_label_colon, nullptr
+};
+
+static const GenericOption *const pos_options[] =
+{
+   &options::pos_bool,   &options::pos_compare,    &options::pos_conditional,
+   &options::pos_comma,  &options::pos_enum_comma,
+   &options::pos_assign, &options::pos_arith,      nullptr
+};
+
+
+//! Moves the tokens whose position options are set, in one walk
+static void chunk_pos_pass(void)
+{
+   vector<chunk_pos_t> positions;
+
+   log_pass_rules(pos_options);
+
+   if (options::pos_bool() != TP_IGNORE)
+   {
+      positions.push_back({ CT_BOOL, options::pos_bool() });
+   }
+
+   if (options::pos_compare() != TP_IGNORE)
+   {
+      positions.push_back({ CT_COMPARE, options::pos_compare() });
+   }
+
+   if (options::pos_conditional() != TP_IGNORE)
+   {
+      positions.push_back({ CT_COND_COLON, options::pos_conditional() });
+      positions.push_back({ CT_QUESTION, options::pos_conditional() });
+   }
+
+   if (options::pos_comma() != TP_IGNORE || options::pos_enum_comma() != TP_IGNORE)
+   {
+      positions.push_back({ CT_COMMA, options::pos_comma() });
+   }
+
+   if (options::pos_assign() != TP_IGNORE)
+   {
+      positions.push_back({ CT_ASSIGN, options::pos_assign() });
+   }
+
+   if (options::pos_arith() != TP_IGNORE)
+   {
+      positions.push_back({ CT_ARITH, options::pos_arith() });
+      positions.push_back({ CT_CARET, options::pos_arith() });
+   }
+   newlines_chunk_pos(positions);
+}
+
+static const GenericOption *const squeeze_ifdef_options[] =
+{
+   &options::nl_squeeze_ifdef, nullptr
+};
+
+static const GenericOption *const squeeze_paren_options[] =
+{
+   &options::nl_squeeze_paren_close, nullptr
+};
+
+static const GenericOption *const start_end_options[] =
+{
+   &options::nl_start_of_file, &options::nl_start_of_file_min,
+   &options::nl_end_of_file,   &options::nl_end_of_file_min, nullptr
+};
+
+
+static bool eats_start_end(void)
+{
+   return(options_changed(start_end_options));
+}
+
+static const pass_t newline_passes[] =
+{
+   { "annotations_newlines",                        annotations_newlines,                        nullptr,                         nullptr,                   has_annotation_newlines },
+   { "newlines_cleanup_dup",                        newlines_cleanup_dup,                        nullptr,                         nullptr,                   nullptr                 },
+   { "newlines_sparens",                            newlines_sparens,                            nullptr,                         nullptr,                   nullptr                 },
+   { "newlines_cleanup_braces",                     newlines_cleanup_braces_pass,                nullptr,                         nullptr,                   nullptr                 },
+   { "newlines_cleanup_angles",                     nullptr,                                     newlines_cleanup_angles,         nullptr,                   has_template_newlines   }, // Issue #1167
+   { "newline_after_multiline_comment",             nullptr,                                     newline_after_multiline_comment, multiline_comment_options, nullptr                 },
+   { "newline_after_label_colon",                   nullptr,                                     newline_after_label_colon,       label_colon_options,       nullptr                 },
+   { "newlines_insert_blank_lines",                 newlines_insert_blank_lines,                 nullptr,                         nullptr,                   nullptr                 },
+   { "newlines_chunk_pos",                          chunk_pos_pass,                              nullptr,                         nullptr,                   nullptr                 },
+   { "newlines_squeeze_ifdef",                      newlines_squeeze_ifdef,                      nullptr,                         squeeze_ifdef_options,     nullptr                 },
+   { "newlines_squeeze_paren_close",                newlines_squeeze_paren_close,                nullptr,                         squeeze_paren_options,     nullptr                 },
+   { "do_blank_lines",                              do_blank_lines,                              nullptr,                         nullptr,                   nullptr                 },
+   { "newlines_eat_start_end",                      newlines_eat_start_end,                      nullptr,                         nullptr,                   eats_start_end          },
+   { "newlines_functions_remove_extra_blank_lines", newlines_functions_remove_extra_blank_lines, nullptr,                         nullptr,                   nullptr                 },
+   { "newlines_cleanup_dup",                        newlines_cleanup_dup,                        nullptr,                         nullptr,                   nullptr                 },
+};
+
+static const pass_list_t newline_pass_list =
+{
+   "newlines (repeated while it changes something)", newline_passes, ARRAY_SIZE(newline_passes)
+};
+
+static const GenericOption *const balance_paren_options[] =
+{
+   &options::sp_balance_nested_parens, nullptr
+};
+
+static const GenericOption *const pawn_semicolon_options[] =
+{
+   &options::mod_pawn_semicolon, nullptr
+};
+
+static const GenericOption *const sort_options[] =
+{
+   &options::mod_sort_import, &options::mod_sort_include, &options::mod_sort_using, nullptr
+};
+
+static const GenericOption *const align_pp_options[] =
+{
+   &options::align_pp_define_span, nullptr
+};
+
+static const GenericOption *const closebrace_comment_options[] =
+{
+   &options::mod_add_long_switch_closebrace_comment,
+   &options::mod_add_long_function_closebrace_comment,
+   &options::mod_add_long_class_closebrace_comment,
+   &options::mod_add_long_namespace_closebrace_comment,
+   nullptr
+};
+
+static const GenericOption *const ifdef_comment_options[] =
+{
+   &options::mod_add_long_ifdef_else_comment, &options::mod_add_long_ifdef_endif_comment, nullptr
+};
+
+static const pass_t layout_passes[] =
+{
+   { "mark_comments",                                   mark_comments,                                   nullptr, nullptr,                    nullptr },
+   { "space_text_balance_nested_parens",                space_text_balance_nested_parens,                nullptr, balance_paren_options,      nullptr },
+   { "pawn_scrub_vsemi",                                pawn_scrub_vsemi,                                nullptr, pawn_semicolon_options,     is_pawn },
+   { "sort_imports",                                    sort_imports,                                    nullptr, sort_options,               nullptr },
+   { "space_text",                                      space_text,                                      nullptr, nullptr,                    nullptr },
+   { "align_preprocessor",                              align_preprocessor,                              nullptr, align_pp_options,           nullptr },
+   { "indent_preproc",                                  indent_preproc,                                  nullptr, nullptr,                    nullptr },
+   { "indent_text",                                     indent_text,                                     nullptr, nullptr,                    nullptr },
+   { "add_long_closebrace_comment",                     add_long_closebrace_comment,                     nullptr, closebrace_comment_options, nullptr },
+   { "add_long_preprocessor_conditional_block_comment", add_long_preprocessor_conditional_block_comment, nullptr, ifdef_comment_options,      nullptr },
+};
+
+static const pass_list_t layout_pass_list =
+{
+   "layout", layout_passes, ARRAY_SIZE(layout_passes)
+};
+
+static const pass_t align_passes[] =
+{
+   { "align_all",   align_all,   nullptr, nullptr, nullptr },
+   { "indent_text", indent_text, nullptr, nullptr, nullptr },
+};
+
+static const pass_list_t align_pass_list =
+{
+   "align (repeated while do_code_width changes something)", align_passes, ARRAY_SIZE(align_passes)
+};
+
+static const GenericOption *const code_width_options[] =
+{
+   &options::code_width, nullptr
+};
+
+static const pass_t code_width_passes[] =
+{
+   { "do_code_width", code_width_pass, nullptr, code_width_options, nullptr },
+};
+
+static const pass_list_t code_width_pass_list =
+{
+   "code width", code_width_passes, ARRAY_SIZE(code_width_passes)
+};
+
+static const GenericOption *const nl_cont_options[] =
+{
+   &options::align_nl_cont, nullptr
+};
+
+static const pass_t finish_passes[] =
+{
+   { "align_right_comments",    align_right_comments,    nullptr, nullptr,         nullptr },
+   { "align_backslash_newline", align_backslash_newline, nullptr, nl_cont_options, nullptr },
+};
+
+static const pass_list_t finish_pass_list =
+{
+   "finish", finish_passes, ARRAY_SIZE(finish_passes)
+};
+
+
+static void show_pipeline(FILE *pfile)
+{
+   show_passes(pfile, prepare_pass_list);
+   show_passes(pfile, newline_pass_list);
+   show_passes(pfile, layout_pass_list);
+   show_passes(pfile, align_pass_list);
+   show_passes(pfile, code_width_pass_list);
+   show_passes(pfile, finish_pass_list);
+}
+
+
 void uncrustify_file(const file_mem &fm, FILE *pfout,
                      const char *parsed_file, bool defer_uncrustify_end)
 {
@@ -1907,30 +2429,17 @@ void uncrustify_file(const file_mem &fm, FILE *pfout,
    {
       cpd.bom = true;
    }
-   // Check for embedded 0's (represents a decoding failure or corrupt file)
-   size_t count_line   = 1;
-   size_t count_column = 1;
 
-   for (int idx = 0; idx < static_cast<int>(data.size()) - 1; idx++)
+   // Check for embedded 0's (represents a decoding failure or corrupt file)
+   if (fm.zero_pos.line != 0)
    {
-      if (data[idx] == 0)
-      {
-         LOG_FMT(LERR, "An embedded 0 was found in '%s' %zu:%zu.\n",
-                 cpd.filename.c_str(), count_line, count_column);
-         LOG_FMT(LERR, "The file may be encoded in an unsupported Unicode format.\n");
-         LOG_FMT(LERR, "Aborting.\n");
-         cpd.error_count++;
-         return;
-      }
-      count_column++;
-
-      if (data[idx] == '\n')
-      {
-         count_line++;
-         count_column = 1;
-      }
+      LOG_FMT(LERR, "An embedded 0 was found in '%s' %zu:%zu.\n",
+              cpd.filename.c_str(), fm.zero_pos.line, fm.zero_pos.column);
+      LOG_FMT(LERR, "The file may be encoded in an unsupported Unicode format.\n");
+      LOG_FMT(LERR, "Aborting.\n");
+      cpd.error_count++;
+      return;
    }
-
    uncrustify_start(data);
 
    cpd.unc_stage = unc_stage_e::OTHER;
@@ -1940,259 +2449,59 @@ void uncrustify_file(const file_mem &fm, FILE *pfout,
     * The detection code needs as few changes as possible.
     */
    {
-      // Add comments before function defs and classes
-      if (!cpd.func_hdr.data.empty())
-      {
-         add_func_header(CT_FUNC_DEF, cpd.func_hdr);
+      // Add comments, change virtual braces into real braces, ...
+      run_passes(prepare_pass_list, __func__);
 
-         log_rule_B("cmt_insert_before_ctor_dtor");
-
-         if (options::cmt_insert_before_ctor_dtor())
-         {
-            add_func_header(CT_FUNC_CLASS_DEF, cpd.func_hdr);
-         }
-      }
-
-      if (!cpd.class_hdr.data.empty())
-      {
-         add_func_header(CT_CLASS, cpd.class_hdr);
-      }
-
-      if (!cpd.oc_msg_hdr.data.empty())
-      {
-         add_msg_header(CT_OC_MSG_DECL, cpd.oc_msg_hdr);
-      }
-      do_braces();  // Change virtual braces into real braces...
-
-      // Scrub extra semicolons
-      log_rule_B("mod_remove_extra_semicolon");
-
-      if (options::mod_remove_extra_semicolon())
-      {
-         remove_extra_semicolons();
-      }
-      // Remove unnecessary returns
-      log_rule_B("mod_remove_empty_return");
-
-      if (options::mod_remove_empty_return())
-      {
-         remove_extra_returns();
-      }
-      // Add parens
-      do_parens();
-
-      // Modify line breaks as needed
-      bool first = true;
-      int  old_changes;
-
-      log_rule_B("nl_remove_extra_newlines");
+      /*
+       * Modify line breaks as needed.
+       * A round only reruns the passes that may find something new to do,
+       * the history skips those that changed nothing since they last ran.
+       */
+      int            old_changes;
+      pass_history_t newline_history;
 
-      if (options::nl_remove_extra_newlines() == 2)
-      {
-         newlines_remove_newlines();
-      }
-      cpd.pass_count = 3;
+      newline_first_round = true;
+      cpd.pass_count      = 3;
 
       do
       {
          old_changes = cpd.changes;
 
          LOG_FMT(LNEWLINE, "Newline loop start: %d\n", cpd.changes);
+         profile_loop("newline");
 
-         annotations_newlines();
-         newlines_cleanup_dup();
-         newlines_sparens();
-         newlines_cleanup_braces(first);
-         newlines_cleanup_angles();                           // Issue #1167
-
-         log_rule_B("nl_after_multiline_comment");
-
-         if (options::nl_after_multiline_comment())
-         {
-            newline_after_multiline_comment();
-         }
-         log_rule_B("nl_after_label_colon");
-
-         if (options::nl_after_label_colon())
-         {
-            newline_after_label_colon();
-         }
-         newlines_insert_blank_lines();
-
-         log_rule_B("pos_bool");
-
-         if (options::pos_bool() != TP_IGNORE)
-         {
-            newlines_chunk_pos(CT_BOOL, options::pos_bool());
-         }
-         log_rule_B("pos_compare");
-
-         if (options::pos_compare() != TP_IGNORE)
-         {
-            newlines_chunk_pos(CT_COMPARE, options::pos_compare());
-         }
-         log_rule_B("pos_conditional");
-
-         if (options::pos_conditional() != TP_IGNORE)
-         {
-            newlines_chunk_pos(CT_COND_COLON, options::pos_conditional());
-            newlines_chunk_pos(CT_QUESTION, options::pos_conditional());
-         }
-         log_rule_B("pos_comma");
-         log_rule_B("pos_enum_comma");
-
-         if (options::pos_comma() != TP_IGNORE || options::pos_enum_comma() != TP_IGNORE)
-         {
-            newlines_chunk_pos(CT_COMMA, options::pos_comma());
-         }
-         log_rule_B("pos_assign");
-
-         if (options::pos_assign() != TP_IGNORE)
-         {
-            newlines_chunk_pos(CT_ASSIGN, options::pos_assign());
-         }
-         log_rule_B("pos_arith");
-
-         if (options::pos_arith() != TP_IGNORE)
-         {
-            newlines_chunk_pos(CT_ARITH, options::pos_arith());
-            newlines_chunk_pos(CT_CARET, options::pos_arith());
-         }
-         newlines_class_colon_pos(CT_CLASS_COLON);
-         newlines_class_colon_pos(CT_CONSTR_COLON);
-
-         log_rule_B("nl_squeeze_ifdef");
+         run_passes(newline_pass_list, __func__, &newline_history);
 
-         if (options::nl_squeeze_ifdef())
+         if (newline_first_round)
          {
-            newlines_squeeze_ifdef();
+            newline_first_round = false;
+            forget_pass(newline_history, newline_pass_list, newlines_cleanup_braces_pass);
          }
-         log_rule_B("nl_squeeze_paren_close");
-
-         if (options::nl_squeeze_paren_close())
-         {
-            newlines_squeeze_paren_close();
-         }
-         do_blank_lines();
-         newlines_eat_start_end();
-         newlines_functions_remove_extra_blank_lines();
-         newlines_cleanup_dup();
-         first = false;
       } while (old_changes != cpd.changes && cpd.pass_count-- > 0);
 
-      mark_comments();
-
-      // Add balanced spaces around nested params
-      log_rule_B("sp_balance_nested_parens");
+      // Fix spacing, indent the text and add the trailing comments
+      run_passes(layout_pass_list, __func__);
 
-      if (options::sp_balance_nested_parens())
-      {
-         space_text_balance_nested_parens();
-      }
-      // Scrub certain added semicolons
-      log_rule_B("mod_pawn_semicolon");
-
-      if (language_is_set(LANG_PAWN) && options::mod_pawn_semicolon())
-      {
-         pawn_scrub_vsemi();
-      }
-      // Sort imports/using/include
-      log_rule_B("mod_sort_import");
-      log_rule_B("mod_sort_include");
-      log_rule_B("mod_sort_using");
-
-      if (  options::mod_sort_import()
-         || options::mod_sort_include()
-         || options::mod_sort_using())
-      {
-         sort_imports();
-      }
-      // Fix same-line inter-chunk spacing
-      space_text();
-
-      // Do any aligning of preprocessors
-      log_rule_B("align_pp_define_span");
-
-      if (options::align_pp_define_span() > 0)
-      {
-         align_preprocessor();
-      }
-      // Indent the text
-      indent_preproc();
-      indent_text();
-
-      // Insert trailing comments after certain close braces
-      log_rule_B("mod_add_long_switch_closebrace_comment");
-      log_rule_B("mod_add_long_function_closebrace_comment");
-      log_rule_B("mod_add_long_class_closebrace_comment");
-      log_rule_B("mod_add_long_namespace_closebrace_comment");
-
-      if (  (options::mod_add_long_switch_closebrace_comment() > 0)
-         || (options::mod_add_long_function_closebrace_comment() > 0)
-         || (options::mod_add_long_class_closebrace_comment() > 0)
-         || (options::mod_add_long_namespace_closebrace_comment() > 0))
-      {
-         add_long_closebrace_comment();
-      }
-      // Insert trailing comments after certain preprocessor conditional blocks
-      log_rule_B("mod_add_long_ifdef_else_comment");
-      log_rule_B("mod_add_long_ifdef_endif_comment");
-
-      if (  (options::mod_add_long_ifdef_else_comment() > 0)
-         || (options::mod_add_long_ifdef_endif_comment() > 0))
-      {
-         add_long_preprocessor_conditional_block_comment();
-      }
       // Align everything else, reindent and break at code_width
-      first = true;
+      code_width_first_round = true;
 
       do
       {
-         align_all();
-         indent_text();
+         profile_loop("code width");
+         run_passes(align_pass_list, __func__);
          old_changes = cpd.changes;
-
-         log_rule_B("code_width");
-
-         if (options::code_width() > 0)
-         {
-            LOG_FMT(LNEWLINE, "%s(%d): Code_width loop start: %d\n",
-                    __func__, __LINE__, cpd.changes);
-
-            if (options::debug_max_number_of_loops() > 0)
-            {
-               if (cpd.changes > options::debug_max_number_of_loops())                 // Issue #2432
-               {
-                  LOG_FMT(LNEWLINE, "%s(%d): too many loop. Make a report, please.\n",
-                          __func__, __LINE__);
-                  log_flush(true);
-                  exit(EX_SOFTWARE);
-               }
-            }
-            do_code_width();
-
-            if (old_changes != cpd.changes && first)
-            {
-               // retry line breaks caused by splitting 1-liners
-               newlines_cleanup_braces(false);
-               newlines_insert_blank_lines();
-               first = false;
-            }
-         }
+         run_passes(code_width_pass_list, __func__);
       } while (old_changes != cpd.changes);
 
-      // And finally, align the backslash newline stuff
-      align_right_comments();
+      // And finally, align the comments and the backslash newline stuff
+      run_passes(finish_pass_list, __func__);
 
-      log_rule_B("align_nl_cont");
-
-      if (options::align_nl_cont())
-      {
-         align_backslash_newline();
-      }
       // Now render it all to the output file
+      profile_stage("output_text");
       output_text(pfout);
    }
+   profile_file_end(cpd.filename.c_str());
+   emit_tokens(unc_stage_e::OTHER);
 
    // Special hook for dumping parsed data for debugging
    if (parsed_file != nullptr)
@@ -2255,7 +2564,6 @@ void uncrustify_end()
    }
    // Clean up some state variables
    cpd.unc_off     = false;
-   cpd.al_cnt      = 0;
    cpd.did_newline = true;
    cpd.pp_level    = 0;
    cpd.changes     = 0;
@@ -2264,6 +2572,7 @@ void uncrustify_end()
    cpd.preproc_ncnl_count                     = 0;
    cpd.ifdef_over_whole_file                  = 0;
    cpd.warned_unable_string_replace_tab_chars = false;
+   quick_align_forget();
 }
 
 
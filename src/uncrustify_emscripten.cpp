@@ -24,6 +24,10 @@
  *   --no-backup
  *   --replace
  *   --mtime
+ *   --threads ( the tokenizer runs on a single thread )
+ *   --emit-tokens, --emit-stage ( no file output )
+ *   --show-pipeline
+ *   --profile
  *   --universalindent
  *   -help, -h, --usage, -?
  *
@@ -517,7 +521,7 @@ intptr_t _uncrustify(intptr_t _file, lang_flag_e langIDX, bool frag, bool defer)
       fm.raw.push_back(c);
    }
 
-   if (!decode_unicode(fm.raw, fm.data, fm.enc, fm.bom))
+   if (!decode_unicode(fm.raw, fm.data, fm.enc, fm.bom, fm.zero_pos))
    {
       LOG_FMT(LERR, "Failed to read code\n");
       return(0);
@@ -129,6 +129,25 @@ struct align_ptr_t
 };
 
 
+/**
+ * A range of the decoded input file. It lets a chunk refer to a region that
+ * is copied to the output unchanged, without holding the text itself.
+ *
+ * The span does not own the text: data points to the decoded text the chunk
+ * was tokenized from, and copies of the chunk (chunk_dup(), the chunks
+ * tokenized_text_t keeps) share the pointer. That text must live as long as
+ * any chunk that refers to it. For a source file that is the file_mem of
+ * the file, kept until uncrustify_end() deletes the chunks; for the comment
+ * headers it is the file_mem in cpd, kept for the whole run.
+ */
+struct text_span_t
+{
+   const std::deque<int> *data; //! decoded input, nullptr if the span is unused
+   size_t                idx;   //! index of the first character in data
+   size_t                len;   //! number of characters
+};
+
+
 // This is the main type of this program
 struct chunk_t
 {
@@ -143,6 +162,7 @@ struct chunk_t
    {
       memset(&align, 0, sizeof(align));
       memset(&indent, 0, sizeof(indent));
+      memset(&span, 0, sizeof(span));
       next          = nullptr;
       prev          = nullptr;
       parent        = nullptr;
@@ -162,6 +182,10 @@ struct chunk_t
       pp_level      = 0;
       after_tab     = false;
       str.clear();
+      ncnl_next       = nullptr;
+      ncnl_prev       = nullptr;
+      ncnl_next_stamp = 0;
+      ncnl_prev_stamp = 0;
    }
 
 
@@ -202,6 +226,11 @@ struct chunk_t
    size_t       pp_level;         //! nest level in preprocessor
    bool         after_tab;        //! whether this token was after a tab
    unc_text     str;              //! the token text
+   text_span_t  span;             //! input region of a CT_IGNORED chunk that holds no str
+   chunk_t      *ncnl_next;       //! chunk_get_next_ncnl() of this chunk, if ncnl_next_stamp is current
+   chunk_t      *ncnl_prev;       //! chunk_get_prev_ncnl() of this chunk, if ncnl_prev_stamp is current
+   size_t       ncnl_next_stamp;  //! see g_links_stamp in chunk_list.cpp
+   size_t       ncnl_prev_stamp;
 };
 
 
@@ -265,13 +294,21 @@ struct align_t
    size_t    len;    //! length of the token + space
 };
 
+//! position of a char in a file
+struct file_pos_t
+{
+   size_t line;    //! line number, starts with 1
+   size_t column;  //! column number, starts with 1
+};
+
 //! holds information and data of a file
 struct file_mem
 {
-   std::vector<UINT8> raw;  //! raw content of file
-   std::deque<int>    data; //! processed content of file
+   std::vector<UINT8> raw;      //! raw content of file
+   std::deque<int>    data;     //! processed content of file
    bool               bom;
-   char_encoding_e    enc;  //! character encoding of file ASCII, utf, etc.
+   char_encoding_e    enc;      //! character encoding of file ASCII, utf, etc.
+   file_pos_t         zero_pos; //! first embedded 0 in data, line 0 if there is none
 #ifdef HAVE_UTIME_H
    struct utimbuf     utb;
 #endif
@@ -323,6 +360,8 @@ struct cp_data_t
    bool              frag;          //! activates code fragment option
    UINT32            frag_cols;
 
+   size_t            threads;       //! threads for large files, 0 for one per CPU core
+
    // stuff to auto-detect line endings
    UINT32            le_counts[uncrustify::line_end_styles];
    unc_text          newline;
@@ -340,16 +379,15 @@ struct cp_data_t
    int               changes;
    int               pass_count;       //! indicates how often the chunk list shall be processed
 
-   align_t           al[uncrustify::limits::AL_SIZE];
-   size_t            al_cnt;
-   bool              al_c99_array;
-
    bool              warned_unable_string_replace_tab_chars;
 
    int               pp_level;       // TODO: can this ever be -1?
 
    const char        *phase_name;
    const char        *dumped_file;
+
+   const char        *tokens_file;    //! where --emit-tokens writes the token stream
+   unc_stage_e       tokens_stage;    //! the stage after which it is written
 };
 
 extern cp_data_t cpd;  // TODO: can we avoid this external variable?
@@ -13,6 +13,7 @@
 #include "uncrustify.h"
 #include "uncrustify_types.h"
 
+#include <algorithm>
 #include <cstdlib>
 #include <cstring>
 
@@ -20,19 +21,46 @@
 using namespace std;
 
 
-//! See if all characters are ASCII (0-127)
-static bool is_ascii(const vector<UINT8> &data, size_t &non_ascii_cnt, size_t &zero_cnt);
+//! most bytes a single char takes in any of the output encodings
+static constexpr size_t MAX_CHAR_BYTES = 6;
+
+
+//! size of the block the encoded bytes are collected in before writing
+static constexpr size_t OUT_BUF_SIZE = 4096;
+
+
+//! number of chars that are checked and narrowed at once
+static constexpr size_t NARROW_CHARS = 8;
+
+
+//! index of the first 0 char when there is none
+static constexpr size_t NO_ZERO = static_cast<size_t>(-1);
 
 
 //! Convert the array of bytes into an array of ints
 static bool decode_bytes(const vector<UINT8> &in_data, deque<int> &out_data);
 
 
+/**
+ * Decode UTF-8 sequences from in_data and put the chars in out_data, while
+ * counting the bytes that are not ASCII (0-127) and the zero bytes.
+ * Everything is done in a single pass, blocks of ASCII are recognized and
+ * widened a word at a time.
+ * After a decoding error only the counting goes on, and out_data is left
+ * incomplete.
+ *
+ * @param first_zero  index of the first 0 char in out_data, NO_ZERO if none
+ *
+ * @return true if in_data is valid UTF-8
+ */
+static bool decode_utf8(const vector<UINT8> &in_data, deque<int> &out_data, size_t &non_ascii_cnt, size_t &zero_cnt, size_t &first_zero);
+
+
 /**
  * Decode UTF-8 sequences from in_data and put the chars in out_data.
  * If there are any decoding errors, then return false.
  */
-static bool decode_utf8(const vector<UINT8> &in_data, deque<int> &out_data);
+static bool decode_utf8(const vector<UINT8> &in_data, deque<int> &out_data, size_t &first_zero);
 
 
 /**
@@ -48,8 +76,10 @@ static int get_word(const vector<UINT8> &in_data, size_t &idx, bool be);
  * Decode a UTF-16 sequence.
  * Sets enc based on the BOM.
  * Must have the BOM as the first two bytes.
+ *
+ * @param first_zero  index of the first 0 char in out_data, NO_ZERO if none
  */
-static bool decode_utf16(const vector<UINT8> &in_data, deque<int> &out_data, char_encoding_e &enc);
+static bool decode_utf16(const vector<UINT8> &in_data, deque<int> &out_data, char_encoding_e &enc, size_t &first_zero);
 
 
 /**
@@ -60,134 +90,166 @@ static bool decode_utf16(const vector<UINT8> &in_data, deque<int> &out_data, cha
 static bool decode_bom(const vector<UINT8> &in_data, char_encoding_e &enc);
 
 
-//! Write for ASCII and BYTE encoding
-static void write_byte(int ch);
+//! Hands a block of encoded bytes on to the output file and buffer
+static void write_bytes(const UINT8 *bytes, size_t len);
 
 
-//! Writes a single character to a file using UTF-8 encoding
-static void write_utf8(int ch);
+//! Encoder for ASCII encoding, drops chars that do not fit in a byte
+static UINT8 *put_byte(int ch, UINT8 *dst);
 
 
-static void write_utf16(int ch, bool be);
+//! Encoder for BYTE encoding, keeps the low byte of each char
+static UINT8 *put_low_byte(int ch, UINT8 *dst);
 
 
-static bool is_ascii(const vector<UINT8> &data, size_t &non_ascii_cnt, size_t &zero_cnt)
-{
-   non_ascii_cnt = 0;
-   zero_cnt      = 0;
+//! Encoder for UTF-8 encoding
+static UINT8 *put_utf8(int ch, UINT8 *dst);
 
-   for (unsigned char value : data)
-   {
-      if (value & 0x80)
-      {
-         non_ascii_cnt++;
-      }
 
-      if (!value)
-      {
-         zero_cnt++;
-      }
-   }
+static UINT8 *put_utf16(int ch, bool be, UINT8 *dst);
 
-   return((non_ascii_cnt + zero_cnt) == 0);
-}
 
+//! Encoder for UTF-16 little endian encoding
+static UINT8 *put_utf16_le(int ch, UINT8 *dst);
 
-static bool decode_bytes(const vector<UINT8> &in_data, deque<int> &out_data)
-{
-   out_data.resize(in_data.size());
 
-   for (size_t idx = 0; idx < in_data.size(); idx++)
-   {
-      out_data[idx] = in_data[idx];
-   }
+//! Encoder for UTF-16 big endian encoding
+static UINT8 *put_utf16_be(int ch, UINT8 *dst);
+
+
+/**
+ * Encodes a run of chars with a single encoder and writes the bytes out
+ * in blocks. Runs of ASCII chars are checked in groups, so that the
+ * encoder only has to handle the plain case for them.
+ *
+ * @param it    first char to write
+ * @param last  end of the run
+ */
+template<UINT8 *(*encode)(int, UINT8 *)> static void write_run(deque<int>::const_iterator it, deque<int>::const_iterator last);
 
+
+static bool decode_bytes(const vector<UINT8> &in_data, deque<int> &out_data)
+{
+   out_data.assign(in_data.begin(), in_data.end());
    return(true);
 }
 
 
 void encode_utf8(int ch, vector<UINT8> &res)
 {
-   if (ch < 0)
-   {
-      // illegal code - do not store
-   }
-   else if (ch < 0x80)
-   {
-      // 0xxxxxxx
-      res.push_back(ch);
-   }
-   else if (ch < 0x0800)
-   {
-      // 110xxxxx 10xxxxxx
-      res.push_back(0xC0 | (ch >> 6));
-      res.push_back(0x80 | (ch & 0x3f));
-   }
-   else if (ch < 0x10000)
-   {
-      // 1110xxxx 10xxxxxx 10xxxxxx
-      res.push_back(0xE0 | (ch >> 12));
-      res.push_back(0x80 | ((ch >> 6) & 0x3f));
-      res.push_back(0x80 | (ch & 0x3f));
-   }
-   else if (ch < 0x200000)
-   {
-      // 11110xxx 10xxxxxx 10xxxxxx 10xxxxxx
-      res.push_back(0xF0 | (ch >> 18));
-      res.push_back(0x80 | ((ch >> 12) & 0x3f));
-      res.push_back(0x80 | ((ch >> 6) & 0x3f));
-      res.push_back(0x80 | (ch & 0x3f));
-   }
-   else if (ch < 0x4000000)
-   {
-      // 111110xx 10xxxxxx 10xxxxxx 10xxxxxx 10xxxxxx
-      res.push_back(0xF8 | (ch >> 24));
-      res.push_back(0x80 | ((ch >> 18) & 0x3f));
-      res.push_back(0x80 | ((ch >> 12) & 0x3f));
-      res.push_back(0x80 | ((ch >> 6) & 0x3f));
-      res.push_back(0x80 | (ch & 0x3f));
-   }
-   else // (ch <= 0x7fffffff)
-   {
-      // 1111110x 10xxxxxx 10xxxxxx 10xxxxxx 10xxxxxx 10xxxxxx
-      res.push_back(0xFC | (ch >> 30));
-      res.push_back(0x80 | ((ch >> 24) & 0x3f));
-      res.push_back(0x80 | ((ch >> 18) & 0x3f));
-      res.push_back(0x80 | ((ch >> 12) & 0x3f));
-      res.push_back(0x80 | ((ch >> 6) & 0x3f));
-      res.push_back(0x80 | (ch & 0x3f));
-   }
-} // encode_utf8
+   UINT8 bytes[MAX_CHAR_BYTES];
+
+   res.insert(res.end(), bytes, put_utf8(ch, bytes));
+}
+
+
+//! number of bytes that are checked and widened at once
+static constexpr size_t WORD_SIZE = sizeof(UINT64);
+
 
+//! the high bit of every byte in a word
+static constexpr UINT64 HIGH_BITS = 0x8080808080808080ULL;
 
-static bool decode_utf8(const vector<UINT8> &in_data, deque<int> &out_data)
+
+//! the low 7 bits of every byte in a word
+static constexpr UINT64 LOW_BITS = 0x7f7f7f7f7f7f7f7fULL;
+
+
+/**
+ * Counts the zero bytes in a word of ASCII bytes.
+ * Adding 0x7f to a byte 0-127 sets its high bit, unless the byte is zero.
+ */
+static size_t count_zero_bytes(UINT64 word)
 {
-   size_t idx = 0;
-   int    cnt;
+   UINT64 nonzero = ((word + LOW_BITS) & HIGH_BITS) >> 7;
 
-   out_data.clear();
+   // sum up the 0/1 flags of all bytes in the top byte
+   return(WORD_SIZE - static_cast<size_t>((nonzero * 0x0101010101010101ULL) >> 56));
+}
+
+
+static bool decode_utf8(const vector<UINT8> &in_data, deque<int> &out_data, size_t &non_ascii_cnt, size_t &zero_cnt, size_t &first_zero)
+{
+   const UINT8  *in   = in_data.data();
+   const size_t size  = in_data.size();
+   size_t       idx   = 0;
+   bool         valid = true;
+
+   non_ascii_cnt = 0;
+   zero_cnt      = 0;
+   first_zero    = NO_ZERO;
+
+   // there can't be more chars than bytes, shrink to fit at the end
+   out_data.resize(size);
+   auto out = out_data.begin();
 
    // check for UTF-8 BOM silliness and skip
-   if (in_data.size() >= 3)
+   if (  size >= 3
+      && (in[0] == 0xef)
+      && (in[1] == 0xbb)
+      && (in[2] == 0xbf))
    {
-      if (  (in_data[0] == 0xef)
-         && (in_data[1] == 0xbb)
-         && (in_data[2] == 0xbf))
-      {
-         idx = 3;  // skip it
-      }
+      non_ascii_cnt = 3;
+      idx           = 3;  // skip it
    }
 
-   while (idx < in_data.size())
+   while (idx < size)
    {
-      int ch = in_data[idx++];
+      if (idx + WORD_SIZE <= size)
+      {
+         UINT64 word;
+         memcpy(&word, in + idx, WORD_SIZE);
+
+         if ((word & HIGH_BITS) == 0)
+         {
+            // a block of ASCII, which is valid as it is
+            const size_t zeros = count_zero_bytes(word);
+
+            if (zeros > 0 && first_zero == NO_ZERO && valid)
+            {
+               first_zero = (out - out_data.begin())
+                            + (std::find(in + idx, in + idx + WORD_SIZE, 0) - (in + idx));
+            }
+            zero_cnt += zeros;
+
+            if (valid)
+            {
+               out = std::copy(in + idx, in + idx + WORD_SIZE, out);
+            }
+            idx += WORD_SIZE;
+            continue;
+         }
+      }
+      int ch = in[idx++];
 
       if (ch < 0x80)                   // 1-byte sequence
       {
-         out_data.push_back(ch);
+         if (ch == 0)
+         {
+            zero_cnt++;
+
+            if (first_zero == NO_ZERO && valid)
+            {
+               first_zero = out - out_data.begin();
+            }
+         }
+
+         if (valid)
+         {
+            *out++ = ch;
+         }
          continue;
       }
-      else if ((ch & 0xE0) == 0xC0)    // 2-byte sequence
+      non_ascii_cnt++;
+
+      if (!valid)
+      {
+         // only counting from here on
+         continue;
+      }
+      int cnt;
+
+      if ((ch & 0xE0) == 0xC0)         // 2-byte sequence
       {
          ch &= 0x1F;
          cnt = 1;
@@ -215,32 +277,48 @@ static bool decode_utf8(const vector<UINT8> &in_data, deque<int> &out_data)
       else
       {
          // invalid UTF-8 sequence
-         return(false);
+         valid = false;
+         continue;
       }
 
-      while (cnt-- > 0 && idx < in_data.size())
+      // the trailing bytes must all be 10xxxxxx, leave a bad one to be counted
+      while (  cnt > 0
+            && idx < size
+            && (in[idx] & 0xC0) == 0x80)
       {
-         int tmp = in_data[idx++];
+         ch = (ch << 6) | (in[idx++] & 0x3f);
+         non_ascii_cnt++;
+         cnt--;
+      }
 
-         if ((tmp & 0xC0) != 0x80)
-         {
-            // invalid UTF-8 sequence
-            return(false);
-         }
-         ch = (ch << 6) | (tmp & 0x3f);
+      if (cnt > 0)
+      {
+         // invalid or short UTF-8 sequence
+         valid = false;
+         continue;
       }
 
-      if (cnt >= 0)
+      if (ch == 0 && first_zero == NO_ZERO)
       {
-         // short UTF-8 sequence
-         return(false);
+         // an overlong encoding of 0
+         first_zero = out - out_data.begin();
       }
-      out_data.push_back(ch);
+      *out++ = ch;
    }
-   return(true);
+   out_data.erase(out, out_data.end());
+   return(valid);
 } // decode_utf8
 
 
+static bool decode_utf8(const vector<UINT8> &in_data, deque<int> &out_data, size_t &first_zero)
+{
+   size_t non_ascii_cnt;
+   size_t zero_cnt;
+
+   return(decode_utf8(in_data, out_data, non_ascii_cnt, zero_cnt, first_zero));
+}
+
+
 static int get_word(const vector<UINT8> &in_data, size_t &idx, bool be)
 {
    int ch;
@@ -262,9 +340,10 @@ static int get_word(const vector<UINT8> &in_data, size_t &idx, bool be)
 }
 
 
-static bool decode_utf16(const vector<UINT8> &in_data, deque<int> &out_data, char_encoding_e &enc)
+static bool decode_utf16(const vector<UINT8> &in_data, deque<int> &out_data, char_encoding_e &enc, size_t &first_zero)
 {
    out_data.clear();
+   first_zero = NO_ZERO;
 
    if (in_data.size() & 1)
    {
@@ -340,6 +419,10 @@ static bool decode_utf16(const vector<UINT8> &in_data, deque<int> &out_data, cha
       else if (  (ch >= 0 && ch < 0xD800)
               || ch >= 0xE000)
       {
+         if (ch == 0 && first_zero == NO_ZERO)
+         {
+            first_zero = out_data.size();
+         }
          out_data.push_back(ch);
       }
       else
@@ -383,8 +466,41 @@ static bool decode_bom(const vector<UINT8> &in_data, char_encoding_e &enc)
 }
 
 
-bool decode_unicode(const vector<UINT8> &in_data, deque<int> &out_data, char_encoding_e &enc, bool &has_bom)
+/**
+ * Finds the line and column of the first 0 char, a 0 at the very end of the
+ * data is ignored. Only walks the data if there is a 0 to find.
+ */
+static void locate_zero(const deque<int> &data, size_t first_zero, file_pos_t &zero_pos)
+{
+   zero_pos.line   = 0;
+   zero_pos.column = 0;
+
+   if (  data.empty()
+      || first_zero >= data.size() - 1)
+   {
+      return;
+   }
+   zero_pos.line   = 1;
+   zero_pos.column = 1;
+
+   for (size_t idx = 0; idx < first_zero; idx++)
+   {
+      zero_pos.column++;
+
+      if (data[idx] == '\n')
+      {
+         zero_pos.line++;
+         zero_pos.column = 1;
+      }
+   }
+}
+
+
+bool decode_unicode(const vector<UINT8> &in_data, deque<int> &out_data, char_encoding_e &enc, bool &has_bom, file_pos_t &zero_pos)
 {
+   size_t first_zero;
+   bool   result;
+
    // check for a BOM
    if (decode_bom(in_data, enc))
    {
@@ -392,20 +508,28 @@ bool decode_unicode(const vector<UINT8> &in_data, deque<int> &out_data, char_enc
 
       if (enc == char_encoding_e::e_UTF8)
       {
-         return(decode_utf8(in_data, out_data));
+         result = decode_utf8(in_data, out_data, first_zero);
       }
-      return(decode_utf16(in_data, out_data, enc));
+      else
+      {
+         result = decode_utf16(in_data, out_data, enc, first_zero);
+      }
+      locate_zero(out_data, first_zero, zero_pos);
+      return(result);
    }
    has_bom = false;
 
-   // Check for simple ASCII
-   size_t non_ascii_cnt;
-   size_t zero_cnt;
+   // Decode as UTF-8 and check for simple ASCII in one go
+   size_t     non_ascii_cnt;
+   size_t     zero_cnt;
+   const bool is_utf8 = decode_utf8(in_data, out_data, non_ascii_cnt, zero_cnt, first_zero);
 
-   if (is_ascii(in_data, non_ascii_cnt, zero_cnt))
+   if ((non_ascii_cnt + zero_cnt) == 0)
    {
+      // the ASCII chars are already in place
       enc = char_encoding_e::e_ASCII;
-      return(decode_bytes(in_data, out_data));
+      locate_zero(out_data, first_zero, zero_pos);
+      return(true);
    }
 
    // There are a lot of 0's in UTF-16 (~50%)
@@ -413,75 +537,152 @@ bool decode_unicode(const vector<UINT8> &in_data, deque<int> &out_data, char_enc
       && (zero_cnt <= (in_data.size() / 2)))
    {
       // likely is UTF-16
-      if (decode_utf16(in_data, out_data, enc))
+      deque<int> utf16_data;
+      size_t     utf16_zero;
+
+      if (decode_utf16(in_data, utf16_data, enc, utf16_zero))
       {
+         out_data.swap(utf16_data);
+         locate_zero(out_data, utf16_zero, zero_pos);
          return(true);
       }
    }
 
-   if (decode_utf8(in_data, out_data))
+   if (is_utf8)
    {
       enc = char_encoding_e::e_UTF8;
+      locate_zero(out_data, first_zero, zero_pos);
       return(true);
    }
    // it is an unrecognized byte sequence
-   enc = char_encoding_e::e_BYTE;
-   return(decode_bytes(in_data, out_data));
+   enc    = char_encoding_e::e_BYTE;
+   result = decode_bytes(in_data, out_data);
+
+   // the chars are the bytes, so the first 0 char is at the first 0 byte
+   first_zero = (zero_cnt > 0)
+                ? std::find(in_data.begin(), in_data.end(), 0) - in_data.begin()
+                : NO_ZERO;
+   locate_zero(out_data, first_zero, zero_pos);
+   return(result);
 } // decode_unicode
 
 
-static void write_byte(int ch)
+static void write_bytes(const UINT8 *bytes, size_t len)
 {
-   if ((ch & 0xff) == ch)
+   if (cpd.fout)
    {
-      if (cpd.fout)
-      {
-         fputc(ch, cpd.fout);
-      }
+      fwrite(bytes, 1, len, cpd.fout);
+   }
 
-      if (cpd.bout)
-      {
-         cpd.bout->push_back(static_cast<UINT8>(ch));
-      }
+   if (cpd.bout)
+   {
+      cpd.bout->insert(cpd.bout->end(), bytes, bytes + len);
+   }
+}
+
+
+static UINT8 *put_byte(int ch, UINT8 *dst)
+{
+   if ((ch & 0xff) == ch)
+   {
+      *dst++ = static_cast<UINT8>(ch);
    }
    else
    {
       // illegal code - do not store
    }
+   return(dst);
 }
 
 
-static void write_utf8(int ch)
+static UINT8 *put_low_byte(int ch, UINT8 *dst)
 {
-   vector<UINT8> vv;
+   if (ch >= 0)
+   {
+      *dst++ = static_cast<UINT8>(ch & 0xff);
+   }
+   return(dst);
+}
 
-   vv.reserve(6);
 
-   encode_utf8(ch, vv);
+static UINT8 *put_utf8(int ch, UINT8 *dst)
+{
+   if (ch < 0)
+   {
+      // illegal code - do not store
+   }
+   else if (ch < 0x80)
+   {
+      // 0xxxxxxx
+      *dst++ = ch;
+   }
+   else if (ch < 0x0800)
+   {
+      // 110xxxxx 10xxxxxx
+      *dst++ = 0xC0 | (ch >> 6);
+      *dst++ = 0x80 | (ch & 0x3f);
+   }
+   else if (ch < 0x10000)
+   {
+      // 1110xxxx 10xxxxxx 10xxxxxx
+      *dst++ = 0xE0 | (ch >> 12);
+      *dst++ = 0x80 | ((ch >> 6) & 0x3f);
+      *dst++ = 0x80 | (ch & 0x3f);
+   }
+   else if (ch < 0x200000)
+   {
+      // 11110xxx 10xxxxxx 10xxxxxx 10xxxxxx
+      *dst++ = 0xF0 | (ch >> 18);
+      *dst++ = 0x80 | ((ch >> 12) & 0x3f);
+      *dst++ = 0x80 | ((ch >> 6) & 0x3f);
+      *dst++ = 0x80 | (ch & 0x3f);
+   }
+   else if (ch < 0x4000000)
+   {
+      // 111110xx 10xxxxxx 10xxxxxx 10xxxxxx 10xxxxxx
+      *dst++ = 0xF8 | (ch >> 24);
+      *dst++ = 0x80 | ((ch >> 18) & 0x3f);
+      *dst++ = 0x80 | ((ch >> 12) & 0x3f);
+      *dst++ = 0x80 | ((ch >> 6) & 0x3f);
+      *dst++ = 0x80 | (ch & 0x3f);
+   }
+   else // (ch <= 0x7fffffff)
+   {
+      // 1111110x 10xxxxxx 10xxxxxx 10xxxxxx 10xxxxxx 10xxxxxx
+      *dst++ = 0xFC | (ch >> 30);
+      *dst++ = 0x80 | ((ch >> 24) & 0x3f);
+      *dst++ = 0x80 | ((ch >> 18) & 0x3f);
+      *dst++ = 0x80 | ((ch >> 12) & 0x3f);
+      *dst++ = 0x80 | ((ch >> 6) & 0x3f);
+      *dst++ = 0x80 | (ch & 0x3f);
+   }
+   return(dst);
+} // put_utf8
 
-   for (unsigned char char_val : vv)
+
+static UINT8 *put_word(int word, bool be, UINT8 *dst)
+{
+   if (be)
    {
-      write_byte(char_val);
+      *dst++ = word >> 8;
+      *dst++ = word & 0xff;
    }
+   else
+   {
+      *dst++ = word & 0xff;
+      *dst++ = word >> 8;
+   }
+   return(dst);
 }
 
 
-static void write_utf16(int ch, bool be)
+static UINT8 *put_utf16(int ch, bool be, UINT8 *dst)
 {
    // U+0000 to U+D7FF and U+E000 to U+FFFF
    if (  (ch >= 0 && ch < 0xD800)
       || (ch >= 0xE000 && ch < 0x10000))
    {
-      if (be)
-      {
-         write_byte(ch >> 8);
-         write_byte(ch & 0xff);
-      }
-      else
-      {
-         write_byte(ch & 0xff);
-         write_byte(ch >> 8);
-      }
+      dst = put_word(ch, be, dst);
    }
    else if (ch >= 0x10000 && ch < 0x110000)
    {
@@ -489,44 +690,90 @@ static void write_utf16(int ch, bool be)
       int w1 = 0xD800 + (v1 >> 10);
       int w2 = 0xDC00 + (v1 & 0x3ff);
 
-      if (be)
-      {
-         write_byte(w1 >> 8);
-         write_byte(w1 & 0xff);
-         write_byte(w2 >> 8);
-         write_byte(w2 & 0xff);
-      }
-      else
-      {
-         write_byte(w1 & 0xff);
-         write_byte(w1 >> 8);
-         write_byte(w2 & 0xff);
-         write_byte(w2 >> 8);
-      }
+      dst = put_word(w1, be, dst);
+      dst = put_word(w2, be, dst);
    }
    else
    {
       // illegal code - do not store
    }
-} // write_utf16
+   return(dst);
+} // put_utf16
+
+
+static UINT8 *put_utf16_le(int ch, UINT8 *dst)
+{
+   return(put_utf16(ch, false, dst));
+}
+
+
+static UINT8 *put_utf16_be(int ch, UINT8 *dst)
+{
+   return(put_utf16(ch, true, dst));
+}
+
+
+template<UINT8 *(*encode)(int, UINT8 *)>
+static void write_run(deque<int>::const_iterator it, deque<int>::const_iterator last)
+{
+   UINT8       buf[OUT_BUF_SIZE];
+   UINT8       *dst = buf;
+   const UINT8 *lim = buf + OUT_BUF_SIZE - NARROW_CHARS * MAX_CHAR_BYTES;
+
+   while (it != last)
+   {
+      if (dst > lim)
+      {
+         write_bytes(buf, dst - buf);
+         dst = buf;
+      }
+
+      if (last - it >= static_cast<ptrdiff_t>(NARROW_CHARS))
+      {
+         int group[NARROW_CHARS];
+         int bits = 0;
+
+         for (size_t k = 0; k < NARROW_CHARS; k++)
+         {
+            group[k] = it[k];
+            bits    |= group[k];
+         }
+
+         // no bits above 0x7f, including the sign, so they are all ASCII
+         if ((bits & ~0x7f) == 0)
+         {
+            for (size_t k = 0; k < NARROW_CHARS; k++)
+            {
+               dst = encode(group[k], dst);
+            }
+
+            it += NARROW_CHARS;
+            continue;
+         }
+      }
+      dst = encode(*it, dst);
+      ++it;
+   }
+   write_bytes(buf, dst - buf);
+} // write_run
 
 
 void write_bom(void)
 {
+   UINT8 bytes[MAX_CHAR_BYTES];
+
    switch (cpd.enc)
    {
    case char_encoding_e::e_UTF8:
-      write_byte(0xef);
-      write_byte(0xbb);
-      write_byte(0xbf);
+      write_bytes(bytes, put_utf8(0xfeff, bytes) - bytes);
       break;
 
    case char_encoding_e::e_UTF16_LE:
-      write_utf16(0xfeff, false);
+      write_bytes(bytes, put_utf16_le(0xfeff, bytes) - bytes);
       break;
 
    case char_encoding_e::e_UTF16_BE:
-      write_utf16(0xfeff, true);
+      write_bytes(bytes, put_utf16_be(0xfeff, bytes) - bytes);
       break;
 
    default:
@@ -541,39 +788,69 @@ void write_bom(void)
 
 void write_char(int ch)
 {
-   if (ch >= 0)
+   UINT8 bytes[MAX_CHAR_BYTES];
+   UINT8 *end;
+
+   switch (cpd.enc)
    {
-      switch (cpd.enc)
-      {
-      case char_encoding_e::e_BYTE:
-         write_byte(ch & 0xff);
-         break;
-
-      case char_encoding_e::e_ASCII:
-      default:
-         write_byte(ch);
-         break;
-
-      case char_encoding_e::e_UTF8:
-         write_utf8(ch);
-         break;
-
-      case char_encoding_e::e_UTF16_LE:
-         write_utf16(ch, false);
-         break;
-
-      case char_encoding_e::e_UTF16_BE:
-         write_utf16(ch, true);
-         break;
-      }
+   case char_encoding_e::e_BYTE:
+      end = put_low_byte(ch, bytes);
+      break;
+
+   case char_encoding_e::e_ASCII:
+   default:
+      end = put_byte(ch, bytes);
+      break;
+
+   case char_encoding_e::e_UTF8:
+      end = put_utf8(ch, bytes);
+      break;
+
+   case char_encoding_e::e_UTF16_LE:
+      end = put_utf16_le(ch, bytes);
+      break;
+
+   case char_encoding_e::e_UTF16_BE:
+      end = put_utf16_be(ch, bytes);
+      break;
    }
+   write_bytes(bytes, end - bytes);
 }
 
 
-void write_string(const unc_text &text)
+void write_chars(const deque<int> &chars, size_t idx, size_t len)
 {
-   for (size_t idx = 0; idx < text.size(); idx++)
+   auto it   = chars.begin() + idx;
+   auto last = it + len;
+
+   // pick the encoder once for the whole run
+   switch (cpd.enc)
    {
-      write_char(text[idx]);
+   case char_encoding_e::e_BYTE:
+      write_run<put_low_byte>(it, last);
+      break;
+
+   case char_encoding_e::e_ASCII:
+   default:
+      write_run<put_byte>(it, last);
+      break;
+
+   case char_encoding_e::e_UTF8:
+      write_run<put_utf8>(it, last);
+      break;
+
+   case char_encoding_e::e_UTF16_LE:
+      write_run<put_utf16_le>(it, last);
+      break;
+
+   case char_encoding_e::e_UTF16_BE:
+      write_run<put_utf16_be>(it, last);
+      break;
    }
 }
+
+
+void write_string(const unc_text &text)
+{
+   write_chars(text.get(), 0, text.size());
+}
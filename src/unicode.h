@@ -22,11 +22,27 @@ void write_bom(void);
 void write_char(int ch);
 
 
+/**
+ * Writes a run of chars in the output encoding
+ *
+ * @param chars  the chars to take the run from
+ * @param idx    index of the first char to write
+ * @param len    number of chars to write
+ */
+void write_chars(const std::deque<int> &chars, size_t idx, size_t len);
+
+
 void write_string(const unc_text &text);
 
 
-//! Figure out the encoding and convert to an int sequence
-bool decode_unicode(const std::vector<UINT8> &in_data, std::deque<int> &out_data, char_encoding_e &enc, bool &has_bom);
+/**
+ * Figure out the encoding and convert to an int sequence
+ *
+ * @param zero_pos  set to the position of the first embedded 0 in out_data,
+ *                  line 0 if there is none. A 0 as the last char is not
+ *                  counted.
+ */
+bool decode_unicode(const std::vector<UINT8> &in_data, std::deque<int> &out_data, char_encoding_e &enc, bool &has_bom, file_pos_t &zero_pos);
 
 
 void encode_utf8(int ch, std::vector<UINT8> &res);
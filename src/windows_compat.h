@@ -17,6 +17,8 @@
 
 #define HAVE_SYS_STAT_H
 
+#define HAVE_THREADS
+
 #define NO_MACRO_VARARG
 
 typedef char                 CHAR;
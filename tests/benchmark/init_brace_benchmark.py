@@ -0,0 +1,95 @@
+#!/usr/bin/env python
+#
+# Measures how the alignment of brace initializers of uncrustify scales with
+# the width of the tables. Generates lookup tables with the same number of
+# cells but more and more columns, formats them with --profile=json and
+# prints the time align_all takes per cell. The widest table has more columns
+# than the fixed size table of columns that uncrustify used to have.
+#
+# Usage: init_brace_benchmark.py --executable UNCRUSTIFY [--columns 16,256,9000]
+#
+
+import argparse
+import json
+import os
+import random
+import subprocess
+import sys
+import tempfile
+
+
+CONFIG = '''\
+indent_columns         = 4
+align_struct_init_span = 3
+align_number_right     = true
+'''
+
+
+# -----------------------------------------------------------------------------
+def generate(path, rows, columns):
+    """Writes a table with numbers of random widths, so the columns move"""
+    rnd = random.Random(columns)
+
+    with open(path, 'wt') as f:
+        f.write('static const int table[][{}] = {{\n'.format(columns))
+        for row in range(rows):
+            cells = [str(rnd.randint(0, 10 ** rnd.randint(1, 6)))
+                     for col in range(columns)]
+            f.write('    {{ {} }},\n'.format(', '.join(cells)))
+        f.write('};\n')
+
+
+# -----------------------------------------------------------------------------
+def run(exe, cfg, src):
+    proc = subprocess.run(
+        [exe, '-q', '-c', cfg, '-f', src, '-o', os.devnull,
+         '--profile=json'],
+        stdout=subprocess.PIPE, stderr=subprocess.PIPE,
+        universal_newlines=True)
+
+    if proc.returncode != 0:
+        sys.stderr.write(proc.stderr)
+        raise RuntimeError('uncrustify failed on {}'.format(src))
+
+    stages = json.loads(proc.stderr)['total']['stages']
+    return sum(s['ms'] for s in stages if s['stage'] == 'align_all')
+
+
+# -----------------------------------------------------------------------------
+def main(argv):
+    parser = argparse.ArgumentParser(
+        description='Measure the brace initializer alignment of uncrustify')
+    parser.add_argument('--executable', required=True,
+                        help='the uncrustify binary to measure')
+    parser.add_argument('--columns', default='16,256,9000',
+                        help='the numbers of columns of the tables')
+    parser.add_argument('--cells', type=int, default=20000,
+                        help='the number of cells of each table')
+    args = parser.parse_args(argv)
+
+    columns = [int(col) for col in args.columns.split(',')]
+
+    with tempfile.TemporaryDirectory() as tmp:
+        cfg = os.path.join(tmp, 'init_brace.cfg')
+        with open(cfg, 'wt') as f:
+            f.write(CONFIG)
+
+        print('{:>8} {:>6} {:>10} {:>10}'.format(
+            'columns', 'rows', 'align_all', 'us/cell'))
+
+        for width in columns:
+            rows = max(2, args.cells // width)
+            src = os.path.join(tmp, 'table{}.c'.format(width))
+            generate(src, rows, width)
+
+            align_ms = run(args.executable, cfg, src)
+            print('{:>8} {:>6} {:>10.3f} {:>10.3f}'.format(
+                width, rows, align_ms, 1000.0 * align_ms / (rows * width)))
+
+    return 0
+
+
+# -----------------------------------------------------------------------------
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv[1:]))
@@ -0,0 +1,115 @@
+#!/usr/bin/env python
+#
+# Measures how brace_cleanup and indent_text of uncrustify scale with the
+# depth of #if nesting. Generates inputs with the same number of blocks of
+# nested #if/#elif/#else/#endif inside nested braces, formats them with
+# --profile=json and prints the time the two stages take per directive,
+# which should not grow much with the depth.
+#
+# Usage: pp_nesting_benchmark.py --executable UNCRUSTIFY [--depths 10,25,50]
+#
+
+import argparse
+import json
+import os
+import subprocess
+import sys
+import tempfile
+
+
+CONFIG = '''\
+indent_columns = 4
+pp_indent      = add
+pp_indent_if   = 2
+'''
+
+
+# -----------------------------------------------------------------------------
+def generate(path, blocks, depth, braces):
+    """Writes the input, returns the number of preprocessor directives"""
+    directives = 0
+
+    with open(path, 'wt') as f:
+        f.write('namespace n {\n')
+        for level in range(braces):
+            f.write('struct s{} {{\n'.format(level))
+
+        for block in range(blocks):
+            for level in range(depth):
+                f.write('#if defined(CFG_{}_{})\n'.format(block, level))
+                f.write('int a{0}_{1} = {1};\n'.format(block, level))
+            for level in reversed(range(depth)):
+                f.write('#elif defined(OTHER_{}_{})\n'.format(block, level))
+                f.write('int b{}_{};\n'.format(block, level))
+                f.write('#else\n')
+                f.write('int c{}_{};\n'.format(block, level))
+                f.write('#endif\n')
+            directives += 4 * depth
+
+        for level in range(braces):
+            f.write('};\n')
+        f.write('}\n')
+
+    return directives
+
+
+# -----------------------------------------------------------------------------
+def run(exe, cfg, src):
+    proc = subprocess.run(
+        [exe, '-q', '-c', cfg, '-f', src, '-o', os.devnull,
+         '--profile=json'],
+        stdout=subprocess.PIPE, stderr=subprocess.PIPE,
+        universal_newlines=True)
+
+    if proc.returncode != 0:
+        sys.stderr.write(proc.stderr)
+        raise RuntimeError('uncrustify failed on {}'.format(src))
+
+    stages = json.loads(proc.stderr)['total']['stages']
+    ms = {}
+    for stage in stages:
+        ms[stage['stage']] = ms.get(stage['stage'], 0.0) + stage['ms']
+    return ms.get('brace_cleanup', 0.0), ms.get('indent_text', 0.0)
+
+
+# -----------------------------------------------------------------------------
+def main(argv):
+    parser = argparse.ArgumentParser(
+        description='Measure the #if handling of uncrustify')
+    parser.add_argument('--executable', required=True,
+                        help='the uncrustify binary to measure')
+    parser.add_argument('--depths', default='10,25,50',
+                        help='the depths of #if nesting to generate')
+    parser.add_argument('--blocks', type=int, default=100,
+                        help='the number of nested #if blocks')
+    parser.add_argument('--braces', type=int, default=30,
+                        help='the depth of braces around the blocks')
+    args = parser.parse_args(argv)
+
+    depths = [int(depth) for depth in args.depths.split(',')]
+
+    with tempfile.TemporaryDirectory() as tmp:
+        cfg = os.path.join(tmp, 'pp_nesting.cfg')
+        with open(cfg, 'wt') as f:
+            f.write(CONFIG)
+
+        print('{:>6} {:>10} {:>14} {:>12} {:>12}'.format(
+            'depth', 'directives', 'brace_cleanup', 'indent_text',
+            'us/directive'))
+
+        for depth in depths:
+            src = os.path.join(tmp, 'pp{}.cpp'.format(depth))
+            directives = generate(src, args.blocks, depth, args.braces)
+
+            brace_ms, indent_ms = run(args.executable, cfg, src)
+            print('{:>6} {:>10} {:>14.3f} {:>12.3f} {:>12.3f}'.format(
+                depth, directives, brace_ms, indent_ms,
+                1000.0 * (brace_ms + indent_ms) / directives))
+
+    return 0
+
+
+# -----------------------------------------------------------------------------
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv[1:]))
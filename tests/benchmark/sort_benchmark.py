@@ -0,0 +1,99 @@
+#!/usr/bin/env python
+#
+# Measures how the sorting of #include and import lines of uncrustify scales
+# with the number of lines. Generates blocks of includes and of Java imports
+# in random order, formats them with --profile=json and prints the time
+# sort_imports takes per line, which should not grow much with the count.
+#
+# Usage: sort_benchmark.py --executable UNCRUSTIFY [--lines 100,1000,10000]
+#
+
+import argparse
+import json
+import os
+import random
+import subprocess
+import sys
+import tempfile
+
+
+CONFIG = '''\
+mod_sort_include = true
+mod_sort_import  = true
+'''
+
+
+# -----------------------------------------------------------------------------
+def name(rnd, parts, sep):
+    return sep.join(''.join(rnd.choice('abcdefghXY_') for c in range(6))
+                    for part in range(parts))
+
+
+# -----------------------------------------------------------------------------
+def generate(path, lines, java):
+    """Writes a block of lines to sort, in random order"""
+    rnd = random.Random(lines)
+
+    with open(path, 'wt') as f:
+        for line in range(lines):
+            if java:
+                f.write('import {};\n'.format(name(rnd, 3, '.')))
+            else:
+                f.write('#include <{}.h>\n'.format(name(rnd, 2, '/')))
+        f.write('class A {}\n' if java else 'int a;\n')
+
+
+# -----------------------------------------------------------------------------
+def run(exe, cfg, src):
+    proc = subprocess.run(
+        [exe, '-q', '-c', cfg, '-f', src, '-o', os.devnull,
+         '--profile=json'],
+        stdout=subprocess.PIPE, stderr=subprocess.PIPE,
+        universal_newlines=True)
+
+    if proc.returncode != 0:
+        sys.stderr.write(proc.stderr)
+        raise RuntimeError('uncrustify failed on {}'.format(src))
+
+    stages = json.loads(proc.stderr)['total']['stages']
+    return sum(s['ms'] for s in stages if s['stage'] == 'sort_imports')
+
+
+# -----------------------------------------------------------------------------
+def main(argv):
+    parser = argparse.ArgumentParser(
+        description='Measure the include and import sorting of uncrustify')
+    parser.add_argument('--executable', required=True,
+                        help='the uncrustify binary to measure')
+    parser.add_argument('--lines', default='100,1000,10000',
+                        help='the numbers of lines to sort')
+    args = parser.parse_args(argv)
+
+    counts = [int(count) for count in args.lines.split(',')]
+
+    with tempfile.TemporaryDirectory() as tmp:
+        cfg = os.path.join(tmp, 'sort.cfg')
+        with open(cfg, 'wt') as f:
+            f.write(CONFIG)
+
+        print('{:>8} {:>6} {:>12} {:>10}'.format(
+            'language', 'lines', 'sort_imports', 'us/line'))
+
+        for java in (False, True):
+            for count in counts:
+                src = os.path.join(tmp, 'sort{}.{}'.format(
+                    count, 'java' if java else 'cpp'))
+                generate(src, count, java)
+
+                sort_ms = run(args.executable, cfg, src)
+                print('{:>8} {:>6} {:>12.3f} {:>10.3f}'.format(
+                    'java' if java else 'c++', count, sort_ms,
+                    1000.0 * sort_ms / count))
+
+    return 0
+
+
+# -----------------------------------------------------------------------------
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv[1:]))
@@ -0,0 +1,118 @@
+/**
+ * @file unicode_benchmark.cpp
+ * Measures the throughput of decode_unicode() over a set of input files.
+ *
+ * Usage: unicode_benchmark [-n LOOPS] -F FILE
+ *   -n LOOPS : number of times every file is decoded (default 20)
+ *   -F FILE  : read the files to decode from FILE, one filename per line
+ *
+ * @license GPL v2+
+ */
+
+#include "unicode.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+
+using namespace std;
+
+
+// unicode.cpp writes through the global state of the program
+cp_data_t cpd;
+
+
+static bool load_file(const string &filename, vector<UINT8> &raw)
+{
+   ifstream in(filename.c_str(), ios::binary);
+
+   if (!in)
+   {
+      return(false);
+   }
+   raw.assign(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+   return(true);
+}
+
+
+int main(int argc, char *argv[])
+{
+   const char *list = nullptr;
+   size_t     loops = 20;
+
+   for (int idx = 1; idx < argc; idx++)
+   {
+      if (strcmp(argv[idx], "-n") == 0 && idx + 1 < argc)
+      {
+         loops = strtoul(argv[++idx], nullptr, 10);
+      }
+      else if (strcmp(argv[idx], "-F") == 0 && idx + 1 < argc)
+      {
+         list = argv[++idx];
+      }
+   }
+
+   if (list == nullptr)
+   {
+      fprintf(stderr, "Usage: %s [-n LOOPS] -F FILE\n", argv[0]);
+      return(EXIT_FAILURE);
+   }
+   ifstream               names(list);
+   string                 name;
+   vector<vector<UINT8> > files;
+   size_t                 total_bytes = 0;
+
+   while (getline(names, name))
+   {
+      vector<UINT8> raw;
+
+      if (!name.empty() && load_file(name, raw))
+      {
+         total_bytes += raw.size();
+         files.push_back(raw);
+      }
+   }
+   // count the encodings once, then time the repeated decoding
+   size_t enc_cnt[5] = { 0 };
+   size_t chars      = 0;
+
+   for (const auto &raw : files)
+   {
+      deque<int>      data;
+      char_encoding_e enc;
+      bool            bom;
+      file_pos_t      zero_pos;
+
+      decode_unicode(raw, data, enc, bom, zero_pos);
+      enc_cnt[static_cast<size_t>(enc)]++;
+      chars += data.size();
+   }
+
+   const auto start = chrono::steady_clock::now();
+
+   for (size_t loop = 0; loop < loops; loop++)
+   {
+      for (const auto &raw : files)
+      {
+         deque<int>      data;
+         char_encoding_e enc;
+         bool            bom;
+         file_pos_t      zero_pos;
+
+         decode_unicode(raw, data, enc, bom, zero_pos);
+      }
+   }
+
+   const double secs = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+   const double mb   = static_cast<double>(total_bytes * loops) / (1024.0 * 1024.0);
+
+   printf("files     : %zu (%zu bytes, %zu chars)\n", files.size(), total_bytes, chars);
+   printf("encodings : ASCII %zu, BYTE %zu, UTF-8 %zu, UTF-16 LE %zu, UTF-16 BE %zu\n",
+          enc_cnt[0], enc_cnt[1], enc_cnt[2], enc_cnt[3], enc_cnt[4]);
+   printf("decoded   : %.1f MiB in %.3f s, %.1f MiB/s\n", mb, secs, (secs > 0) ? mb / secs : 0.0);
+   return(EXIT_SUCCESS);
+} // main
@@ -0,0 +1,6 @@
+int a  =  1;
+/* *INDENT-OFF* */
+int   b =   2;
+   int c=3;
+/* *INDENT-ON* */
+int d  =  4;
@@ -0,0 +1,13 @@
+class A
+{
+@Foo @Bar
+void f()
+{
+if (x)
+
+
+{
+y();
+}
+}
+}
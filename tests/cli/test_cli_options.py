@@ -21,6 +21,7 @@ import re
 import difflib
 import argparse
 import pprint
+import struct
 
 if os_name == 'nt':
     EX_OK = 0
@@ -380,6 +381,51 @@ def check_uncrustify_output(
     return ret_flag
 
 
+def read_token_stream(path):
+    """
+    renders a token stream written by --emit-tokens as text, one line per
+    chunk, following the format in documentation/token_stream.txt
+
+
+    Parameters
+    ----------------------------------------------------------------------------
+    :param path: string
+        path to the token stream
+
+    :return: string or None
+    ----------------------------------------------------------------------------
+    the text, None if the stream could not be read
+    """
+    try:
+        with open(path, 'rb') as f:
+            data = f.read()
+    except IOError:
+        eprint("Failed to read '%s'" % path)
+        return None
+
+    order = '<' if struct.unpack_from('<I', data, 60)[0] == 0x01020304 else '>'
+    (magic, version, header_size, record_size, stage, count, text_offset,
+     text_size, names_offset, names_count) = struct.unpack_from(
+        order + '8s4I4QI', data, 0)
+    if magic != b'UNCTOKEN':
+        eprint("'%s' is not a token stream" % path)
+        return None
+
+    names = data[names_offset:].split(b'\0')[:names_count]
+    lines = [u'version %d, stage %d, %d chunks' % (version, stage, count)]
+    for idx in range(count):
+        (flags, tok, parent, level, brace_level, pp_level, line, col, col_end,
+         column, nl_count, text_len, text_pos) = struct.unpack_from(
+            order + 'Q2H9IQ', data, header_size + idx * record_size)
+        text = data[text_offset + text_pos:text_offset + text_pos + text_len]
+        text = text.decode('utf-8').replace(u'\n', u'\\n')
+        lines.append((u'%3d:%-3d %-3d %s|%s [%d/%d/%d] %x %d %s' % (
+            line, col, col_end, names[tok].decode('utf-8'),
+            names[parent].decode('utf-8'), brace_level, level, pp_level,
+            flags, nl_count, text)).rstrip())
+    return u'\n'.join(lines) + u'\n'
+
+
 def clear_dir(path):
     """
     clears a directory by deleting and creating it again
@@ -648,6 +694,90 @@ def main(args):
             ):
         return_flag = False
 
+    #
+    # Test --emit-tokens, also with a region where formatting is disabled
+    #
+    for src, name in [('testSrcP.cpp', 'tokens'),
+                      ('disabled.cpp', 'tokens-disabled')]:
+        tokens_path = s_path_join(script_dir, 'results/%s.bin' % name)
+        proc(uncr_bin, ['-c', s_path_join(script_dir, 'config/mini_nd.cfg'),
+                        '-f', s_path_join(script_dir, 'input/%s' % src),
+                        '-o', NULL_DEVICE,
+                        '--emit-tokens', tokens_path,
+                        '--emit-stage', 'FIX_SYMBOLS'])
+        tokens_txt = read_token_stream(tokens_path)
+        if parsed_args.apply:
+            parsed_args.auto_output_path = s_path_join(script_dir, 'output/%s.txt' % name)
+        if tokens_txt is None or not check_std_output(
+                s_path_join(script_dir, 'output/%s.txt' % name),
+                s_path_join(script_dir, 'results/%s.txt' % name),
+                tokens_txt, program_args=parsed_args):
+            return_flag = False
+        else:
+            remove(tokens_path)
+
+    # the token stream and the formatted code cannot both go to stdout
+    if not check_uncrustify_output(
+            uncr_bin,
+            parsed_args,
+            args_arr=['-q', '-c', s_path_join(script_dir, 'config/replace.cfg'),
+                      '-f', s_path_join(script_dir, 'input/testSrcP.cpp'),
+                      '--emit-tokens', '-'],
+            err_expected_path=s_path_join(script_dir, 'output/tokens-err.txt'),
+            err_result_path=s_path_join(script_dir, 'results/tokens-err.txt')
+            ):
+        return_flag = False
+
+    #
+    # Test --show-pipeline
+    #
+    if not check_uncrustify_output(
+            uncr_bin,
+            parsed_args,
+            args_arr=['-c', s_path_join(script_dir, 'config/mini_nd.cfg'),
+                      '--set', 'nl_after_multiline_comment=true',
+                      '--set', 'nl_after_label_colon=true',
+                      '--set', 'code_width=80',
+                      '--show-pipeline'],
+            out_expected_path=s_path_join(script_dir, 'output/pipeline.txt'),
+            out_result_path=s_path_join(script_dir, 'results/pipeline.txt')
+            ):
+        return_flag = False
+
+    #
+    # Test --profile=json, the times differ from run to run
+    #
+    if not check_uncrustify_output(
+            uncr_bin,
+            parsed_args,
+            args_arr=['-q', '-c', s_path_join(script_dir, 'config/replace.cfg'),
+                      '-f', s_path_join(script_dir, 'input/testSrcP.cpp'),
+                      '-o', NULL_DEVICE,
+                      '--profile=json'],
+            err_expected_path=s_path_join(script_dir, 'output/profile.txt'),
+            err_result_path=s_path_join(script_dir, 'results/profile.txt'),
+            err_result_manip=[reg_replace(r'"ms": [0-9.]+', '"ms": 0'),
+                              reg_replace(r'"file": "[^"]*"', '"file": "testSrcP.cpp"')]
+            ):
+        return_flag = False
+
+    #
+    # Test that a newline pass runs again after a change of a field only
+    #
+    if not check_uncrustify_output(
+            uncr_bin,
+            parsed_args,
+            args_arr=['-q', '-c', s_path_join(script_dir, 'config/field_change.cfg'),
+                      '-f', s_path_join(script_dir, 'input/field_change.java'),
+                      '-o', NULL_DEVICE,
+                      '--profile=json'],
+            err_expected_path=s_path_join(script_dir, 'output/field_change.txt'),
+            err_result_path=s_path_join(script_dir, 'results/field_change.txt'),
+            err_result_manip=[reg_replace(r'"ms": [0-9.]+', '"ms": 0'),
+                              reg_replace(r'"file": "[^"]*"', '"file": "field_change.java"')]
+            ):
+        return_flag = False
+
     #
     # Test --replace
     #
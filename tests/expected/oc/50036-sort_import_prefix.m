@@ -0,0 +1,18 @@
+#import "a.hpp"
+#import "aa.hxx"
+#import "ab.h"
+#import "b.h"
+
+#import "a.hpp"
+#import "aa.hxx"
+#import "ab.h"
+#import "b.h"
+
+#import "a.h"
+#import "a.hpp"
+#import "aa.hxx"
+#import "ab.h"
+#import "b.h"
+
+@interface Foo : NSObject
+@end
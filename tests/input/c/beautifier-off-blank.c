@@ -0,0 +1,22 @@
+int a;
+
+/* *INDENT-OFF* */   
+int   b ;   
+   
+	
+  int c;  
+ 	 
+   int d;
+
+    
+/* *INDENT-ON* */
+int   e;
+
+#asm
+  mov a,b  
+    
+
+  mov b,c
+	
+#endasm
+int   f;
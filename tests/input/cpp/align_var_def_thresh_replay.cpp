@@ -0,0 +1,26 @@
+void comes_back()
+{
+int a;
+unsigned_long_long_type b;
+char c;
+short_t d;
+medium_t e;
+longer_type f;
+even_longer_t g;
+x h;
+very_very_long_type_name i;
+y j;
+longer_type_k k;
+}
+
+void stays_skipped()
+{
+int a;
+very_long_type_name b;
+long c;
+short_t d;
+longer_t e;
+longest_t f;
+int_type_ten g;
+int h;
+}
@@ -0,0 +1,18 @@
+#import "ab.h"
+#import "aa.hxx"
+#import "a.hpp"
+#import "b.h"
+
+#import "a.hpp"
+#import "b.h"
+#import "ab.h"
+#import "aa.hxx"
+
+#import "aa.hxx"
+#import "ab.h"
+#import "b.h"
+#import "a.hpp"
+#import "a.h"
+
+@interface Foo : NSObject
+@end